@@ -6,7 +6,6 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
-#include <zephyr/sys/ring_buffer.h>
 
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/uuid.h>
@@ -20,6 +19,7 @@
 #include "ble_ctrl_event.h"
 #include "ble_data_event.h"
 #include "uart_data_event.h"
+#include "bridge_buf.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(MODULE, CONFIG_BRIDGE_BLE_LOG_LEVEL);
@@ -28,8 +28,6 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_BRIDGE_BLE_LOG_LEVEL);
 #define BLE_RX_BUF_COUNT 4
 #define BLE_SLAB_ALIGNMENT 4
 
-#define BLE_TX_BUF_SIZE (CONFIG_BRIDGE_BUF_SIZE * 2)
-
 #define BLE_AD_IDX_FLAGS 0
 #define BLE_AD_IDX_NAME 1
 
@@ -38,11 +36,14 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_BRIDGE_BLE_LOG_LEVEL);
 static void bt_send_work_handler(struct k_work *work);
 
 K_MEM_SLAB_DEFINE(ble_rx_slab, BLE_RX_BLOCK_SIZE, BLE_RX_BUF_COUNT, BLE_SLAB_ALIGNMENT);
-RING_BUF_DECLARE(ble_tx_ring_buf, BLE_TX_BUF_SIZE);
+/* UART data is sent in place from the UART RX blocks */
+static struct bridge_frag_queue ble_tx_queue;
 
 static K_SEM_DEFINE(ble_tx_sem, 0, 1);
 
 static K_WORK_DEFINE(bt_send_work, bt_send_work_handler);
+/* The queue is flushed by bt_send_work, so that it does not release the data being sent */
+static atomic_t tx_flush_pending;
 
 static struct bt_conn *current_conn;
 static struct bt_gatt_exchange_params exchange_params;
@@ -89,7 +90,8 @@ static void connected(struct bt_conn *conn, uint8_t err)
 		LOG_WRN("bt_gatt_exchange_mtu: %d", err);
 	}
 
-	ring_buf_reset(&ble_tx_ring_buf);
+	atomic_set(&tx_flush_pending, true);
+	k_work_submit(&bt_send_work);
 
 	struct peer_conn_event *event = new_peer_conn_event();
 
@@ -112,6 +114,10 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
+	/* Don't hold UART blocks while disconnected */
+	atomic_set(&tx_flush_pending, true);
+	k_work_submit(&bt_send_work);
+
 	struct peer_conn_event *event = new_peer_conn_event();
 
 	event->peer_id = PEER_ID_BLE;
@@ -128,13 +134,22 @@ static struct bt_conn_cb conn_callbacks = {
 
 static void bt_send_work_handler(struct k_work *work)
 {
-	uint16_t len;
+	size_t len;
 	uint8_t *buf;
 	int err;
 	bool notif_disabled = false;
 
+	if (atomic_set(&tx_flush_pending, false)) {
+		bridge_frag_queue_flush(&ble_tx_queue);
+		return;
+	}
+
 	do {
-		len = ring_buf_get_claim(&ble_tx_ring_buf, &buf, nus_max_send_len);
+		len = bridge_frag_queue_peek(&ble_tx_queue, &buf);
+		len = MIN(len, nus_max_send_len);
+		if (len == 0) {
+			break;
+		}
 
 		err = bt_nus_send(current_conn, buf, len);
 		if (err == -EINVAL) {
@@ -144,16 +159,12 @@ static void bt_send_work_handler(struct k_work *work)
 			len = 0;
 		}
 
-		err = ring_buf_get_finish(&ble_tx_ring_buf, len);
-		if (err) {
-			LOG_ERR("ring_buf_get_finish: %d", err);
-			break;
-		}
-	} while (len != 0 && !ring_buf_is_empty(&ble_tx_ring_buf));
+		bridge_frag_queue_consume(&ble_tx_queue, len);
+	} while (len != 0);
 
 	if (notif_disabled) {
 		/* Peer has not enabled notifications: don't accumulate data */
-		ring_buf_reset(&ble_tx_ring_buf);
+		bridge_frag_queue_flush(&ble_tx_queue);
 	}
 }
 
@@ -190,7 +201,7 @@ static void bt_receive_cb(struct bt_conn *conn, const uint8_t *const data,
 
 static void bt_sent_cb(struct bt_conn *conn)
 {
-	if (ring_buf_is_empty(&ble_tx_ring_buf)) {
+	if (bridge_frag_queue_is_empty(&ble_tx_queue)) {
 		return;
 	}
 
@@ -297,23 +308,13 @@ static bool app_event_handler(const struct app_event_header *aeh)
 			return false;
 		}
 
-		uint32_t written = ring_buf_put(
-			&ble_tx_ring_buf,
+		bridge_frag_queue_put(
+			&ble_tx_queue,
 			event->buf,
 			event->len);
-		if (written != event->len) {
-			LOG_WRN("UART_%d -> BLE overflow", event->dev_idx);
-		}
-
-		uint32_t buf_utilization =
-			(ring_buf_capacity_get(&ble_tx_ring_buf) -
-			ring_buf_space_get(&ble_tx_ring_buf));
 
-		/* Simple check to start transmission. */
-		/* If bt_send_work is already running, this has no effect */
-		if (buf_utilization == written) {
-			k_work_submit(&bt_send_work);
-		}
+		/* If bt_send_work is already pending, this has no effect */
+		k_work_submit(&bt_send_work);
 
 		return false;
 	}
@@ -365,6 +366,8 @@ static bool app_event_handler(const struct app_event_header *aeh)
 			atomic_set(&active, false);
 
 			nus_max_send_len = ATT_MIN_PAYLOAD;
+			bridge_frag_queue_init(&ble_tx_queue);
+			atomic_set(&tx_flush_pending, false);
 
 			err = bt_enable(bt_ready);
 			if (err) {
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+
+#include "bridge_buf.h"
+
+/* A full sink must hold UART RX blocks, which pauses the UART, instead of dropping data. */
+BUILD_ASSERT(CONFIG_BRIDGE_SINK_FRAG_COUNT >= BRIDGE_PORT_COUNT * CONFIG_BRIDGE_UART_BUF_COUNT,
+	     "CONFIG_BRIDGE_SINK_FRAG_COUNT must cover all UART RX blocks");
+
+struct bridge_port_stats bridge_stats[BRIDGE_PORT_COUNT];
+
+static struct bridge_frag *frag_at(struct bridge_frag_queue *q, uint8_t pos)
+{
+	return &q->frags[(q->head + pos) % CONFIG_BRIDGE_SINK_FRAG_COUNT];
+}
+
+static void frag_release(struct bridge_frag_queue *q)
+{
+	q->head = (q->head + 1) % CONFIG_BRIDGE_SINK_FRAG_COUNT;
+	q->count--;
+}
+
+void bridge_frag_queue_init(struct bridge_frag_queue *q)
+{
+	memset(q, 0, sizeof(*q));
+}
+
+void bridge_frag_queue_put(struct bridge_frag_queue *q, uint8_t *buf, size_t len)
+{
+	k_spinlock_key_t key;
+	struct bridge_frag *frag;
+
+	if (len == 0) {
+		return;
+	}
+
+	key = k_spin_lock(&q->lock);
+
+	if (q->count > 0) {
+		frag = frag_at(q, q->count - 1);
+
+		/* Consecutive UART RX chunks share a reference to their block. */
+		if (frag->buf + frag->len == buf) {
+			frag->len += len;
+			k_spin_unlock(&q->lock, key);
+			return;
+		}
+	}
+
+	/* Other data is in a block of its own, and there are no more blocks than
+	 * fragments.
+	 */
+	__ASSERT_NO_MSG(q->count < CONFIG_BRIDGE_SINK_FRAG_COUNT);
+
+	frag = frag_at(q, q->count);
+	frag->buf = buf;
+	frag->len = len;
+	q->count++;
+	uart_rx_buf_ref(buf);
+
+	k_spin_unlock(&q->lock, key);
+}
+
+size_t bridge_frag_queue_peek(struct bridge_frag_queue *q, uint8_t **buf)
+{
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+	size_t len = 0;
+
+	if (q->count > 0) {
+		*buf = q->frags[q->head].buf;
+		len = q->frags[q->head].len;
+	}
+
+	k_spin_unlock(&q->lock, key);
+
+	return len;
+}
+
+void bridge_frag_queue_consume(struct bridge_frag_queue *q, size_t len)
+{
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+	struct bridge_frag *frag;
+	uint8_t *done = NULL;
+
+	if (q->count == 0 || len == 0) {
+		k_spin_unlock(&q->lock, key);
+		return;
+	}
+
+	frag = &q->frags[q->head];
+
+	__ASSERT_NO_MSG(len <= frag->len);
+
+	frag->buf += len;
+	frag->len -= len;
+	if (frag->len == 0) {
+		/* Any pointer into the block identifies it, the end included. */
+		done = frag->buf - 1;
+		frag_release(q);
+	}
+
+	k_spin_unlock(&q->lock, key);
+
+	if (done) {
+		uart_rx_buf_unref(done);
+	}
+}
+
+void bridge_frag_queue_flush(struct bridge_frag_queue *q)
+{
+	uint8_t *done[CONFIG_BRIDGE_SINK_FRAG_COUNT];
+	uint8_t count = 0;
+	k_spinlock_key_t key = k_spin_lock(&q->lock);
+
+	while (q->count > 0) {
+		done[count++] = q->frags[q->head].buf;
+		frag_release(q);
+	}
+
+	k_spin_unlock(&q->lock, key);
+
+	for (uint8_t i = 0; i < count; i++) {
+		uart_rx_buf_unref(done[i]);
+	}
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _BRIDGE_BUF_H_
+#define _BRIDGE_BUF_H_
+
+/**
+ * @brief Shared UART RX buffers
+ * @defgroup bridge_buf Shared UART RX buffers
+ * @{
+ *
+ * Data received on a UART is passed to all sinks by reference, in the
+ * buffer block it was received to. A sink that cannot send the data right
+ * away queues a reference to it, and releases it once sent. The block is
+ * freed when all references are released. While blocks are held by the
+ * sinks, UART RX is paused, which propagates flow control to the UART peer.
+ * A sink queue can reference all blocks, so received data is never dropped.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of UART ports bridged. */
+#define BRIDGE_PORT_COUNT 2
+
+/** Reference to data in a UART RX buffer block. */
+struct bridge_frag {
+	uint8_t *buf;
+	size_t len;
+};
+
+/** Queue of data references held by a sink. */
+struct bridge_frag_queue {
+	struct k_spinlock lock;
+	struct bridge_frag frags[CONFIG_BRIDGE_SINK_FRAG_COUNT];
+	uint8_t head;
+	uint8_t count;
+};
+
+/** Per-port counters. */
+struct bridge_port_stats {
+	/** Bytes received on the UART. */
+	atomic_t rx_bytes;
+	/** Bytes sent on the UART. */
+	atomic_t tx_bytes;
+	/** RX overruns reported by the UART driver. */
+	atomic_t rx_overruns;
+	/** RX pauses because all buffer blocks were held by the sinks. */
+	atomic_t rx_pauses;
+};
+
+extern struct bridge_port_stats bridge_stats[BRIDGE_PORT_COUNT];
+
+/** Take a reference to the UART RX buffer block holding @p buf. */
+void uart_rx_buf_ref(void *buf);
+
+/** Release a reference to the UART RX buffer block holding @p buf. */
+void uart_rx_buf_unref(void *buf);
+
+/** Initialize a queue. */
+void bridge_frag_queue_init(struct bridge_frag_queue *q);
+
+/**
+ * @brief Queue a reference to received data.
+ *
+ * Data that directly follows the last queued fragment in the same block
+ * extends that fragment, otherwise a new reference is taken. The fragments
+ * of a queue are in distinct blocks, so the queue cannot overflow.
+ */
+void bridge_frag_queue_put(struct bridge_frag_queue *q, uint8_t *buf, size_t len);
+
+/**
+ * @brief Get the data at the head of the queue.
+ *
+ * @param q Queue.
+ * @param buf Start of the data.
+ *
+ * @return Length of the data, 0 if the queue is empty.
+ */
+size_t bridge_frag_queue_peek(struct bridge_frag_queue *q, uint8_t **buf);
+
+/** Release @p len bytes sent from the head of the queue. */
+void bridge_frag_queue_consume(struct bridge_frag_queue *q, size_t len);
+
+/** Release all queued data. */
+void bridge_frag_queue_flush(struct bridge_frag_queue *q);
+
+/** @return Whether the queue is empty. */
+static inline bool bridge_frag_queue_is_empty(const struct bridge_frag_queue *q)
+{
+	return q->count == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* _BRIDGE_BUF_H_ */
@@ -15,6 +15,7 @@
 #include "ble_data_event.h"
 #include "cdc_data_event.h"
 #include "uart_data_event.h"
+#include "bridge_buf.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(MODULE, CONFIG_BRIDGE_UART_LOG_LEVEL);
@@ -26,6 +27,8 @@ static const struct device *devices[] = {
 
 #define UART_DEVICE_COUNT ARRAY_SIZE(devices)
 
+BUILD_ASSERT(UART_DEVICE_COUNT == BRIDGE_PORT_COUNT);
+
 #define UART_BUF_SIZE CONFIG_BRIDGE_BUF_SIZE
 
 #define UART_SLAB_BLOCK_SIZE sizeof(struct uart_rx_buf)
@@ -63,12 +66,24 @@ static uint32_t uart_default_baudrate[UART_DEVICE_COUNT];
 static int subscriber_count[UART_DEVICE_COUNT];
 static bool enable_rx_retry[UART_DEVICE_COUNT];
 static atomic_t uart_tx_started[UART_DEVICE_COUNT];
+/* RX is paused while all blocks are held by the sinks */
+static atomic_t rx_starved[UART_DEVICE_COUNT];
+static atomic_t rx_paused[UART_DEVICE_COUNT];
 
 static void enable_uart_rx(uint8_t dev_idx);
 static void disable_uart_rx(uint8_t dev_idx);
 static void set_uart_power_state(uint8_t dev_idx, bool active);
 static int uart_tx_start(uint8_t dev_idx);
 static void uart_tx_finish(uint8_t dev_idx, size_t len);
+static void rx_resume_work_handler(struct k_work *work);
+
+static K_WORK_DEFINE(rx_resume_work, rx_resume_work_handler);
+
+#if CONFIG_BRIDGE_STATS_INTERVAL > 0
+static void stats_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(stats_work, stats_work_handler);
+#endif
 
 static inline struct uart_rx_buf *block_start_get(uint8_t *buf)
 {
@@ -103,14 +118,14 @@ static struct uart_rx_buf *uart_rx_buf_alloc(void)
 	return buf;
 }
 
-static void uart_rx_buf_ref(void *buf)
+void uart_rx_buf_ref(void *buf)
 {
 	__ASSERT_NO_MSG(buf);
 
 	atomic_inc(&(block_start_get(buf)->ref_counter));
 }
 
-static void uart_rx_buf_unref(void *buf)
+void uart_rx_buf_unref(void *buf)
 {
 	__ASSERT_NO_MSG(buf);
 
@@ -120,6 +135,13 @@ static void uart_rx_buf_unref(void *buf)
 	/* ref_counter is the uart_buf->ref_counter value prior to decrement */
 	if (ref_counter == 1) {
 		k_mem_slab_free(&uart_rx_slab, (void *)uart_buf);
+
+		for (int i = 0; i < UART_DEVICE_COUNT; ++i) {
+			if (atomic_get(&rx_paused[i])) {
+				k_work_submit(&rx_resume_work);
+				break;
+			}
+		}
 	}
 }
 
@@ -134,6 +156,7 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 	switch (evt->type) {
 	case UART_RX_RDY:
 		uart_rx_buf_ref(evt->data.rx.buf);
+		atomic_add(&bridge_stats[dev_idx].rx_bytes, evt->data.rx.len);
 
 		event = new_uart_data_event();
 		event->dev_idx = dev_idx;
@@ -149,7 +172,11 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 	case UART_RX_BUF_REQUEST:
 		buf = uart_rx_buf_alloc();
 		if (buf == NULL) {
-			LOG_WRN("UART_%d RX overflow", dev_idx);
+			/* RX stops when the current block is full, until a sink */
+			/* releases a block. */
+			LOG_DBG("UART_%d RX paused", dev_idx);
+			atomic_set(&rx_starved[dev_idx], true);
+			atomic_inc(&bridge_stats[dev_idx].rx_pauses);
 			break;
 		}
 
@@ -163,11 +190,18 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 		if (enable_rx_retry[dev_idx]) {
 			enable_uart_rx(dev_idx);
 			enable_rx_retry[dev_idx] = false;
+		} else if (atomic_set(&rx_starved[dev_idx], false)) {
+			atomic_set(&rx_paused[dev_idx], true);
+			/* A block may have been released before RX stopped */
+			if (k_mem_slab_num_free_get(&uart_rx_slab) > 0) {
+				k_work_submit(&rx_resume_work);
+			}
 		} else if (UART_SET_PM_STATE) {
 			set_uart_power_state(dev_idx, false);
 		}
 		break;
 	case UART_TX_DONE:
+		atomic_add(&bridge_stats[dev_idx].tx_bytes, evt->data.tx.len);
 		uart_tx_finish(dev_idx, evt->data.tx.len);
 
 		if (ring_buf_is_empty(&uart_tx_ringbufs[dev_idx].rb)) {
@@ -183,6 +217,10 @@ static void uart_callback(const struct device *dev, struct uart_event *evt,
 	case UART_RX_STOPPED:
 		LOG_WRN("UART_%d stop reason %d", dev_idx, evt->data.rx_stop.reason);
 
+		if (evt->data.rx_stop.reason & UART_ERROR_OVERRUN) {
+			atomic_inc(&bridge_stats[dev_idx].rx_overruns);
+		}
+
 		/* Retry automatically in case of unexpected stop.
 		 * Typically happens when the peer does not drive its TX GPIO,
 		 * or if there is a baud rate mismatch.
@@ -255,7 +293,9 @@ static void enable_uart_rx(uint8_t dev_idx)
 
 	buf = uart_rx_buf_alloc();
 	if (!buf) {
-		LOG_ERR("uart_rx_buf_alloc error");
+		/* Resumed when a sink releases a block */
+		LOG_DBG("UART_%d RX paused", dev_idx);
+		atomic_set(&rx_paused[dev_idx], true);
 		return;
 	}
 
@@ -279,6 +319,48 @@ static void disable_uart_rx(uint8_t dev_idx)
 	}
 }
 
+static void rx_resume_work_handler(struct k_work *work)
+{
+	for (int i = 0; i < UART_DEVICE_COUNT; ++i) {
+		if (!atomic_set(&rx_paused[i], false)) {
+			continue;
+		}
+
+		if (subscriber_count[i] > 0) {
+			LOG_DBG("UART_%d RX resumed", i);
+			enable_uart_rx(i);
+		} else if (UART_SET_PM_STATE) {
+			set_uart_power_state(i, false);
+		}
+	}
+}
+
+#if CONFIG_BRIDGE_STATS_INTERVAL > 0
+static void stats_work_handler(struct k_work *work)
+{
+	static uint32_t last_rx_bytes[UART_DEVICE_COUNT];
+	static uint32_t last_tx_bytes[UART_DEVICE_COUNT];
+
+	for (int i = 0; i < UART_DEVICE_COUNT; ++i) {
+		struct bridge_port_stats *stats = &bridge_stats[i];
+		uint32_t rx_bytes = atomic_get(&stats->rx_bytes);
+		uint32_t tx_bytes = atomic_get(&stats->tx_bytes);
+
+		LOG_INF("UART_%d: RX %u B/s, TX %u B/s, overruns %u, pauses %u",
+			i,
+			(rx_bytes - last_rx_bytes[i]) / CONFIG_BRIDGE_STATS_INTERVAL,
+			(tx_bytes - last_tx_bytes[i]) / CONFIG_BRIDGE_STATS_INTERVAL,
+			(uint32_t)atomic_get(&stats->rx_overruns),
+			(uint32_t)atomic_get(&stats->rx_pauses));
+
+		last_rx_bytes[i] = rx_bytes;
+		last_tx_bytes[i] = tx_bytes;
+	}
+
+	k_work_reschedule(&stats_work, K_SECONDS(CONFIG_BRIDGE_STATS_INTERVAL));
+}
+#endif
+
 static int uart_tx_start(uint8_t dev_idx)
 {
 	int len;
@@ -426,7 +508,12 @@ static bool app_event_handler(const struct app_event_header *aeh)
 			set_uart_baudrate(
 				event->dev_idx,
 				uart_default_baudrate[event->dev_idx]);
-			disable_uart_rx(event->dev_idx);
+			if (!atomic_set(&rx_paused[event->dev_idx], false)) {
+				disable_uart_rx(event->dev_idx);
+			} else if (UART_SET_PM_STATE) {
+				/* RX is already off while paused */
+				set_uart_power_state(event->dev_idx, false);
+			}
 		} else if (prev_count == 0) {
 			LOG_DBG("First subscriber. Open UART_%d RX", event->dev_idx);
 			if (UART_SET_PM_STATE) {
@@ -462,6 +549,8 @@ static bool app_event_handler(const struct app_event_header *aeh)
 				uart_default_baudrate[i] = cfg.baudrate;
 				subscriber_count[i] = 0;
 				enable_rx_retry[i] = false;
+				atomic_set(&rx_starved[i], false);
+				atomic_set(&rx_paused[i], false);
 
 				atomic_set(&uart_tx_started[i], false);
 
@@ -474,6 +563,10 @@ static bool app_event_handler(const struct app_event_header *aeh)
 					set_uart_power_state(i, false);
 				}
 			}
+
+#if CONFIG_BRIDGE_STATS_INTERVAL > 0
+			k_work_reschedule(&stats_work, K_SECONDS(CONFIG_BRIDGE_STATS_INTERVAL));
+#endif
 		}
 
 		return false;
@@ -13,6 +13,7 @@
 #include "peer_conn_event.h"
 #include "cdc_data_event.h"
 #include "uart_data_event.h"
+#include "bridge_buf.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(MODULE, CONFIG_BRIDGE_CDC_LOG_LEVEL);
@@ -38,6 +39,8 @@ static K_WORK_DEFINE(cdc_dtr_work, cdc_dtr_work_handler);
 K_MEM_SLAB_DEFINE(cdc_rx_slab, USB_CDC_RX_BLOCK_SIZE, USB_CDC_RX_BLOCK_COUNT, USB_CDC_SLAB_ALIGNMENT);
 
 static uint32_t cdc_ready[CDC_DEVICE_COUNT];
+/* UART data waiting for room in the CDC TX FIFO, sent from the IRQ handler */
+static struct bridge_frag_queue cdc_tx_queues[CDC_DEVICE_COUNT];
 
 static uint8_t overflow_buf[64];
 
@@ -81,6 +84,11 @@ static void poll_dtr(void)
 			APP_EVENT_SUBMIT(event);
 
 			cdc_ready[i] = cdc_val;
+
+			if (cdc_val == 0) {
+				/* Port closed: don't hold UART blocks */
+				bridge_frag_queue_flush(&cdc_tx_queues[i]);
+			}
 		}
 	}
 }
@@ -131,6 +139,22 @@ static void cdc_uart_interrupt_handler(const struct device *dev, void *user_data
 			}
 		}
 	}
+
+	if (uart_irq_tx_ready(dev)) {
+		uint8_t *tx_buf;
+		size_t len;
+		int written;
+
+		len = bridge_frag_queue_peek(&cdc_tx_queues[dev_idx], &tx_buf);
+		if (len == 0) {
+			uart_irq_tx_disable(dev);
+		} else {
+			written = uart_fifo_fill(dev, tx_buf, len);
+			if (written > 0) {
+				bridge_frag_queue_consume(&cdc_tx_queues[dev_idx], written);
+			}
+		}
+	}
 }
 
 static void enable_rx_irq(int dev_idx)
@@ -178,7 +202,6 @@ static bool app_event_handler(const struct app_event_header *aeh)
 	if (is_uart_data_event(aeh)) {
 		const struct uart_data_event *event =
 			cast_uart_data_event(aeh);
-		int tx_written;
 
 		if (event->dev_idx >= CDC_DEVICE_COUNT) {
 			return false;
@@ -188,16 +211,13 @@ static bool app_event_handler(const struct app_event_header *aeh)
 			return false;
 		}
 
-		tx_written = uart_fifo_fill(
-			devices[event->dev_idx],
+		/* The data is sent in place from the UART RX block */
+		bridge_frag_queue_put(
+			&cdc_tx_queues[event->dev_idx],
 			event->buf,
 			event->len);
 
-		if (tx_written != event->len) {
-			LOG_DBG("UART_%d->CDC_%d overflow",
-				event->dev_idx,
-				event->dev_idx);
-		}
+		uart_irq_tx_enable(devices[event->dev_idx]);
 
 		return false;
 	}
@@ -232,6 +252,7 @@ static bool app_event_handler(const struct app_event_header *aeh)
 			}
 			for (int i = 0; i < CDC_DEVICE_COUNT; ++i) {
 				cdc_ready[i] = 0;
+				bridge_frag_queue_init(&cdc_tx_queues[i]);
 				if (device_is_ready(devices[i])) {
 					enable_rx_irq(i);
 					LOG_DBG("%s available", devices[i]->name);
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <app_event_manager.h>
+
+#define MODULE main
+#include "module_state_event.h"
+#include "peer_conn_event.h"
+#include "uart_data_event.h"
+#include "bridge_buf.h"
+#include "uart_emul.h"
+
+#define BUF_SIZE CONFIG_BRIDGE_BUF_SIZE
+#define BLOCK_COUNT (BRIDGE_PORT_COUNT * CONFIG_BRIDGE_UART_BUF_COUNT)
+/* RX is enabled with a block, and the next one is requested right away. */
+#define RX_BLOCK_COUNT 2
+
+/* Time for the events and the RX resume work to be handled. */
+#define EVENT_TIME K_MSEC(10)
+
+extern struct k_mem_slab uart_rx_slab;
+
+static const struct device *const uart0 = DEVICE_DT_GET(DT_NODELABEL(uart0));
+
+/* Stands in for the USB CDC ACM and BLE sinks of UART_0, which hold the data until sent. */
+static struct bridge_frag_queue sink;
+static bool connected;
+
+static uint8_t data[BUF_SIZE];
+
+static bool app_event_handler(const struct app_event_header *aeh)
+{
+	if (is_uart_data_event(aeh)) {
+		const struct uart_data_event *event = cast_uart_data_event(aeh);
+
+		if (event->dev_idx == 0) {
+			bridge_frag_queue_put(&sink, event->buf, event->len);
+		}
+
+		return false;
+	}
+
+	return false;
+}
+
+APP_EVENT_LISTENER(test_sink, app_event_handler);
+APP_EVENT_SUBSCRIBE(test_sink, uart_data_event);
+
+static uint32_t free_blocks(void)
+{
+	return k_mem_slab_num_free_get(&uart_rx_slab);
+}
+
+static uint32_t rx_pauses(void)
+{
+	return atomic_get(&bridge_stats[0].rx_pauses);
+}
+
+static void peer_conn(enum peer_conn_state state)
+{
+	struct peer_conn_event *event = new_peer_conn_event();
+
+	event->peer_id = PEER_ID_USB;
+	event->dev_idx = 0;
+	event->conn_state = state;
+	event->baudrate = 0;
+	APP_EVENT_SUBMIT(event);
+
+	connected = (state == PEER_STATE_CONNECTED);
+	k_sleep(EVENT_TIME);
+}
+
+static void rx(size_t len)
+{
+	zassert_equal(uart_emul_rx(uart0, data, len), len, "Data not received");
+	k_sleep(EVENT_TIME);
+}
+
+/* Fill all blocks, which the sink holds, until RX is paused. */
+static void rx_starve(void)
+{
+	for (size_t i = 0; i < BLOCK_COUNT; i++) {
+		rx(BUF_SIZE);
+	}
+
+	zassert_false(uart_emul_rx_enabled(uart0), "RX not paused");
+	zassert_equal(free_blocks(), 0, "Blocks not held by the sink");
+	zassert_equal(uart_emul_rx(uart0, data, 1), 0, "Data received while paused");
+}
+
+static void *setup(void)
+{
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+
+	zassert_ok(app_event_manager_init());
+	module_set_state(MODULE_STATE_READY);
+	k_sleep(EVENT_TIME);
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	bridge_frag_queue_init(&sink);
+	peer_conn(PEER_STATE_CONNECTED);
+
+	zassert_true(uart_emul_rx_enabled(uart0), "RX not enabled");
+	zassert_equal(free_blocks(), BLOCK_COUNT - RX_BLOCK_COUNT);
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	bridge_frag_queue_flush(&sink);
+	k_sleep(EVENT_TIME);
+
+	if (connected) {
+		peer_conn(PEER_STATE_DISCONNECTED);
+	}
+
+	zassert_false(uart_emul_rx_enabled(uart0), "RX still enabled");
+	zassert_equal(free_blocks(), BLOCK_COUNT, "Block reference leaked");
+}
+
+ZTEST(bridge_uart_handler, test_frag_queue_ref)
+{
+	uint8_t *buf;
+
+	/* Consecutive data in a block shares a reference. */
+	rx(16);
+	rx(16);
+	zassert_equal(bridge_frag_queue_peek(&sink, &buf), 32);
+	zassert_mem_equal(buf, data, 32);
+
+	/* The block is held until all its data is sent, and by the UART until it is full. */
+	bridge_frag_queue_consume(&sink, 16);
+	zassert_equal(bridge_frag_queue_peek(&sink, &buf), 16);
+	bridge_frag_queue_consume(&sink, 16);
+	zassert_true(bridge_frag_queue_is_empty(&sink));
+	zassert_equal(free_blocks(), BLOCK_COUNT - RX_BLOCK_COUNT);
+
+	rx(BUF_SIZE - 32);
+	zassert_equal(bridge_frag_queue_peek(&sink, &buf), BUF_SIZE - 32);
+	zassert_equal(free_blocks(), BLOCK_COUNT - RX_BLOCK_COUNT - 1, "Full block not held");
+
+	/* Data in another block takes a reference of its own. */
+	rx(8);
+	bridge_frag_queue_consume(&sink, BUF_SIZE - 32);
+	zassert_equal(bridge_frag_queue_peek(&sink, &buf), 8);
+	zassert_equal(free_blocks(), BLOCK_COUNT - RX_BLOCK_COUNT, "Sent block not freed");
+
+	bridge_frag_queue_flush(&sink);
+	zassert_true(bridge_frag_queue_is_empty(&sink));
+	zassert_equal(free_blocks(), BLOCK_COUNT - RX_BLOCK_COUNT);
+}
+
+ZTEST(bridge_uart_handler, test_rx_pause_resume)
+{
+	uint32_t pauses = rx_pauses();
+	uint8_t *buf;
+
+	rx_starve();
+
+	/* Releasing a block resumes RX, which pauses again right away as only one block
+	 * is free.
+	 */
+	zassert_equal(bridge_frag_queue_peek(&sink, &buf), BUF_SIZE);
+	bridge_frag_queue_consume(&sink, BUF_SIZE);
+	k_sleep(EVENT_TIME);
+
+	zassert_true(uart_emul_rx_enabled(uart0), "RX not resumed");
+	zassert_equal(free_blocks(), 0);
+	rx(BUF_SIZE);
+	zassert_false(uart_emul_rx_enabled(uart0), "RX not paused");
+
+	/* Releasing all blocks resumes RX with both RX blocks. */
+	bridge_frag_queue_flush(&sink);
+	k_sleep(EVENT_TIME);
+
+	zassert_true(uart_emul_rx_enabled(uart0), "RX not resumed");
+	zassert_equal(free_blocks(), BLOCK_COUNT - RX_BLOCK_COUNT);
+	zassert_true(rx_pauses() > pauses, "Pause not counted");
+
+	rx(BUF_SIZE);
+	zassert_equal(bridge_frag_queue_peek(&sink, &buf), BUF_SIZE);
+	zassert_mem_equal(buf, data, BUF_SIZE);
+}
+
+ZTEST(bridge_uart_handler, test_rx_pause_disconnect)
+{
+	rx_starve();
+
+	/* RX stays off when the sink disconnects while RX is paused. */
+	peer_conn(PEER_STATE_DISCONNECTED);
+	bridge_frag_queue_flush(&sink);
+	k_sleep(EVENT_TIME);
+
+	zassert_false(uart_emul_rx_enabled(uart0), "RX resumed without subscribers");
+	zassert_equal(free_blocks(), BLOCK_COUNT);
+
+	/* A new subscriber enables RX again. */
+	peer_conn(PEER_STATE_CONNECTED);
+	zassert_true(uart_emul_rx_enabled(uart0), "RX not enabled");
+}
+
+ZTEST_SUITE(bridge_uart_handler, NULL, setup, before, after, NULL);
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#define DT_DRV_COMPAT vnd_bridge_uart
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+
+#include "uart_emul.h"
+
+/* RX events are raised from the thread that receives the data. Transfers end right away. */
+struct uart_emul_data {
+	const struct device *dev;
+	uart_callback_t cb;
+	void *user_data;
+	uint8_t *rx_buf;
+	size_t rx_size;
+	size_t rx_offset;
+	uint8_t *rx_next;
+	size_t rx_next_size;
+	struct k_work tx_work;
+	const uint8_t *tx_buf;
+	size_t tx_len;
+};
+
+static void event_send(struct uart_emul_data *data, struct uart_event *evt)
+{
+	if (data->cb) {
+		data->cb(data->dev, evt, data->user_data);
+	}
+}
+
+static void rx_buf_release(struct uart_emul_data *data, uint8_t *buf)
+{
+	struct uart_event evt = {
+		.type = UART_RX_BUF_RELEASED,
+		.data.rx_buf.buf = buf,
+	};
+
+	event_send(data, &evt);
+}
+
+/* Switch to the next buffer. Like the hardware, RX stops if there is none. */
+static void rx_buf_next(struct uart_emul_data *data)
+{
+	struct uart_event evt = {
+		.type = data->rx_next ? UART_RX_BUF_REQUEST : UART_RX_DISABLED,
+	};
+
+	rx_buf_release(data, data->rx_buf);
+
+	data->rx_buf = data->rx_next;
+	data->rx_size = data->rx_next_size;
+	data->rx_offset = 0;
+	data->rx_next = NULL;
+
+	event_send(data, &evt);
+}
+
+static void tx_work_handler(struct k_work *work)
+{
+	struct uart_emul_data *data = CONTAINER_OF(work, struct uart_emul_data, tx_work);
+	struct uart_event evt = {
+		.type = UART_TX_DONE,
+		.data.tx.buf = data->tx_buf,
+		.data.tx.len = data->tx_len,
+	};
+
+	data->tx_buf = NULL;
+	data->tx_len = 0;
+	event_send(data, &evt);
+}
+
+static int uart_emul_callback_set(const struct device *dev, uart_callback_t callback,
+				  void *user_data)
+{
+	struct uart_emul_data *data = dev->data;
+
+	data->cb = callback;
+	data->user_data = user_data;
+
+	return 0;
+}
+
+static int uart_emul_tx(const struct device *dev, const uint8_t *buf, size_t len,
+			int32_t timeout)
+{
+	struct uart_emul_data *data = dev->data;
+
+	ARG_UNUSED(timeout);
+
+	if (data->tx_len) {
+		return -EBUSY;
+	}
+
+	data->tx_buf = buf;
+	data->tx_len = len;
+	k_work_submit(&data->tx_work);
+
+	return 0;
+}
+
+static int uart_emul_rx_enable(const struct device *dev, uint8_t *buf, size_t len,
+			       int32_t timeout)
+{
+	struct uart_emul_data *data = dev->data;
+	struct uart_event evt = {
+		.type = UART_RX_BUF_REQUEST,
+	};
+
+	ARG_UNUSED(timeout);
+
+	if (data->rx_buf) {
+		return -EBUSY;
+	}
+
+	data->rx_buf = buf;
+	data->rx_size = len;
+	data->rx_offset = 0;
+
+	event_send(data, &evt);
+
+	return 0;
+}
+
+static int uart_emul_rx_buf_rsp(const struct device *dev, uint8_t *buf, size_t len)
+{
+	struct uart_emul_data *data = dev->data;
+
+	if (!data->rx_buf) {
+		return -EACCES;
+	}
+	if (data->rx_next) {
+		return -EBUSY;
+	}
+
+	data->rx_next = buf;
+	data->rx_next_size = len;
+
+	return 0;
+}
+
+static int uart_emul_rx_disable(const struct device *dev)
+{
+	struct uart_emul_data *data = dev->data;
+	struct uart_event evt = {
+		.type = UART_RX_DISABLED,
+	};
+
+	if (!data->rx_buf) {
+		return -EFAULT;
+	}
+
+	rx_buf_release(data, data->rx_buf);
+	data->rx_buf = NULL;
+
+	if (data->rx_next) {
+		rx_buf_release(data, data->rx_next);
+		data->rx_next = NULL;
+	}
+
+	event_send(data, &evt);
+
+	return 0;
+}
+
+static int uart_emul_configure(const struct device *dev, const struct uart_config *cfg)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(cfg);
+
+	return 0;
+}
+
+static int uart_emul_config_get(const struct device *dev, struct uart_config *cfg)
+{
+	ARG_UNUSED(dev);
+
+	*cfg = (struct uart_config) {
+		.baudrate = 115200,
+		.parity = UART_CFG_PARITY_NONE,
+		.stop_bits = UART_CFG_STOP_BITS_1,
+		.data_bits = UART_CFG_DATA_BITS_8,
+		.flow_ctrl = UART_CFG_FLOW_CTRL_RTS_CTS,
+	};
+
+	return 0;
+}
+
+static int uart_emul_init(const struct device *dev)
+{
+	struct uart_emul_data *data = dev->data;
+
+	data->dev = dev;
+	k_work_init(&data->tx_work, tx_work_handler);
+
+	return 0;
+}
+
+static const struct uart_driver_api uart_emul_api = {
+	.callback_set = uart_emul_callback_set,
+	.tx = uart_emul_tx,
+	.rx_enable = uart_emul_rx_enable,
+	.rx_buf_rsp = uart_emul_rx_buf_rsp,
+	.rx_disable = uart_emul_rx_disable,
+	.configure = uart_emul_configure,
+	.config_get = uart_emul_config_get,
+};
+
+#define UART_EMUL_DEFINE(inst)                                                               \
+	static struct uart_emul_data uart_emul_data_##inst;                                  \
+	DEVICE_DT_INST_DEFINE(inst, uart_emul_init, NULL, &uart_emul_data_##inst, NULL,      \
+			      POST_KERNEL, CONFIG_SERIAL_INIT_PRIORITY, &uart_emul_api);
+
+DT_INST_FOREACH_STATUS_OKAY(UART_EMUL_DEFINE)
+
+size_t uart_emul_rx(const struct device *dev, const uint8_t *buf, size_t len)
+{
+	struct uart_emul_data *data = dev->data;
+	size_t received = 0;
+
+	while (data->rx_buf && received < len) {
+		size_t chunk = MIN(len - received, data->rx_size - data->rx_offset);
+		struct uart_event evt = {
+			.type = UART_RX_RDY,
+			.data.rx.buf = data->rx_buf,
+			.data.rx.offset = data->rx_offset,
+			.data.rx.len = chunk,
+		};
+
+		memcpy(&data->rx_buf[data->rx_offset], &buf[received], chunk);
+		data->rx_offset += chunk;
+		received += chunk;
+
+		event_send(data, &evt);
+
+		if (data->rx_offset == data->rx_size) {
+			rx_buf_next(data);
+		}
+	}
+
+	return received;
+}
+
+bool uart_emul_rx_enabled(const struct device *dev)
+{
+	struct uart_emul_data *data = dev->data;
+
+	return data->rx_buf != NULL;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef UART_EMUL_H_
+#define UART_EMUL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+/* Receive data into the RX buffers of @p dev, as the UART peer sends it.
+ *
+ * @return Number of bytes received, less than @p len if RX stopped.
+ */
+size_t uart_emul_rx(const struct device *dev, const uint8_t *buf, size_t len);
+
+/* Return whether RX is enabled. */
+bool uart_emul_rx_enabled(const struct device *dev);
+
+#endif /* UART_EMUL_H_ */
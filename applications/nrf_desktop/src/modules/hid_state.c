@@ -14,7 +14,6 @@
 #include <sys/types.h>
 
 #include <zephyr/types.h>
-#include <zephyr/sys/slist.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/byteorder.h>
 
@@ -75,6 +74,14 @@ enum state {
 
 #define AXIS_COUNT (IS_ENABLED(CONFIG_DESKTOP_HID_REPORT_MOUSE_SUPPORT) * MOUSE_REPORT_AXIS_COUNT)
 
+#if defined(CONFIG_BT_L2CAP_TX_BUF_COUNT) && defined(CONFIG_BT_CONN_TX_MAX)
+/* Every report in flight to a Bluetooth subscriber holds a Bluetooth TX buffer. */
+BUILD_ASSERT(CONFIG_DESKTOP_HID_STATE_PIPELINE_DEPTH <= CONFIG_BT_L2CAP_TX_BUF_COUNT,
+	     "HID report pipeline deeper than the number of L2CAP TX buffers");
+BUILD_ASSERT(CONFIG_DESKTOP_HID_STATE_PIPELINE_DEPTH <= CONFIG_BT_CONN_TX_MAX,
+	     "HID report pipeline deeper than the number of connection TX contexts");
+#endif
+
 /**@brief HID state item. */
 struct item {
 	uint16_t usage_id; /**< HID usage ID. */
@@ -90,15 +97,15 @@ struct items {
 
 /**@brief Enqueued HID state item. */
 struct item_event {
-	sys_snode_t node; /**< Event queue linked list node. */
 	struct item item; /**< HID state item which has been enqueued. */
 	uint32_t timestamp; /**< HID event timestamp. */
 };
 
-/**@brief Event queue. */
+/**@brief Event queue. Ring buffer ordered by event timestamps. */
 struct eventq {
-	sys_slist_t root;
-	size_t len;
+	struct item_event events[CONFIG_DESKTOP_HID_EVENT_QUEUE_SIZE];
+	size_t head; /**< Index of the oldest event. */
+	size_t len; /**< Number of enqueued events. */
 };
 
 /**@brief Axis data. */
@@ -131,6 +138,7 @@ struct subscriber {
 	const void *id;
 	bool is_usb;
 	uint8_t report_max;
+	uint8_t pipeline_depth;
 	uint8_t report_cnt;
 	struct output_report_state output_reports[OUTPUT_REPORT_STATE_COUNT];
 	struct report_state state[INPUT_REPORT_STATE_COUNT];
@@ -143,8 +151,7 @@ struct hid_state {
 };
 
 
-static const struct report_data empty_rd = {
-			.eventq.root = SYS_SLIST_STATIC_INIT(&empty_rd.eventq.root)};
+static const struct report_data empty_rd;
 
 static uint8_t report_data_index[REPORT_ID_COUNT];
 static uint8_t report_state_index[REPORT_ID_COUNT];
@@ -228,18 +235,27 @@ static int usage_id_compare(const void *a, const void *b)
 	return (p_a->usage_id - p_b->usage_id);
 }
 
-static void eventq_reset(struct eventq *eventq)
+static size_t eventq_idx(const struct eventq *eventq, size_t pos)
 {
-	struct item_event *event;
-	struct item_event *tmp;
-
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&eventq->root, event, tmp, node) {
-		sys_slist_remove(&eventq->root, NULL, &event->node);
+	size_t idx = eventq->head + pos;
 
-		k_free(event);
+	if (idx >= CONFIG_DESKTOP_HID_EVENT_QUEUE_SIZE) {
+		idx -= CONFIG_DESKTOP_HID_EVENT_QUEUE_SIZE;
 	}
 
-	sys_slist_init(&eventq->root);
+	return idx;
+}
+
+static struct item_event *eventq_at(struct eventq *eventq, size_t pos)
+{
+	__ASSERT_NO_MSG(pos < eventq->len);
+
+	return &eventq->events[eventq_idx(eventq, pos)];
+}
+
+static void eventq_reset(struct eventq *eventq)
+{
+	eventq->head = 0;
 	eventq->len = 0;
 }
 
@@ -249,103 +265,94 @@ static bool eventq_is_full(const struct eventq *eventq)
 }
 
 
-static bool eventq_is_empty(struct eventq *eventq)
+static bool eventq_is_empty(const struct eventq *eventq)
 {
-	bool empty = sys_slist_is_empty(&eventq->root);
-
-	__ASSERT_NO_MSG(!empty == (eventq->len != 0));
-
-	return empty;
+	return (eventq->len == 0);
 }
 
-static struct item_event *eventq_get(struct eventq *eventq)
+/**@brief Remove the oldest event from the queue.
+ *
+ * The returned event stays valid until the next event is appended.
+ */
+static const struct item_event *eventq_get(struct eventq *eventq)
 {
-	sys_snode_t *node = sys_slist_get(&eventq->root);
-
-	if (!node) {
+	if (eventq_is_empty(eventq)) {
 		return NULL;
 	}
 
+	const struct item_event *event = &eventq->events[eventq->head];
+
+	eventq->head = eventq_idx(eventq, 1);
 	eventq->len--;
 
-	return CONTAINER_OF(node, struct item_event, node);
+	return event;
 }
 
 static void eventq_append(struct eventq *eventq, uint16_t usage_id, int16_t value)
 {
-	struct item_event *hid_event = k_malloc(sizeof(*hid_event));
-
-	if (!hid_event) {
-		LOG_ERR("Failed to allocate HID event");
+	if (eventq_is_full(eventq)) {
+		LOG_ERR("No space for HID event");
 		/* Should never happen. */
 		__ASSERT_NO_MSG(false);
 		return;
 	}
 
+	struct item_event *hid_event = &eventq->events[eventq_idx(eventq, eventq->len)];
+
 	hid_event->item.usage_id = usage_id;
 	hid_event->item.value = value;
 	hid_event->timestamp = k_uptime_get_32();
 
-	/* Add a new event to the queue. */
-	sys_slist_append(&eventq->root, &hid_event->node);
-
 	eventq->len++;
 }
 
-static void eventq_region_purge(struct eventq *eventq,
-				sys_snode_t *last_to_purge)
+static void eventq_region_purge(struct eventq *eventq, size_t cnt)
 {
-	sys_snode_t *tmp;
-	sys_snode_t *tmp_safe;
-	size_t cnt = 0;
-
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&eventq->root, tmp, tmp_safe) {
-		sys_slist_remove(&eventq->root, NULL, tmp);
-
-		k_free(CONTAINER_OF(tmp, struct item_event, node));
-		cnt++;
-
-		if (tmp == last_to_purge) {
-			break;
-		}
-	}
+	__ASSERT_NO_MSG(cnt <= eventq->len);
 
+	eventq->head = eventq_idx(eventq, cnt);
 	eventq->len -= cnt;
 
-	LOG_WRN("%u stale events removed from the queue!", cnt);
+	LOG_WRN("%zu stale events removed from the queue!", cnt);
 }
 
-
-static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
+/**@brief Get the number of events that expired at the given time.
+ *
+ * Events are appended with non-decreasing timestamps, so the expired events
+ * form a prefix of the queue and the cut-off can be found by binary search.
+ */
+static size_t eventq_expired_count(struct eventq *eventq, uint32_t timestamp)
 {
-	/* Find timed out events. */
-
-	sys_snode_t *first_valid;
+	size_t lower = 0;
+	size_t upper = eventq->len;
 
-	SYS_SLIST_FOR_EACH_NODE(&eventq->root, first_valid) {
-		uint32_t diff = timestamp - CONTAINER_OF(
-			first_valid, struct item_event, node)->timestamp;
+	while (lower < upper) {
+		size_t m = lower + (upper - lower) / 2;
+		uint32_t diff = timestamp - eventq_at(eventq, m)->timestamp;
 
 		if (diff < CONFIG_DESKTOP_HID_REPORT_EXPIRATION) {
-			break;
+			upper = m;
+		} else {
+			lower = m + 1;
 		}
 	}
 
+	return lower;
+}
+
+static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
+{
+	/* Find timed out events. */
+	size_t first_valid = eventq_expired_count(eventq, timestamp);
+
 	/* Remove events but only if key up was generated for each removed
 	 * key down.
 	 */
+	size_t maxfound = 0;
+	size_t purged = 0;
 
-	sys_snode_t *maxfound = sys_slist_peek_head(&eventq->root);
-	size_t maxfound_pos = 0;
-
-	sys_snode_t *cur;
-	size_t cur_pos = 0;
-
-	sys_snode_t *tmp_safe;
-
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&eventq->root, cur, tmp_safe) {
-		const struct item cur_item =
-			CONTAINER_OF(cur, struct item_event, node)->item;
+	for (size_t cur = 0; cur < first_valid; cur++) {
+		const struct item cur_item = eventq_at(eventq, cur)->item;
 
 		if (cur_item.value > 0) {
 			/* Every key down must be paired with key up.
@@ -354,19 +361,10 @@ static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
 			 */
 
 			unsigned int hit_count = cur_item.value;
-			sys_snode_t *j = cur;
-			size_t j_pos = cur_pos;
+			size_t j;
 
-			SYS_SLIST_ITERATE_FROM_NODE(&eventq->root, j) {
-				j_pos++;
-				if (j == first_valid) {
-					break;
-				}
-
-				const struct item item =
-					CONTAINER_OF(j,
-						     struct item_event,
-						     node)->item;
+			for (j = cur + 1; j < first_valid; j++) {
+				const struct item item = eventq_at(eventq, j)->item;
 
 				if (cur_item.usage_id == item.usage_id) {
 					hit_count += item.value;
@@ -385,26 +383,89 @@ static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
 				break;
 			}
 
-			if (j_pos > maxfound_pos) {
+			if (j > maxfound) {
 				maxfound = j;
-				maxfound_pos = j_pos;
 			}
 		}
 
-
-		if (cur == first_valid) {
-			break;
-		}
-
 		if (cur == maxfound) {
 			/* All events up to this point have pairs and can
 			 * be deleted.
 			 */
-			eventq_region_purge(eventq, maxfound);
+			purged = cur + 1;
+		}
+	}
+
+	if (purged > 0) {
+		eventq_region_purge(eventq, purged);
+	}
+}
+
+/**@brief Drop the oldest key press together with its key release.
+ *
+ * Used when the queue is saturated. The state of the usage is the same
+ * before and after the removed events, so the remaining events still
+ * replay to a consistent HID state. Relative order of the remaining events
+ * is preserved.
+ *
+ * @return true if the events were removed.
+ */
+static bool eventq_coalesce(struct eventq *eventq)
+{
+	for (size_t cur = 0; cur < eventq->len; cur++) {
+		const struct item cur_item = eventq_at(eventq, cur)->item;
+
+		if (cur_item.value <= 0) {
+			continue;
+		}
+
+		unsigned int hit_count = cur_item.value;
+		size_t j;
+
+		for (j = cur + 1; j < eventq->len; j++) {
+			const struct item item = eventq_at(eventq, j)->item;
+
+			if (cur_item.usage_id == item.usage_id) {
+				hit_count += item.value;
+
+				if (hit_count == 0) {
+					break;
+				}
+			}
+		}
+
+		if (j == eventq->len) {
+			/* Key is still pressed. */
+			continue;
+		}
+
+		/* Compact the events in range, skipping the given usage. */
+		size_t dst = cur;
+
+		for (size_t src = cur; src <= j; src++) {
+			const struct item_event *event = eventq_at(eventq, src);
+
+			if (event->item.usage_id != cur_item.usage_id) {
+				*eventq_at(eventq, dst) = *event;
+				dst++;
+			}
 		}
 
-		cur_pos++;
+		size_t removed = j + 1 - dst;
+
+		for (size_t src = j + 1; src < eventq->len; src++) {
+			*eventq_at(eventq, src - removed) = *eventq_at(eventq, src);
+		}
+
+		eventq->len -= removed;
+
+		LOG_DBG("Coalesced %zu events of usage 0x%x", removed,
+			cur_item.usage_id);
+
+		return true;
 	}
+
+	return false;
 }
 
 static void sort_by_usage_id(struct item items[], size_t array_size)
@@ -832,7 +893,7 @@ static bool update_report(struct report_data *rd)
 
 	while (!update_needed && !eventq_is_empty(&rd->eventq)) {
 		/* There are enqueued events to handle. */
-		struct item_event *event = eventq_get(&rd->eventq);
+		const struct item_event *event = eventq_get(&rd->eventq);
 
 		__ASSERT_NO_MSG(event);
 
@@ -842,15 +903,27 @@ static bool update_report(struct report_data *rd)
 
 		rd->linked_rs->update_needed = rd->linked_rs->update_needed || update_needed;
 
-
-		k_free(event);
-
 		/* If no item was changed, try next event. */
 	}
 
 	return rd->linked_rs->update_needed;
 }
 
+/**@brief Get the number of reports of the given type that can be in flight.
+ *
+ * Motion is accumulated in the report data while the pipeline is full and
+ * is sent with the next report.
+ */
+static unsigned int get_pipeline_depth(const struct report_state *rs)
+{
+	if ((rs->report_id == REPORT_ID_CONSUMER_CTRL) ||
+	    (rs->report_id == REPORT_ID_SYSTEM_CTRL)) {
+		return 1;
+	}
+
+	return rs->subscriber->pipeline_depth;
+}
+
 static bool report_send(struct report_state *rs,
 			struct report_data *rd,
 			bool check_state,
@@ -869,15 +942,7 @@ static bool report_send(struct report_state *rs,
 	}
 
 	if (!check_state || (rs->state != STATE_DISCONNECTED)) {
-		unsigned int pipeline_depth;
-
-		if ((rs->subscriber->is_usb) ||
-		    (rs->report_id == REPORT_ID_CONSUMER_CTRL) ||
-		    (rs->report_id == REPORT_ID_SYSTEM_CTRL))  {
-			pipeline_depth = 1;
-		} else {
-			pipeline_depth = 2;
-		}
+		unsigned int pipeline_depth = get_pipeline_depth(rs);
 
 		while ((rs->cnt < pipeline_depth) &&
 		       (rs->subscriber->report_cnt < rs->subscriber->report_max) &&
@@ -915,10 +980,6 @@ static bool report_send(struct report_state *rs,
 			rs->cnt++;
 			rs->subscriber->report_cnt++;
 			report_sent = true;
-
-			/* To make sure report is sampled on every connection
-			 * event, add one additional report to the pipeline.
-			 */
 		}
 
 		if (rs->cnt != 0) {
@@ -988,7 +1049,7 @@ static void report_issued(const void *subscriber_id, uint8_t report_id, bool err
 
 	while (true) {
 		if ((next_rs->state != STATE_DISCONNECTED) &&
-		    (next_rs->cnt == 0) &&
+		    (next_rs->cnt < get_pipeline_depth(next_rs)) &&
 		    ((next_rs->linked_rd->linked_rs == next_rs) ||
 		     (next_rs->linked_rd->linked_rs == NULL))) {
 			if (report_send(next_rs, NULL, false, false)) {
@@ -1201,13 +1262,15 @@ static void disconnect(const void *subscriber_id, uint8_t report_id)
 	update_output_report_state();
 }
 
-static void connect_subscriber(const void *subscriber_id, bool is_usb, uint8_t report_max)
+static void connect_subscriber(const void *subscriber_id, bool is_usb,
+			       uint8_t report_max, uint8_t pipeline_depth)
 {
 	for (size_t i = 0; i < ARRAY_SIZE(state.subscriber); i++) {
 		if (!state.subscriber[i].id) {
 			state.subscriber[i].id = subscriber_id;
 			state.subscriber[i].is_usb = is_usb;
 			state.subscriber[i].report_max = report_max;
+			state.subscriber[i].pipeline_depth = pipeline_depth;
 			state.subscriber[i].report_cnt = 0;
 			update_output_report_state();
 			LOG_INF("Subscriber %p connected", subscriber_id);
@@ -1279,16 +1342,12 @@ static void enqueue(struct report_data *rd, uint16_t usage_id, int16_t value,
 			 * Try to remove queued items starting from the
 			 * oldest one.
 			 */
-			sys_snode_t *i;
-
-			SYS_SLIST_FOR_EACH_NODE(&rd->eventq.root, i) {
+			for (size_t i = 0; i < rd->eventq.len; i++) {
 				/* Initial cleanup was done above. Queue will
 				 * not contain events with expired timestamp.
 				 */
 				uint32_t timestamp =
-					CONTAINER_OF(i,
-						     struct item_event,
-						     node)->timestamp +
+					eventq_at(&rd->eventq, i)->timestamp +
 					CONFIG_DESKTOP_HID_REPORT_EXPIRATION;
 
 				eventq_cleanup(&rd->eventq, timestamp);
@@ -1296,13 +1355,20 @@ static void enqueue(struct report_data *rd, uint16_t usage_id, int16_t value,
 				if (!eventq_is_full(&rd->eventq)) {
 					/* At least one element was removed
 					 * from the queue. Do not continue
-					 * list traverse, content was modified!
+					 * queue traverse, content was modified!
 					 */
 					break;
 				}
 			}
 		}
 
+		if (eventq_is_full(&rd->eventq)) {
+			/* Drop a complete key press and release instead of
+			 * the whole queue, if possible.
+			 */
+			eventq_coalesce(&rd->eventq);
+		}
+
 		if (eventq_is_full(&rd->eventq)) {
 			/* To maintain the sanity of HID state, clear
 			 * all recorded events and items.
@@ -1540,7 +1606,11 @@ static bool handle_ble_peer_event(const struct ble_peer_event *event)
 {
 	switch (event->state) {
 	case PEER_STATE_CONNECTED:
-		connect_subscriber(event->id, false, UINT8_MAX);
+		/* Keep more reports in flight to make sure a report is
+		 * sampled on every connection event.
+		 */
+		connect_subscriber(event->id, false, UINT8_MAX,
+				   CONFIG_DESKTOP_HID_STATE_PIPELINE_DEPTH);
 		break;
 
 	case PEER_STATE_DISCONNECTING:
@@ -1564,7 +1634,8 @@ static bool handle_ble_peer_event(const struct ble_peer_event *event)
 static bool handle_usb_hid_event(const struct usb_hid_event *event)
 {
 	if (event->enabled) {
-		connect_subscriber(event->id, true, 1);
+		/* USB state handles one report at a time. */
+		connect_subscriber(event->id, true, 1, 1);
 	} else {
 		disconnect_subscriber(event->id);
 	}
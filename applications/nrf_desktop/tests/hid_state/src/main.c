@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <app_event_manager.h>
+
+#include <caf/events/ble_common_event.h>
+#include "hid_event.h"
+#include "motion_event.h"
+#include "hid_report_desc.h"
+
+#define MODULE main
+#include <caf/events/module_state_event.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(MODULE);
+
+#define PIPELINE_DEPTH CONFIG_DESKTOP_HID_STATE_PIPELINE_DEPTH
+
+/* Time for the event manager to process the submitted events. */
+#define EVENT_PROCESS_TIME K_MSEC(10)
+
+/* Stands in for the Bluetooth connection and the HID service. */
+static int peer;
+
+static size_t reports_unexpected;
+static size_t reports_in_flight;
+static size_t reports_max_in_flight;
+static size_t reports_total;
+static int32_t motion_total;
+
+static void events_process(void)
+{
+	k_sleep(EVENT_PROCESS_TIME);
+}
+
+static void peer_state_set(enum peer_state state)
+{
+	struct ble_peer_event *event = new_ble_peer_event();
+
+	event->id = &peer;
+	event->state = state;
+	APP_EVENT_SUBMIT(event);
+}
+
+static void mouse_subscribe(bool enabled)
+{
+	struct hid_report_subscription_event *event = new_hid_report_subscription_event();
+
+	event->subscriber = &peer;
+	event->report_id = REPORT_ID_MOUSE;
+	event->enabled = enabled;
+	APP_EVENT_SUBMIT(event);
+}
+
+static void motion_submit(int16_t dx)
+{
+	struct motion_event *event = new_motion_event();
+
+	event->dx = dx;
+	event->dy = 0;
+	APP_EVENT_SUBMIT(event);
+}
+
+/* Confirm the oldest report in flight, as the HID service does when the
+ * notification is sent.
+ */
+static void report_sent(void)
+{
+	struct hid_report_sent_event *event = new_hid_report_sent_event();
+
+	zassert_true(reports_in_flight > 0, "No report in flight");
+	reports_in_flight--;
+
+	event->subscriber = &peer;
+	event->report_id = REPORT_ID_MOUSE;
+	event->error = false;
+	APP_EVENT_SUBMIT(event);
+}
+
+static int16_t mouse_report_dx(const uint8_t *data)
+{
+	/* 12-bit X movement follows the report ID, buttons and wheel. */
+	uint16_t x = data[3] | ((data[4] & 0x0f) << 8);
+
+	return (int16_t)(x << 4) >> 4;
+}
+
+static bool handle_hid_report_event(const struct hid_report_event *event)
+{
+	if (event->subscriber != &peer) {
+		return false;
+	}
+
+	if (event->dyndata.data[0] != REPORT_ID_MOUSE) {
+		reports_unexpected++;
+		return false;
+	}
+
+	reports_in_flight++;
+	reports_max_in_flight = MAX(reports_max_in_flight, reports_in_flight);
+	reports_total++;
+	motion_total += mouse_report_dx(event->dyndata.data);
+
+	return false;
+}
+
+static bool app_event_handler(const struct app_event_header *aeh)
+{
+	if (is_hid_report_event(aeh)) {
+		return handle_hid_report_event(cast_hid_report_event(aeh));
+	}
+
+	/* If event is unhandled, unsubscribe. */
+	__ASSERT_NO_MSG(false);
+
+	return false;
+}
+
+APP_EVENT_LISTENER(test_main, app_event_handler);
+APP_EVENT_SUBSCRIBE(test_main, hid_report_event);
+
+static void *setup(void)
+{
+	zassert_ok(app_event_manager_init(), "Error when initializing");
+	module_set_state(MODULE_STATE_READY);
+	events_process();
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	reports_unexpected = 0;
+	reports_in_flight = 0;
+	reports_max_in_flight = 0;
+	reports_total = 0;
+	motion_total = 0;
+
+	peer_state_set(PEER_STATE_CONNECTED);
+	mouse_subscribe(true);
+	events_process();
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_equal(reports_unexpected, 0, "Unexpected report type");
+
+	while (reports_in_flight > 0) {
+		report_sent();
+		events_process();
+	}
+
+	mouse_subscribe(false);
+	peer_state_set(PEER_STATE_DISCONNECTED);
+	events_process();
+}
+
+ZTEST(hid_state, test_pipeline_fill)
+{
+	motion_submit(1);
+	events_process();
+
+	/* A single motion fills the whole pipeline, so that a report is ready
+	 * on every connection event.
+	 */
+	zassert_equal(reports_in_flight, PIPELINE_DEPTH, "Pipeline not filled");
+	zassert_equal(motion_total, 1, "Motion lost");
+
+	/* Motion is accumulated while the pipeline is full. */
+	for (size_t i = 0; i < 3; i++) {
+		motion_submit(1);
+	}
+	events_process();
+
+	zassert_equal(reports_total, PIPELINE_DEPTH, "Report sent to full pipeline");
+
+	/* The accumulated motion is sent in a single report. */
+	report_sent();
+	events_process();
+
+	zassert_equal(reports_total, PIPELINE_DEPTH + 1, "Pipeline not refilled");
+	zassert_equal(reports_in_flight, PIPELINE_DEPTH, "Unexpected reports in flight");
+	zassert_equal(motion_total, 4, "Motion lost");
+}
+
+ZTEST(hid_state, test_pipeline_drain)
+{
+	int32_t motion_sent = 0;
+
+	for (size_t i = 0; i < 4 * PIPELINE_DEPTH; i++) {
+		motion_submit(2);
+		motion_sent += 2;
+		events_process();
+
+		report_sent();
+		events_process();
+	}
+
+	while (reports_in_flight > 0) {
+		report_sent();
+		events_process();
+	}
+
+	zassert_equal(reports_max_in_flight, PIPELINE_DEPTH, "Pipeline depth exceeded");
+	zassert_equal(motion_total, motion_sent, "Motion lost");
+	zassert_equal(reports_in_flight, 0, "Reports sent without motion");
+}
+
+ZTEST_SUITE(hid_state, NULL, setup, before, after, NULL);
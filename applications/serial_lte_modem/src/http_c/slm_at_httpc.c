@@ -108,6 +108,10 @@ static void response_cb(struct http_response *rsp,
 		rsp_send("\r\n#XHTTPCRSP:%d,%hu\r\n", httpc.rsp_body_length, final_data);
 		httpc.state = HTTPC_COMPLETE;
 	}
+
+	/* The HTTP client receives the next data to the same buffer. */
+	data_buf_sync();
+
 	LOG_DBG("Response data received (%zd bytes)", rsp->data_len);
 }
 
@@ -329,6 +329,10 @@ int handle_at_sendto(enum at_cmd_type cmd_type);
 int handle_at_recvfrom(enum at_cmd_type cmd_type);
 int handle_at_poll(enum at_cmd_type cmd_type);
 int handle_at_getaddrinfo(enum at_cmd_type cmd_type);
+#if defined(CONFIG_SLM_SOCKET_POLL)
+int handle_at_apoll(enum at_cmd_type cmd_type);
+int handle_at_apoll_recv(enum at_cmd_type cmd_type);
+#endif
 
 #if defined(CONFIG_SLM_NATIVE_TLS)
 int handle_at_xcmng(enum at_cmd_type cmd_type);
@@ -427,6 +431,10 @@ static struct slm_at_cmd {
 	{"AT#XRECVFROM", handle_at_recvfrom},
 	{"AT#XPOLL", handle_at_poll},
 	{"AT#XGETADDRINFO", handle_at_getaddrinfo},
+#if defined(CONFIG_SLM_SOCKET_POLL)
+	{"AT#XAPOLL", handle_at_apoll},
+	{"AT#XAPOLLRECV", handle_at_apoll_recv},
+#endif
 
 #if defined(CONFIG_SLM_NATIVE_TLS)
 	{"AT#XCMNG", handle_at_xcmng},
@@ -41,7 +41,14 @@ K_MUTEX_DEFINE(mutex_mode); /* Protects the operation mode variables. */
 
 struct at_param_list slm_at_param_list;
 uint8_t slm_at_buf[SLM_AT_MAX_CMD_LEN];
-uint8_t slm_data_buf[SLM_MAX_MESSAGE_SIZE];
+
+/* Socket data is received to one buffer while the other one is sent. */
+static uint8_t data_bufs[2][SLM_MAX_MESSAGE_SIZE];
+uint8_t (*slm_data_buf_cur)[SLM_MAX_MESSAGE_SIZE] = &data_bufs[0];
+/* Available while the buffer is not being sent. */
+static K_SEM_DEFINE(data_buf_idle_0, 1, 1);
+static K_SEM_DEFINE(data_buf_idle_1, 1, 1);
+static struct k_sem *const data_buf_idle[] = { &data_buf_idle_0, &data_buf_idle_1 };
 
 RING_BUF_DECLARE(data_rb, CONFIG_SLM_DATAMODE_BUF_SIZE);
 static uint8_t quit_str_partial_match;
@@ -660,11 +667,11 @@ void rsp_send_error(void)
 	(void)slm_uart_tx_write(ERROR_STR, sizeof(ERROR_STR) - 1, true);
 }
 
+static K_MUTEX_DEFINE(mutex_rsp_buf);
+static char rsp_buf[SLM_AT_MAX_RSP_LEN];
+
 void rsp_send(const char *fmt, ...)
 {
-	static K_MUTEX_DEFINE(mutex_rsp_buf);
-	static char rsp_buf[SLM_AT_MAX_RSP_LEN];
-
 	if (!slm_uart_can_context_send(fmt, strlen(fmt))) {
 		return;
 	}
@@ -681,9 +688,111 @@ void rsp_send(const char *fmt, ...)
 	k_mutex_unlock(&mutex_rsp_buf);
 }
 
+static void data_sent(void *user_data, int err)
+{
+	ARG_UNUSED(err);
+
+	k_sem_give(user_data);
+}
+
+/* Index of the data buffer, if the data is in the current one. */
+static int data_buf_cur_idx(const uint8_t *data)
+{
+	const uint8_t *buf = *slm_data_buf_cur;
+
+	if (data < buf || data >= buf + sizeof(*slm_data_buf_cur)) {
+		return -1;
+	}
+
+	return slm_data_buf_cur - data_bufs;
+}
+
+/* Wait until the data buffer is not being sent. */
+static void data_buf_idle_wait(int idx)
+{
+	k_sem_take(data_buf_idle[idx], K_FOREVER);
+	k_sem_give(data_buf_idle[idx]);
+}
+
+/* Send the fragments, the last one holds the data. Data of at least
+ * CONFIG_SLM_UART_TX_ZERO_COPY_THRESHOLD bytes is sent in place. From slm_data_buf, it is
+ * sent in the background and slm_data_buf switches to the other buffer, so that the next
+ * data is received while the UART sends. Otherwise, the function returns once it has been
+ * sent. @p lock is unlocked as soon as the fragments are queued.
+ */
+static void data_frags_send(struct slm_uart_tx_frag *frags, size_t count, struct k_mutex *lock)
+{
+	struct slm_uart_tx_frag *data = &frags[count - 1];
+	int idx = data_buf_cur_idx(data->data);
+	struct k_sem sent;
+	struct k_sem *done = &sent;
+	int err;
+
+	data->ref = data->len >= CONFIG_SLM_UART_TX_ZERO_COPY_THRESHOLD;
+	if (data->ref && idx >= 0) {
+		/* The current buffer is never being sent. */
+		done = data_buf_idle[idx];
+		(void)k_sem_take(done, K_NO_WAIT);
+	} else {
+		k_sem_init(&sent, 0, 1);
+	}
+
+	err = slm_uart_tx_writev_ref(frags, count, data_sent, done);
+	if (lock) {
+		k_mutex_unlock(lock);
+	}
+	if (err) {
+		if (done != &sent) {
+			k_sem_give(done);
+		}
+		return;
+	}
+
+	if (done == &sent) {
+		k_sem_take(&sent, K_FOREVER);
+		return;
+	}
+
+	/* The other buffer was sent before this one, usually it is idle already. */
+	idx = !idx;
+	data_buf_idle_wait(idx);
+	slm_data_buf_cur = &data_bufs[idx];
+}
+
+void data_buf_sync(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(data_bufs); i++) {
+		data_buf_idle_wait(i);
+	}
+}
+
 void data_send(const uint8_t *data, size_t len)
 {
-	(void)slm_uart_tx_write(data, len, false);
+	struct slm_uart_tx_frag frag = { .data = data, .len = len };
+
+	data_frags_send(&frag, 1, NULL);
+}
+
+void rsp_data_send(const uint8_t *data, size_t len, const char *fmt, ...)
+{
+	struct slm_uart_tx_frag frags[2] = {
+		{ .data = rsp_buf },
+		{ .data = data, .len = len }
+	};
+	va_list arg_ptr;
+
+	if (!slm_uart_can_context_send(fmt, strlen(fmt))) {
+		return;
+	}
+	k_mutex_lock(&mutex_rsp_buf, K_FOREVER);
+
+	va_start(arg_ptr, fmt);
+	vsnprintf(rsp_buf, sizeof(rsp_buf), fmt, arg_ptr);
+	va_end(arg_ptr);
+
+	/* The header is copied, so rsp_buf is released once the fragments are queued. */
+	frags[0].len = strlen(rsp_buf);
+	data_frags_send(frags, ARRAY_SIZE(frags), &mutex_rsp_buf);
 }
 
 int enter_datamode(slm_datamode_handler_t handler)
@@ -24,7 +24,11 @@
 #define SLM_DATAMODE_FLAGS_MORE_DATA	1 << 0
 
 extern struct at_param_list slm_at_param_list; /* For AT parser. */
-extern uint8_t slm_data_buf[SLM_MAX_MESSAGE_SIZE];  /* For socket data. */
+/* For socket data. Double-buffered: data sent from it by data_send() or rsp_data_send()
+ * is sent in the background, and slm_data_buf refers to the other buffer from then on.
+ */
+extern uint8_t (*slm_data_buf_cur)[SLM_MAX_MESSAGE_SIZE];
+#define slm_data_buf (*slm_data_buf_cur)
 extern uint8_t slm_at_buf[SLM_AT_MAX_CMD_LEN]; /* AT command buffer. */
 
 extern uint16_t slm_datamode_time_limit; /* Send trigger by time in data mode. */
@@ -76,15 +80,43 @@ void rsp_send_ok(void);
  */
 void rsp_send_error(void);
 
+/**
+ * @brief Wait until the data sent from slm_data_buf has been sent
+ *
+ * Callers that keep a pointer to slm_data_buf across data_send() or rsp_data_send()
+ * must call this before writing to the buffer again.
+ */
+void data_buf_sync(void);
+
 /**
  * @brief Send raw data received in data mode
  *
+ * Data of at least CONFIG_SLM_UART_TX_ZERO_COPY_THRESHOLD bytes is sent from the
+ * caller buffer without copying it. From slm_data_buf, it is sent in the background
+ * and slm_data_buf switches to the other buffer. From any other buffer, the function
+ * returns only once the UART has sent it.
+ *
  * @param data Raw data received
  * @param len Length of raw data
  *
  */
 void data_send(const uint8_t *data, size_t len);
 
+/**
+ * @brief Send AT command response followed by raw data
+ *
+ * The response and the data are sent together. Data of at least
+ * CONFIG_SLM_UART_TX_ZERO_COPY_THRESHOLD bytes is sent from the caller buffer
+ * without copying it, like with data_send(). Other responses can be sent as soon
+ * as this one is queued.
+ *
+ * @param data Raw data
+ * @param len Length of raw data
+ * @param fmt Response message format string
+ *
+ */
+void rsp_data_send(const uint8_t *data, size_t len, const char *fmt, ...);
+
 /**
  * @brief Request SLM AT host to enter data mode
  *
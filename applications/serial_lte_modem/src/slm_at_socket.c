@@ -14,6 +14,9 @@
 #include "slm_at_host.h"
 #include "slm_at_socket.h"
 #include "slm_native_tls.h"
+#if defined(CONFIG_SLM_SOCKET_POLL)
+#include "slm_sock_poll.h"
+#endif
 
 LOG_MODULE_REGISTER(slm_sock, CONFIG_SLM_LOG_LEVEL);
 
@@ -60,6 +63,9 @@ static struct slm_socket {
 static struct pollfd fds[SLM_MAX_SOCKET_COUNT];
 static struct slm_socket sock;
 
+/* Serializes the socket table updates with the poll engine thread. */
+static K_MUTEX_DEFINE(socks_mutex);
+
 /* forward declarations */
 #define SOCKET_SEND_TMO_SEC      30
 static int socket_poll(int sock_fd, int event, int timeout);
@@ -75,6 +81,177 @@ static int socket_ranking;
 	socket.ranking = 0;			\
 	socket.cid     = 0;
 
+#if defined(CONFIG_SLM_SOCKET_POLL)
+#define APOLL_STACK_SIZE	KB(2)
+#define APOLL_PRIORITY		K_LOWEST_APPLICATION_THREAD_PRIO
+
+/**@brief Poll engine operations. */
+enum slm_apoll_operation {
+	AT_APOLL_STOP,
+	AT_APOLL_START
+};
+
+static struct slm_sock_poll apoll;
+static K_THREAD_STACK_DEFINE(apoll_stack, APOLL_STACK_SIZE);
+static struct k_thread apoll_thread;
+static bool apoll_running;
+static bool apoll_thread_created;
+
+/* Held by the poll engine while it polls, so that the polled sockets are not closed.
+ * Taken after socks_mutex.
+ */
+static K_MUTEX_DEFINE(apoll_wait_mutex);
+
+static bool apoll_notify(int handle, size_t len, short revents)
+{
+	/* No URC allowed in data mode, the report is sent after it. */
+	if (in_datamode()) {
+		return false;
+	}
+
+	rsp_send("\r\n#XAPOLL: %d,%d,\"0x%04x\"\r\n", handle, (int)len, revents);
+
+	return true;
+}
+
+static const struct slm_sock_poll_ops apoll_ops = {
+	.poll = poll,
+	.recv = recv,
+	.notify = apoll_notify
+};
+
+/* Called with socks_mutex held. */
+static void apoll_sync(void)
+{
+	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
+		int fd = socks[i].fd;
+
+		/* For TCP/TLS Server, receive from incoming socket */
+		if (socks[i].type == SOCK_STREAM && socks[i].role == AT_SOCKET_ROLE_SERVER) {
+			fd = socks[i].fd_peer;
+		}
+		slm_sock_poll_update(&apoll, i, socks[i].fd, fd, socks[i].type == SOCK_STREAM);
+	}
+}
+
+static void apoll_thread_func(void *p1, void *p2, void *p3)
+{
+	int ret;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (apoll_running) {
+		k_mutex_lock(&socks_mutex, K_FOREVER);
+		apoll_sync();
+		ret = slm_sock_poll_prepare(&apoll);
+		k_mutex_lock(&apoll_wait_mutex, K_FOREVER);
+		k_mutex_unlock(&socks_mutex);
+
+		/* The socket table is not locked while waiting, changes are picked up
+		 * after the poll period at the latest. Closing a polled socket waits for
+		 * the poll to end.
+		 */
+		if (ret > 0) {
+			ret = slm_sock_poll_wait(&apoll, CONFIG_SLM_SOCKET_POLL_PERIOD);
+			k_mutex_unlock(&apoll_wait_mutex);
+			if (ret < 0) {
+				LOG_WRN("poll() error: %d", -errno);
+				k_sleep(K_MSEC(CONFIG_SLM_SOCKET_POLL_PERIOD));
+			}
+		} else {
+			k_mutex_unlock(&apoll_wait_mutex);
+			k_sleep(K_MSEC(CONFIG_SLM_SOCKET_POLL_PERIOD));
+		}
+
+		k_mutex_lock(&socks_mutex, K_FOREVER);
+		apoll_sync();
+		slm_sock_poll_handle(&apoll);
+		k_mutex_unlock(&socks_mutex);
+	}
+}
+
+static int apoll_stop(void)
+{
+	apoll_running = false;
+	if (!apoll_thread_created) {
+		return 0;
+	}
+
+	/* The thread may still be sending a report, it is joined again on the next stop. */
+	if (k_thread_join(&apoll_thread, K_MSEC(CONFIG_SLM_SOCKET_POLL_PERIOD * 2)) != 0) {
+		LOG_WRN("Wait for thread terminate failed");
+		return -EBUSY;
+	}
+	apoll_thread_created = false;
+
+	return 0;
+}
+
+static int apoll_start(bool auto_recv)
+{
+	int err;
+
+	/* The thread object and stack cannot be reused until the thread has ended. */
+	err = apoll_stop();
+	if (err) {
+		return err;
+	}
+
+	slm_sock_poll_init(&apoll, &apoll_ops, auto_recv);
+	apoll_running = true;
+	apoll_thread_created = true;
+	k_thread_create(&apoll_thread, apoll_stack, K_THREAD_STACK_SIZEOF(apoll_stack),
+			apoll_thread_func, NULL, NULL, NULL,
+			APOLL_PRIORITY, 0, K_NO_WAIT);
+
+	return 0;
+}
+
+/* Read data received by the poll engine, -ENOENT if the socket is not buffered. */
+static int apoll_buffered_read(int handle, uint8_t *buf, size_t len)
+{
+	int ret = -ENOENT;
+
+	k_mutex_lock(&socks_mutex, K_FOREVER);
+	if (apoll_running && slm_sock_poll_is_buffered(&apoll, handle)) {
+		ret = slm_sock_poll_read(&apoll, handle, buf, len);
+	}
+	k_mutex_unlock(&socks_mutex);
+
+	return ret;
+}
+
+static void apoll_rearm(int handle)
+{
+	k_mutex_lock(&socks_mutex, K_FOREVER);
+	if (apoll_running) {
+		slm_sock_poll_rearm(&apoll, handle);
+	}
+	k_mutex_unlock(&socks_mutex);
+}
+#endif /* CONFIG_SLM_SOCKET_POLL */
+
+/* Close a socket of the socket table. Called with socks_mutex held. */
+static int socket_close(int fd)
+{
+#if defined(CONFIG_SLM_SOCKET_POLL)
+	int ret;
+
+	/* Wait for the poll engine to stop polling the socket. The socket table update
+	 * that follows removes it from the next poll.
+	 */
+	k_mutex_lock(&apoll_wait_mutex, K_FOREVER);
+	ret = close(fd);
+	k_mutex_unlock(&apoll_wait_mutex);
+
+	return ret;
+#else
+	return close(fd);
+#endif
+}
+
 static bool is_opened_socket(int fd)
 {
 	if (fd == INVALID_SOCKET) {
@@ -154,7 +331,9 @@ static int do_socket_open(void)
 	if (ret < 0) {
 		return ret;
 	}
+	k_mutex_lock(&socks_mutex, K_FOREVER);
 	socks[ret] = sock;
+	k_mutex_unlock(&socks_mutex);
 	rsp_send("\r\n#XSOCKET: %d,%d,%d\r\n", sock.fd, sock.type, proto);
 
 	return 0;
@@ -225,7 +404,9 @@ static int do_secure_socket_open(int peer_verify)
 	if (ret < 0) {
 		return ret;
 	}
+	k_mutex_lock(&socks_mutex, K_FOREVER);
 	socks[ret] = sock;
+	k_mutex_unlock(&socks_mutex);
 	rsp_send("\r\n#XSSOCKET: %d,%d,%d\r\n", sock.fd, sock.type, proto);
 
 	return 0;
@@ -259,21 +440,20 @@ static int do_socket_close(void)
 		sock.sec_tag = INVALID_SEC_TAG;
 	}
 #endif
+	k_mutex_lock(&socks_mutex, K_FOREVER);
 	if (sock.fd_peer != INVALID_SOCKET) {
-		ret = close(sock.fd_peer);
+		ret = socket_close(sock.fd_peer);
 		if (ret) {
 			LOG_WRN("peer close() error: %d", -errno);
 		}
 		sock.fd_peer = INVALID_SOCKET;
 	}
-	ret = close(sock.fd);
+	ret = socket_close(sock.fd);
 	if (ret) {
 		LOG_WRN("close() error: %d", -errno);
 		ret = -errno;
 	}
 
-	rsp_send("\r\n#XSOCKET: %d,\"closed\"\r\n", ret);
-
 	/* Select most recent socket as current active */
 	int ranking = 0, index = -1;
 
@@ -291,6 +471,10 @@ static int do_socket_close(void)
 			}
 		}
 	}
+	k_mutex_unlock(&socks_mutex);
+
+	rsp_send("\r\n#XSOCKET: %d,\"closed\"\r\n", ret);
+
 	if (index >= 0) {
 		LOG_INF("Swap to socket %d", socks[index].fd);
 		sock = socks[index];
@@ -646,6 +830,13 @@ static int do_accept(int timeout)
 	} else {
 		return -EINVAL;
 	}
+	k_mutex_lock(&socks_mutex, K_FOREVER);
+	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
+		if (socks[i].fd == sock.fd) {
+			socks[i].fd_peer = sock.fd_peer;
+		}
+	}
+	k_mutex_unlock(&socks_mutex);
 	rsp_send("\r\n#XACCEPT: %d,\"%s\"\r\n", sock.fd_peer, peer_addr);
 
 	return 0;
@@ -739,11 +930,25 @@ static int do_recv(int timeout, int flags)
 		}
 	}
 
+#if defined(CONFIG_SLM_SOCKET_POLL)
+	/* Data received by the poll engine comes first, the socket is not read directly. */
+	ret = apoll_buffered_read(sock.fd, slm_data_buf, sizeof(slm_data_buf));
+	if (ret != -ENOENT) {
+		if (ret > 0) {
+			rsp_data_send(slm_data_buf, ret, "\r\n#XRECV: %d\r\n", ret);
+			ret = 0;
+		}
+		return ret;
+	}
+#endif
 	ret = socket_poll(sockfd, POLLIN, timeout);
 	if (ret) {
 		return ret;
 	}
 	ret = recv(sockfd, (void *)slm_data_buf, sizeof(slm_data_buf), flags);
+#if defined(CONFIG_SLM_SOCKET_POLL)
+	apoll_rearm(sock.fd);
+#endif
 	if (ret < 0) {
 		LOG_WRN("recv() error: %d", -errno);
 		return -errno;
@@ -758,8 +963,7 @@ static int do_recv(int timeout, int flags)
 	if (ret == 0) {
 		LOG_WRN("recv() return 0");
 	} else {
-		rsp_send("\r\n#XRECV: %d\r\n", ret);
-		data_send(slm_data_buf, ret);
+		rsp_data_send(slm_data_buf, ret, "\r\n#XRECV: %d\r\n", ret);
 		ret = 0;
 	}
 
@@ -859,6 +1063,9 @@ static int do_recvfrom(int timeout, int flags)
 	}
 	ret = recvfrom(
 		sock.fd, (void *)slm_data_buf, sizeof(slm_data_buf), flags, &remote, &addrlen);
+#if defined(CONFIG_SLM_SOCKET_POLL)
+	apoll_rearm(sock.fd);
+#endif
 	if (ret < 0) {
 		LOG_ERR("recvfrom() error: %d", -errno);
 		return -errno;
@@ -885,8 +1092,8 @@ static int do_recvfrom(int timeout, int flags)
 			peer_port = ntohs(((struct sockaddr_in6 *)&remote)->sin6_port);
 		}
 
-		rsp_send("\r\n#XRECVFROM: %d,\"%s\",%d\r\n", ret, peer_addr, peer_port);
-		data_send(slm_data_buf, ret);
+		rsp_data_send(slm_data_buf, ret, "\r\n#XRECVFROM: %d,\"%s\",%d\r\n",
+			      ret, peer_addr, peer_port);
 	}
 
 	return 0;
@@ -1625,14 +1832,105 @@ int handle_at_poll(enum at_cmd_type cmd_type)
 	return err;
 }
 
+#if defined(CONFIG_SLM_SOCKET_POLL)
+/* Handles AT#XAPOLL commands. */
+int handle_at_apoll(enum at_cmd_type cmd_type)
+{
+	int err = -EINVAL;
+	uint16_t op;
+	uint16_t auto_recv = 0;
+
+	switch (cmd_type) {
+	case AT_CMD_TYPE_SET_COMMAND:
+		err = at_params_unsigned_short_get(&slm_at_param_list, 1, &op);
+		if (err) {
+			return err;
+		}
+		if (at_params_valid_count_get(&slm_at_param_list) > 2) {
+			err = at_params_unsigned_short_get(&slm_at_param_list, 2, &auto_recv);
+			if (err) {
+				return err;
+			}
+		}
+		if (op == AT_APOLL_START && auto_recv <= 1) {
+			err = apoll_start(auto_recv == 1);
+		} else if (op == AT_APOLL_STOP) {
+			err = apoll_stop();
+		} else {
+			return -EINVAL;
+		}
+		break;
+
+	case AT_CMD_TYPE_READ_COMMAND:
+		rsp_send("\r\n#XAPOLL: %d,%d\r\n", apoll_running, apoll.auto_recv);
+		err = 0;
+		break;
+
+	case AT_CMD_TYPE_TEST_COMMAND:
+		rsp_send("\r\n#XAPOLL: (%d,%d),(0,1)\r\n", AT_APOLL_STOP, AT_APOLL_START);
+		err = 0;
+		break;
+
+	default:
+		break;
+	}
+
+	return err;
+}
+
+/* Handles AT#XAPOLLRECV command. */
+int handle_at_apoll_recv(enum at_cmd_type cmd_type)
+{
+	int err = -EINVAL;
+	int handle;
+	int size = sizeof(slm_data_buf);
+
+	switch (cmd_type) {
+	case AT_CMD_TYPE_SET_COMMAND:
+		err = at_params_int_get(&slm_at_param_list, 1, &handle);
+		if (err) {
+			return err;
+		}
+		if (at_params_valid_count_get(&slm_at_param_list) > 2) {
+			err = at_params_int_get(&slm_at_param_list, 2, &size);
+			if (err) {
+				return err;
+			}
+		}
+		if (!apoll_running || size <= 0) {
+			return -EINVAL;
+		}
+		size = MIN(size, (int)sizeof(slm_data_buf));
+
+		k_mutex_lock(&socks_mutex, K_FOREVER);
+		err = slm_sock_poll_read(&apoll, handle, slm_data_buf, size);
+		k_mutex_unlock(&socks_mutex);
+		if (err < 0) {
+			return err;
+		}
+
+		rsp_data_send(slm_data_buf, err, "\r\n#XAPOLLRECV: %d,%d\r\n", handle, err);
+		err = 0;
+		break;
+
+	default:
+		break;
+	}
+
+	return err;
+}
+#endif /* CONFIG_SLM_SOCKET_POLL */
+
 /**@brief API to initialize Socket AT commands handler
  */
 int slm_at_socket_init(void)
 {
 	INIT_SOCKET(sock);
+	k_mutex_lock(&socks_mutex, K_FOREVER);
 	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
 		INIT_SOCKET(socks[i]);
 	}
+	k_mutex_unlock(&socks_mutex);
 	socket_ranking = 1;
 
 	return 0;
@@ -1642,15 +1940,21 @@ int slm_at_socket_init(void)
  */
 int slm_at_socket_uninit(void)
 {
+#if defined(CONFIG_SLM_SOCKET_POLL)
+	(void)apoll_stop();
+#endif
 	(void)do_socket_close();
+	k_mutex_lock(&socks_mutex, K_FOREVER);
 	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
 		if (socks[i].fd_peer != INVALID_SOCKET) {
-			close(socks[i].fd_peer);
+			(void)socket_close(socks[i].fd_peer);
 		}
 		if (socks[i].fd != INVALID_SOCKET) {
-			close(socks[i].fd);
+			(void)socket_close(socks[i].fd);
 		}
+		INIT_SOCKET(socks[i]);
 	}
+	k_mutex_unlock(&socks_mutex);
 
 	return 0;
 }
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "slm_sock_poll.h"
+
+#define POLL_CLOSED_EVENTS (POLLHUP | POLLERR | POLLNVAL)
+
+static void entry_reset(struct slm_sock_poll_entry *e, int handle)
+{
+	e->handle = handle;
+	e->fd = INVALID_SOCKET;
+	e->stream = false;
+	e->armed = true;
+	e->revents = 0;
+	ring_buf_init(&e->ring, sizeof(e->ring_data), e->ring_data);
+}
+
+static struct slm_sock_poll_entry *entry_find(struct slm_sock_poll *p, int handle)
+{
+	if (handle == INVALID_SOCKET) {
+		return NULL;
+	}
+
+	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
+		if (p->entries[i].handle == handle) {
+			return &p->entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool is_buffered(const struct slm_sock_poll *p, const struct slm_sock_poll_entry *e)
+{
+	return p->auto_recv && e->stream;
+}
+
+/* Receive the available data of a buffered socket to its ring buffer. */
+static void entry_receive(struct slm_sock_poll *p, struct slm_sock_poll_entry *e, short revents)
+{
+	uint8_t *buf;
+	uint32_t space;
+	ssize_t ret;
+
+	if (!(revents & POLLIN)) {
+		e->revents |= revents & POLL_CLOSED_EVENTS;
+		return;
+	}
+
+	/* Only the contiguous space is filled, the rest is filled by the next round. */
+	space = ring_buf_put_claim(&e->ring, &buf, ring_buf_space_get(&e->ring));
+	ret = p->ops->recv(e->fd, buf, space, MSG_DONTWAIT);
+	if (ret > 0) {
+		(void)ring_buf_put_finish(&e->ring, ret);
+		p->bytes_buffered += ret;
+		return;
+	}
+
+	(void)ring_buf_put_finish(&e->ring, 0);
+	if (ret == 0) {
+		/* Orderly shutdown by the peer. */
+		e->revents |= POLLHUP;
+	} else if (errno != EAGAIN) {
+		e->revents |= POLLERR;
+	}
+}
+
+static void entry_notify(struct slm_sock_poll *p, struct slm_sock_poll_entry *e)
+{
+	short revents = e->revents;
+	size_t len = 0;
+
+	if (e->fd == INVALID_SOCKET || !e->armed) {
+		return;
+	}
+
+	if (is_buffered(p, e)) {
+		len = ring_buf_size_get(&e->ring);
+		if (len > 0) {
+			revents |= POLLIN;
+		}
+	} else if (revents & POLLIN) {
+		/* The size reported is what one read returns. */
+		ssize_t ret = p->ops->recv(e->fd, p->peek_buf, sizeof(p->peek_buf),
+					   MSG_PEEK | MSG_DONTWAIT);
+
+		if (ret > 0) {
+			len = ret;
+		} else if (ret < 0 && errno == EAGAIN) {
+			revents &= ~POLLIN;
+			e->revents = revents;
+		}
+	}
+
+	if (revents == 0) {
+		return;
+	}
+
+	if (!p->ops->notify(e->handle, len, revents)) {
+		return;
+	}
+
+	e->armed = false;
+	p->notifications++;
+	if (!is_buffered(p, e)) {
+		e->revents = 0;
+	}
+}
+
+void slm_sock_poll_init(struct slm_sock_poll *p, const struct slm_sock_poll_ops *ops,
+			bool auto_recv)
+{
+	p->ops = ops;
+	p->auto_recv = auto_recv;
+	p->notifications = 0;
+	p->bytes_buffered = 0;
+
+	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
+		entry_reset(&p->entries[i], INVALID_SOCKET);
+		p->fds[i].fd = INVALID_SOCKET;
+	}
+}
+
+void slm_sock_poll_update(struct slm_sock_poll *p, int slot, int handle, int fd, bool stream)
+{
+	struct slm_sock_poll_entry *e = &p->entries[slot];
+
+	if (e->handle != handle) {
+		entry_reset(e, handle);
+	}
+
+	if (handle == INVALID_SOCKET) {
+		return;
+	}
+
+	if (e->fd != fd) {
+		/* Accepted connection of a server socket. */
+		e->fd = fd;
+		e->armed = true;
+		e->revents = 0;
+		ring_buf_reset(&e->ring);
+	}
+	e->stream = stream;
+}
+
+int slm_sock_poll_prepare(struct slm_sock_poll *p)
+{
+	int count = 0;
+
+	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
+		struct slm_sock_poll_entry *e = &p->entries[i];
+		bool poll_in;
+
+		if (is_buffered(p, e)) {
+			/* Keep receiving until the buffer is full or the connection is closed. */
+			poll_in = !(e->revents & POLL_CLOSED_EVENTS) &&
+				  ring_buf_space_get(&e->ring) > 0;
+		} else {
+			/* A refused report is retried without polling the socket again. */
+			poll_in = e->armed && !e->revents;
+		}
+
+		p->fds[i].revents = 0;
+		if (e->fd != INVALID_SOCKET && poll_in) {
+			p->fds[i].fd = e->fd;
+			p->fds[i].events = POLLIN;
+			count++;
+		} else {
+			/* Negative descriptors are ignored by poll(). */
+			p->fds[i].fd = INVALID_SOCKET;
+			p->fds[i].events = 0;
+		}
+	}
+
+	return count;
+}
+
+int slm_sock_poll_wait(struct slm_sock_poll *p, int timeout)
+{
+	return p->ops->poll(p->fds, SLM_MAX_SOCKET_COUNT, timeout);
+}
+
+void slm_sock_poll_handle(struct slm_sock_poll *p)
+{
+	for (int i = 0; i < SLM_MAX_SOCKET_COUNT; i++) {
+		struct slm_sock_poll_entry *e = &p->entries[i];
+		short revents = p->fds[i].revents;
+
+		/* Skip the events of a socket that was replaced during the wait. */
+		if (p->fds[i].fd != INVALID_SOCKET && p->fds[i].fd == e->fd && revents) {
+			if (is_buffered(p, e)) {
+				entry_receive(p, e, revents);
+			} else {
+				e->revents = revents;
+			}
+		}
+
+		/* Reports refused earlier are sent here too. */
+		entry_notify(p, e);
+	}
+}
+
+int slm_sock_poll_read(struct slm_sock_poll *p, int handle, uint8_t *buf, size_t len)
+{
+	struct slm_sock_poll_entry *e = entry_find(p, handle);
+	ssize_t ret;
+
+	if (!e) {
+		return -ENOENT;
+	}
+	if (e->fd == INVALID_SOCKET) {
+		return -ENOTCONN;
+	}
+
+	e->armed = true;
+
+	if (is_buffered(p, e)) {
+		if (ring_buf_is_empty(&e->ring) && !(e->revents & POLL_CLOSED_EVENTS)) {
+			return -EAGAIN;
+		}
+		return ring_buf_get(&e->ring, buf, len);
+	}
+
+	ret = p->ops->recv(e->fd, buf, len, MSG_DONTWAIT);
+	if (ret < 0) {
+		return -errno;
+	}
+
+	return ret;
+}
+
+void slm_sock_poll_rearm(struct slm_sock_poll *p, int handle)
+{
+	struct slm_sock_poll_entry *e = entry_find(p, handle);
+
+	if (e) {
+		e->armed = true;
+	}
+}
+
+bool slm_sock_poll_is_buffered(struct slm_sock_poll *p, int handle)
+{
+	struct slm_sock_poll_entry *e = entry_find(p, handle);
+
+	return e && is_buffered(p, e);
+}
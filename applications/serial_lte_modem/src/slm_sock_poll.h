@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef SLM_SOCK_POLL_
+#define SLM_SOCK_POLL_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/ring_buffer.h>
+#include "slm_defines.h"
+
+/**@file slm_sock_poll.h
+ *
+ * @brief Background socket poll engine for serial LTE modem
+ *
+ * The engine polls a set of sockets and reports the sockets that have data
+ * available. A socket is reported once, and then left out of the poll set until
+ * it is re-armed by reading from it. In auto-receive mode, the data of stream
+ * sockets is received to a per-socket ring buffer as it arrives.
+ *
+ * One iteration consists of slm_sock_poll_prepare(), slm_sock_poll_wait() and
+ * slm_sock_poll_handle(). Only the wait does not access the socket entries, so
+ * it can be run without holding the lock that serializes the other calls.
+ * @{
+ */
+
+/**@brief Socket operations used by the engine. */
+struct slm_sock_poll_ops {
+	/** Same as poll(). */
+	int (*poll)(struct pollfd *fds, int nfds, int timeout);
+	/** Same as recv(). */
+	ssize_t (*recv)(int sock, void *buf, size_t len, int flags);
+	/**
+	 * Report a socket with data available or an error condition.
+	 * Returns false if the report could not be sent, it is then retried.
+	 */
+	bool (*notify)(int handle, size_t len, short revents);
+};
+
+/**@brief Polled socket. */
+struct slm_sock_poll_entry {
+	/** Socket handle known to the host, INVALID_SOCKET if unused. */
+	int handle;
+	/** Socket that is polled and read, INVALID_SOCKET if none. */
+	int fd;
+	/** Data of stream sockets can be received to the ring buffer. */
+	bool stream;
+	/** Report the socket when data is available. */
+	bool armed;
+	/** Events that are reported with the buffered data. */
+	short revents;
+	struct ring_buf ring;
+	uint8_t ring_data[CONFIG_SLM_SOCKET_POLL_RX_BUF_SIZE];
+};
+
+/**@brief Poll engine. */
+struct slm_sock_poll {
+	const struct slm_sock_poll_ops *ops;
+	bool auto_recv;
+	struct pollfd fds[SLM_MAX_SOCKET_COUNT];
+	struct slm_sock_poll_entry entries[SLM_MAX_SOCKET_COUNT];
+	uint8_t peek_buf[CONFIG_SLM_SOCKET_RX_MAX];
+	/** Number of reports sent. */
+	uint32_t notifications;
+	/** Number of bytes received to the ring buffers. */
+	uint32_t bytes_buffered;
+};
+
+/**
+ * @brief Initialize the engine with an empty socket set.
+ *
+ * @param p Engine.
+ * @param ops Socket operations.
+ * @param auto_recv Receive the data of stream sockets to the ring buffers.
+ */
+void slm_sock_poll_init(struct slm_sock_poll *p, const struct slm_sock_poll_ops *ops,
+			bool auto_recv);
+
+/**
+ * @brief Update a slot of the socket set.
+ *
+ * A new handle resets the slot and drops any buffered data.
+ *
+ * @param p Engine.
+ * @param slot Slot index, less than SLM_MAX_SOCKET_COUNT.
+ * @param handle Socket handle known to the host, INVALID_SOCKET to free the slot.
+ * @param fd Socket that is polled and read, INVALID_SOCKET if none yet.
+ * @param stream Whether the socket is a stream socket.
+ */
+void slm_sock_poll_update(struct slm_sock_poll *p, int slot, int handle, int fd, bool stream);
+
+/**
+ * @brief Build the poll set.
+ *
+ * @param p Engine.
+ *
+ * @return Number of sockets in the poll set.
+ */
+int slm_sock_poll_prepare(struct slm_sock_poll *p);
+
+/**
+ * @brief Wait for events on the poll set.
+ *
+ * @param p Engine.
+ * @param timeout Timeout in milliseconds.
+ *
+ * @return Return value of the poll operation.
+ */
+int slm_sock_poll_wait(struct slm_sock_poll *p, int timeout);
+
+/**
+ * @brief Receive the available data and send the reports.
+ *
+ * @param p Engine.
+ */
+void slm_sock_poll_handle(struct slm_sock_poll *p);
+
+/**
+ * @brief Read data of a socket.
+ *
+ * Buffered sockets are read from the ring buffer, others directly from the socket
+ * without blocking. The socket is re-armed, remaining data is reported again.
+ *
+ * @param p Engine.
+ * @param handle Socket handle.
+ * @param buf Output buffer.
+ * @param len Size of @p buf.
+ *
+ * @return Number of bytes read, 0 if the connection is closed, otherwise a (negative)
+ *         error code. -ENOENT if the socket is not in the set.
+ */
+int slm_sock_poll_read(struct slm_sock_poll *p, int handle, uint8_t *buf, size_t len);
+
+/**
+ * @brief Re-arm a socket after its data was read directly from the socket.
+ *
+ * @param p Engine.
+ * @param handle Socket handle.
+ */
+void slm_sock_poll_rearm(struct slm_sock_poll *p, int handle);
+
+/**
+ * @brief Check whether the data of a socket is received to its ring buffer.
+ *
+ * @param p Engine.
+ * @param handle Socket handle.
+ *
+ * @retval true If the socket must be read with slm_sock_poll_read().
+ * @retval false Otherwise.
+ */
+bool slm_sock_poll_is_buffered(struct slm_sock_poll *p, int handle);
+/** @} */
+
+#endif /* SLM_SOCK_POLL_ */
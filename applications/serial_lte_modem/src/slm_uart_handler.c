@@ -7,19 +7,18 @@
 #include <zephyr/kernel.h>
 #include <stdio.h>
 #include <zephyr/drivers/uart.h>
-#include <hal/nrf_uarte.h>
-#include <hal/nrf_gpio.h>
 #include <zephyr/sys/ring_buffer.h>
 #include <zephyr/pm/device.h>
-#include <pm_config.h>
 #include "slm_settings.h"
 #include "slm_uart_handler.h"
+#include "slm_uart_tx_queue.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(slm_uart_handler, CONFIG_SLM_LOG_LEVEL);
 
 #define UART_RX_TIMEOUT_US		2000
 #define UART_ERROR_DELAY_MS		500
+#define UART_TX_DRAIN_TIMEOUT_MS	1000
 
 #define SLM_SYNC_STR	"Ready\r\n"
 
@@ -50,8 +49,10 @@ struct rx_event_t {
 };
 K_MSGQ_DEFINE(rx_event_queue, sizeof(struct rx_event_t), UART_RX_EVENT_COUNT, 4);
 
-RING_BUF_DECLARE(tx_buf, CONFIG_SLM_UART_TX_BUF_SIZE);
-K_MUTEX_DEFINE(mutex_tx_put); /* Protects the tx_buf from multiple writes. */
+static struct slm_uart_tx_queue tx_queue;
+static struct k_spinlock tx_lock; /* Protects the tx_queue from the UART callback. */
+K_MUTEX_DEFINE(mutex_tx_put); /* Keeps the data of a single write together. */
+static atomic_t tx_stopped; /* No new transfers are started while the UART powers off. */
 
 enum uart_recovery_state {
 	RECOVERY_IDLE,
@@ -188,30 +189,83 @@ static void rx_process(struct k_work *work)
 	rx_recovery();
 }
 
-static int tx_start(void)
+static bool uart_is_active(void)
 {
-	uint8_t *buf;
-	size_t ret;
-	int err;
 	enum pm_device_state state = PM_DEVICE_STATE_OFF;
 
 	(void)pm_device_state_get(uart_dev, &state);
-	if (state != PM_DEVICE_STATE_ACTIVE) {
+
+	return state == PM_DEVICE_STATE_ACTIVE;
+}
+
+/* Release the callers of the referenced data that cannot be sent. */
+static void tx_refs_drop(void)
+{
+	size_t dropped;
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+	dropped = slm_uart_tx_queue_ref_drop(&tx_queue);
+	k_spin_unlock(&tx_lock, key);
+
+	if (dropped) {
+		LOG_ERR("UART TX stopped, %d referenced bytes dropped", dropped);
+	}
+}
+
+static int tx_start(void)
+{
+	const uint8_t *buf;
+	size_t len;
+	int err;
+	k_spinlock_key_t key;
+
+	if (!uart_is_active()) {
 		(void)indicate_start();
+		tx_refs_drop();
 		return -ENODEV;
 	}
+	if (atomic_get(&tx_stopped)) {
+		tx_refs_drop();
+		return -ENODEV;
+	}
+
+	key = k_spin_lock(&tx_lock);
+	len = slm_uart_tx_queue_claim(&tx_queue, &buf);
+	k_spin_unlock(&tx_lock, key);
 
-	ret = ring_buf_get_claim(&tx_buf, &buf, ring_buf_capacity_get(&tx_buf));
-	err = uart_tx(uart_dev, buf, ret, SYS_FOREVER_US);
+	if (len == 0) {
+		/* Everything was sent already. */
+		k_sem_give(&tx_done_sem);
+		return 0;
+	}
+
+	err = uart_tx(uart_dev, buf, len, SYS_FOREVER_US);
 	if (err) {
 		LOG_ERR("UART TX error: %d", err);
-		(void)ring_buf_get_finish(&tx_buf, 0);
+		key = k_spin_lock(&tx_lock);
+		slm_uart_tx_queue_finish(&tx_queue, 0);
+		k_spin_unlock(&tx_lock, key);
+		tx_refs_drop();
 		return err;
 	}
 
 	return 0;
 }
 
+/* Release the sent data. Returns whether there is more data to send. */
+static bool tx_finish(size_t len)
+{
+	bool empty;
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+	slm_uart_tx_queue_finish(&tx_queue, len);
+	empty = slm_uart_tx_queue_is_empty(&tx_queue);
+
+	k_spin_unlock(&tx_lock, key);
+
+	return !empty;
+}
+
 static void uart_callback(const struct device *dev, struct uart_event *evt, void *user_data)
 {
 	struct rx_buf_t *buf;
@@ -223,24 +277,9 @@ static void uart_callback(const struct device *dev, struct uart_event *evt, void
 
 	switch (evt->type) {
 	case UART_TX_DONE:
-		err = ring_buf_get_finish(&tx_buf, evt->data.tx.len);
-		if (err) {
-			LOG_ERR("UART_TX_DONE failure: %d", err);
-		}
-		if (ring_buf_is_empty(&tx_buf) == false) {
-			(void)tx_start();
-		} else {
-			k_sem_give(&tx_done_sem);
-		}
-		break;
 	case UART_TX_ABORTED:
-		err = ring_buf_get_finish(&tx_buf, evt->data.tx.len);
-		if (err) {
-			LOG_ERR("UART_TX_ABORTED failure: %d", err);
-		}
-		if (ring_buf_is_empty(&tx_buf) == false) {
-			(void)tx_start();
-		} else {
+		if (!tx_finish(evt->data.tx.len) || tx_start()) {
+			/* Sent everything, or the rest cannot be sent now. */
 			k_sem_give(&tx_done_sem);
 		}
 		break;
@@ -291,6 +330,28 @@ static void uart_callback(const struct device *dev, struct uart_event *evt, void
 	}
 }
 
+/* Start sending the queued data unless the TX is already in progress. */
+static int tx_kick(void)
+{
+	int err;
+
+	if (k_sem_take(&tx_done_sem, K_NO_WAIT) == 0) {
+		err = tx_start();
+		if (err == -ENODEV) {
+			k_sem_give(&tx_done_sem);
+			return 0;
+		} else if (err) {
+			LOG_ERR("TX start failed: %d", err);
+			k_sem_give(&tx_done_sem);
+			return err;
+		}
+	} else {
+		/* TX already in progress. */
+	}
+
+	return 0;
+}
+
 int slm_uart_power_on(void)
 {
 	int err;
@@ -309,21 +370,45 @@ int slm_uart_power_on(void)
 		return err;
 	}
 
-	k_sem_give(&tx_done_sem);
-	(void)tx_start();
+	/* Send the data queued while powered off. */
+	(void)atomic_set(&tx_stopped, false);
+	(void)tx_kick();
 
 	return 0;
 }
 
+/* Wait until the TX is idle, so that the UART can be suspended. Must be called with
+ * mutex_tx_put locked, and leaves the TX stopped.
+ */
+static void tx_stop(void)
+{
+	/* Let the queued data be sent first. */
+	if (k_sem_take(&tx_done_sem, K_MSEC(UART_TX_DRAIN_TIMEOUT_MS)) == 0) {
+		(void)atomic_set(&tx_stopped, true);
+		return;
+	}
+
+	/* The host does not read. Abort the transfer, the referenced data is dropped. */
+	LOG_WRN("UART TX not drained, aborting");
+	(void)atomic_set(&tx_stopped, true);
+	(void)uart_tx_abort(uart_dev);
+	k_sem_take(&tx_done_sem, K_FOREVER);
+}
+
 int slm_uart_power_off(void)
 {
 	int err;
 
+	k_mutex_lock(&mutex_tx_put, K_FOREVER);
+	tx_stop();
 	rx_disable();
 	err = pm_device_action_run(uart_dev, PM_DEVICE_ACTION_SUSPEND);
 	if (err && err != -EALREADY) {
 		LOG_ERR("Can't suspend UART: %d", err);
+		(void)atomic_set(&tx_stopped, false);
 	}
+	k_sem_give(&tx_done_sem);
+	k_mutex_unlock(&mutex_tx_put);
 
 	/* Write sync str to buffer, so it is send first when we power UART.*/
 	(void)slm_uart_tx_write(SLM_SYNC_STR, sizeof(SLM_SYNC_STR)-1, true);
@@ -340,49 +425,100 @@ bool slm_uart_can_context_send(const uint8_t *data, size_t len)
 	return false;
 }
 
-/* Write the data to tx_buffer and trigger sending. */
-int slm_uart_tx_write(const uint8_t *data, size_t len, bool print_full_debug)
+/* Wait until the TX is idle and send the queued data to make space in the queue. */
+static int tx_flush(size_t pending)
+{
+	int err;
+
+	k_sem_take(&tx_done_sem, K_FOREVER);
+	err = tx_start();
+	if (err) {
+		LOG_ERR("TX buf overflow, %d dropped. Unable to send: %d", pending, err);
+		k_sem_give(&tx_done_sem);
+	}
+
+	return err;
+}
+
+/* Copy the data to the TX queue. Must be called with mutex_tx_put locked. */
+static int tx_put_copy(const uint8_t *data, size_t len)
 {
 	size_t ret;
 	size_t sent = 0;
 	int err;
+	k_spinlock_key_t key;
 
-	if (!slm_uart_can_context_send(data, len)) {
-		return -EINTR;
-	}
-	k_mutex_lock(&mutex_tx_put, K_FOREVER);
 	while (sent < len) {
-		ret = ring_buf_put(&tx_buf, data + sent, len - sent);
+		key = k_spin_lock(&tx_lock);
+		ret = slm_uart_tx_queue_copy(&tx_queue, data + sent, len - sent);
+		k_spin_unlock(&tx_lock, key);
+
 		if (ret) {
 			sent += ret;
 		} else {
 			/* Buffer full, block and start TX. */
-			k_sem_take(&tx_done_sem, K_FOREVER);
-			err = tx_start();
+			err = tx_flush(len - sent);
 			if (err) {
-				LOG_ERR("TX buf overflow, %d dropped. Unable to send: %d",
-					len - sent,
-					err);
-				k_sem_give(&tx_done_sem);
-				k_mutex_unlock(&mutex_tx_put);
 				return err;
 			}
 		}
 	}
-	k_mutex_unlock(&mutex_tx_put);
 
-	if (k_sem_take(&tx_done_sem, K_NO_WAIT) == 0) {
-		err = tx_start();
-		if (err == -ENODEV) {
-			k_sem_give(&tx_done_sem);
-			return 0;
-		} else if (err) {
-			LOG_ERR("TX start failed: %d", err);
-			k_sem_give(&tx_done_sem);
+	return 0;
+}
+
+/* Queue a reference to the data. Must be called with mutex_tx_put locked. */
+static int tx_put_ref(const uint8_t *data, size_t len, slm_uart_tx_done_cb_t cb, void *user_data)
+{
+	int err;
+	k_spinlock_key_t key;
+
+	/* While the UART is powered off, the data could wait in the queue for a long time.
+	 * Copy it, so that the caller buffer is not held.
+	 */
+	if (!uart_is_active()) {
+		err = tx_put_copy(data, len);
+		if (!err && cb) {
+			cb(user_data, 0);
+		}
+		return err;
+	}
+
+	while (true) {
+		key = k_spin_lock(&tx_lock);
+		err = slm_uart_tx_queue_ref(&tx_queue, data, len, cb, user_data);
+		k_spin_unlock(&tx_lock, key);
+
+		if (err != -ENOMEM) {
 			return err;
 		}
-	} else {
-		/* TX already in progress. */
+
+		/* No free fragment, block and start TX. */
+		err = tx_flush(len);
+		if (err) {
+			return err;
+		}
+	}
+}
+
+/* Write the data to tx_buffer and trigger sending. */
+int slm_uart_tx_write(const uint8_t *data, size_t len, bool print_full_debug)
+{
+	int err;
+
+	if (!slm_uart_can_context_send(data, len)) {
+		return -EINTR;
+	}
+	k_mutex_lock(&mutex_tx_put, K_FOREVER);
+	err = tx_put_copy(data, len);
+	k_mutex_unlock(&mutex_tx_put);
+	if (err) {
+		return err;
+	}
+
+	err = tx_kick();
+	if (err) {
+		return err;
 	}
 
 	LOG_HEXDUMP_DBG(data, print_full_debug ? len : MIN(HEXDUMP_LIMIT, len), "TX");
@@ -390,6 +526,112 @@ int slm_uart_tx_write(const uint8_t *data, size_t len, bool print_full_debug)
 	return 0;
 }
 
+int slm_uart_tx_write_ref(const uint8_t *data, size_t len, slm_uart_tx_done_cb_t cb,
+			  void *user_data)
+{
+	int err;
+
+	if (!slm_uart_can_context_send(data, len)) {
+		return -EINTR;
+	}
+	k_mutex_lock(&mutex_tx_put, K_FOREVER);
+	err = tx_put_ref(data, len, cb, user_data);
+	if (!err) {
+		/* Once queued, a TX start failure is reported through the callback. */
+		(void)tx_kick();
+	}
+	k_mutex_unlock(&mutex_tx_put);
+	if (err) {
+		return err;
+	}
+
+	LOG_HEXDUMP_DBG(data, MIN(HEXDUMP_LIMIT, len), "TX");
+
+	return 0;
+}
+
+int slm_uart_tx_writev_ref(const struct slm_uart_tx_frag *frags, size_t count,
+			   slm_uart_tx_done_cb_t cb, void *user_data)
+{
+	size_t last_ref = count;
+	int err = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!slm_uart_can_context_send(frags[i].data, frags[i].len)) {
+			return -EINTR;
+		}
+		if (frags[i].ref && frags[i].len) {
+			last_ref = i;
+		}
+	}
+
+	k_mutex_lock(&mutex_tx_put, K_FOREVER);
+	for (size_t i = 0; i < count && !err; i++) {
+		if (frags[i].len == 0) {
+			continue;
+		}
+
+		/* The queue releases the fragments in order, so the last one reports for all.
+		 * If a write fails, the referenced fragments queued before it were dropped.
+		 */
+		if (i == last_ref) {
+			err = tx_put_ref(frags[i].data, frags[i].len, cb, user_data);
+		} else if (frags[i].ref) {
+			err = tx_put_ref(frags[i].data, frags[i].len, NULL, NULL);
+		} else {
+			err = tx_put_copy(frags[i].data, frags[i].len);
+		}
+
+		LOG_HEXDUMP_DBG(frags[i].data, MIN(HEXDUMP_LIMIT, frags[i].len), "TX");
+	}
+
+	if (!err) {
+		/* Once queued, a TX start failure is reported through the callback. */
+		(void)tx_kick();
+	}
+	k_mutex_unlock(&mutex_tx_put);
+	if (err) {
+		return err;
+	}
+
+	if (last_ref == count && cb) {
+		/* Everything was copied. */
+		cb(user_data, 0);
+	}
+
+	return 0;
+}
+
+struct tx_writev_ctx {
+	struct k_sem done;
+	int err;
+};
+
+static void tx_writev_done(void *user_data, int err)
+{
+	struct tx_writev_ctx *ctx = user_data;
+
+	ctx->err = err;
+	k_sem_give(&ctx->done);
+}
+
+int slm_uart_tx_writev(const struct slm_uart_tx_frag *frags, size_t count)
+{
+	struct tx_writev_ctx ctx = { .err = 0 };
+	int err;
+
+	k_sem_init(&ctx.done, 0, 1);
+
+	err = slm_uart_tx_writev_ref(frags, count, tx_writev_done, &ctx);
+	if (err) {
+		return err;
+	}
+
+	k_sem_take(&ctx.done, K_FOREVER);
+
+	return ctx.err;
+}
+
 int slm_uart_handler_init(slm_uart_rx_callback_t callback_t)
 {
 	int err;
@@ -439,6 +681,7 @@ int slm_uart_handler_init(slm_uart_rx_callback_t callback_t)
 
 	k_work_init_delayable(&rx_process_work, rx_process);
 
+	slm_uart_tx_queue_init(&tx_queue);
 	k_sem_give(&tx_done_sem);
 
 	err = slm_uart_tx_write(SLM_SYNC_STR, sizeof(SLM_SYNC_STR)-1, true);
@@ -454,6 +697,9 @@ void slm_uart_handler_uninit(void)
 	int err;
 
 	/* Power off UART module */
+	k_mutex_lock(&mutex_tx_put, K_FOREVER);
+	tx_stop();
+	k_mutex_unlock(&mutex_tx_put);
 	rx_disable();
 	err = pm_device_action_run(uart_dev, PM_DEVICE_ACTION_SUSPEND);
 	if (err) {
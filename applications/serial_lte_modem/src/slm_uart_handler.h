@@ -7,6 +7,8 @@
 #ifndef SLM_UART_HANDLER_
 #define SLM_UART_HANDLER_
 
+#include "slm_uart_tx_queue.h"
+
 /**@file slm_uart_handler.h
  *
  * @brief UART handler for serial LTE modem
@@ -56,6 +58,74 @@ bool slm_uart_can_context_send(const uint8_t *data, size_t len);
  */
 int slm_uart_tx_write(const uint8_t *data, size_t len, bool print_full_debug);
 
+/**
+ * @brief Queue a reference to the data and trigger sending.
+ *
+ * The data is sent in place, without copying it to the TX buffer.
+ *
+ * @param data Data to send. Must stay valid until @p cb is called.
+ * @param len Length of data
+ * @param cb Completion callback, called from the UART callback once the data is sent.
+ *           Called before returning if the UART is powered off, in which case the
+ *           data is copied. If the UART fails to send the data, or the UART is powered
+ *           off before the data is sent, the data is dropped and @p cb gets -ECANCELED.
+ * @param user_data User data passed to @p cb.
+ *
+ * @retval 0 If the data was successfully queued. @p cb is called.
+ *           Otherwise, a (negative) error code is returned and @p cb is not called.
+ */
+int slm_uart_tx_write_ref(const uint8_t *data, size_t len, slm_uart_tx_done_cb_t cb,
+			  void *user_data);
+
+/**@brief TX fragment. */
+struct slm_uart_tx_frag {
+	/** Fragment data. */
+	const uint8_t *data;
+	/** Length of fragment data. */
+	size_t len;
+	/** Send the data in place instead of copying it to the TX buffer. */
+	bool ref;
+};
+
+/**
+ * @brief Write a list of fragments and trigger sending.
+ *
+ * The fragments are sent in order, without data of other writes in between.
+ * Returns once the referenced fragments have been sent, so that their buffers
+ * can be reused. The caller is blocked for the UART transfer time of the referenced
+ * fragments, and cannot prepare its next data meanwhile.
+ *
+ * @param frags Fragments.
+ * @param count Number of fragments.
+ *
+ * @retval 0 If the fragments were successfully written.
+ *           Otherwise, a (negative) error code is returned. -ECANCELED means that
+ *           referenced fragments were dropped, because the UART failed or was
+ *           powered off before sending them.
+ */
+int slm_uart_tx_writev(const struct slm_uart_tx_frag *frags, size_t count);
+
+/**
+ * @brief Write a list of fragments and trigger sending, without waiting for the
+ *        referenced fragments to be sent.
+ *
+ * The fragments are sent in order, without data of other writes in between.
+ * The copied fragments can be reused when the function returns.
+ *
+ * @param frags Fragments.
+ * @param count Number of fragments.
+ * @param cb Completion callback, called once all referenced fragments have been sent,
+ *           like for @ref slm_uart_tx_write_ref. Called before returning if no fragment
+ *           is referenced.
+ * @param user_data User data passed to @p cb.
+ *
+ * @retval 0 If the fragments were successfully queued. @p cb is called.
+ *           Otherwise, a (negative) error code is returned, @p cb is not called and
+ *           none of the fragments is referenced any more.
+ */
+int slm_uart_tx_writev_ref(const struct slm_uart_tx_frag *frags, size_t count,
+			   slm_uart_tx_done_cb_t cb, void *user_data);
+
 /**
  * @brief Initialize SLM UART handler for serial LTE modem
  *
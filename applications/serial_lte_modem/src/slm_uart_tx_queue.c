@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "slm_uart_tx_queue.h"
+
+static struct slm_uart_tx_seg *seg_at(struct slm_uart_tx_queue *q, size_t pos)
+{
+	return &q->segs[(q->head + pos) % CONFIG_SLM_UART_TX_FRAG_COUNT];
+}
+
+static struct slm_uart_tx_seg *seg_append(struct slm_uart_tx_queue *q)
+{
+	struct slm_uart_tx_seg *seg;
+
+	if (q->count == CONFIG_SLM_UART_TX_FRAG_COUNT) {
+		return NULL;
+	}
+
+	seg = seg_at(q, q->count);
+	memset(seg, 0, sizeof(*seg));
+	q->count++;
+
+	return seg;
+}
+
+void slm_uart_tx_queue_init(struct slm_uart_tx_queue *q)
+{
+	ring_buf_init(&q->ring, sizeof(q->ring_data), q->ring_data);
+	q->head = 0;
+	q->count = 0;
+	q->claimed = 0;
+	q->bytes_copied = 0;
+	q->bytes_ref = 0;
+}
+
+size_t slm_uart_tx_queue_copy(struct slm_uart_tx_queue *q, const uint8_t *data, size_t len)
+{
+	struct slm_uart_tx_seg *seg = NULL;
+
+	/* Consecutive copies share a segment. */
+	if (q->count > 0) {
+		seg = seg_at(q, q->count - 1);
+		if (seg->data) {
+			seg = NULL;
+		}
+	}
+
+	if (!seg && ring_buf_space_get(&q->ring) > 0) {
+		seg = seg_append(q);
+	}
+
+	if (!seg) {
+		return 0;
+	}
+
+	len = ring_buf_put(&q->ring, data, len);
+	seg->len += len;
+	q->bytes_copied += len;
+
+	return len;
+}
+
+int slm_uart_tx_queue_ref(struct slm_uart_tx_queue *q, const uint8_t *data, size_t len,
+			  slm_uart_tx_done_cb_t cb, void *user_data)
+{
+	struct slm_uart_tx_seg *seg;
+
+	if (len == 0) {
+		return -EINVAL;
+	}
+
+	seg = seg_append(q);
+	if (!seg) {
+		return -ENOMEM;
+	}
+
+	seg->data = data;
+	seg->len = len;
+	seg->cb = cb;
+	seg->user_data = user_data;
+	q->bytes_ref += len;
+
+	return 0;
+}
+
+size_t slm_uart_tx_queue_claim(struct slm_uart_tx_queue *q, const uint8_t **buf)
+{
+	struct slm_uart_tx_seg *seg;
+
+	if ((q->count == 0) || (q->claimed > 0)) {
+		return 0;
+	}
+
+	seg = seg_at(q, 0);
+	if (seg->data) {
+		*buf = seg->data;
+		q->claimed = seg->len;
+	} else {
+		q->claimed = ring_buf_get_claim(&q->ring, (uint8_t **)buf, seg->len);
+	}
+
+	return q->claimed;
+}
+
+void slm_uart_tx_queue_finish(struct slm_uart_tx_queue *q, size_t len)
+{
+	struct slm_uart_tx_seg *seg;
+	slm_uart_tx_done_cb_t cb;
+	void *user_data;
+
+	if (q->count == 0) {
+		return;
+	}
+
+	seg = seg_at(q, 0);
+	if (seg->data) {
+		seg->data += len;
+	} else {
+		(void)ring_buf_get_finish(&q->ring, len);
+	}
+
+	seg->len -= len;
+	q->claimed = 0;
+
+	if (seg->len > 0) {
+		return;
+	}
+
+	cb = seg->cb;
+	user_data = seg->user_data;
+
+	q->head = (q->head + 1) % CONFIG_SLM_UART_TX_FRAG_COUNT;
+	q->count--;
+
+	if (cb) {
+		cb(user_data, 0);
+	}
+}
+
+size_t slm_uart_tx_queue_ref_drop(struct slm_uart_tx_queue *q)
+{
+	struct slm_uart_tx_seg *seg;
+	size_t kept = 0;
+	size_t dropped = 0;
+
+	for (size_t pos = 0; pos < q->count; pos++) {
+		seg = seg_at(q, pos);
+
+		/* The claimed buffer is in use by the UART until it is finished. */
+		if (seg->data && !(pos == 0 && q->claimed > 0)) {
+			dropped += seg->len;
+			if (seg->cb) {
+				seg->cb(seg->user_data, -ECANCELED);
+			}
+			continue;
+		}
+
+		if (kept != pos) {
+			*seg_at(q, kept) = *seg;
+		}
+		kept++;
+	}
+
+	q->count = kept;
+	q->bytes_ref -= dropped;
+
+	return dropped;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef SLM_UART_TX_QUEUE_
+#define SLM_UART_TX_QUEUE_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/ring_buffer.h>
+
+/**@file slm_uart_tx_queue.h
+ *
+ * @brief UART TX queue for serial LTE modem
+ *
+ * The queue holds an ordered list of segments. A segment either holds data copied
+ * to the queue ring buffer, or references a caller buffer that is sent in place.
+ * Referenced buffers must stay valid until their completion callback is called.
+ *
+ * The queue does no locking, the user is responsible for serializing the access.
+ * @{
+ */
+
+/**@brief TX completion callback type.
+ *
+ * Called from the context that releases the sent data, typically the UART callback.
+ *
+ * @param user_data User data given when the buffer was queued.
+ * @param err 0 if the buffer was sent, -ECANCELED if it was dropped.
+ */
+typedef void (*slm_uart_tx_done_cb_t)(void *user_data, int err);
+
+/**@brief Queue segment. */
+struct slm_uart_tx_seg {
+	/** Referenced data, or NULL for data copied to the ring buffer. */
+	const uint8_t *data;
+	/** Number of bytes left to send. */
+	size_t len;
+	slm_uart_tx_done_cb_t cb;
+	void *user_data;
+};
+
+/**@brief TX queue. */
+struct slm_uart_tx_queue {
+	struct ring_buf ring;
+	uint8_t ring_data[CONFIG_SLM_UART_TX_BUF_SIZE];
+	struct slm_uart_tx_seg segs[CONFIG_SLM_UART_TX_FRAG_COUNT];
+	size_t head;
+	size_t count;
+	/** Number of bytes of the first segment handed to the UART. */
+	size_t claimed;
+	/** Number of bytes copied to the ring buffer. */
+	uint32_t bytes_copied;
+	/** Number of bytes sent in place. */
+	uint32_t bytes_ref;
+};
+
+/**
+ * @brief Initialize the queue.
+ *
+ * @param q Queue.
+ */
+void slm_uart_tx_queue_init(struct slm_uart_tx_queue *q);
+
+/**
+ * @brief Copy data to the end of the queue.
+ *
+ * @param q Queue.
+ * @param data Data to copy.
+ * @param len Length of data.
+ *
+ * @return Number of bytes copied, 0 if the queue is full.
+ */
+size_t slm_uart_tx_queue_copy(struct slm_uart_tx_queue *q, const uint8_t *data, size_t len);
+
+/**
+ * @brief Append a reference to a caller buffer to the end of the queue.
+ *
+ * @param q Queue.
+ * @param data Data to send. Must stay valid until @p cb is called.
+ * @param len Length of data.
+ * @param cb Completion callback, or NULL.
+ * @param user_data User data passed to @p cb.
+ *
+ * @retval 0 If the buffer was queued.
+ * @retval -EINVAL If @p len is 0.
+ * @retval -ENOMEM If there is no free segment.
+ */
+int slm_uart_tx_queue_ref(struct slm_uart_tx_queue *q, const uint8_t *data, size_t len,
+			  slm_uart_tx_done_cb_t cb, void *user_data);
+
+/**
+ * @brief Get the next contiguous block of data to send.
+ *
+ * The block stays claimed until slm_uart_tx_queue_finish() is called.
+ *
+ * @param q Queue.
+ * @param buf Start of the block.
+ *
+ * @return Length of the block, 0 if the queue is empty or a block is already claimed.
+ */
+size_t slm_uart_tx_queue_claim(struct slm_uart_tx_queue *q, const uint8_t **buf);
+
+/**
+ * @brief Release the sent part of the claimed block.
+ *
+ * The completion callbacks of fully sent buffers are called. Data that was claimed
+ * but not sent is returned by the next claim.
+ *
+ * @param q Queue.
+ * @param len Number of bytes sent.
+ */
+void slm_uart_tx_queue_finish(struct slm_uart_tx_queue *q, size_t len);
+
+/**
+ * @brief Drop the referenced buffers that are not claimed.
+ *
+ * Used when the data cannot be sent, so that the callers of the dropped buffers
+ * are not left waiting. Their completion callbacks are called with -ECANCELED.
+ * Copied data stays in the queue.
+ *
+ * @param q Queue.
+ *
+ * @return Number of bytes dropped.
+ */
+size_t slm_uart_tx_queue_ref_drop(struct slm_uart_tx_queue *q);
+
+/** @return Whether the queue is empty. */
+static inline bool slm_uart_tx_queue_is_empty(const struct slm_uart_tx_queue *q)
+{
+	return q->count == 0;
+}
+/** @} */
+
+#endif /* SLM_UART_TX_QUEUE_ */
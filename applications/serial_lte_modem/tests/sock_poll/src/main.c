@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "slm_sock_poll.h"
+
+#define FAKE_SOCK_COUNT 4
+#define FAKE_SOCK_BASE 10
+#define FAKE_SOCK_BUF_SIZE 2048
+#define FAKE_DGRAM_MAX 8
+#define REPORT_MAX 64
+
+/* Socket stand-in: the peer side writes to the receive queue of a socket. */
+static struct fake_sock {
+	bool dgram;
+	bool closed;
+	uint8_t data[FAKE_SOCK_BUF_SIZE];
+	size_t len;
+	size_t dgram_len[FAKE_DGRAM_MAX];
+	size_t dgram_count;
+} fake_socks[FAKE_SOCK_COUNT];
+
+static int poll_count;
+static int recv_count;
+
+static struct report {
+	int handle;
+	size_t len;
+	short revents;
+} reports[REPORT_MAX];
+static int report_count;
+static bool notify_refused;
+
+static struct slm_sock_poll engine;
+
+static uint8_t payload[FAKE_SOCK_BUF_SIZE];
+static uint8_t buf[FAKE_SOCK_BUF_SIZE];
+
+static struct fake_sock *fake_sock_get(int fd)
+{
+	if (fd < FAKE_SOCK_BASE || fd >= FAKE_SOCK_BASE + FAKE_SOCK_COUNT) {
+		return NULL;
+	}
+
+	return &fake_socks[fd - FAKE_SOCK_BASE];
+}
+
+static void peer_send(int fd, const uint8_t *data, size_t len)
+{
+	struct fake_sock *s = fake_sock_get(fd);
+
+	zassert_true(s->len + len <= sizeof(s->data), "Socket buffer overflow");
+
+	memcpy(&s->data[s->len], data, len);
+	s->len += len;
+
+	if (s->dgram) {
+		zassert_true(s->dgram_count < FAKE_DGRAM_MAX, "Too many datagrams");
+		s->dgram_len[s->dgram_count++] = len;
+	}
+}
+
+static int fake_poll(struct pollfd *fds, int nfds, int timeout)
+{
+	int count = 0;
+
+	ARG_UNUSED(timeout);
+
+	poll_count++;
+
+	for (int i = 0; i < nfds; i++) {
+		struct fake_sock *s = fake_sock_get(fds[i].fd);
+
+		fds[i].revents = 0;
+		if (fds[i].fd < 0) {
+			continue;
+		}
+
+		if (!s) {
+			fds[i].revents = POLLNVAL;
+		} else {
+			if (s->len > 0 && (fds[i].events & POLLIN)) {
+				fds[i].revents |= POLLIN;
+			}
+			if (s->closed) {
+				fds[i].revents |= POLLHUP;
+			}
+		}
+
+		if (fds[i].revents) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static ssize_t fake_recv(int fd, void *out, size_t len, int flags)
+{
+	struct fake_sock *s = fake_sock_get(fd);
+	size_t avail;
+	size_t consumed;
+
+	recv_count++;
+
+	if (!s) {
+		errno = EBADF;
+		return -1;
+	}
+
+	if (s->len == 0) {
+		if (s->closed) {
+			return 0;
+		}
+		errno = EAGAIN;
+		return -1;
+	}
+
+	avail = s->dgram ? s->dgram_len[0] : s->len;
+	len = MIN(len, avail);
+	memcpy(out, s->data, len);
+
+	if (flags & MSG_PEEK) {
+		return len;
+	}
+
+	/* The rest of a truncated datagram is dropped. */
+	consumed = s->dgram ? avail : len;
+	memmove(s->data, &s->data[consumed], s->len - consumed);
+	s->len -= consumed;
+
+	if (s->dgram) {
+		memmove(s->dgram_len, &s->dgram_len[1], --s->dgram_count * sizeof(size_t));
+	}
+
+	return len;
+}
+
+static bool fake_notify(int handle, size_t len, short revents)
+{
+	if (notify_refused) {
+		return false;
+	}
+
+	zassert_true(report_count < REPORT_MAX, "Too many reports");
+
+	reports[report_count].handle = handle;
+	reports[report_count].len = len;
+	reports[report_count].revents = revents;
+	report_count++;
+
+	return true;
+}
+
+static const struct slm_sock_poll_ops fake_ops = {
+	.poll = fake_poll,
+	.recv = fake_recv,
+	.notify = fake_notify,
+};
+
+/* Open a socket in slot @p slot. Handles differ from descriptors, like for servers. */
+static int sock_open(int slot, bool dgram)
+{
+	int fd = FAKE_SOCK_BASE + slot;
+
+	fake_socks[slot].dgram = dgram;
+	slm_sock_poll_update(&engine, slot, slot, fd, !dgram);
+
+	return fd;
+}
+
+/* One round of the engine thread. */
+static int engine_run(void)
+{
+	int count = slm_sock_poll_prepare(&engine);
+
+	slm_sock_poll_wait(&engine, 0);
+	slm_sock_poll_handle(&engine);
+
+	return count;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(fake_socks, 0, sizeof(fake_socks));
+	memset(reports, 0, sizeof(reports));
+	report_count = 0;
+	notify_refused = false;
+	poll_count = 0;
+	recv_count = 0;
+
+	for (size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = i * 7;
+	}
+
+	slm_sock_poll_init(&engine, &fake_ops, false);
+}
+
+ZTEST(slm_sock_poll, test_notify_once)
+{
+	int fd0 = sock_open(0, false);
+	int fd2 = sock_open(2, true);
+
+	zassert_equal(engine_run(), 2, "Sockets not polled");
+	zassert_equal(report_count, 0, "Report without data");
+
+	peer_send(fd0, payload, 100);
+	peer_send(fd2, payload, 30);
+	peer_send(fd2, payload, 40);
+	engine_run();
+
+	zassert_equal(report_count, 2, "Invalid report count");
+	zassert_equal(reports[0].handle, 0, "Invalid handle");
+	zassert_equal(reports[0].len, 100, "Invalid stream size");
+	zassert_equal(reports[0].revents, POLLIN, "Invalid events");
+	zassert_equal(reports[1].handle, 2, "Invalid handle");
+	zassert_equal(reports[1].len, 30, "Size is not the next datagram");
+
+	/* Reported sockets are not polled until they are read. */
+	peer_send(fd0, payload, 10);
+	zassert_equal(engine_run(), 0, "Reported sockets polled");
+	zassert_equal(report_count, 2, "Reported twice");
+
+	/* The data stays in the socket in notify-only mode. */
+	zassert_equal(slm_sock_poll_read(&engine, 2, buf, sizeof(buf)), 30, "Invalid read");
+	engine_run();
+	zassert_equal(report_count, 3, "Remaining datagram not reported");
+	zassert_equal(reports[2].handle, 2, "Invalid handle");
+	zassert_equal(reports[2].len, 40, "Invalid size");
+
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), 110, "Invalid read");
+	zassert_mem_equal(buf, payload, 100, "Invalid data");
+	engine_run();
+	zassert_equal(report_count, 3, "Report without data");
+}
+
+ZTEST(slm_sock_poll, test_notify_size)
+{
+	int fd = sock_open(0, false);
+
+	/* The size reported is what one read returns. */
+	peer_send(fd, payload, CONFIG_SLM_SOCKET_RX_MAX + 100);
+	engine_run();
+
+	zassert_equal(report_count, 1, "Invalid report count");
+	zassert_equal(reports[0].len, CONFIG_SLM_SOCKET_RX_MAX, "Invalid size");
+	zassert_equal(fake_socks[0].len, CONFIG_SLM_SOCKET_RX_MAX + 100, "Data consumed");
+}
+
+ZTEST(slm_sock_poll, test_direct_read_rearm)
+{
+	int fd = sock_open(0, false);
+
+	peer_send(fd, payload, 20);
+	engine_run();
+	zassert_equal(report_count, 1, "Invalid report count");
+
+	/* The host read the socket with #XRECV. */
+	zassert_equal(fake_recv(fd, buf, 20, 0), 20, "Invalid read");
+	slm_sock_poll_rearm(&engine, 0);
+
+	engine_run();
+	zassert_equal(report_count, 1, "Report without data");
+
+	peer_send(fd, payload, 5);
+	engine_run();
+	zassert_equal(report_count, 2, "New data not reported");
+	zassert_equal(reports[1].len, 5, "Invalid size");
+
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), 5, "Invalid read");
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), -EAGAIN,
+		      "Read without data");
+	zassert_equal(slm_sock_poll_read(&engine, 3, buf, sizeof(buf)), -ENOENT,
+		      "Read of unknown socket");
+}
+
+ZTEST(slm_sock_poll, test_auto_recv)
+{
+	int fd0;
+	int fd1;
+
+	slm_sock_poll_init(&engine, &fake_ops, true);
+	fd0 = sock_open(0, false);
+	fd1 = sock_open(1, true);
+
+	zassert_true(slm_sock_poll_is_buffered(&engine, 0), "Stream socket not buffered");
+	zassert_false(slm_sock_poll_is_buffered(&engine, 1), "Datagram socket buffered");
+
+	peer_send(fd0, payload, 50);
+	peer_send(fd1, payload, 60);
+	engine_run();
+
+	zassert_equal(report_count, 2, "Invalid report count");
+	zassert_equal(reports[0].len, 50, "Invalid buffered size");
+	zassert_equal(fake_socks[0].len, 0, "Stream data not received");
+	zassert_equal(fake_socks[1].len, 60, "Datagram received");
+
+	/* Data that arrives after the report is buffered as well. */
+	peer_send(fd0, &payload[50], 70);
+	engine_run();
+	zassert_equal(report_count, 2, "Reported twice");
+	zassert_equal(engine.bytes_buffered, 120, "Invalid buffered count");
+
+	recv_count = 0;
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, 100), 100, "Invalid read");
+	zassert_equal(recv_count, 0, "Socket read directly");
+	engine_run();
+	zassert_equal(report_count, 3, "Remaining data not reported");
+	zassert_equal(reports[2].len, 20, "Invalid remaining size");
+
+	zassert_equal(slm_sock_poll_read(&engine, 0, &buf[100], 100), 20, "Invalid read");
+	zassert_mem_equal(buf, payload, 120, "Invalid data");
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), -EAGAIN,
+		      "Read from empty buffer");
+}
+
+ZTEST(slm_sock_poll, test_auto_recv_full)
+{
+	size_t total = 0;
+	int fd;
+
+	slm_sock_poll_init(&engine, &fake_ops, true);
+	fd = sock_open(0, false);
+
+	peer_send(fd, payload, sizeof(payload));
+
+	/* The socket is left out of the poll set while its buffer is full. */
+	while (ring_buf_space_get(&engine.entries[0].ring) > 0) {
+		zassert_equal(engine_run(), 1, "Socket not polled");
+	}
+	zassert_equal(engine_run(), 0, "Full socket polled");
+	zassert_equal(report_count, 1, "Invalid report count");
+	zassert_equal(reports[0].len, ring_buf_capacity_get(&engine.entries[0].ring),
+		      "Invalid size");
+
+	/* Reads make room, the data comes out in order across the ring buffer end. */
+	while (total < sizeof(payload)) {
+		int ret = slm_sock_poll_read(&engine, 0, &buf[total], 100);
+
+		if (ret > 0) {
+			total += ret;
+		}
+		engine_run();
+	}
+
+	zassert_mem_equal(buf, payload, sizeof(payload), "Invalid data");
+}
+
+ZTEST(slm_sock_poll, test_auto_recv_hangup)
+{
+	int fd;
+
+	slm_sock_poll_init(&engine, &fake_ops, true);
+	fd = sock_open(0, false);
+
+	peer_send(fd, payload, 30);
+	fake_socks[0].closed = true;
+	engine_run();
+
+	/* The data is reported before the shutdown. */
+	zassert_equal(report_count, 1, "Invalid report count");
+	zassert_equal(reports[0].revents, POLLIN, "Shutdown reported with data left");
+
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), 30, "Invalid read");
+	engine_run();
+	zassert_equal(report_count, 2, "Shutdown not reported");
+	zassert_equal(reports[1].len, 0, "Invalid size");
+	zassert_equal(reports[1].revents, POLLHUP, "Invalid events");
+
+	/* Closed sockets are not polled, reads report the end of the data. */
+	zassert_equal(engine_run(), 0, "Closed socket polled");
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), 0, "Invalid read");
+}
+
+ZTEST(slm_sock_poll, test_refused)
+{
+	int fd = sock_open(0, false);
+
+	/* No reports are sent in data mode. */
+	notify_refused = true;
+	peer_send(fd, payload, 10);
+	engine_run();
+	zassert_equal(report_count, 0, "Refused report counted");
+
+	/* Pending reports are retried without polling the socket. */
+	zassert_equal(engine_run(), 0, "Socket polled again");
+	zassert_equal(engine.notifications, 0, "Refused report counted");
+
+	notify_refused = false;
+	engine_run();
+	zassert_equal(report_count, 1, "Report not retried");
+	zassert_equal(reports[0].len, 10, "Invalid size");
+}
+
+ZTEST(slm_sock_poll, test_socket_replaced)
+{
+	int fd;
+
+	slm_sock_poll_init(&engine, &fake_ops, true);
+	fd = sock_open(0, false);
+
+	peer_send(fd, payload, 40);
+	engine_run();
+	zassert_equal(report_count, 1, "Invalid report count");
+
+	/* A new socket in the slot starts with an empty buffer. */
+	slm_sock_poll_update(&engine, 0, 5, fd, true);
+	zassert_equal(ring_buf_size_get(&engine.entries[0].ring), 0, "Data of old socket kept");
+	zassert_equal(slm_sock_poll_read(&engine, 0, buf, sizeof(buf)), -ENOENT,
+		      "Old handle readable");
+
+	/* Closed sockets are dropped from the poll set. */
+	slm_sock_poll_update(&engine, 0, INVALID_SOCKET, INVALID_SOCKET, false);
+	zassert_equal(engine_run(), 0, "Closed socket polled");
+
+	/* Servers without a connection are not polled. */
+	slm_sock_poll_update(&engine, 1, 1, INVALID_SOCKET, true);
+	zassert_equal(engine_run(), 0, "Listening socket polled");
+	zassert_equal(slm_sock_poll_read(&engine, 1, buf, sizeof(buf)), -ENOTCONN,
+		      "Read without connection");
+}
+
+ZTEST(slm_sock_poll, test_many_sockets)
+{
+	int rounds = 10;
+	int reads = 0;
+
+	for (int i = 0; i < FAKE_SOCK_COUNT; i++) {
+		sock_open(i, false);
+	}
+
+	/* Data arriving on any socket is reported without the host polling. */
+	for (int round = 0; round < rounds; round++) {
+		int fd = FAKE_SOCK_BASE + round % FAKE_SOCK_COUNT;
+
+		peer_send(fd, payload, 10 + round);
+		engine_run();
+		zassert_equal(report_count, round + 1, "Data not reported in round %d", round);
+		zassert_equal(reports[round].handle, round % FAKE_SOCK_COUNT, "Invalid handle");
+		zassert_equal(reports[round].len, (size_t)(10 + round), "Invalid size");
+
+		if (slm_sock_poll_read(&engine, reports[round].handle, buf, sizeof(buf)) > 0) {
+			reads++;
+		}
+	}
+
+	zassert_equal(reads, rounds, "Reads failed");
+	TC_PRINT("%d reports for %d data arrivals, %d polls\n", report_count, rounds,
+		 poll_count);
+}
+
+ZTEST_SUITE(slm_sock_poll, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "slm_uart_handler.h"
+#include "uart_emul.h"
+
+#define SYNC_STR "Ready\r\n"
+#define HDR_STR "\r\n#XRECV: 64\r\n"
+#define PAYLOAD_STR "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ+/"
+#define OK_STR "\r\nOK\r\n"
+
+#define TX_TIME K_MSEC(20)
+#define WRITER_TIMEOUT K_MSEC(2000)
+
+/* Socket receive loop: each chunk takes as long to receive as to send. */
+#define CHUNK_COUNT 10
+#define CHUNK_RECV_TIME_MS 20
+#define CHUNK_TX_TIME K_MSEC(10)
+
+/* Sends socket data the way #XRECV does, from a thread that can be blocked. */
+static K_THREAD_STACK_DEFINE(writer_stack, 1024);
+static struct k_thread writer;
+static int writer_err;
+
+static int ref_done_count;
+static int ref_done_err;
+
+static uint8_t chunk_bufs[2][sizeof(PAYLOAD_STR)];
+static K_SEM_DEFINE(chunk_idle_0, 1, 1);
+static K_SEM_DEFINE(chunk_idle_1, 1, 1);
+static struct k_sem *const chunk_idle[] = { &chunk_idle_0, &chunk_idle_1 };
+
+/* Stands in for the SLM main, which indicates to the host that there is data to read. */
+int indicate_start(void)
+{
+	return 0;
+}
+
+static void rx_data(const uint8_t *data, size_t len)
+{
+	ARG_UNUSED(data);
+	ARG_UNUSED(len);
+}
+
+static int socket_data_send(void)
+{
+	const struct slm_uart_tx_frag frags[] = {
+		{ .data = HDR_STR, .len = strlen(HDR_STR) },
+		{ .data = PAYLOAD_STR, .len = strlen(PAYLOAD_STR), .ref = true },
+	};
+
+	return slm_uart_tx_writev(frags, ARRAY_SIZE(frags));
+}
+
+static void writer_run(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	writer_err = socket_data_send();
+}
+
+static void writer_start(void)
+{
+	(void)k_thread_create(&writer, writer_stack, K_THREAD_STACK_SIZEOF(writer_stack),
+			      writer_run, NULL, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+}
+
+static void tx_idle_wait(void)
+{
+	while (uart_emul_tx_busy()) {
+		k_sleep(K_MSEC(1));
+	}
+}
+
+/* Check that the UART sent exactly the expected data. */
+static void sent_check(const char *expected)
+{
+	const uint8_t *sent;
+	size_t len = uart_emul_sent_get(&sent);
+
+	zassert_equal(len, strlen(expected), "Invalid length");
+	zassert_mem_equal(sent, expected, len, "Invalid data");
+}
+
+static void ref_done(void *user_data, int err)
+{
+	ARG_UNUSED(user_data);
+
+	ref_done_count++;
+	ref_done_err = err;
+}
+
+static void chunk_sent(void *user_data, int err)
+{
+	zassert_ok(err, "Chunk dropped");
+	k_sem_give(user_data);
+}
+
+static void chunk_idle_wait(int idx)
+{
+	zassert_ok(k_sem_take(chunk_idle[idx], WRITER_TIMEOUT), "Chunk not sent");
+	k_sem_give(chunk_idle[idx]);
+}
+
+/* Receive and send socket data like #XRECV, return the elapsed time in ms. With
+ * double buffering, a chunk is received while the previous one is sent, like the
+ * SLM does with slm_data_buf.
+ */
+static int64_t recv_loop_run(bool double_buffered)
+{
+	int64_t start = k_uptime_get();
+	int idx = 0;
+
+	for (size_t i = 0; i < CHUNK_COUNT; i++) {
+		const struct slm_uart_tx_frag frags[] = {
+			{ .data = HDR_STR, .len = strlen(HDR_STR) },
+			{ .data = chunk_bufs[idx], .len = strlen(PAYLOAD_STR), .ref = true },
+		};
+
+		/* Stands in for the socket receive. */
+		k_msleep(CHUNK_RECV_TIME_MS);
+		memcpy(chunk_bufs[idx], PAYLOAD_STR, strlen(PAYLOAD_STR));
+
+		if (!double_buffered) {
+			zassert_ok(slm_uart_tx_writev(frags, ARRAY_SIZE(frags)), "Write failed");
+			continue;
+		}
+
+		zassert_ok(k_sem_take(chunk_idle[idx], K_NO_WAIT), "Buffer being sent");
+		zassert_ok(slm_uart_tx_writev_ref(frags, ARRAY_SIZE(frags), chunk_sent,
+						  chunk_idle[idx]), "Write failed");
+		idx = !idx;
+		chunk_idle_wait(idx);
+	}
+
+	chunk_idle_wait(0);
+	chunk_idle_wait(1);
+
+	return k_uptime_get() - start;
+}
+
+static void *setup(void)
+{
+	zassert_ok(slm_uart_handler_init(rx_data), "Init failed");
+	tx_idle_wait();
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	uart_emul_tx_time_set(K_NO_WAIT);
+	uart_emul_tx_error_set(0);
+	tx_idle_wait();
+	uart_emul_sent_clear();
+
+	writer_err = 0;
+	ref_done_count = 0;
+	ref_done_err = 0;
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	uart_emul_tx_time_set(K_NO_WAIT);
+	uart_emul_tx_error_set(0);
+}
+
+ZTEST(slm_uart_handler, test_writev)
+{
+
+	zassert_ok(socket_data_send(), "Write failed");
+
+	/* The payload is sent once the write returns. */
+	sent_check(HDR_STR PAYLOAD_STR);
+}
+
+ZTEST(slm_uart_handler, test_writev_waits_for_tx)
+{
+
+	uart_emul_tx_time_set(TX_TIME);
+	writer_start();
+
+	zassert_equal(k_thread_join(&writer, K_MSEC(10)), -EAGAIN,
+		      "Returned before the payload was sent");
+	zassert_ok(k_thread_join(&writer, WRITER_TIMEOUT), "Write blocked");
+	zassert_ok(writer_err, "Write failed");
+
+	sent_check(HDR_STR PAYLOAD_STR);
+}
+
+ZTEST(slm_uart_handler, test_writev_ref)
+{
+	const struct slm_uart_tx_frag frags[] = {
+		{ .data = HDR_STR, .len = strlen(HDR_STR) },
+		{ .data = PAYLOAD_STR, .len = strlen(PAYLOAD_STR), .ref = true },
+	};
+
+	uart_emul_tx_time_set(TX_TIME);
+
+	/* Returns once queued, the callback reports when the payload is sent. */
+	zassert_ok(slm_uart_tx_writev_ref(frags, ARRAY_SIZE(frags), ref_done, NULL),
+		   "Write failed");
+	zassert_equal(ref_done_count, 0, "Returned after the payload was sent");
+
+	tx_idle_wait();
+	zassert_equal(ref_done_count, 1, "Callback not called");
+	zassert_ok(ref_done_err, "Payload dropped");
+
+	sent_check(HDR_STR PAYLOAD_STR);
+}
+
+ZTEST(slm_uart_handler, test_writev_ref_copied)
+{
+	const struct slm_uart_tx_frag frag = { .data = OK_STR, .len = strlen(OK_STR) };
+
+	/* Nothing is referenced, the caller is released at once. */
+	uart_emul_tx_time_set(TX_TIME);
+	zassert_ok(slm_uart_tx_writev_ref(&frag, 1, ref_done, NULL), "Write failed");
+	zassert_equal(ref_done_count, 1, "Callback not called");
+
+	tx_idle_wait();
+	sent_check(OK_STR);
+}
+
+ZTEST(slm_uart_handler, test_recv_loop_throughput)
+{
+	size_t bytes = CHUNK_COUNT * strlen(PAYLOAD_STR);
+	int64_t blocking_ms;
+	int64_t double_buffered_ms;
+
+	uart_emul_tx_time_set(CHUNK_TX_TIME);
+
+	blocking_ms = recv_loop_run(false);
+	tx_idle_wait();
+	uart_emul_sent_clear();
+	double_buffered_ms = recv_loop_run(true);
+
+	printk("%zu bytes: blocking %lld ms (%lld B/s), double-buffered %lld ms (%lld B/s)\n",
+	       bytes, blocking_ms, (int64_t)bytes * MSEC_PER_SEC / blocking_ms,
+	       double_buffered_ms, (int64_t)bytes * MSEC_PER_SEC / double_buffered_ms);
+
+	/* The receive and the transfer overlap, instead of adding up. */
+	zassert_true(double_buffered_ms * 4 < blocking_ms * 3, "No overlap");
+}
+
+ZTEST(slm_uart_handler, test_writev_tx_start_error)
+{
+
+	/* The write returns instead of waiting for a payload that is never sent. */
+	uart_emul_tx_error_set(-EIO);
+	zassert_equal(socket_data_send(), -ECANCELED, "Payload not dropped");
+
+	uart_emul_tx_error_set(0);
+	zassert_ok(slm_uart_tx_write(OK_STR, strlen(OK_STR), false), "Write failed");
+	tx_idle_wait();
+
+	/* The payload reference was released, the copied header stayed queued. */
+	sent_check(HDR_STR OK_STR);
+}
+
+ZTEST(slm_uart_handler, test_writev_tx_error_in_progress)
+{
+
+	uart_emul_tx_time_set(TX_TIME);
+	writer_start();
+
+	/* The header is being sent, the next transfer fails. */
+	k_sleep(K_MSEC(5));
+	zassert_true(uart_emul_tx_busy(), "Header not sent");
+	uart_emul_tx_error_set(-EIO);
+
+	zassert_ok(k_thread_join(&writer, WRITER_TIMEOUT), "Write blocked");
+	zassert_equal(writer_err, -ECANCELED, "Payload not dropped");
+
+	/* The TX is idle again. */
+	uart_emul_tx_error_set(0);
+	zassert_ok(slm_uart_tx_write(OK_STR, strlen(OK_STR), false), "Write failed");
+	tx_idle_wait();
+
+	sent_check(HDR_STR OK_STR);
+}
+
+ZTEST(slm_uart_handler, test_power_off_drains_tx)
+{
+
+	uart_emul_tx_time_set(TX_TIME);
+	writer_start();
+	k_sleep(K_MSEC(5));
+
+	/* The emulated UART refuses to suspend in the middle of a transfer. */
+	zassert_ok(slm_uart_power_off(), "Power off failed");
+	zassert_ok(k_thread_join(&writer, WRITER_TIMEOUT), "Write blocked");
+	zassert_ok(writer_err, "Write failed");
+
+	zassert_ok(slm_uart_power_on(), "Power on failed");
+	tx_idle_wait();
+
+	sent_check(HDR_STR PAYLOAD_STR SYNC_STR);
+}
+
+ZTEST(slm_uart_handler, test_power_off_aborts_stuck_tx)
+{
+
+	/* The host does not read, the header transfer never ends. */
+	uart_emul_tx_time_set(K_FOREVER);
+	writer_start();
+	k_sleep(K_MSEC(5));
+
+	zassert_ok(slm_uart_power_off(), "Power off failed");
+	zassert_ok(k_thread_join(&writer, WRITER_TIMEOUT), "Write blocked");
+	zassert_equal(writer_err, -ECANCELED, "Payload not dropped");
+
+	/* The aborted header is sent again after power on. */
+	uart_emul_tx_time_set(K_NO_WAIT);
+	zassert_ok(slm_uart_power_on(), "Power on failed");
+	tx_idle_wait();
+
+	sent_check(HDR_STR SYNC_STR);
+}
+
+ZTEST(slm_uart_handler, test_write_ref_powered_off)
+{
+	const uint8_t *sent;
+
+	zassert_ok(slm_uart_power_off(), "Power off failed");
+
+	/* The payload is copied, so the caller buffer is released at once. */
+	zassert_ok(slm_uart_tx_write_ref(PAYLOAD_STR, strlen(PAYLOAD_STR), ref_done, NULL),
+		   "Write failed");
+	zassert_equal(ref_done_count, 1, "Buffer held while powered off");
+	zassert_ok(ref_done_err, "Buffer dropped");
+	zassert_equal(uart_emul_sent_get(&sent), 0, "Sent while powered off");
+
+	zassert_ok(slm_uart_power_on(), "Power on failed");
+	tx_idle_wait();
+
+	sent_check(SYNC_STR PAYLOAD_STR);
+}
+
+ZTEST_SUITE(slm_uart_handler, NULL, setup, before, after, NULL);
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#define DT_DRV_COMPAT vnd_slm_uart
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/pm/device.h>
+
+#include "uart_emul.h"
+
+#define SENT_SIZE 1024
+
+/* Single instance, whatever is handed to the TX DMA shows up in the sent buffer. */
+static struct uart_emul_data {
+	const struct device *dev;
+	uart_callback_t cb;
+	void *user_data;
+	struct k_work_delayable tx_work;
+	k_timeout_t tx_time;
+	int tx_err;
+	const uint8_t *tx_buf;
+	size_t tx_len;
+	uint8_t *rx_buf;
+	uint8_t sent[SENT_SIZE];
+	size_t sent_len;
+} emul;
+
+static void tx_event(enum uart_event_type type, size_t len)
+{
+	struct uart_event evt = {
+		.type = type,
+		.data.tx.buf = emul.tx_buf,
+		.data.tx.len = len,
+	};
+
+	/* The callback starts the next transfer. */
+	emul.tx_buf = NULL;
+	emul.tx_len = 0;
+
+	if (emul.cb) {
+		emul.cb(emul.dev, &evt, emul.user_data);
+	}
+}
+
+static void tx_work_handler(struct k_work *work)
+{
+	size_t len = emul.tx_len;
+
+	ARG_UNUSED(work);
+
+	if (len == 0) {
+		return;
+	}
+
+	len = MIN(len, sizeof(emul.sent) - emul.sent_len);
+	memcpy(&emul.sent[emul.sent_len], emul.tx_buf, len);
+	emul.sent_len += len;
+
+	tx_event(UART_TX_DONE, emul.tx_len);
+}
+
+static int uart_emul_callback_set(const struct device *dev, uart_callback_t callback,
+				  void *user_data)
+{
+	ARG_UNUSED(dev);
+
+	emul.cb = callback;
+	emul.user_data = user_data;
+
+	return 0;
+}
+
+static int uart_emul_tx(const struct device *dev, const uint8_t *buf, size_t len,
+			int32_t timeout)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(timeout);
+
+	if (emul.tx_err) {
+		return emul.tx_err;
+	}
+	if (emul.tx_len) {
+		return -EBUSY;
+	}
+
+	emul.tx_buf = buf;
+	emul.tx_len = len;
+
+	if (!K_TIMEOUT_EQ(emul.tx_time, K_FOREVER)) {
+		(void)k_work_schedule(&emul.tx_work, emul.tx_time);
+	}
+
+	return 0;
+}
+
+static int uart_emul_tx_abort(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	if (emul.tx_len == 0) {
+		return -EFAULT;
+	}
+
+	(void)k_work_cancel_delayable(&emul.tx_work);
+	tx_event(UART_TX_ABORTED, 0);
+
+	return 0;
+}
+
+static int uart_emul_rx_enable(const struct device *dev, uint8_t *buf, size_t len,
+			       int32_t timeout)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(len);
+	ARG_UNUSED(timeout);
+
+	emul.rx_buf = buf;
+
+	return 0;
+}
+
+static int uart_emul_rx_buf_rsp(const struct device *dev, uint8_t *buf, size_t len)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(buf);
+	ARG_UNUSED(len);
+
+	return -EACCES;
+}
+
+static int uart_emul_rx_disable(const struct device *dev)
+{
+	struct uart_event evt = {
+		.type = UART_RX_BUF_RELEASED,
+		.data.rx_buf.buf = emul.rx_buf,
+	};
+
+	if (!emul.rx_buf) {
+		return -EFAULT;
+	}
+
+	emul.rx_buf = NULL;
+	emul.cb(dev, &evt, emul.user_data);
+
+	evt.type = UART_RX_DISABLED;
+	emul.cb(dev, &evt, emul.user_data);
+
+	return 0;
+}
+
+static int uart_emul_err_check(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static int uart_emul_config_get(const struct device *dev, struct uart_config *cfg)
+{
+	ARG_UNUSED(dev);
+
+	*cfg = (struct uart_config) {
+		.baudrate = 115200,
+		.parity = UART_CFG_PARITY_NONE,
+		.stop_bits = UART_CFG_STOP_BITS_1,
+		.data_bits = UART_CFG_DATA_BITS_8,
+		.flow_ctrl = UART_CFG_FLOW_CTRL_RTS_CTS,
+	};
+
+	return 0;
+}
+
+static int uart_emul_pm_action(const struct device *dev, enum pm_device_action action)
+{
+	ARG_UNUSED(dev);
+
+	switch (action) {
+	case PM_DEVICE_ACTION_SUSPEND:
+		/* Like the UARTE driver, the UART can only be suspended when idle. */
+		return emul.tx_len ? -EBUSY : 0;
+	case PM_DEVICE_ACTION_RESUME:
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+
+static int uart_emul_init(const struct device *dev)
+{
+	emul.dev = dev;
+	emul.tx_time = K_NO_WAIT;
+	k_work_init_delayable(&emul.tx_work, tx_work_handler);
+
+	return 0;
+}
+
+static const struct uart_driver_api uart_emul_api = {
+	.callback_set = uart_emul_callback_set,
+	.tx = uart_emul_tx,
+	.tx_abort = uart_emul_tx_abort,
+	.rx_enable = uart_emul_rx_enable,
+	.rx_buf_rsp = uart_emul_rx_buf_rsp,
+	.rx_disable = uart_emul_rx_disable,
+	.err_check = uart_emul_err_check,
+	.config_get = uart_emul_config_get,
+};
+
+PM_DEVICE_DT_INST_DEFINE(0, uart_emul_pm_action);
+
+DEVICE_DT_INST_DEFINE(0, uart_emul_init, PM_DEVICE_DT_INST_GET(0), NULL, NULL,
+		      POST_KERNEL, CONFIG_SERIAL_INIT_PRIORITY, &uart_emul_api);
+
+void uart_emul_tx_time_set(k_timeout_t time)
+{
+	emul.tx_time = time;
+}
+
+void uart_emul_tx_error_set(int err)
+{
+	emul.tx_err = err;
+}
+
+bool uart_emul_tx_busy(void)
+{
+	return emul.tx_len > 0;
+}
+
+size_t uart_emul_sent_get(const uint8_t **data)
+{
+	*data = emul.sent;
+
+	return emul.sent_len;
+}
+
+void uart_emul_sent_clear(void)
+{
+	emul.sent_len = 0;
+}
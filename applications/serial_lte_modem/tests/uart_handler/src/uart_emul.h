@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef UART_EMUL_H_
+#define UART_EMUL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+/* Set the duration of a transfer. Transfers never end with K_FOREVER. */
+void uart_emul_tx_time_set(k_timeout_t time);
+
+/* Fail the next transfers with @p err, 0 to let them succeed again. */
+void uart_emul_tx_error_set(int err);
+
+/* Return whether a transfer is in progress. */
+bool uart_emul_tx_busy(void);
+
+/* Get the data sent since the last clear. */
+size_t uart_emul_sent_get(const uint8_t **data);
+
+void uart_emul_sent_clear(void);
+
+#endif /* UART_EMUL_H_ */
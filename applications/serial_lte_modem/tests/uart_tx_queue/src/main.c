@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "slm_uart_tx_queue.h"
+
+#define LOOPBACK_SIZE 4096
+#define PAYLOAD_SIZE 1024
+#define THROUGHPUT_PAYLOADS 256
+
+static struct slm_uart_tx_queue q;
+
+/* Loopback UART: whatever is handed to the TX DMA shows up in this buffer. */
+static uint8_t loopback[LOOPBACK_SIZE];
+static size_t loopback_len;
+static size_t loopback_total;
+
+static uint8_t payload[PAYLOAD_SIZE];
+
+static int done_count;
+static size_t done_at;
+static int drop_count;
+
+static void tx_done(void *user_data, int err)
+{
+	ARG_UNUSED(user_data);
+
+	if (err) {
+		zassert_equal(err, -ECANCELED, "Invalid completion error");
+		drop_count++;
+		return;
+	}
+
+	done_count++;
+	done_at = loopback_len;
+}
+
+/* Emulate the UART until the queue is empty. Transfers longer than @p dma_max are
+ * aborted after @p dma_max bytes, like when the UART is stopped mid-transfer.
+ */
+static void uart_run(size_t dma_max)
+{
+	const uint8_t *buf;
+	size_t len;
+
+	while ((len = slm_uart_tx_queue_claim(&q, &buf)) > 0) {
+		len = MIN(len, dma_max);
+
+		if (loopback_len + len > sizeof(loopback)) {
+			/* Only the amount is of interest once the buffer is full. */
+			loopback_len = 0;
+		}
+
+		memcpy(&loopback[loopback_len], buf, len);
+		loopback_len += len;
+		loopback_total += len;
+
+		slm_uart_tx_queue_finish(&q, len);
+	}
+}
+
+static void copy_all(const void *data, size_t len)
+{
+	size_t sent = 0;
+
+	while (sent < len) {
+		size_t ret = slm_uart_tx_queue_copy(&q, (const uint8_t *)data + sent, len - sent);
+
+		if (ret == 0) {
+			/* Queue full, wait for the UART. */
+			uart_run(SIZE_MAX);
+		}
+		sent += ret;
+	}
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	slm_uart_tx_queue_init(&q);
+
+	loopback_len = 0;
+	loopback_total = 0;
+	done_count = 0;
+	done_at = 0;
+	drop_count = 0;
+
+	for (size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = i * 7;
+	}
+}
+
+ZTEST(slm_uart_tx_queue, test_order)
+{
+	static const char expected[] = "\r\n#XRECV: 16\r\n0123456789abcdef\r\nOK\r\n";
+
+	copy_all("\r\n#XRECV: 16\r\n", 14);
+	zassert_ok(slm_uart_tx_queue_ref(&q, (const uint8_t *)"0123456789abcdef", 16,
+					 tx_done, NULL), "Ref failed");
+	copy_all("\r\nOK\r\n", 6);
+
+	zassert_equal(q.count, 3, "Invalid segment count");
+
+	uart_run(SIZE_MAX);
+
+	zassert_true(slm_uart_tx_queue_is_empty(&q), "Queue not empty");
+	zassert_equal(loopback_len, sizeof(expected) - 1, "Invalid length");
+	zassert_mem_equal(loopback, expected, loopback_len, "Invalid data");
+	zassert_equal(done_count, 1, "Invalid completion count");
+	zassert_equal(done_at, 30, "Completion not after the referenced data");
+	zassert_equal(q.bytes_copied, 20, "Invalid copied count");
+	zassert_equal(q.bytes_ref, 16, "Invalid referenced count");
+}
+
+ZTEST(slm_uart_tx_queue, test_copies_share_segment)
+{
+	copy_all("AT", 2);
+	copy_all("+CFUN", 5);
+	copy_all("?", 1);
+
+	zassert_equal(q.count, 1, "Copies not merged");
+
+	uart_run(SIZE_MAX);
+	zassert_mem_equal(loopback, "AT+CFUN?", 8, "Invalid data");
+}
+
+ZTEST(slm_uart_tx_queue, test_claim)
+{
+	const uint8_t *buf;
+	const uint8_t *again;
+
+	zassert_equal(slm_uart_tx_queue_claim(&q, &buf), 0, "Claimed from empty queue");
+
+	zassert_ok(slm_uart_tx_queue_ref(&q, payload, 8, tx_done, NULL), "Ref failed");
+	zassert_equal(slm_uart_tx_queue_claim(&q, &buf), 8, "Invalid claim");
+	zassert_equal(buf, payload, "Referenced data copied");
+	zassert_equal(slm_uart_tx_queue_claim(&q, &again), 0, "Claimed twice");
+
+	/* A failed transfer releases nothing. */
+	slm_uart_tx_queue_finish(&q, 0);
+	zassert_equal(slm_uart_tx_queue_claim(&q, &again), 8, "Claim lost");
+	zassert_equal(again, payload, "Claim moved");
+
+	slm_uart_tx_queue_finish(&q, 8);
+	zassert_equal(done_count, 1, "No completion");
+	zassert_true(slm_uart_tx_queue_is_empty(&q), "Queue not empty");
+}
+
+ZTEST(slm_uart_tx_queue, test_aborted_transfers)
+{
+	copy_all("HDR", 3);
+	zassert_ok(slm_uart_tx_queue_ref(&q, payload, sizeof(payload), tx_done, NULL),
+		   "Ref failed");
+
+	/* Each transfer is cut short, the rest is sent by the next one. */
+	uart_run(5);
+
+	zassert_equal(loopback_len, 3 + sizeof(payload), "Invalid length");
+	zassert_mem_equal(&loopback[3], payload, sizeof(payload), "Invalid data");
+	zassert_equal(done_count, 1, "Invalid completion count");
+	zassert_equal(done_at, loopback_len, "Early completion");
+}
+
+ZTEST(slm_uart_tx_queue, test_full)
+{
+	uint8_t fill[CONFIG_SLM_UART_TX_BUF_SIZE + 1];
+
+	zassert_equal(slm_uart_tx_queue_ref(&q, payload, 0, tx_done, NULL), -EINVAL,
+		      "Empty ref accepted");
+
+	/* Copies stop when the ring buffer is full. */
+	memset(fill, 'x', sizeof(fill));
+	zassert_equal(slm_uart_tx_queue_copy(&q, fill, sizeof(fill)),
+		      ring_buf_capacity_get(&q.ring), "Copied more than the buffer");
+	zassert_equal(slm_uart_tx_queue_copy(&q, fill, 1), 0, "Copied to full buffer");
+
+	/* References do not need buffer space, only segments. */
+	for (size_t i = 1; i < CONFIG_SLM_UART_TX_FRAG_COUNT; i++) {
+		zassert_ok(slm_uart_tx_queue_ref(&q, payload, 1, tx_done, NULL), "Ref failed");
+	}
+	zassert_equal(slm_uart_tx_queue_ref(&q, payload, 1, tx_done, NULL), -ENOMEM,
+		      "Ref to full queue");
+
+	uart_run(SIZE_MAX);
+	zassert_equal(done_count, CONFIG_SLM_UART_TX_FRAG_COUNT - 1, "Completions lost");
+	zassert_equal(loopback_len,
+		      ring_buf_capacity_get(&q.ring) + CONFIG_SLM_UART_TX_FRAG_COUNT - 1,
+		      "Invalid length");
+}
+
+ZTEST(slm_uart_tx_queue, test_ref_drop)
+{
+	const uint8_t *buf;
+
+	zassert_ok(slm_uart_tx_queue_ref(&q, payload, 8, tx_done, NULL), "Ref failed");
+	copy_all("HDR", 3);
+	zassert_ok(slm_uart_tx_queue_ref(&q, &payload[8], 8, tx_done, NULL), "Ref failed");
+	copy_all("END", 3);
+
+	/* The UART holds the first reference, it is not dropped. */
+	zassert_equal(slm_uart_tx_queue_claim(&q, &buf), 8, "Invalid claim");
+	zassert_equal(slm_uart_tx_queue_ref_drop(&q), 8, "Invalid drop count");
+	zassert_equal(drop_count, 1, "Dropped reference not completed");
+	zassert_equal(q.count, 3, "Invalid segment count");
+	zassert_equal(q.bytes_ref, 8, "Dropped bytes counted as sent");
+
+	slm_uart_tx_queue_finish(&q, 8);
+	zassert_equal(done_count, 1, "Claimed reference not completed");
+
+	uart_run(SIZE_MAX);
+	zassert_equal(loopback_len, 6, "Invalid length");
+	zassert_mem_equal(loopback, "HDREND", 6, "Copied data lost");
+	zassert_true(slm_uart_tx_queue_is_empty(&q), "Queue not empty");
+
+	/* Unclaimed references are all dropped. */
+	zassert_ok(slm_uart_tx_queue_ref(&q, payload, 8, tx_done, NULL), "Ref failed");
+	zassert_ok(slm_uart_tx_queue_ref(&q, payload, 8, tx_done, NULL), "Ref failed");
+	zassert_equal(slm_uart_tx_queue_ref_drop(&q), 16, "Invalid drop count");
+	zassert_equal(drop_count, 3, "Dropped references not completed");
+	zassert_true(slm_uart_tx_queue_is_empty(&q), "Queue not empty");
+}
+
+ZTEST(slm_uart_tx_queue, test_ring_wrap)
+{
+	uint8_t expected[64];
+
+	/* Odd sizes move the ring buffer around its end. */
+	for (size_t round = 0; round < 50; round++) {
+		size_t len = 1 + (round * 13) % sizeof(expected);
+
+		for (size_t i = 0; i < len; i++) {
+			expected[i] = round + i;
+		}
+
+		loopback_len = 0;
+		copy_all(expected, len);
+		uart_run(SIZE_MAX);
+
+		zassert_equal(loopback_len, len, "Invalid length in round %d", round);
+		zassert_mem_equal(loopback, expected, len, "Invalid data in round %d", round);
+	}
+}
+
+/* Send socket data the way #XRECV does: a response header followed by the payload. */
+static uint32_t socket_data_send(bool zero_copy)
+{
+	char hdr[32];
+	uint32_t start = k_cycle_get_32();
+
+	for (size_t i = 0; i < THROUGHPUT_PAYLOADS; i++) {
+		int len = snprintf(hdr, sizeof(hdr), "\r\n#XRECV: %d\r\n", PAYLOAD_SIZE);
+
+		copy_all(hdr, len);
+		if (zero_copy) {
+			zassert_ok(slm_uart_tx_queue_ref(&q, payload, sizeof(payload), tx_done,
+							 NULL), "Ref failed");
+			/* The sender waits until its buffer is sent. */
+			uart_run(SIZE_MAX);
+		} else {
+			copy_all(payload, sizeof(payload));
+		}
+	}
+
+	uart_run(SIZE_MAX);
+
+	return k_cycle_get_32() - start;
+}
+
+static void throughput_report(const char *name, uint32_t cycles)
+{
+	uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+	TC_PRINT("%s: %zu bytes sent, %u bytes copied by the CPU\n", name, loopback_total,
+		 q.bytes_copied);
+
+	if (ns == 0) {
+		TC_PRINT("%s: throughput not measurable on this platform\n", name);
+		return;
+	}
+
+	TC_PRINT("%s: %u kB/s, %u cycles per kB\n", name,
+		 (uint32_t)((uint64_t)loopback_total * 1000000 / ns),
+		 (uint32_t)((uint64_t)cycles * 1024 / loopback_total));
+}
+
+ZTEST(slm_uart_tx_queue, test_throughput)
+{
+	uint32_t cycles;
+	size_t hdr_total;
+
+	cycles = socket_data_send(false);
+	throughput_report("Copy", cycles);
+	zassert_equal(q.bytes_copied, loopback_total, "Not all data copied");
+
+	hdr_total = loopback_total - THROUGHPUT_PAYLOADS * PAYLOAD_SIZE;
+
+	before(NULL);
+	cycles = socket_data_send(true);
+	throughput_report("Zero-copy", cycles);
+	zassert_equal(q.bytes_copied, hdr_total, "Payload copied");
+	zassert_equal(q.bytes_ref, THROUGHPUT_PAYLOADS * PAYLOAD_SIZE, "Payload not referenced");
+	zassert_equal(done_count, THROUGHPUT_PAYLOADS, "Completions lost");
+}
+
+ZTEST_SUITE(slm_uart_tx_queue, NULL, NULL, before, NULL, NULL);
@@ -72,6 +72,11 @@ struct audio_metadata {
 	/* The timestamp for when the data was received. */
 	uint32_t data_rx_ts_us;
 
+	/* The time by which the data must have been processed, or 0 if the data has no
+	 * deadline. The audio module uses audio_module_time_us_get() as the time base.
+	 */
+	uint32_t deadline_us;
+
 	/* A Boolean flag to indicate this data has errors
 	 * (true = bad, false = good).
 	 * Note: Timestamps are still valid even though this flag is set.
@@ -208,6 +208,23 @@ struct audio_module_description {
 
 	/* A pointer to the functions in the module. */
 	const struct audio_module_functions *functions;
+
+	/* Flag to indicate that an in/out module can process the audio data in place.
+	 *
+	 * @note When the module holds the only reference to the input audio data block, the
+	 *       output audio data given to data_process points to the input audio data and the
+	 *       block is passed on without copying. Otherwise, a block is taken from the
+	 *       module's data slab as usual. The output data size must not exceed the input
+	 *       data size when processing in place.
+	 */
+	bool in_place;
+
+	/* Flag to drop audio data received after its deadline.
+	 *
+	 * @note By default, late audio data is processed with the bad_data flag set in the
+	 *       metadata, so that the module can conceal it.
+	 */
+	bool drop_late;
 };
 
 /**
@@ -234,10 +251,35 @@ struct audio_module_thread_configuration {
 
 	/* Size of each memory data buffer in bytes that will be
 	 * taken from the audio data buffer slab. The size can be 0.
+	 *
+	 * @note The blocks of the slab must be at least
+	 *       AUDIO_MODULE_DATA_BLOCK_SIZE(data_size) bytes.
 	 */
 	size_t data_size;
 };
 
+/**
+ * @brief Header of an audio data block taken from a module's data slab.
+ */
+struct audio_module_block {
+	/* Number of references to the block, the block is freed when the last one is released. */
+	atomic_t refs;
+
+	/* The slab to return the block to. */
+	struct k_mem_slab *slab;
+
+	/* The audio data. */
+	uint8_t data[];
+};
+
+/**
+ * @brief Size of the data slab blocks for audio data of the given size.
+ *
+ * @param data_size  Size of the audio data in bytes.
+ */
+#define AUDIO_MODULE_DATA_BLOCK_SIZE(data_size)                                                    \
+	WB_UP(sizeof(struct audio_module_block) + (data_size))
+
 /**
  * @brief Module's generic set-up structure.
  */
@@ -249,6 +291,34 @@ struct audio_module_parameters {
 	struct audio_module_thread_configuration thread;
 };
 
+#if defined(CONFIG_AUDIO_MODULE_STATS) || defined(__DOXYGEN__)
+/**
+ * @brief Module's timing statistics.
+ */
+struct audio_module_stats {
+	/* Number of audio data items processed. */
+	uint32_t processed;
+
+	/* Number of audio data items received after their deadline. */
+	uint32_t late;
+
+	/* Number of audio data items dropped, late or for lack of an output block. */
+	uint32_t dropped;
+
+	/* Number of audio data items processed past their deadline. */
+	uint32_t overruns;
+
+	/* Longest processing time in microseconds. */
+	uint32_t max_us;
+
+	/* Histogram of the processing times. Bucket 0 counts the times below 1 microsecond
+	 * and bucket n counts the times from 2^(n-1) to 2^n - 1 microseconds. The last bucket
+	 * also counts all longer times.
+	 */
+	uint32_t histogram[CONFIG_AUDIO_MODULE_STATS_HISTOGRAM_SIZE];
+};
+#endif /* CONFIG_AUDIO_MODULE_STATS */
+
 /**
  * @brief Private module handle.
  */
@@ -280,10 +350,7 @@ struct audio_module_handle {
 	/* Number of destination modules. */
 	uint8_t dest_count;
 
-	/* Semaphore to count messages between modules and on a module's TX FIFO. */
-	struct k_sem sem;
-
-	/* Mutex to make the above destinations list thread safe. */
+	/* Mutex to serialize the changes to the above destinations list. */
 	struct k_mutex dest_mutex;
 
 	/* Module's thread configuration. */
@@ -291,6 +358,16 @@ struct audio_module_handle {
 
 	/* Private context for the module. */
 	struct audio_module_context *context;
+
+#if defined(CONFIG_AUDIO_MODULE_STATS)
+	/* Module's timing statistics. */
+	struct audio_module_stats stats;
+#endif /* CONFIG_AUDIO_MODULE_STATS */
+
+#if defined(CONFIG_AUDIO_MODULE_SHELL)
+	/* List node in the list of open modules. */
+	sys_snode_t open_node;
+#endif /* CONFIG_AUDIO_MODULE_SHELL */
 };
 
 /**
@@ -305,6 +382,11 @@ struct audio_module_message {
 
 	/* Callback for when the audio data has been consumed. */
 	audio_module_response_cb response_cb;
+
+	/* Reference counted block holding the audio data, NULL for audio data from outside
+	 * the audio system.
+	 */
+	struct audio_module_block *block;
 };
 
 /**
@@ -491,6 +573,37 @@ int audio_module_state_get(struct audio_module_handle const *const handle,
  */
 int audio_module_number_channels_calculate(uint32_t locations, int8_t *number_channels);
 
+/**
+ * @brief Get the current time in the time base of the audio data deadlines.
+ *
+ * @note The time wraps around, compare times by their difference.
+ *
+ * @return Current time in microseconds.
+ */
+uint32_t audio_module_time_us_get(void);
+
+#if defined(CONFIG_AUDIO_MODULE_STATS) || defined(__DOXYGEN__)
+/**
+ * @brief Get the timing statistics of a given audio module handle.
+ *
+ * @param handle  [in]   The handle to the module instance.
+ * @param stats   [out]  Pointer to the module's statistics.
+ *
+ * @return 0 if successful, error otherwise.
+ */
+int audio_module_stats_get(struct audio_module_handle const *const handle,
+			   struct audio_module_stats *stats);
+
+/**
+ * @brief Reset the timing statistics of a given audio module handle.
+ *
+ * @param handle  [in/out]  The handle to the module instance.
+ *
+ * @return 0 if successful, error otherwise.
+ */
+int audio_module_stats_reset(struct audio_module_handle *handle);
+#endif /* CONFIG_AUDIO_MODULE_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
 #ifndef BT_ADV_PROV_H_
 #define BT_ADV_PROV_H_
 
+#include <zephyr/sys/atomic.h>
 #include <zephyr/bluetooth/bluetooth.h>
 
 /**
@@ -75,12 +76,66 @@ typedef int (*bt_le_adv_prov_data_get)(struct bt_data *d,
 				       const struct bt_le_adv_prov_adv_state *state,
 				       struct bt_le_adv_prov_feedback *fb);
 
+/** Update policy of provider's data.
+ *
+ * The policy tells the subsystem when the provider's data must be regenerated. Until then, the
+ * subsystem uses the data cached from the last call of the provider's callback. The cached data
+ * is always regenerated if @ref bt_le_adv_prov_adv_state.pairing_mode or
+ * @ref bt_le_adv_prov_adv_state.in_grace_period changes, or if the provider reports a change
+ * using @ref bt_le_adv_prov_data_changed.
+ */
+enum bt_le_adv_prov_update {
+	/** The data is time-varying. The callback is called on every advertising data update. */
+	BT_LE_ADV_PROV_UPDATE_ALWAYS,
+
+	/** The data is regenerated together with RPA rotation and on new advertising session. */
+	BT_LE_ADV_PROV_UPDATE_ROTATION,
+
+	/** The data is regenerated on new advertising session. */
+	BT_LE_ADV_PROV_UPDATE_SESSION,
+
+	/** The data is static. */
+	BT_LE_ADV_PROV_UPDATE_STATIC,
+};
+
+/** @cond INTERNAL_HIDDEN */
+
+/** Cached data of a provider. */
+struct bt_le_adv_prov_cache {
+	struct bt_data data;
+	struct bt_le_adv_prov_feedback fb;
+	int err;
+	bool pairing_mode;
+	bool in_grace_period;
+	atomic_t flags;
+};
+
+/** @endcond */
+
 /** Structure describing advertising data provider. */
 struct bt_le_adv_prov_provider {
 	/** Function used to get provider's data. */
 	bt_le_adv_prov_data_get get_data;
+
+	/** Update policy of provider's data. */
+	enum bt_le_adv_prov_update update;
+
+	/** Cached provider's data, NULL if not cached. */
+	struct bt_le_adv_prov_cache *cache;
 };
 
+/** @cond INTERNAL_HIDDEN */
+
+#define _BT_LE_ADV_PROV_PROVIDER_REGISTER(set, pname, get_data_fn, update_policy)		 \
+	static struct bt_le_adv_prov_cache _CONCAT(_bt_le_adv_prov_cache_, pname);		 \
+	STRUCT_SECTION_ITERABLE_ALTERNATE(set, bt_le_adv_prov_provider, pname) = {		 \
+		.get_data = get_data_fn,							 \
+		.update = update_policy,							 \
+		.cache = &_CONCAT(_bt_le_adv_prov_cache_, pname),				 \
+	}
+
+/** @endcond */
+
 /** Register advertising data provider.
  *
  * The macro statically registers an advertising data provider. The provider appends data to
@@ -107,6 +162,47 @@ struct bt_le_adv_prov_provider {
 		.get_data = get_data_fn,							 \
 	}
 
+/** Register advertising data provider with cached data.
+ *
+ * The macro statically registers an advertising data provider, like
+ * @ref BT_LE_ADV_PROV_AD_PROVIDER_REGISTER. The provider's data is cached according to the
+ * update policy. The data pointed by the provided Bluetooth data structure must stay valid until
+ * it is regenerated.
+ *
+ * @param pname		Provider name.
+ * @param get_data_fn	Function used to get provider's advertising data.
+ * @param update_policy	Update policy of provider's data (@ref bt_le_adv_prov_update).
+ */
+#define BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(pname, get_data_fn, update_policy)		 \
+	_BT_LE_ADV_PROV_PROVIDER_REGISTER(bt_le_adv_prov_ad, pname, get_data_fn, update_policy)
+
+/** Register scan response data provider with cached data.
+ *
+ * The macro statically registers a scan response data provider, like
+ * @ref BT_LE_ADV_PROV_SD_PROVIDER_REGISTER. The provider's data is cached according to the
+ * update policy. The data pointed by the provided Bluetooth data structure must stay valid until
+ * it is regenerated.
+ *
+ * @param pname		Provider name.
+ * @param get_data_fn	Function used to get provider's scan response data.
+ * @param update_policy	Update policy of provider's data (@ref bt_le_adv_prov_update).
+ */
+#define BT_LE_ADV_PROV_SD_PROVIDER_REGISTER_CACHED(pname, get_data_fn, update_policy)		 \
+	_BT_LE_ADV_PROV_PROVIDER_REGISTER(bt_le_adv_prov_sd, pname, get_data_fn, update_policy)
+
+/** Inform that provider's data has changed.
+ *
+ * The cached data of the provider is regenerated on the next call of @ref bt_le_adv_prov_get_ad
+ * or @ref bt_le_adv_prov_get_sd. The module that controls Bluetooth advertising must still be
+ * requested to update the advertising data.
+ *
+ * The function can be called from any context.
+ *
+ * @param provider	Provider registered with @ref BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED or
+ *			@ref BT_LE_ADV_PROV_SD_PROVIDER_REGISTER_CACHED.
+ */
+void bt_le_adv_prov_data_changed(const struct bt_le_adv_prov_provider *provider);
+
 /** Get number of advertising data packet providers.
  *
  * The number of advertising data packet providers defines maximum number of elements in advertising
@@ -23,23 +23,39 @@ extern "C" {
 #endif
 
 /**@brief Macro for defining a Bluetooth connection context library instance.
+ *
+ * The context data memory is sized for @p _max_clients connections at
+ * compile time, while the contexts are indexed directly by the connection
+ * index.
  *
  * @param  _name	Name of the instance.
  * @param  _max_clients	Maximum number of clients connected at a time.
  * @param  _ctx_sz	Context size in bytes for a single connection.
  */
 #define BT_CONN_CTX_DEF(_name, _max_clients, _ctx_sz)                          \
+	BUILD_ASSERT((_max_clients) > 0 && (_max_clients) <= CONFIG_BT_MAX_CONN, \
+		     "Invalid number of clients for " #_name);                 \
 	K_MEM_SLAB_DEFINE(_name##_mem_slab,                                    \
 			  ROUND_UP(_ctx_sz, CONFIG_BT_CONN_CTX_MEM_BUF_ALIGN), \
 			  (_max_clients),                                      \
 			  CONFIG_BT_CONN_CTX_MEM_BUF_ALIGN);                   \
-	K_MUTEX_DEFINE(_name##_mutex);                                         \
 	static struct bt_conn_ctx_lib _CONCAT(_name, _ctx_lib) =                \
 	{                                                                      \
 		.mem_slab = &_CONCAT(_name, _mem_slab),                         \
-		.mutex = &_name##_mutex                                        \
+		.max_clients = (_max_clients),                                 \
 	}
 
+/**@brief Get the context data memory size of a library instance.
+ *
+ * @param  _max_clients	Maximum number of clients connected at a time.
+ * @param  _ctx_sz	Context size in bytes for a single connection.
+ *
+ * @return Size in bytes of the context data memory that @ref BT_CONN_CTX_DEF
+ *         reserves with the same parameters.
+ */
+#define BT_CONN_CTX_MEM_SIZE(_max_clients, _ctx_sz)                            \
+	((_max_clients) * ROUND_UP(_ctx_sz, CONFIG_BT_CONN_CTX_MEM_BUF_ALIGN))
+
 /** @brief Context data for a connection. */
 struct bt_conn_ctx {
 	/** Any kind of data associated with a specific connection. */
@@ -47,19 +63,27 @@ struct bt_conn_ctx {
 
 	 /** The connection that the data is associated with. */
 	struct bt_conn *conn;
+
+	/* Number of references to the context, including the allocation. */
+	atomic_t ref;
+
+	/* Context state flags. */
+	atomic_t flags;
 };
 
 /** @brief Bluetooth connection context library structure. */
 struct bt_conn_ctx_lib {
-	/** Connection contexts. */
+	/** Connection contexts, indexed by the connection index. */
 	struct bt_conn_ctx ctx[CONFIG_BT_MAX_CONN];
 
-	/** Context data mutex that ensures that only one connection context is
-	  * manipulated at a time. */
-	struct k_mutex * const mutex;
+	/** Lock for allocating and freeing the context data. */
+	struct k_spinlock lock;
 
 	/** Memory slab instance where the memory is allocated. */
 	struct k_mem_slab * const mem_slab;
+
+	/** Maximum number of clients connected at a time. */
+	const size_t max_clients;
 };
 
 /**
@@ -127,7 +151,9 @@ void bt_conn_ctx_free_all(struct bt_conn_ctx_lib *ctx_lib);
  * The link to find is identified by the connection object.
  *
  * This function should be used in conjunction with
- * @ref bt_conn_ctx_release to ensure proper operation.
+ * @ref bt_conn_ctx_release to ensure proper operation. The context data
+ * stays valid until it is released, even if the context is freed in the
+ * meantime. The library does not serialize access to the context data.
  *
  * @param ctx_lib	Bluetooth connection context library instance.
  * @param conn		Bluetooth connection.
@@ -159,7 +185,8 @@ const struct bt_conn_ctx *bt_conn_ctx_get_by_id(struct bt_conn_ctx_lib *ctx_lib,
  * @brief Release a connection context from the memory pool.
  *
  * This function finds and releases a connection context in the memory pool.
- * The link to find is identified by its context data.
+ * The link to find is identified by its context data. The context data is
+ * freed when the last reference to a freed context is released.
  *
  * This function should be used in conjunction with @ref bt_conn_ctx_alloc,
  * @ref bt_conn_ctx_get, or @ref bt_conn_ctx_get_by_id to ensure proper
@@ -179,6 +179,30 @@ int bt_gatt_pool_ccc_alloc(struct bt_gatt_pool *gp,
 			   struct _bt_gatt_ccc *ccc,
 			   uint8_t perm);
 
+/** @brief Take all attributes of a service from the pool in one call.
+ *
+ *  The attributes are described the same way as for a static service, for
+ *  example with @ref BT_GATT_PRIMARY_SERVICE, @ref BT_GATT_CHARACTERISTIC,
+ *  @ref BT_GATT_CCC and @ref BT_GATT_DESCRIPTOR. The UUIDs and
+ *  characteristic declarations are copied to the pool, so the description can
+ *  be discarded afterwards. The CCC configurations are used as they are, and
+ *  must stay valid as long as the service.
+ *
+ *  Either all attributes are taken from the pool, or none of them are.
+ *
+ *  @param gp    GATT service object with dynamic attribute allocation.
+ *  @param attrs Attributes to take from the pool.
+ *  @param count Number of attributes.
+ *
+ *  @retval 0 Operation finished successfully.
+ *  @retval -EINVAL Invalid input value.
+ *  @retval -ENOSPC Number of attributes in @c svc would exceed
+ *                  @c attr_array_size.
+ *  @retval -ENOMEM No internal memory in the gatt_pool module.
+ */
+int bt_gatt_pool_attrs_alloc(struct bt_gatt_pool *gp,
+			     struct bt_gatt_attr const *attrs, size_t count);
+
 /** @brief Free the whole dynamically created GATT service.
  *
  *  @param gp GATT service object with dynamic attribute allocation.
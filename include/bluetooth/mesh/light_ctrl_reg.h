@@ -56,6 +56,15 @@ struct bt_mesh_light_ctrl_reg {
 	 *  @param[in] reg           Illuminance regulator instance.
 	 */
 	void (*stop)(struct bt_mesh_light_ctrl_reg *reg);
+	/** Notify the regulator of new input. Optional.
+	 *
+	 *  Called when the measured value, the target value or the
+	 *  configuration has been updated, so that a regulator that suspends
+	 *  its steps while its output is stable can resume.
+	 *
+	 *  @param[in] reg           Illuminance regulator instance.
+	 */
+	void (*input_changed)(struct bt_mesh_light_ctrl_reg *reg);
 	/** Regulator configuration. */
 	struct bt_mesh_light_ctrl_reg_cfg cfg;
 	/** Measured value. */
@@ -101,6 +110,20 @@ void bt_mesh_light_ctrl_reg_target_set(struct bt_mesh_light_ctrl_reg *reg,
  */
 float bt_mesh_light_ctrl_reg_target_get(struct bt_mesh_light_ctrl_reg *reg);
 
+/** @brief Notify the regulator of new input.
+ *
+ *  Must be called after updating the measured value or the configuration of
+ *  a running regulator.
+ *
+ *  @param[in] reg      Illuminance regulator instance.
+ */
+static inline void bt_mesh_light_ctrl_reg_input_changed(struct bt_mesh_light_ctrl_reg *reg)
+{
+	if (reg->input_changed) {
+		reg->input_changed(reg);
+	}
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,8 +29,12 @@ extern "C" {
 		.reg = {                                                       \
 			.init = bt_mesh_light_ctrl_reg_spec_init,              \
 			.start = bt_mesh_light_ctrl_reg_spec_start,            \
-			.stop = bt_mesh_light_ctrl_reg_spec_stop               \
-		}                                                              \
+			.stop = bt_mesh_light_ctrl_reg_spec_stop,              \
+			IF_ENABLED(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_FIXED_POINT, \
+				   (.input_changed =                           \
+				    bt_mesh_light_ctrl_reg_spec_input_changed,)) \
+		},                                                             \
+		.interval = CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL,       \
 	}
 
 /** Specification-defined illuminance regulator context. */
@@ -39,8 +43,30 @@ struct bt_mesh_light_ctrl_reg_spec {
 	struct bt_mesh_light_ctrl_reg reg;
 	/** Regulator step timer. */
 	struct k_work_delayable timer;
+	/** Regulator step interval in milliseconds. Can only be changed while
+	 *  the regulator is stopped.
+	 */
+	uint16_t interval;
+#if defined(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_FIXED_POINT)
+	/** Internal integral sum, with 16 fractional bits. */
+	int64_t i;
+	/* Regulator input the terms below were calculated from. */
+	struct {
+		struct bt_mesh_light_ctrl_reg_cfg cfg;
+		float measured;
+		float target;
+		bool valid;
+	} input;
+	/* Integral term of a step, with 16 fractional bits. */
+	int64_t i_step;
+	/* Proportional term, with 16 fractional bits. */
+	int64_t p;
+	/* If true, the regulator output is stable and the steps are suspended. */
+	bool suspended;
+#else
 	/** Internal integral sum. */
 	float i;
+#endif
 	/** Regulator enabled flag. */
 	bool enabled;
 	/* If true, internal integral sum can be negative until it becomes positive. */
@@ -51,6 +77,7 @@ struct bt_mesh_light_ctrl_reg_spec {
 void bt_mesh_light_ctrl_reg_spec_init(struct bt_mesh_light_ctrl_reg *reg);
 void bt_mesh_light_ctrl_reg_spec_start(struct bt_mesh_light_ctrl_reg *reg, uint16_t lightness);
 void bt_mesh_light_ctrl_reg_spec_stop(struct bt_mesh_light_ctrl_reg *reg);
+void bt_mesh_light_ctrl_reg_spec_input_changed(struct bt_mesh_light_ctrl_reg *reg);
 /** @endcond */
 
 #ifdef __cplusplus
@@ -10,6 +10,7 @@
 #include <zephyr/bluetooth/mesh.h>
 
 #include <bluetooth/mesh/model_types.h>
+#include <bluetooth/mesh/transition.h>
 
 /* Foundation models */
 #include <zephyr/bluetooth/mesh/cfg_cli.h>
@@ -22,6 +22,22 @@
 extern "C" {
 #endif
 
+#ifndef CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX
+#define CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX 0
+#endif
+
+#ifndef CONFIG_BT_MESH_SENSOR_CHANNELS_MAX
+#define CONFIG_BT_MESH_SENSOR_CHANNELS_MAX 0
+#endif
+
+#ifndef CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX
+#define CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX 0
+#endif
+
+#define BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN                                    \
+	(CONFIG_BT_MESH_SENSOR_CHANNELS_MAX *                                  \
+	 CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX)
+
 /** Largest period divisor value allowed. */
 #define BT_MESH_SENSOR_PERIOD_DIV_MAX 15
 /** Largest sensor interval allowed. The value is represented as
@@ -335,6 +351,16 @@ struct bt_mesh_sensor_series {
 		struct sensor_value *value);
 };
 
+/* Cached encoding of a sensor value, for internal use. */
+struct bt_mesh_sensor_enc_cache {
+	/* Sensor value the encoding is of. */
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+	/* Encoded sensor value. */
+	uint8_t data[BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN];
+	/* Length of the encoded sensor value, or 0 if the cache is empty. */
+	uint8_t len;
+};
+
 /** Sensor instance. */
 struct bt_mesh_sensor {
 	/** Sensor type.
@@ -411,6 +437,11 @@ struct bt_mesh_sensor {
 
 		/** Flag indicating whether the sensor cadence state has been configured. */
 		uint8_t configured : 1;
+
+#if defined(CONFIG_BT_MESH_SENSOR_SRV_VALUE_CACHE)
+		/** Encoding of the last reported sensor value. */
+		struct bt_mesh_sensor_enc_cache enc;
+#endif
 	} state;
 };
 
@@ -517,22 +548,6 @@ const char *bt_mesh_sensor_ch_str(const struct sensor_value *ch);
 #define BT_MESH_SENSOR_OP_SETTING_SET_UNACKNOWLEDGED BT_MESH_MODEL_OP_1(0x5A)
 #define BT_MESH_SENSOR_OP_SETTING_STATUS BT_MESH_MODEL_OP_1(0x5B)
 
-#ifndef CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX
-#define CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX 0
-#endif
-
-#ifndef CONFIG_BT_MESH_SENSOR_CHANNELS_MAX
-#define CONFIG_BT_MESH_SENSOR_CHANNELS_MAX 0
-#endif
-
-#ifndef CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX
-#define CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX 0
-#endif
-
-#define BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN                                    \
-	(CONFIG_BT_MESH_SENSOR_CHANNELS_MAX *                                  \
-	 CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX)
-
 #define BT_MESH_SENSOR_STATUS_MAXLEN (3 + BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN)
 
 #define BT_MESH_SENSOR_MSG_MINLEN_DESCRIPTOR_GET 0
@@ -58,17 +58,38 @@ struct bt_mesh_sensor_srv;
 					      _srv),                           \
 			 &_bt_mesh_sensor_setup_srv_cb)
 
+/* Cached encoding of a sensor series column, for internal use. */
+struct bt_mesh_sensor_series_cache {
+	/* Sensor the column belongs to, or NULL if the entry is empty. */
+	const struct bt_mesh_sensor *sensor;
+	/* Column index. */
+	uint32_t column;
+	/* Encoded column start and width, for sensors with more than two channels. */
+	uint8_t header[2 * CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX];
+	/* Length of the encoded column start and width. */
+	uint8_t header_len;
+	/* Encoded column value. */
+	struct bt_mesh_sensor_enc_cache value;
+};
+
 /** Sensor server instance. */
 struct bt_mesh_sensor_srv {
 	/** Sensors owned by this server. */
 	struct bt_mesh_sensor *const *sensor_array;
 	/** Ordered linked list of sensors. */
 	sys_slist_t sensors;
+	/* Sensors sorted by ID, for lookup by ID. */
+	struct bt_mesh_sensor *sensors_by_id[CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX];
 	/** Publish sequence counter */
 	uint16_t seq;
 	/** Number of sensors. */
 	uint8_t sensor_count;
 
+#if CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE > 0
+	/* Encoded series columns, indexed by sensor type ID and column. */
+	struct bt_mesh_sensor_series_cache
+		series_cache[CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE];
+#endif
 	/** Publish parameters. */
 	struct bt_mesh_model_pub pub;
 	/* Publication buffer */
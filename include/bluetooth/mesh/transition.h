@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/** @file
+ *  @defgroup bt_mesh_transition Transition engine
+ *  @ingroup bt_mesh_model_types
+ *  @{
+ *  @brief Shared engine for non-instantaneous state changes.
+ */
+
+#ifndef BT_MESH_TRANSITION_H__
+#define BT_MESH_TRANSITION_H__
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include <bluetooth/mesh/model_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bt_mesh_transition;
+
+/** @brief Transition step handler.
+ *
+ *  Called every time the present value of the transition changes, and
+ *  always with the target value at the end of the transition. The handler is
+ *  called from the system workqueue, or from @ref bt_mesh_transition_start
+ *  for instantaneous transitions. It may start and stop transitions.
+ *
+ *  @param[in] trans Transition instance.
+ *  @param[in] value New present value.
+ */
+typedef void (*bt_mesh_transition_step_t)(struct bt_mesh_transition *trans,
+					  int32_t value);
+
+/** @def BT_MESH_TRANSITION_INIT
+ *
+ *  @brief Initialization macro for @ref bt_mesh_transition.
+ *
+ *  @param[in] _step Step handler.
+ */
+#define BT_MESH_TRANSITION_INIT(_step)                                         \
+	{                                                                      \
+		.step = _step,                                                 \
+	}
+
+/** @def BT_MESH_TRANSITION_INIT_BEGIN
+ *
+ *  @brief Initialization macro for @ref bt_mesh_transition with a begin
+ *         handler.
+ *
+ *  @param[in] _step  Step handler.
+ *  @param[in] _begin Begin handler.
+ */
+#define BT_MESH_TRANSITION_INIT_BEGIN(_step, _begin)                           \
+	{                                                                      \
+		.step = _step,                                                 \
+		.begin = _begin,                                               \
+	}
+
+/** Transition instance. Drives one state value from its present value to a
+ *  target value.
+ */
+struct bt_mesh_transition {
+	/** Step handler. */
+	bt_mesh_transition_step_t step;
+	/** Optional begin handler. Called with the present value when the
+	 *  delay has elapsed and the transition starts, before any step. Lets
+	 *  binary states change at the start of a transition, without stepping
+	 *  through a wider value range.
+	 */
+	bt_mesh_transition_step_t begin;
+	/* Node in the list of running transitions. */
+	sys_snode_t node;
+	/* System uptime when the value starts moving, after the delay. */
+	int64_t start_time;
+	/* System uptime of the next step. */
+	int64_t due;
+	/* Time to move from the start value to the target value. */
+	uint32_t duration;
+	/* Value at the start of the transition. */
+	int32_t start;
+	/* Target value of the transition. */
+	int32_t target;
+	/* Last value passed to the step handler. */
+	int32_t present;
+	/* Whether the transition is running. */
+	bool running;
+	/* Whether the begin handler is due at the end of the delay. */
+	bool begin_pending;
+};
+
+/** @brief Start a transition.
+ *
+ *  Moves the value linearly from @p present to @p target over the
+ *  transition time, after the transition delay. Any transition already
+ *  running on the instance is replaced.
+ *
+ *  If the transition is instantaneous, the step handler is called with the
+ *  target value before this function returns, and the begin handler is not
+ *  called. Otherwise, if the transition has no delay, the begin handler is
+ *  called before this function returns.
+ *
+ *  May be called from any thread.
+ *
+ *  @param[in] trans      Transition instance.
+ *  @param[in] present    Present value of the state.
+ *  @param[in] target     Target value of the state.
+ *  @param[in] transition Transition parameters, or NULL to change the value
+ *                        instantaneously.
+ */
+void bt_mesh_transition_start(struct bt_mesh_transition *trans, int32_t present,
+			      int32_t target,
+			      const struct bt_mesh_model_transition *transition);
+
+/** @brief Stop a transition.
+ *
+ *  The present value is kept at its last value, and the step handler is not
+ *  called again, unless a step is already in progress on the system
+ *  workqueue.
+ *
+ *  May be called from any thread.
+ *
+ *  @param[in] trans Transition instance.
+ */
+void bt_mesh_transition_stop(struct bt_mesh_transition *trans);
+
+/** @brief Get the remaining transition time.
+ *
+ *  The remaining time does not include the remaining delay.
+ *
+ *  @param[in] trans Transition instance.
+ *
+ *  @return Remaining transition time in milliseconds, or 0 if the transition
+ *          is not running.
+ */
+uint32_t bt_mesh_transition_remaining_get(const struct bt_mesh_transition *trans);
+
+/** @brief Check whether a transition is running.
+ *
+ *  A transition is running from when it is started until the step handler has
+ *  been called with the target value, including the delay.
+ *
+ *  @param[in] trans Transition instance.
+ *
+ *  @return true if the transition is running, false otherwise.
+ */
+static inline bool bt_mesh_transition_in_progress(const struct bt_mesh_transition *trans)
+{
+	return trans->running;
+}
+
+/** @brief Get the present value of a transition.
+ *
+ *  @param[in] trans Transition instance.
+ *
+ *  @return The last value passed to the step handler.
+ */
+static inline int32_t bt_mesh_transition_present_get(const struct bt_mesh_transition *trans)
+{
+	return trans->present;
+}
+
+/** @brief Get the target value of a transition.
+ *
+ *  @param[in] trans Transition instance.
+ *
+ *  @return The target value of the last started transition.
+ */
+static inline int32_t bt_mesh_transition_target_get(const struct bt_mesh_transition *trans)
+{
+	return trans->target;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BT_MESH_TRANSITION_H__ */
+
+/** @} */
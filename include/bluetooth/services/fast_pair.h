@@ -97,6 +97,12 @@ struct bt_fast_pair_not_disc_adv_info {
 	 *  @ref bt_fast_pair_battery_set.
 	 */
 	enum bt_fast_pair_adv_battery_mode battery_mode;
+
+	/** Reuse the salt of the previously generated not discoverable advertising data. The
+	 *  Account Key Filter is then reused too, unless the Account Keys or the battery data
+	 *  changed. A new salt should be used whenever the Resolvable Private Address changes.
+	 */
+	bool keep_salt;
 };
 
 /** @brief Fast Pair advertising config. Used to generate advertising packet. */
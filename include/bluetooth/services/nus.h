@@ -18,6 +18,9 @@
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
+#if defined(CONFIG_BT_NUS_STREAM)
+#include <bluetooth/services/nus_stream.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -126,6 +129,40 @@ static inline uint32_t bt_nus_get_mtu(struct bt_conn *conn)
 	return bt_gatt_get_mtu(conn) - 3;
 }
 
+#if defined(CONFIG_BT_NUS_STREAM) || defined(__DOXYGEN__)
+/**@brief Write data to the stream of a connection.
+ *
+ * @details The data is copied to the stream buffer of the connection, and
+ *          sent in notifications as large as the ATT MTU allows. Small
+ *          writes are coalesced while notifications are in flight. When the
+ *          stream buffer is full, the function waits for the notifications
+ *          in flight to free up space.
+ *
+ *          The @ref bt_nus_cb.sent callback is called for every sent
+ *          notification.
+ *
+ * @param[in] conn    Pointer to connection object.
+ * @param[in] data    Pointer to a data buffer.
+ * @param[in] len     Length of the data in the buffer.
+ * @param[in] timeout Time to wait for space in the stream buffer, every time
+ *                    it fills up.
+ *
+ * @return Number of bytes written to the stream, which is less than @p len
+ *         if the timeout expired. Otherwise, a negative error code is
+ *         returned.
+ */
+int bt_nus_stream_send(struct bt_conn *conn, const uint8_t *data, uint16_t len,
+		       k_timeout_t timeout);
+
+/**@brief Get the stream statistics of a connection.
+ *
+ * @param[in] conn Pointer to connection object.
+ *
+ * @return Stream statistics of the connection, since it was established.
+ */
+const struct bt_nus_stream_stats *bt_nus_stream_stats_get(struct bt_conn *conn);
+#endif /* CONFIG_BT_NUS_STREAM */
+
 #ifdef __cplusplus
 }
 #endif
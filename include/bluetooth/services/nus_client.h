@@ -21,6 +21,9 @@ extern "C" {
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/conn.h>
 #include <bluetooth/gatt_dm.h>
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM)
+#include <bluetooth/services/nus_stream.h>
+#endif
 
 /** @brief Handles on the connected peer device that are needed to interact with
  * the device.
@@ -103,6 +106,14 @@ struct bt_nus_client {
 
         /** Application callbacks. */
 	struct bt_nus_client_cb cb;
+
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM)
+        /** Stream to the NUS RX Characteristic. */
+	struct bt_nus_stream stream;
+
+        /** Node in the list of clients, to close the stream on disconnection. */
+	sys_snode_t node;
+#endif
 };
 
 /** @brief NUS Client initialization structure. */
@@ -143,6 +154,33 @@ int bt_nus_client_init(struct bt_nus_client *nus,
 int bt_nus_client_send(struct bt_nus_client *nus, const uint8_t *data,
 		       uint16_t len);
 
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM) || defined(__DOXYGEN__)
+/** @brief Write data to the stream to the server.
+ *
+ * The data is copied to the stream buffer, and written to the RX
+ * Characteristic of the server in Write Without Response commands as large
+ * as the ATT MTU allows. Small writes are coalesced while commands are in
+ * flight. When the stream buffer is full, the function waits for the
+ * commands in flight to free up space.
+ *
+ * The stream is opened by @ref bt_nus_handles_assign, and closed on
+ * disconnection, discarding the data not yet sent. The data is not
+ * reported through the @ref bt_nus_client_cb.sent callback.
+ *
+ * @param[in,out] nus NUS Client instance.
+ * @param[in] data Data to be transmitted.
+ * @param[in] len Length of data.
+ * @param[in] timeout Time to wait for space in the stream buffer, every time
+ *                    it fills up.
+ *
+ * @return Number of bytes written to the stream, which is less than @p len
+ *         if the timeout expired. Otherwise, a negative error code is
+ *         returned.
+ */
+int bt_nus_client_stream_send(struct bt_nus_client *nus, const uint8_t *data,
+			      uint16_t len, k_timeout_t timeout);
+#endif /* CONFIG_BT_NUS_CLIENT_STREAM */
+
 /** @brief Assign handles to the NUS Client instance.
  *
  * This function should be called when a link with a peer has been established
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef BT_NUS_STREAM_H_
+#define BT_NUS_STREAM_H_
+
+/**
+ * @file
+ * @defgroup bt_nus_stream Nordic UART (NUS) stream
+ * @{
+ * @brief Stream interface shared by the NUS Service and the NUS Client.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/bluetooth/conn.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bt_nus_stream;
+
+/** @brief NUS stream statistics. */
+struct bt_nus_stream_stats {
+	/** Number of payload bytes sent. */
+	uint32_t bytes;
+	/** Number of PDUs sent. */
+	uint32_t pdus;
+};
+
+/** @cond INTERNAL_HIDDEN */
+
+/** Transport of a NUS stream, either notifications or write commands. */
+struct bt_nus_stream_transport {
+	/** Send a PDU. Must call @ref bt_nus_stream_sent when the PDU has been
+	 *  sent, if it returns 0.
+	 */
+	int (*send)(struct bt_nus_stream *stream, const uint8_t *data, uint16_t len);
+	/** Get the maximum PDU payload length. */
+	uint16_t (*max_len)(struct bt_nus_stream *stream);
+};
+
+/** @endcond */
+
+/** @brief NUS stream.
+ *
+ *  Coalesces the written data into PDUs of the maximum length allowed by the
+ *  ATT MTU, and keeps up to @kconfig{CONFIG_BT_NUS_STREAM_MAX_IN_FLIGHT}
+ *  PDUs in flight.
+ */
+struct bt_nus_stream {
+	/** Connection of the stream. */
+	struct bt_conn *conn;
+	/** Stream statistics. */
+	struct bt_nus_stream_stats stats;
+
+	/** @cond INTERNAL_HIDDEN */
+	const struct bt_nus_stream_transport *transport;
+	struct ring_buf rb;
+	uint8_t buf[CONFIG_BT_NUS_STREAM_BUF_SIZE];
+	struct k_spinlock lock;
+	struct k_sem space;
+	struct k_work_delayable work;
+	atomic_t in_flight;
+	atomic_t flags;
+	/** @endcond */
+};
+
+/** @cond INTERNAL_HIDDEN */
+
+void bt_nus_stream_init(struct bt_nus_stream *stream,
+			const struct bt_nus_stream_transport *transport);
+
+void bt_nus_stream_open(struct bt_nus_stream *stream, struct bt_conn *conn);
+
+void bt_nus_stream_close(struct bt_nus_stream *stream);
+
+int bt_nus_stream_write(struct bt_nus_stream *stream, const uint8_t *data,
+			uint16_t len, k_timeout_t timeout);
+
+void bt_nus_stream_sent(struct bt_nus_stream *stream);
+
+/** @endcond */
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ *@}
+ */
+
+#endif /* BT_NUS_STREAM_H_ */
@@ -7,6 +7,7 @@
 #define __CPU_LOAD_H
 
 #include <zephyr/types.h>
+#include <zephyr/kernel.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +49,123 @@ uint32_t cpu_load_get(void);
 
 /** @} */
 
+#if defined(CONFIG_CPU_LOAD_ACCOUNTING)
+
+/**
+ * @defgroup cpu_load_acct CPU accounting
+ * @brief Per-thread and per-ISR CPU cycle accounting.
+ *
+ * Companion mode of the CPU load measurement. Cycles measured with
+ * k_cycle_get_32() are charged to the thread or interrupt that was running
+ * between two consecutive context changes.
+ *
+ * @{
+ */
+
+/** @brief Identifier of ISR entries that cannot be mapped to an IRQ line. */
+#define CPU_LOAD_ACCT_IRQ_OTHER UINT16_MAX
+
+/** @brief Type of an accounted execution context. */
+enum cpu_load_acct_type {
+	/** Thread context. */
+	CPU_LOAD_ACCT_THREAD,
+
+	/** Interrupt context. */
+	CPU_LOAD_ACCT_ISR,
+};
+
+/** @brief Accounting entry. */
+struct cpu_load_acct_entry {
+	/** Type of the context. */
+	enum cpu_load_acct_type type;
+
+	union {
+		/** Thread, or NULL for threads that did not fit in the
+		 *  accounting table and threads that exited. Valid for
+		 *  @ref CPU_LOAD_ACCT_THREAD.
+		 */
+		const struct k_thread *thread;
+
+		/** IRQ line, or @ref CPU_LOAD_ACCT_IRQ_OTHER. Valid for
+		 *  @ref CPU_LOAD_ACCT_ISR.
+		 */
+		uint16_t irq;
+	};
+
+	/** Number of cycles spent in the context. */
+	uint64_t cycles;
+
+	/** Number of times the context was entered. */
+	uint32_t count;
+};
+
+/** @brief Sample of the most loading contexts within a sampling window. */
+struct cpu_load_acct_sample {
+	/** Uptime at the end of the window [ms]. */
+	int64_t timestamp;
+
+	/** Length of the window [cycles]. */
+	uint32_t window;
+
+	/** Number of valid entries in @ref top. */
+	uint8_t count;
+
+	/** Most loading contexts, sorted in descending load order.
+	 *  The @ref cpu_load_acct_entry::cycles field holds the cycles
+	 *  spent within the window.
+	 */
+	struct cpu_load_acct_entry top[CONFIG_CPU_LOAD_ACCOUNTING_TOP_N];
+};
+
+/** @brief Callback used to iterate over accounting entries.
+ *
+ * @param entry Accounting entry.
+ * @param user_data User data.
+ */
+typedef void (*cpu_load_acct_cb_t)(const struct cpu_load_acct_entry *entry,
+				   void *user_data);
+
+/** @brief Iterate over all accounting entries.
+ *
+ * Counters are accumulated since the last call to cpu_load_acct_reset().
+ * Entries with zero cycles are skipped.
+ *
+ * @param cb Callback called for every entry.
+ * @param user_data User data passed to the callback.
+ */
+void cpu_load_acct_foreach(cpu_load_acct_cb_t cb, void *user_data);
+
+/** @brief Get the number of cycles accounted since the last reset.
+ *
+ * @return Number of cycles.
+ */
+uint64_t cpu_load_acct_total_get(void);
+
+/** @brief Reset accounting counters and the sample history. */
+void cpu_load_acct_reset(void);
+
+/** @brief Close the current sampling window.
+ *
+ * The most loading contexts of the window are stored in the history ring and,
+ * if enabled, reported as application events. The function is called
+ * periodically if CONFIG_CPU_LOAD_ACCOUNTING_SAMPLE_INTERVAL is not zero.
+ */
+void cpu_load_acct_sample(void);
+
+/** @brief Get a sample from the history ring.
+ *
+ * @param[in] idx Index of the sample, where 0 is the most recent one.
+ * @param[out] sample Sample.
+ *
+ * @retval 0 The sample was copied.
+ * @retval -ENOENT The sample is not available.
+ */
+int cpu_load_acct_history_get(size_t idx, struct cpu_load_acct_sample *sample);
+
+/** @} */
+
+#endif /* CONFIG_CPU_LOAD_ACCOUNTING */
+
 #ifdef __cplusplus
 }
 #endif
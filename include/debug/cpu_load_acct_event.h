@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _CPU_LOAD_ACCT_EVENT_H_
+#define _CPU_LOAD_ACCT_EVENT_H_
+
+/**
+ * @brief CPU Accounting Event
+ * @defgroup cpu_load_acct_event CPU Accounting Event
+ * @{
+ */
+
+#include <app_event_manager.h>
+#include <app_event_manager_profiler_tracer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief CPU accounting event.
+ *
+ * The event is submitted for every top-N entry of a CPU accounting sample.
+ */
+struct cpu_load_acct_event {
+	struct app_event_header header; /**< Event header. */
+
+	uint8_t type; /**< Context type (@ref cpu_load_acct_type). */
+	uint32_t id; /**< Thread address or IRQ line. */
+	uint32_t load; /**< Context load [in 0,001% units]. */
+};
+
+APP_EVENT_TYPE_DECLARE(cpu_load_acct_event);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */
+
+#endif /* _CPU_LOAD_ACCT_EVENT_H_ */
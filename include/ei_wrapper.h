@@ -58,6 +58,17 @@ size_t ei_wrapper_get_frame_size(void);
 size_t ei_wrapper_get_window_size(void);
 
 
+/** Get the size of the data processed by a single prediction.
+ *
+ * If continuous classification is enabled, only a slice of the input window
+ * is processed by a single prediction. Features of the previous slices are
+ * cached by the library. Otherwise, the slice size equals the window size.
+ *
+ * @return Size of the slice, expressed as a number of input values.
+ */
+size_t ei_wrapper_get_slice_size(void);
+
+
 /** Get input data sampling frequency of the classifier.
  *
  * @return The sampling frequency in Hz.
@@ -86,6 +97,8 @@ const char *ei_wrapper_get_classifier_label(size_t idx);
 /** Add input data for the library.
  *
  * Size of the added data must be divisible by input frame size.
+ * The function can be used only if the input data buffer stores floats
+ * (CONFIG_EI_WRAPPER_DATA_TYPE_FLOAT).
  *
  * @param[in] data       Pointer to the buffer with input data.
  * @param[in] data_size  Size of the data (number of floating-point values).
@@ -96,6 +109,40 @@ const char *ei_wrapper_get_classifier_label(size_t idx);
 int ei_wrapper_add_data(const float *data, size_t data_size);
 
 
+/** Add 16-bit integer input data for the library.
+ *
+ * Size of the added data must be divisible by input frame size.
+ * The function can be used only if the input data buffer stores 16-bit
+ * integers (CONFIG_EI_WRAPPER_DATA_TYPE_INT16). The values are converted to
+ * floats without scaling when the library reads them.
+ *
+ * @param[in] data       Pointer to the buffer with input data.
+ * @param[in] data_size  Size of the data (number of values).
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -ENOTSUP If the input data buffer stores other data type.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_add_data_int16(const int16_t *data, size_t data_size);
+
+
+/** Add 8-bit integer input data for the library.
+ *
+ * Size of the added data must be divisible by input frame size.
+ * The function can be used only if the input data buffer stores 8-bit
+ * integers (CONFIG_EI_WRAPPER_DATA_TYPE_INT8). The values are converted to
+ * floats without scaling when the library reads them.
+ *
+ * @param[in] data       Pointer to the buffer with input data.
+ * @param[in] data_size  Size of the data (number of values).
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -ENOTSUP If the input data buffer stores other data type.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_add_data_int8(const int8_t *data, size_t data_size);
+
+
 /** Clear all buffered data.
  *
  * The buffer cannot be cleared if the prediction was already started and the
@@ -118,6 +165,12 @@ int ei_wrapper_clear_data(bool *cancelled);
  * If there is not enough data in the input buffer, the prediction start is
  * delayed until the missing data is added.
  *
+ * If continuous classification is enabled, the prediction processes a single
+ * slice (see @ref ei_wrapper_get_slice_size) and the window and frame shifts
+ * move the slice. Shifting by exactly one slice between predictions allows
+ * the library to reuse features calculated for the previous slices. Any other
+ * shift, or clearing the data, resets the cached features.
+ *
  * @param[in] window_shift  Number of windows the input window is shifted before
  *                          prediction.
  * @param[in] frame_shift   Number of frames the input window is shifted before
@@ -175,6 +228,9 @@ int ei_wrapper_get_anomaly(float *anomaly);
  * If calculating the anomaly value is not supported, anomaly_time is set to
  * the value of -1.
  *
+ * If continuous classification is enabled, dsp_time covers only the processing
+ * of the new slice.
+ *
  * @param[out] dsp_time            Pointer to the variable that is used to store
  *                                 the dsp time.
  * @param[out] classification_time Pointer to the variable that is used to store
@@ -209,6 +209,28 @@ struct esb_evt {
 	uint32_t tx_attempts;	/**< Number of TX retransmission attempts. */
 };
 
+/** @brief Enhanced ShockBurst statistics.
+ *
+ *  ACK latency is the time from the first transmission of a packet until
+ *  its acknowledgment is received, measured with the resolution of the
+ *  system cycle counter.
+ */
+struct esb_stats {
+	uint32_t tx_success;		/**< Packets transmitted successfully. */
+	uint32_t tx_failed;		/**< Packets dropped after all retransmissions. */
+	uint32_t retransmits;		/**< Retransmissions performed. */
+	uint32_t rx_dropped;		/**< Packets dropped because the RX FIFO was full. */
+	uint32_t ack_latency_us_last;	/**< Latency of the last acknowledged packet. */
+	uint32_t ack_latency_us_avg;	/**< Average latency of acknowledged packets. */
+	uint32_t ack_latency_us_max;	/**< Maximum latency of acknowledged packets. */
+	uint8_t tx_fifo_count;		/**< Packets currently in the TX FIFO. */
+	uint8_t tx_fifo_max;		/**< Maximum number of packets in the TX FIFO. */
+	uint8_t rx_fifo_count;		/**< Packets currently in the RX FIFO. */
+	uint8_t rx_fifo_max;		/**< Maximum number of packets in the RX FIFO. */
+	/** Packets currently in the TX FIFO per pipe. */
+	uint8_t tx_pipe_count[CONFIG_ESB_PIPE_COUNT];
+};
+
 /** @brief Event handler prototype. */
 typedef void (*esb_event_handler)(const struct esb_evt *event);
 
@@ -336,7 +358,10 @@ int esb_stop_rx(void);
 
 /** @brief Flush the TX buffer.
  *
- * This function clears the TX FIFO buffer.
+ * This function clears the TX FIFO buffer. A packet that is being transmitted
+ * is removed when its transmission ends. In PRX mode, an ACK payload that has
+ * been sent but not yet confirmed by the next packet on its pipe is kept, as
+ * it is sent again if the packet is retransmitted.
  *
  * @retval 0 If successful.
  *           Otherwise, a (negative) error code is returned.
@@ -344,6 +369,11 @@ int esb_stop_rx(void);
 int esb_flush_tx(void);
 
 /** @brief Pop the first item from the TX buffer.
+ *
+ * If the first item is being transmitted, it is removed when its
+ * transmission ends. Popping it again while it is in flight fails
+ * with -EBUSY. In PRX mode, popping an ACK payload that has been sent but
+ * not yet confirmed fails with -EBUSY.
  *
  * @retval 0 If successful.
  *           Otherwise, a (negative) error code is returned.
@@ -507,6 +537,35 @@ int esb_set_bitrate(enum esb_bitrate bitrate);
  */
 int esb_reuse_pid(uint8_t pipe);
 
+/** @brief Set the TX scheduling weight of a pipe.
+ *
+ *  Packets are queued per pipe and the pipes are served in a round-robin
+ *  fashion. A pipe with a weight of N sends up to N packets in a row before
+ *  the next pipe with pending packets is served. All pipes have a weight of 1
+ *  after @ref esb_init.
+ *
+ *  @param[in] pipe	Pipe.
+ *  @param[in] weight	Weight, at least 1.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_set_tx_pipe_weight(uint8_t pipe, uint8_t weight);
+
+#if defined(CONFIG_ESB_STATS)
+/** @brief Get the statistics.
+ *
+ *  @param[out] stats	Statistics.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_stats_get(struct esb_stats *stats);
+
+/** @brief Reset the statistics. */
+void esb_stats_reset(void);
+#endif /* defined(CONFIG_ESB_STATS) */
+
 /** @} */
 
 #ifdef __cplusplus
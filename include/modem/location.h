@@ -483,6 +483,37 @@ struct location_config {
 	 * location_config_defaults_set() function is called.
 	 */
 	enum location_req_mode mode;
+
+	/**
+	 * @brief Required location accuracy in meters.
+	 *
+	 * @details If a method returns a location with an accuracy value above the threshold,
+	 * the location is stored and the next method in the list is tried as if the method
+	 * failed. The first location meeting the threshold is returned. If no location meets
+	 * the threshold, the most accurate stored location is returned.
+	 *
+	 * For example, with methods Wi-Fi, cellular and GNSS in this order, Wi-Fi scan and
+	 * cellular measurements run in parallel and are sent in a single cloud request,
+	 * and GNSS is started only if the cloud location is not accurate enough.
+	 *
+	 * Applies only to @ref LOCATION_REQ_MODE_FALLBACK. Set to 0 to accept any location.
+	 * Default value is 0. It is applied when location_config_defaults_set() function
+	 * is called.
+	 */
+	float accuracy_threshold;
+
+	/**
+	 * @brief Fuse the locations acquired during the request.
+	 *
+	 * @details If enabled, the returned location is the accuracy-weighted average of
+	 * the locations acquired by the methods that were run because of
+	 * @ref accuracy_threshold. Every location is weighted with the inverse of its
+	 * squared accuracy. The reported method is the method of the most accurate location.
+	 *
+	 * Applies only to @ref LOCATION_REQ_MODE_FALLBACK. Default value is false. It is
+	 * applied when location_config_defaults_set() function is called.
+	 */
+	bool accuracy_fusion;
 };
 
 /**
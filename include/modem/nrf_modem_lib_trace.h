@@ -116,6 +116,32 @@ int nrf_modem_lib_trace_clear(void);
 uint32_t nrf_modem_lib_trace_backend_bitrate_get(void);
 #endif /* defined(CONFIG_NRF_MODEM_LIB_TRACE_BACKEND_BITRATE) || defined(__DOXYGEN__) */
 
+#if defined(CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION) || defined(__DOXYGEN__)
+/** @brief Trace compression statistics. */
+struct nrf_modem_lib_trace_compression_stats {
+	/** Number of trace bytes received from the modem and compressed. */
+	uint32_t bytes_in;
+	/** Number of bytes written to the trace backend, including frame headers. */
+	uint32_t bytes_out;
+	/** Number of frames written to the trace backend. */
+	uint32_t frames;
+	/** Number of frames stored uncompressed because their data did not compress. */
+	uint32_t frames_stored;
+};
+
+/** @brief Get the trace compression statistics.
+ *
+ * The compression ratio is given by @c bytes_out divided by @c bytes_in.
+ * The statistics are reset when the trace backend is initialized.
+ *
+ * @param stats Statistics.
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -EINVAL If @p stats is @c NULL.
+ */
+int nrf_modem_lib_trace_compression_stats_get(struct nrf_modem_lib_trace_compression_stats *stats);
+#endif /* defined(CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION) || defined(__DOXYGEN__) */
+
 /** @} */
 
 #ifdef __cplusplus
@@ -192,6 +192,38 @@ typedef void (*wifi_credentials_ssid_cb)(void *cb_arg, const char *ssid, size_t
  */
 void wifi_credentials_for_each_ssid(wifi_credentials_ssid_cb cb, void *cb_arg);
 
+/**
+ * @brief SSID to match against the stored credentials.
+ */
+struct wifi_credentials_ssid {
+	const char *ssid;
+	size_t ssid_len;
+};
+
+/**
+ * @brief Check which SSIDs of a list have stored credentials.
+ * @note This uses the SSID index in RAM only and does not access the storage backend.
+ *       It can be used to match all the networks found in a scan at once.
+ *
+ * @param[in] ssids		SSIDs to look for
+ * @param[in] count		number of SSIDs
+ * @param[out] matched		array of @p count entries, set to true for each SSID
+ *				with stored credentials
+ *
+ * @return			Number of SSIDs with stored credentials.
+ * @return -EINVAL		A required buffer was NULL.
+ */
+int wifi_credentials_match_ssids(const struct wifi_credentials_ssid *ssids, size_t count,
+				 bool *matched);
+
+/**
+ * @brief Clear the cache of loaded credentials.
+ * @note Cached credentials are kept in RAM in plain text. Call this to wipe them,
+ *       for example before entering a low power state.
+ *       Does nothing if @kconfig{CONFIG_WIFI_CREDENTIALS_CACHE_SIZE} is 0.
+ */
+void wifi_credentials_cache_invalidate(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,15 @@ LOG_MODULE_REGISTER(ei_wrapper, CONFIG_EI_WRAPPER_LOG_LEVEL);
 
 BUILD_ASSERT(CONFIG_EI_WRAPPER_THREAD_STACK_SIZE > 0);
 
+#if defined(CONFIG_EI_WRAPPER_CONTINUOUS)
+/* Only the new slice is processed. Features of previous slices are cached
+ * by the library. The slice size is given in samples per axis.
+ */
+#define PROCESS_WINDOW_SIZE	(EI_CLASSIFIER_SLICE_SIZE * INPUT_FRAME_SIZE)
+#else
+#define PROCESS_WINDOW_SIZE	INPUT_WINDOW_SIZE
+#endif
+
 #define DATA_BUFFER_SIZE	CONFIG_EI_WRAPPER_DATA_BUF_SIZE
 #define THREAD_STACK_SIZE	CONFIG_EI_WRAPPER_THREAD_STACK_SIZE
 #define THREAD_PRIORITY 	CONFIG_EI_WRAPPER_THREAD_PRIORITY
@@ -32,11 +41,21 @@ enum state {
 	STATE_READY,
 };
 
+#if defined(CONFIG_EI_WRAPPER_DATA_TYPE_INT8)
+typedef int8_t data_t;
+#elif defined(CONFIG_EI_WRAPPER_DATA_TYPE_INT16)
+typedef int16_t data_t;
+#else
+typedef float data_t;
+#endif
+
 struct data_buffer {
-	float buf[DATA_BUFFER_SIZE];
+	data_t buf[DATA_BUFFER_SIZE];
 	size_t process_idx;
 	size_t append_idx;
 	size_t wait_data_size;
+	size_t next_slice_move;
+	bool slices_cached;
 	struct k_spinlock lock;
 	enum state state;
 };
@@ -55,6 +74,7 @@ static ei_wrapper_result_ready_cb user_cb;
 
 BUILD_ASSERT(DATA_BUFFER_SIZE > INPUT_WINDOW_SIZE);
 BUILD_ASSERT(INPUT_WINDOW_SIZE % INPUT_FRAME_SIZE == 0);
+BUILD_ASSERT(PROCESS_WINDOW_SIZE % INPUT_FRAME_SIZE == 0);
 
 
 static size_t buf_get_collected_data_count(const struct data_buffer *b)
@@ -70,7 +90,7 @@ static size_t buf_calc_free_space(const struct data_buffer *b)
 {
 	if (b->wait_data_size > 0) {
 		return b->wait_data_size + ARRAY_SIZE(b->buf) -
-		       INPUT_WINDOW_SIZE - 1;
+		       PROCESS_WINDOW_SIZE - 1;
 	}
 
 	return ARRAY_SIZE(b->buf) - buf_get_collected_data_count(b) - 1;
@@ -103,6 +123,8 @@ static int buf_cleanup(struct data_buffer *b, bool *cancelled)
 		b->process_idx = 0;
 		b->append_idx = 0;
 		b->wait_data_size = 0;
+		b->next_slice_move = 0;
+		b->slices_cached = false;
 		b->state = STATE_READY;
 	}
 
@@ -111,7 +133,7 @@ static int buf_cleanup(struct data_buffer *b, bool *cancelled)
 	return err;
 }
 
-static int buf_append(struct data_buffer *b, const float *data, size_t len,
+static int buf_append(struct data_buffer *b, const data_t *data, size_t len,
 		      bool *process_buf)
 {
 	*process_buf = false;
@@ -159,10 +181,24 @@ static int buf_append(struct data_buffer *b, const float *data, size_t len,
 	return 0;
 }
 
+static void data_to_float(float *dst, const data_t *src, size_t len)
+{
+#if defined(CONFIG_EI_WRAPPER_DATA_TYPE_FLOAT)
+	memcpy(dst, src, len * sizeof(src[0]));
+#else
+	/* Conversion is done only when the library reads the data, so that
+	 * it does not slow down the sampling path.
+	 */
+	for (size_t i = 0; i < len; i++) {
+		dst[i] = src[i];
+	}
+#endif
+}
+
 static void buf_get(const struct data_buffer *b, float *b_res, size_t offset,
 		    size_t len)
 {
-	__ASSERT_NO_MSG((offset + len) <= INPUT_WINDOW_SIZE);
+	__ASSERT_NO_MSG((offset + len) <= PROCESS_WINDOW_SIZE);
 
 	/* Processing index cannot change while processing is done. */
 	__ASSERT_NO_MSG(b->state == STATE_PROCESSING);
@@ -173,15 +209,13 @@ static void buf_get(const struct data_buffer *b, float *b_res, size_t offset,
 	if ((read_end > ARRAY_SIZE(b->buf)) && (read_start < ARRAY_SIZE(b->buf))) {
 		size_t copy_cnt = ARRAY_SIZE(b->buf) - read_start;
 
-		memcpy(b_res, &b->buf[read_start],
-		       copy_cnt * sizeof(b->buf[0]));
-		memcpy(b_res + copy_cnt, &b->buf[0],
-		       (len - copy_cnt) * sizeof(b->buf[0]));
+		data_to_float(b_res, &b->buf[read_start], copy_cnt);
+		data_to_float(b_res + copy_cnt, &b->buf[0], len - copy_cnt);
 	} else {
 		if (read_start >= ARRAY_SIZE(b->buf)) {
 			read_start -= ARRAY_SIZE(b->buf);
 		}
-		memcpy(b_res, &b->buf[read_start], len * sizeof(b->buf[0]));
+		data_to_float(b_res, &b->buf[read_start], len);
 	}
 }
 
@@ -202,12 +236,18 @@ static int buf_processing_move(struct data_buffer *b, size_t move,
 
 	size_t max_move = buf_get_collected_data_count(b);
 
+	/* Cached features can be reused only if the slices are consecutive. */
+	if (move != b->next_slice_move) {
+		b->slices_cached = false;
+	}
+	b->next_slice_move = PROCESS_WINDOW_SIZE;
+
 	b->process_idx += move;
 	if (b->process_idx >= ARRAY_SIZE(b->buf)) {
 		b->process_idx -= ARRAY_SIZE(b->buf);
 	}
 
-	size_t processing_end_move = move + INPUT_WINDOW_SIZE;
+	size_t processing_end_move = move + PROCESS_WINDOW_SIZE;
 
 	if (processing_end_move > max_move) {
 		b->wait_data_size = processing_end_move - max_move;
@@ -236,6 +276,11 @@ size_t ei_wrapper_get_window_size(void)
 	return INPUT_WINDOW_SIZE;
 }
 
+size_t ei_wrapper_get_slice_size(void)
+{
+	return PROCESS_WINDOW_SIZE;
+}
+
 size_t ei_wrapper_get_classifier_frequency(void)
 {
 	return INPUT_FREQUENCY;
@@ -257,7 +302,7 @@ const char *ei_wrapper_get_classifier_label(size_t idx)
 	return ei_classifier_inferencing_categories[idx];
 }
 
-int ei_wrapper_add_data(const float *data, size_t data_size)
+static int add_data(const data_t *data, size_t data_size)
 {
 	if (data_size % INPUT_FRAME_SIZE) {
 		return -EINVAL;
@@ -273,6 +318,33 @@ int ei_wrapper_add_data(const float *data, size_t data_size)
 	return err;
 }
 
+int ei_wrapper_add_data(const float *data, size_t data_size)
+{
+#if defined(CONFIG_EI_WRAPPER_DATA_TYPE_FLOAT)
+	return add_data(data, data_size);
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int ei_wrapper_add_data_int16(const int16_t *data, size_t data_size)
+{
+#if defined(CONFIG_EI_WRAPPER_DATA_TYPE_INT16)
+	return add_data(data, data_size);
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int ei_wrapper_add_data_int8(const int8_t *data, size_t data_size)
+{
+#if defined(CONFIG_EI_WRAPPER_DATA_TYPE_INT8)
+	return add_data(data, data_size);
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int ei_wrapper_clear_data(bool *cancelled)
 {
 	return buf_cleanup(&ei_input, cancelled);
@@ -318,15 +390,26 @@ static void edge_impulse_thread_fn(void)
 		k_sem_take(&ei_sem, K_FOREVER);
 
 		features_signal.get_data = &raw_feature_get_data;
-		features_signal.total_length = INPUT_WINDOW_SIZE;
+		features_signal.total_length = PROCESS_WINDOW_SIZE;
 
 		if (IS_ENABLED(CONFIG_EI_WRAPPER_PROFILING)) {
 			start_time = k_uptime_get();
 		}
 
 		/* Invoke the impulse. */
+#if defined(CONFIG_EI_WRAPPER_CONTINUOUS)
+		/* Buffer state cannot change while processing is done. */
+		if (!ei_input.slices_cached) {
+			run_classifier_init();
+			ei_input.slices_cached = true;
+		}
+
+		EI_IMPULSE_ERROR err = run_classifier_continuous(&features_signal,
+								 &ei_result, DEBUG_MODE);
+#else
 		EI_IMPULSE_ERROR err = run_classifier(&features_signal,
 						      &ei_result, DEBUG_MODE);
+#endif
 		if (IS_ENABLED(CONFIG_EI_WRAPPER_PROFILING)) {
 			int64_t delta = k_uptime_delta(&start_time);
 
@@ -134,6 +134,8 @@ int location_request(const struct location_config *config)
 			default_config.interval = config->interval;
 			default_config.timeout = config->timeout;
 			default_config.mode = config->mode;
+			default_config.accuracy_threshold = config->accuracy_threshold;
+			default_config.accuracy_fusion = config->accuracy_fusion;
 		} else {
 			LOG_DBG("No configuration given. Using default configuration.");
 		}
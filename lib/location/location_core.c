@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <modem/location.h>
@@ -289,6 +290,11 @@ int location_core_validate_params(const struct location_config *config)
 		return -EINVAL;
 	}
 
+	if (config->accuracy_threshold < 0) {
+		LOG_ERR("Invalid accuracy threshold");
+		return -EINVAL;
+	}
+
 	for (int i = 0; i < config->methods_count; i++) {
 		/* Check if the method is valid */
 		method_api = location_method_api_get(config->methods[i].method);
@@ -311,6 +317,8 @@ void location_core_config_log(const struct location_config *config)
 	LOG_DBG("  Interval: %d", config->interval);
 	LOG_DBG("  Timeout: %dms", config->timeout);
 	LOG_DBG("  Mode: %d", config->mode);
+	LOG_DBG("  Accuracy threshold: %dm", (int)config->accuracy_threshold);
+	LOG_DBG("  Accuracy fusion: %d", config->accuracy_fusion);
 	LOG_DBG("  List of methods:");
 
 	for (uint8_t i = 0; i < config->methods_count; i++) {
@@ -370,6 +378,10 @@ static int location_core_location_get_pos(void)
 		k_uptime_get() + loc_req_info.config.timeout : SYS_FOREVER_MS;
 	loc_req_info.execute_fallback = true;
 	loc_req_info.current_method_index = 0;
+	loc_req_info.best_valid = false;
+	loc_req_info.fusion_weight_sum = 0;
+	loc_req_info.fusion_latitude_sum = 0;
+	loc_req_info.fusion_longitude_sum = 0;
 	requested_method = loc_req_info.methods[loc_req_info.current_method_index];
 	LOG_DBG("Requesting location with '%s' method",
 		(char *)location_method_api_get(requested_method)->method_string);
@@ -645,6 +657,69 @@ enum location_method location_core_event_method_resolve(enum location_method met
 #endif
 }
 
+static double location_core_longitude_wrap(double longitude)
+{
+	if (longitude > 180.0) {
+		longitude -= 360.0;
+	} else if (longitude < -180.0) {
+		longitude += 360.0;
+	}
+
+	return longitude;
+}
+
+/** Store the location of the current event so that it can be used if no method meets
+ *  the accuracy threshold.
+ */
+static void location_core_location_store(void)
+{
+	const struct location_event_data *event = &loc_req_info.current_event_data;
+
+	if (!loc_req_info.best_valid ||
+	    event->location.accuracy < loc_req_info.best_event_data.location.accuracy) {
+		loc_req_info.best_event_data = *event;
+		loc_req_info.best_valid = true;
+	}
+
+	if (!loc_req_info.config.accuracy_fusion || event->location.accuracy <= 0) {
+		return;
+	}
+
+	double weight = 1.0 / ((double)event->location.accuracy * event->location.accuracy);
+
+	if (loc_req_info.fusion_weight_sum == 0) {
+		loc_req_info.fusion_longitude_ref = event->location.longitude;
+	}
+
+	loc_req_info.fusion_weight_sum += weight;
+	loc_req_info.fusion_latitude_sum += weight * event->location.latitude;
+	loc_req_info.fusion_longitude_sum += weight * location_core_longitude_wrap(
+		event->location.longitude - loc_req_info.fusion_longitude_ref);
+}
+
+/** Replace the current event with the most accurate or fused location, if any. */
+static void location_core_location_select(void)
+{
+	if (!loc_req_info.best_valid) {
+		return;
+	}
+
+	loc_req_info.current_event_data = loc_req_info.best_event_data;
+
+	if (loc_req_info.fusion_weight_sum > 0) {
+		struct location_data *location = &loc_req_info.current_event_data.location;
+
+		location->latitude =
+			loc_req_info.fusion_latitude_sum / loc_req_info.fusion_weight_sum;
+		location->longitude = location_core_longitude_wrap(
+			loc_req_info.fusion_longitude_ref +
+			loc_req_info.fusion_longitude_sum / loc_req_info.fusion_weight_sum);
+		location->accuracy = 1.0 / sqrt(loc_req_info.fusion_weight_sum);
+
+		LOG_DBG("Fused location accuracy: %dm", (int)location->accuracy);
+	}
+}
+
 static void location_core_event_cb_fn(struct k_work *work)
 {
 	char latitude_str[12];
@@ -660,6 +735,35 @@ static void location_core_event_cb_fn(struct k_work *work)
 	/* Update the event structure with the details of the current method */
 	location_core_event_details_get(&loc_req_info.current_event_data);
 
+	if (loc_req_info.config.mode == LOCATION_REQ_MODE_FALLBACK &&
+	    loc_req_info.config.accuracy_threshold > 0 &&
+	    loc_req_info.current_event_data.id == LOCATION_EVT_LOCATION) {
+		location_core_location_store();
+
+		if (loc_req_info.current_event_data.location.accuracy >
+			loc_req_info.config.accuracy_threshold &&
+		    loc_req_info.execute_fallback &&
+		    loc_req_info.current_method_index + 1 < loc_req_info.methods_count) {
+			/* Not accurate enough, try next method */
+			loc_req_info.current_method_index++;
+			requested_method = loc_req_info.methods[loc_req_info.current_method_index];
+
+			sprintf(accuracy_str, "%.01f",
+				loc_req_info.current_event_data.location.accuracy);
+			LOG_INF("Location accuracy %s m using '%s' above threshold, "
+				"trying with '%s' next",
+				accuracy_str,
+				(char *)location_method_api_get(
+					loc_req_info.current_method)->method_string,
+				(char *)location_method_api_get(requested_method)->method_string);
+
+			location_core_current_event_data_init(requested_method);
+			err = location_method_api_get(requested_method)->location_get(
+				&loc_req_info);
+			return;
+		}
+	}
+
 	if (loc_req_info.current_event_data.id == LOCATION_EVT_LOCATION) {
 		/* Location was acquired properly.
 		 * Caller sets loc_req_info.current_event_data.location
@@ -751,6 +855,13 @@ static void location_core_event_cb_fn(struct k_work *work)
 		}
 	}
 
+	if (loc_req_info.config.mode == LOCATION_REQ_MODE_FALLBACK) {
+		/* Use the most accurate or fused location if a location was acquired by
+		 * a method that did not meet the accuracy threshold.
+		 */
+		location_core_location_select();
+	}
+
 	event_handler(&loc_req_info.current_event_data);
 
 	k_work_cancel_delayable(&location_core_timeout_work);
@@ -37,6 +37,20 @@ struct location_request_info {
 	/** Whether to perform fallback for current location request processing. */
 	bool execute_fallback;
 
+	/** Most accurate location acquired during the request. */
+	struct location_event_data best_event_data;
+
+	/** Whether best_event_data contains a location. */
+	bool best_valid;
+
+	/** Accuracy-weighted sums of the acquired locations used for location fusion. */
+	double fusion_weight_sum;
+	double fusion_latitude_sum;
+	double fusion_longitude_sum;
+
+	/** Longitude the fused longitudes are relative to, to handle the antimeridian. */
+	double fusion_longitude_ref;
+
 	/**
 	 * Device uptime when location request timer expires.
 	 * This is used in cloud location method to calculate timeout for the cloud operation.
@@ -16,6 +16,10 @@
 #include <nrf_modem_trace.h>
 #include <nrf_errno.h>
 
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+#include "trace_compress.h"
+#endif
+
 LOG_MODULE_REGISTER(nrf_modem_lib_trace, CONFIG_NRF_MODEM_LIB_LOG_LEVEL);
 
 K_SEM_DEFINE(trace_sem, 0, 1);
@@ -231,16 +235,19 @@ int nrf_modem_lib_trace_processing_done_wait(k_timeout_t timeout)
 	return 0;
 }
 
-static int trace_fragment_write(struct nrf_modem_trace_data *frag)
+/* Number of bytes of the data being written that the backend has already taken. It is kept
+ * when writing fails, so that the data is not written twice when the write is retried.
+ */
+static size_t write_offset;
+
+static int backend_write(const uint8_t *data, size_t len)
 {
 	int ret;
-	size_t remaining = frag->len;
 
-	while (remaining) {
+	while (write_offset < len) {
 		PERF_START();
 
-		ret = trace_backend.write((void *)((uint8_t *)frag->data + frag->len - remaining),
-					  remaining);
+		ret = trace_backend.write(data + write_offset, len - write_offset);
 
 		PERF_END(ret);
 
@@ -266,12 +273,106 @@ static int trace_fragment_write(struct nrf_modem_trace_data *frag)
 			return ret;
 		}
 
-		remaining -= ret;
+		write_offset += ret;
+	}
+
+	write_offset = 0;
+
+	return 0;
+}
+
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+static struct trace_compress compress;
+
+/* Number of bytes of the current fragment consumed by the compressor. It is kept when
+ * writing a frame fails, so that the fragment is not compressed twice when it is retried.
+ */
+static size_t frag_offset;
+
+/* Fragments are released once they are copied to the compressor. The backend reports
+ * the progress on compressed frames, which must not be forwarded to the modem library.
+ */
+static int trace_frame_processed(size_t len)
+{
+	ARG_UNUSED(len);
+
+	return 0;
+}
+
+static int trace_frame_write(void)
+{
+	int err;
+	size_t len;
+	const uint8_t *frame = trace_compress_frame_get(&compress, &len);
+
+	if (!frame) {
+		return 0;
+	}
+
+	err = backend_write(frame, len);
+	if (err) {
+		return err;
+	}
+
+	trace_compress_frame_release(&compress);
+
+	return 0;
+}
+
+static int trace_fragment_write(struct nrf_modem_trace_data *frag, bool last)
+{
+	int err;
+
+	while (frag_offset < frag->len) {
+		err = trace_frame_write();
+		if (err) {
+			return err;
+		}
+
+		frag_offset += trace_compress_feed(&compress,
+						   (const uint8_t *)frag->data + frag_offset,
+						   frag->len - frag_offset);
 	}
 
+	/* Do not hold back the end of a batch until the modem emits more traces. */
+	if (last) {
+		trace_compress_flush(&compress);
+
+		err = trace_frame_write();
+		if (err) {
+			return err;
+		}
+	}
+
+	frag_offset = 0;
+	nrf_modem_trace_processed(frag->len);
+
 	return 0;
 }
 
+int nrf_modem_lib_trace_compression_stats_get(struct nrf_modem_lib_trace_compression_stats *stats)
+{
+	if (!stats) {
+		return -EINVAL;
+	}
+
+	*stats = compress.stats;
+
+	return 0;
+}
+
+#define TRACE_PROCESSED_CB trace_frame_processed
+#else
+static int trace_fragment_write(struct nrf_modem_trace_data *frag, bool last)
+{
+	ARG_UNUSED(last);
+
+	return backend_write(frag->data, frag->len);
+}
+
+#define TRACE_PROCESSED_CB nrf_modem_trace_processed
+#endif /* CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION */
+
 void trace_thread_handler(void)
 {
 	int err;
@@ -314,7 +415,7 @@ trace_reset:
 		}
 
 		for (int i = 0; i < n_frags; i++) {
-			err = trace_fragment_write(&frags[i]);
+			err = trace_fragment_write(&frags[i], i == n_frags - 1);
 			switch (err) {
 			case 0:
 				break;
@@ -358,7 +459,14 @@ static int trace_init(void)
 
 	k_sem_take(&trace_done_sem, K_FOREVER);
 
-	err = trace_backend.init(nrf_modem_trace_processed);
+	write_offset = 0;
+
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+	trace_compress_init(&compress);
+	frag_offset = 0;
+#endif
+
+	err = trace_backend.init(TRACE_PROCESSED_CB);
 	if (err) {
 		LOG_ERR("trace_backend: init failed with err: %d", err);
 		return err;
@@ -13,6 +13,13 @@
 #include <zephyr/logging/log.h>
 #include <modem/trace_backend.h>
 
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+#include "trace_compress.h"
+
+BUILD_ASSERT(TRACE_COMPRESS_FRAME_MAX_LEN <= CONFIG_NRF_MODEM_LIB_TRACE_BACKEND_RAM_LENGTH,
+	     "RAM buffer cannot hold a compressed frame");
+#endif
+
 LOG_MODULE_REGISTER(modem_trace_backend, CONFIG_MODEM_TRACE_BACKEND_LOG_LEVEL);
 
 
@@ -24,6 +31,13 @@ static __noinit uint8_t _ring_buffer_data_ram_trace_buf[
 __noinit struct ring_buf ram_trace_buf;
 __noinit uint32_t ram_trace_buf_magic;
 
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+/* Bytes from the read position to the next frame boundary, left by a read that
+ * stopped inside a frame.
+ */
+static __noinit uint32_t frame_offset;
+#endif
+
 static trace_backend_processed_cb trace_processed_callback;
 
 static bool is_initialized(void)
@@ -31,12 +45,51 @@ static bool is_initialized(void)
 	return ram_trace_buf_magic == 0xdeadbeed;
 }
 
+static void buf_reset(void)
+{
+	ring_buf_reset(&ram_trace_buf);
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+	frame_offset = 0;
+#endif
+}
+
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+/* Find the next frame boundary after reading len bytes of data. */
+static void frame_offset_update(const uint8_t *data, size_t len)
+{
+	uint8_t hdr[TRACE_COMPRESS_HDR_LEN];
+	size_t pos = frame_offset;
+
+	while (pos < len) {
+		size_t hdr_part = MIN(len - pos, sizeof(hdr));
+		size_t frame_len = 0;
+
+		/* The end of the header may still be in the buffer. */
+		memcpy(hdr, &data[pos], hdr_part);
+		if (ring_buf_peek(&ram_trace_buf, &hdr[hdr_part], sizeof(hdr) - hdr_part) ==
+		    sizeof(hdr) - hdr_part) {
+			frame_len = trace_compress_frame_len(hdr);
+		}
+
+		if (frame_len == 0) {
+			/* Not a frame, the oldest data is dropped as such. */
+			frame_offset = 0;
+			return;
+		}
+
+		pos += frame_len;
+	}
+
+	frame_offset = pos - len;
+}
+#endif
+
 int trace_backend_init(trace_backend_processed_cb trace_processed_cb)
 {
 	if (!is_initialized()) {
 		ram_trace_buf.buffer = _ring_buffer_data_ram_trace_buf;
 		ram_trace_buf.size = ARRAY_SIZE(_ring_buffer_data_ram_trace_buf);
-		ring_buf_reset(&ram_trace_buf);
+		buf_reset();
 		ram_trace_buf_magic = 0xdeadbeed;
 	}
 	trace_processed_callback = trace_processed_cb;
@@ -62,7 +115,50 @@ int trace_backend_read(void *buf, size_t len)
 	if (!is_initialized()) {
 		return -EPERM;
 	}
-	return ring_buf_get(&ram_trace_buf, buf, len);
+
+	uint32_t read_len = ring_buf_get(&ram_trace_buf, buf, len);
+
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+	frame_offset_update(buf, read_len);
+#endif
+
+	return read_len;
+}
+
+/* Drop at least len bytes of the oldest trace data. */
+static void oldest_drop(uint32_t len)
+{
+#if CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION
+	/* Every write is a whole frame. Drop whole frames too, so that the buffer always
+	 * starts at a frame boundary and all the frames that are kept can be decoded.
+	 */
+	uint8_t hdr[TRACE_COMPRESS_HDR_LEN];
+	uint32_t dropped;
+
+	/* Drop the rest of a frame that has been partially read. */
+	dropped = ring_buf_get(&ram_trace_buf, NULL, frame_offset);
+	frame_offset = 0;
+
+	while (dropped < len) {
+		size_t frame_len = 0;
+
+		if (ring_buf_peek(&ram_trace_buf, hdr, sizeof(hdr)) == sizeof(hdr)) {
+			frame_len = trace_compress_frame_len(hdr);
+		}
+
+		if (frame_len == 0) {
+			/* Not a frame, for example data kept over a reset with another
+			 * configuration.
+			 */
+			buf_reset();
+			return;
+		}
+
+		dropped += ring_buf_get(&ram_trace_buf, NULL, frame_len);
+	}
+#else
+	ring_buf_get(&ram_trace_buf, NULL, len);
+#endif
 }
 
 int trace_backend_write(const void *data, size_t len)
@@ -73,13 +169,13 @@ int trace_backend_write(const void *data, size_t len)
 	if (len > ring_buf_capacity_get(&ram_trace_buf)) {
 		LOG_ERR("trace_backend_write called with more data then buffer can store!");
 		len = ring_buf_capacity_get(&ram_trace_buf);
-		ring_buf_reset(&ram_trace_buf);
+		buf_reset();
 	}
 
 	uint32_t free_space = ring_buf_space_get(&ram_trace_buf);
 
 	if (len > free_space) {
-		ring_buf_get(&ram_trace_buf, NULL, len - free_space);
+		oldest_drop(len - free_space);
 	}
 
 	int result = ring_buf_put(&ram_trace_buf, data, len);
@@ -94,7 +190,7 @@ int trace_backend_clear(void)
 	if (!is_initialized()) {
 		return -EPERM;
 	}
-	ring_buf_reset(&ram_trace_buf);
+	buf_reset();
 	return 0;
 }
 
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+#include "trace_compress.h"
+
+BUILD_ASSERT(CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE <= UINT16_MAX,
+	     "Frame size must fit the 16-bit length fields");
+
+/* LZ4 block format parameters. A match is at least MINMATCH bytes long, the last
+ * LASTLITERALS bytes are always literals and the last match starts at least MFLIMIT
+ * bytes before the end of the block.
+ */
+#define MINMATCH 4
+#define LASTLITERALS 5
+#define MFLIMIT 12
+#define RUN_MASK 0x0F
+
+#define HASH_BITS CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_HASH_BITS
+
+static uint32_t read32(const uint8_t *p)
+{
+	uint32_t val;
+
+	memcpy(&val, p, sizeof(val));
+
+	return val;
+}
+
+static uint32_t hash(uint32_t seq)
+{
+	return (seq * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static uint8_t *length_put(uint8_t *op, size_t len)
+{
+	while (len >= UINT8_MAX) {
+		*op++ = UINT8_MAX;
+		len -= UINT8_MAX;
+	}
+
+	*op++ = len;
+
+	return op;
+}
+
+/* Worst case size of a sequence with the given number of literals. */
+static size_t sequence_size_max(size_t lit_len, size_t match_len)
+{
+	return 1 + lit_len + lit_len / UINT8_MAX + 1 + 2 + match_len / UINT8_MAX + 1;
+}
+
+static uint8_t *sequence_put(uint8_t *op, const uint8_t *lit, size_t lit_len,
+			     uint16_t offset, size_t match_len)
+{
+	uint8_t *token = op++;
+
+	*token = MIN(lit_len, RUN_MASK) << 4;
+	if (lit_len >= RUN_MASK) {
+		op = length_put(op, lit_len - RUN_MASK);
+	}
+
+	memcpy(op, lit, lit_len);
+	op += lit_len;
+
+	if (match_len == 0) {
+		/* Last sequence, literals only. */
+		return op;
+	}
+
+	*op++ = offset & 0xFF;
+	*op++ = offset >> 8;
+
+	match_len -= MINMATCH;
+	*token |= MIN(match_len, RUN_MASK);
+	if (match_len >= RUN_MASK) {
+		op = length_put(op, match_len - RUN_MASK);
+	}
+
+	return op;
+}
+
+/* Compress a block. Returns the compressed length, or 0 if it does not fit @p dst_size. */
+static size_t block_compress(uint16_t *table, const uint8_t *src, size_t len,
+			     uint8_t *dst, size_t dst_size)
+{
+	const uint8_t *ip = src;
+	const uint8_t *anchor = src;
+	const uint8_t *const iend = src + len;
+	uint8_t *op = dst;
+	uint8_t *const oend = dst + dst_size;
+
+	memset(table, 0, sizeof(uint16_t) << HASH_BITS);
+
+	if (len > MFLIMIT) {
+		const uint8_t *const mflimit = iend - MFLIMIT;
+		const uint8_t *const matchlimit = iend - LASTLITERALS;
+
+		ip++;
+
+		while (ip < mflimit) {
+			uint32_t h = hash(read32(ip));
+			const uint8_t *match = src + table[h];
+			size_t match_len = MINMATCH;
+
+			table[h] = ip - src;
+
+			if ((match >= ip) || (read32(match) != read32(ip))) {
+				ip++;
+				continue;
+			}
+
+			while ((ip > anchor) && (match > src) && (ip[-1] == match[-1])) {
+				ip--;
+				match--;
+			}
+
+			while ((ip + match_len < matchlimit) && (ip[match_len] == match[match_len])) {
+				match_len++;
+			}
+
+			if (sequence_size_max(ip - anchor, match_len) > oend - op) {
+				return 0;
+			}
+
+			op = sequence_put(op, anchor, ip - anchor, ip - match, match_len);
+
+			ip += match_len;
+			anchor = ip;
+		}
+	}
+
+	if (sequence_size_max(iend - anchor, 0) > oend - op) {
+		return 0;
+	}
+
+	op = sequence_put(op, anchor, iend - anchor, 0, 0);
+
+	return op - dst;
+}
+
+static int length_get(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+	uint8_t b;
+
+	do {
+		if (*ip >= iend) {
+			return -EBADMSG;
+		}
+
+		b = *(*ip)++;
+		*len += b;
+	} while (b == UINT8_MAX);
+
+	return 0;
+}
+
+/* Decompress a block. Returns the decompressed length, or a negative error code if the
+ * block is malformed or does not fit @p dst_size.
+ */
+static int block_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size)
+{
+	const uint8_t *ip = src;
+	const uint8_t *const iend = src + len;
+	uint8_t *op = dst;
+	uint8_t *const oend = dst + dst_size;
+
+	while (ip < iend) {
+		uint8_t token = *ip++;
+		size_t lit_len = token >> 4;
+		size_t match_len = token & RUN_MASK;
+		size_t offset;
+
+		if ((lit_len == RUN_MASK) && length_get(&ip, iend, &lit_len)) {
+			return -EBADMSG;
+		}
+
+		if ((lit_len > iend - ip) || (lit_len > oend - op)) {
+			return -EBADMSG;
+		}
+
+		memcpy(op, ip, lit_len);
+		ip += lit_len;
+		op += lit_len;
+
+		if (ip == iend) {
+			break;
+		}
+
+		if (iend - ip < 2) {
+			return -EBADMSG;
+		}
+
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		if ((match_len == RUN_MASK) && length_get(&ip, iend, &match_len)) {
+			return -EBADMSG;
+		}
+
+		match_len += MINMATCH;
+
+		if ((offset == 0) || (offset > op - dst) || (match_len > oend - op)) {
+			return -EBADMSG;
+		}
+
+		/* Byte by byte, the match can overlap the output. */
+		for (size_t i = 0; i < match_len; i++) {
+			op[i] = op[i - offset];
+		}
+
+		op += match_len;
+	}
+
+	return op - dst;
+}
+
+static void frame_close(struct trace_compress *ctx)
+{
+	uint8_t *hdr = ctx->frame;
+	uint8_t *payload = ctx->frame + TRACE_COMPRESS_HDR_LEN;
+	size_t payload_len;
+	uint8_t flags = 0;
+
+	/* Store the data as is, unless compression saves space. */
+	payload_len = block_compress(ctx->table, ctx->buf, ctx->buf_len, payload,
+				     ctx->buf_len - 1);
+	if (payload_len == 0) {
+		memcpy(payload, ctx->buf, ctx->buf_len);
+		payload_len = ctx->buf_len;
+		flags |= TRACE_COMPRESS_FLAG_STORED;
+		ctx->stats.frames_stored++;
+	}
+
+	hdr[0] = TRACE_COMPRESS_MAGIC_0;
+	hdr[1] = TRACE_COMPRESS_MAGIC_1;
+	hdr[2] = flags;
+	hdr[3] = ctx->seq++;
+	hdr[4] = ctx->buf_len & 0xFF;
+	hdr[5] = ctx->buf_len >> 8;
+	hdr[6] = payload_len & 0xFF;
+	hdr[7] = payload_len >> 8;
+	hdr[8] = crc8_ccitt(0xFF, payload, payload_len);
+	hdr[9] = crc8_ccitt(0xFF, hdr, TRACE_COMPRESS_HDR_LEN - 1);
+
+	ctx->frame_len = TRACE_COMPRESS_HDR_LEN + payload_len;
+
+	ctx->stats.frames++;
+	ctx->stats.bytes_in += ctx->buf_len;
+	ctx->stats.bytes_out += ctx->frame_len;
+
+	ctx->buf_len = 0;
+}
+
+void trace_compress_init(struct trace_compress *ctx)
+{
+	ctx->buf_len = 0;
+	ctx->frame_len = 0;
+	ctx->seq = 0;
+
+	memset(&ctx->stats, 0, sizeof(ctx->stats));
+}
+
+size_t trace_compress_feed(struct trace_compress *ctx, const void *data, size_t len)
+{
+	if (ctx->frame_len) {
+		return 0;
+	}
+
+	len = MIN(len, sizeof(ctx->buf) - ctx->buf_len);
+
+	memcpy(&ctx->buf[ctx->buf_len], data, len);
+	ctx->buf_len += len;
+
+	if (ctx->buf_len == sizeof(ctx->buf)) {
+		frame_close(ctx);
+	}
+
+	return len;
+}
+
+void trace_compress_flush(struct trace_compress *ctx)
+{
+	if (!ctx->frame_len && ctx->buf_len) {
+		frame_close(ctx);
+	}
+}
+
+const uint8_t *trace_compress_frame_get(const struct trace_compress *ctx, size_t *len)
+{
+	if (!ctx->frame_len) {
+		return NULL;
+	}
+
+	*len = ctx->frame_len;
+
+	return ctx->frame;
+}
+
+void trace_compress_frame_release(struct trace_compress *ctx)
+{
+	ctx->frame_len = 0;
+}
+
+size_t trace_compress_frame_len(const uint8_t *hdr)
+{
+	size_t raw_len = hdr[4] | (hdr[5] << 8);
+	size_t payload_len = hdr[6] | (hdr[7] << 8);
+
+	if ((hdr[0] != TRACE_COMPRESS_MAGIC_0) || (hdr[1] != TRACE_COMPRESS_MAGIC_1) ||
+	    (hdr[9] != crc8_ccitt(0xFF, hdr, TRACE_COMPRESS_HDR_LEN - 1))) {
+		return 0;
+	}
+
+	if ((raw_len == 0) || (raw_len > CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE) ||
+	    (payload_len > raw_len) ||
+	    ((hdr[2] & TRACE_COMPRESS_FLAG_STORED) && (payload_len != raw_len))) {
+		return 0;
+	}
+
+	return TRACE_COMPRESS_HDR_LEN + payload_len;
+}
+
+static int frame_decode(const uint8_t *frame, size_t frame_len, uint8_t *out, size_t out_size)
+{
+	const uint8_t *payload = frame + TRACE_COMPRESS_HDR_LEN;
+	size_t payload_len = frame_len - TRACE_COMPRESS_HDR_LEN;
+	size_t raw_len = frame[4] | (frame[5] << 8);
+	int ret;
+
+	if (frame[8] != crc8_ccitt(0xFF, payload, payload_len)) {
+		return -EBADMSG;
+	}
+
+	if (raw_len > out_size) {
+		return -ENOMEM;
+	}
+
+	if (frame[2] & TRACE_COMPRESS_FLAG_STORED) {
+		memcpy(out, payload, payload_len);
+		return payload_len;
+	}
+
+	ret = block_decompress(payload, payload_len, out, raw_len);
+	if ((ret >= 0) && (ret != raw_len)) {
+		return -EBADMSG;
+	}
+
+	return ret;
+}
+
+int trace_compress_frame_decode(const uint8_t *data, size_t len, uint8_t *out, size_t out_size,
+				size_t *consumed)
+{
+	size_t pos;
+
+	for (pos = 0; pos + TRACE_COMPRESS_HDR_LEN <= len; pos++) {
+		size_t frame_len = trace_compress_frame_len(&data[pos]);
+		int ret;
+
+		if (frame_len == 0) {
+			continue;
+		}
+
+		if (pos + frame_len > len) {
+			/* Incomplete frame, keep it for when more data is available. */
+			break;
+		}
+
+		ret = frame_decode(&data[pos], frame_len, out, out_size);
+		if (ret == -EBADMSG) {
+			continue;
+		}
+
+		*consumed = (ret < 0) ? pos : pos + frame_len;
+
+		return ret;
+	}
+
+	*consumed = pos;
+
+	return -ENODATA;
+}
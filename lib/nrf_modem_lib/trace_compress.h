@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef TRACE_COMPRESS_H__
+#define TRACE_COMPRESS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <modem/nrf_modem_lib_trace.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Streaming compression of modem traces.
+ *
+ * Trace data is collected into frames of up to
+ * CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE bytes. Each frame is compressed
+ * independently using the LZ4 block format, or stored as is if it does not compress.
+ * A frame starts with a header:
+ *
+ *   0   magic (0xC3 0x7E)
+ *   2   flags (TRACE_COMPRESS_FLAG_*)
+ *   3   sequence number
+ *   4   raw data length (little endian)
+ *   6   payload length (little endian)
+ *   8   CRC-8 of the payload
+ *   9   CRC-8 of the header bytes 0 to 8
+ *
+ * Frames do not reference each other, so decoding can start at any frame boundary.
+ * A decoder that starts in the middle of a frame, for example because the backend has
+ * overwritten the oldest data, skips ahead to the next valid header.
+ *
+ * The module does no locking, the user is responsible for serializing the access.
+ */
+
+#define TRACE_COMPRESS_MAGIC_0 0xC3
+#define TRACE_COMPRESS_MAGIC_1 0x7E
+#define TRACE_COMPRESS_HDR_LEN 10
+
+/* Payload is stored uncompressed. */
+#define TRACE_COMPRESS_FLAG_STORED 0x01
+
+#define TRACE_COMPRESS_FRAME_MAX_LEN \
+	(TRACE_COMPRESS_HDR_LEN + CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE)
+
+struct trace_compress {
+	/* Raw data of the frame being collected. */
+	uint8_t buf[CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE];
+	size_t buf_len;
+	/* Closed frame waiting to be written to the backend. */
+	uint8_t frame[TRACE_COMPRESS_FRAME_MAX_LEN];
+	size_t frame_len;
+	/* Match finder, offsets of the last occurrence of each hashed sequence. */
+	uint16_t table[1 << CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_HASH_BITS];
+	uint8_t seq;
+	struct nrf_modem_lib_trace_compression_stats stats;
+};
+
+/* Reset the compressor, dropping any collected data. Statistics are cleared.
+ *
+ * @param ctx Compressor.
+ */
+void trace_compress_init(struct trace_compress *ctx);
+
+/* Append trace data to the current frame.
+ *
+ * The frame is closed when it becomes full. No data is accepted while a closed frame
+ * is waiting to be released with trace_compress_frame_release().
+ *
+ * @param ctx Compressor.
+ * @param data Trace data.
+ * @param len Length of the trace data.
+ *
+ * @return Number of bytes consumed.
+ */
+size_t trace_compress_feed(struct trace_compress *ctx, const void *data, size_t len);
+
+/* Close the current frame, even if it is not full.
+ *
+ * @param ctx Compressor.
+ */
+void trace_compress_flush(struct trace_compress *ctx);
+
+/* Get the closed frame.
+ *
+ * @param ctx Compressor.
+ * @param len Frame length.
+ *
+ * @return Frame, or NULL if no frame is closed.
+ */
+const uint8_t *trace_compress_frame_get(const struct trace_compress *ctx, size_t *len);
+
+/* Release the closed frame after it has been written.
+ *
+ * @param ctx Compressor.
+ */
+void trace_compress_frame_release(struct trace_compress *ctx);
+
+/* Get the length of a frame from its header.
+ *
+ * @param hdr Header, TRACE_COMPRESS_HDR_LEN bytes.
+ *
+ * @return Frame length including the header, or 0 if the header is not valid or the frame
+ *         holds more than CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE bytes of data.
+ */
+size_t trace_compress_frame_len(const uint8_t *hdr);
+
+/* Decode the first valid frame in a buffer.
+ *
+ * Bytes that do not start a valid frame are skipped. On return, @p consumed holds the
+ * number of bytes that can be discarded from the start of the buffer.
+ *
+ * @param data Compressed trace data.
+ * @param len Length of the compressed trace data.
+ * @param out Output buffer for the raw trace data.
+ * @param out_size Size of the output buffer.
+ * @param consumed Number of bytes consumed.
+ *
+ * @retval Number of decoded bytes if successful.
+ * @retval -ENODATA if the buffer holds no complete frame.
+ */
+int trace_compress_frame_decode(const uint8_t *data, size_t len, uint8_t *out, size_t out_size,
+				size_t *consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_COMPRESS_H__ */
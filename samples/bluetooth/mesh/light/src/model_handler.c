@@ -16,53 +16,62 @@ static void led_set(struct bt_mesh_onoff_srv *srv, struct bt_mesh_msg_ctx *ctx,
 static void led_get(struct bt_mesh_onoff_srv *srv, struct bt_mesh_msg_ctx *ctx,
 		    struct bt_mesh_onoff_status *rsp);
 
+static void led_step(struct bt_mesh_transition *trans, int32_t value);
+
+static void led_begin(struct bt_mesh_transition *trans, int32_t value);
+
 static const struct bt_mesh_onoff_srv_handlers onoff_handlers = {
 	.set = led_set,
 	.get = led_get,
 };
 
+/* The transition moves the onoff state between 0 and 1, so the engine only
+ * wakes up at the end of the delay and at the end of the transition.
+ */
 struct led_ctx {
 	struct bt_mesh_onoff_srv srv;
-	struct k_work_delayable work;
-	uint32_t remaining;
-	bool value;
+	struct bt_mesh_transition trans;
+	/* Present onoff state, as shown on the LED. */
+	bool on;
+	/* Publish the state at the end of the running transition. */
+	bool pub_at_end;
 };
 
+#define LED_CTX_INIT                                                           \
+	{                                                                      \
+		.srv = BT_MESH_ONOFF_SRV_INIT(&onoff_handlers),                \
+		.trans = BT_MESH_TRANSITION_INIT_BEGIN(led_step, led_begin),   \
+	}
+
 static struct led_ctx led_ctx[] = {
 #if DT_NODE_EXISTS(DT_ALIAS(led0))
-	{ .srv = BT_MESH_ONOFF_SRV_INIT(&onoff_handlers) },
+	LED_CTX_INIT,
 #endif
 #if DT_NODE_EXISTS(DT_ALIAS(led1))
-	{ .srv = BT_MESH_ONOFF_SRV_INIT(&onoff_handlers) },
+	LED_CTX_INIT,
 #endif
 #if DT_NODE_EXISTS(DT_ALIAS(led2))
-	{ .srv = BT_MESH_ONOFF_SRV_INIT(&onoff_handlers) },
+	LED_CTX_INIT,
 #endif
 #if DT_NODE_EXISTS(DT_ALIAS(led3))
-	{ .srv = BT_MESH_ONOFF_SRV_INIT(&onoff_handlers) },
+	LED_CTX_INIT,
 #endif
 };
 
-static void led_transition_start(struct led_ctx *led)
+static void led_status(struct led_ctx *led, struct bt_mesh_onoff_status *status)
 {
-	int led_idx = led - &led_ctx[0];
-
-	/* As long as the transition is in progress, the onoff
-	 * state is "on":
-	 */
-	dk_set_led(led_idx, true);
-	k_work_reschedule(&led->work, K_MSEC(led->remaining));
-	led->remaining = 0;
+	/* Do not include delay in the remaining time. */
+	status->remaining_time = bt_mesh_transition_remaining_get(&led->trans);
+	status->target_on_off = bt_mesh_transition_target_get(&led->trans);
+	status->present_on_off = led->on;
 }
 
-static void led_status(struct led_ctx *led, struct bt_mesh_onoff_status *status)
+static void led_onoff_set(struct led_ctx *led, bool on)
 {
-	/* Do not include delay in the remaining time. */
-	status->remaining_time = led->remaining ? led->remaining :
-		k_ticks_to_ms_ceil32(k_work_delayable_remaining_get(&led->work));
-	status->target_on_off = led->value;
-	/* As long as the transition is in progress, the onoff state is "on": */
-	status->present_on_off = led->value || status->remaining_time;
+	int led_idx = led - &led_ctx[0];
+
+	led->on = on;
+	dk_set_led(led_idx, on);
 }
 
 static void led_set(struct bt_mesh_onoff_srv *srv, struct bt_mesh_msg_ctx *ctx,
@@ -70,26 +79,15 @@ static void led_set(struct bt_mesh_onoff_srv *srv, struct bt_mesh_msg_ctx *ctx,
 		    struct bt_mesh_onoff_status *rsp)
 {
 	struct led_ctx *led = CONTAINER_OF(srv, struct led_ctx, srv);
-	int led_idx = led - &led_ctx[0];
 
-	if (set->on_off == led->value) {
+	if (set->on_off == bt_mesh_transition_target_get(&led->trans)) {
 		goto respond;
 	}
 
-	led->value = set->on_off;
-	if (!bt_mesh_model_transition_time(set->transition)) {
-		led->remaining = 0;
-		dk_set_led(led_idx, set->on_off);
-		goto respond;
-	}
-
-	led->remaining = set->transition->time;
-
-	if (set->transition->delay) {
-		k_work_reschedule(&led->work, K_MSEC(set->transition->delay));
-	} else {
-		led_transition_start(led);
-	}
+	/* The server publishes instantaneous changes itself. */
+	led->pub_at_end = bt_mesh_model_transition_time(set->transition);
+	bt_mesh_transition_start(&led->trans, led->on, set->on_off,
+				 set->transition);
 
 respond:
 	if (rsp) {
@@ -105,22 +103,35 @@ static void led_get(struct bt_mesh_onoff_srv *srv, struct bt_mesh_msg_ctx *ctx,
 	led_status(led, rsp);
 }
 
-static void led_work(struct k_work *work)
+static void led_begin(struct bt_mesh_transition *trans, int32_t value)
 {
-	struct led_ctx *led = CONTAINER_OF(work, struct led_ctx, work.work);
-	int led_idx = led - &led_ctx[0];
+	struct led_ctx *led = CONTAINER_OF(trans, struct led_ctx, trans);
 
-	if (led->remaining) {
-		led_transition_start(led);
-	} else {
-		dk_set_led(led_idx, led->value);
+	/* The onoff state is "on" as soon as a transition to "on" starts,
+	 * and until a transition to "off" is complete:
+	 */
+	if (bt_mesh_transition_target_get(trans)) {
+		led_onoff_set(led, true);
+	}
+}
+
+static void led_step(struct bt_mesh_transition *trans, int32_t value)
+{
+	struct led_ctx *led = CONTAINER_OF(trans, struct led_ctx, trans);
 
-		/* Publish the new value at the end of the transition */
-		struct bt_mesh_onoff_status status;
+	led_onoff_set(led, value);
 
-		led_status(led, &status);
-		bt_mesh_onoff_srv_pub(&led->srv, NULL, &status);
+	if (bt_mesh_transition_in_progress(trans) || !led->pub_at_end) {
+		return;
 	}
+
+	led->pub_at_end = false;
+
+	/* Publish the new value at the end of the transition */
+	struct bt_mesh_onoff_status status;
+
+	led_status(led, &status);
+	bt_mesh_onoff_srv_pub(&led->srv, NULL, &status);
 }
 
 /* Set up a repeating delayed work to blink the DK's LEDs when attention is
@@ -214,9 +225,5 @@ const struct bt_mesh_comp *model_handler_init(void)
 {
 	k_work_init_delayable(&attention_blink_work, attention_blink);
 
-	for (int i = 0; i < ARRAY_SIZE(led_ctx); ++i) {
-		k_work_init_delayable(&led_ctx[i].work, led_work);
-	}
-
 	return &comp;
 }
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+"""Restore modem traces captured with CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION.
+
+The input is a sequence of frames, each holding an LZ4 block or stored data.
+Data that is not part of a valid frame, such as a partially overwritten frame at
+the start of a RAM trace buffer, is skipped.
+"""
+
+import argparse
+import sys
+
+MAGIC = b'\xc3\x7e'
+HDR_LEN = 10
+FLAG_STORED = 0x01
+MINMATCH = 4
+
+
+def crc8_ccitt(data, val=0xFF):
+    for b in data:
+        val ^= b
+        for _ in range(8):
+            val = ((val << 1) ^ 0x07) & 0xFF if val & 0x80 else (val << 1) & 0xFF
+    return val
+
+
+def block_decompress(src, raw_len):
+    out = bytearray()
+    pos = 0
+
+    def length(pos, val):
+        while True:
+            b = src[pos]
+            pos += 1
+            val += b
+            if b != 0xFF:
+                return pos, val
+
+    while pos < len(src):
+        token = src[pos]
+        pos += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            pos, lit_len = length(pos, lit_len)
+        out += src[pos:pos + lit_len]
+        pos += lit_len
+        if pos >= len(src):
+            break
+
+        offset = src[pos] | (src[pos + 1] << 8)
+        pos += 2
+        match_len = token & 0x0F
+        if match_len == 15:
+            pos, match_len = length(pos, match_len)
+        match_len += MINMATCH
+        if offset == 0 or offset > len(out):
+            raise ValueError('invalid match offset')
+        for _ in range(match_len):
+            out.append(out[-offset])
+
+    if len(out) != raw_len:
+        raise ValueError('invalid block length')
+
+    return bytes(out)
+
+
+def header_parse(data, pos):
+    hdr = data[pos:pos + HDR_LEN]
+    if len(hdr) < HDR_LEN or hdr[0:2] != MAGIC or crc8_ccitt(hdr[:9]) != hdr[9]:
+        return None
+
+    flags, seq = hdr[2], hdr[3]
+    raw_len = hdr[4] | (hdr[5] << 8)
+    payload_len = hdr[6] | (hdr[7] << 8)
+    if raw_len == 0 or payload_len > raw_len or \
+       (flags & FLAG_STORED and payload_len != raw_len):
+        return None
+
+    return flags, seq, raw_len, payload_len, hdr[8]
+
+
+def decompress(data, stats):
+    out = bytearray()
+    pos = 0
+    next_seq = None
+
+    while pos + HDR_LEN <= len(data):
+        hdr = header_parse(data, pos)
+        if hdr is None:
+            pos += 1
+            stats['skipped'] += 1
+            continue
+
+        flags, seq, raw_len, payload_len, payload_crc = hdr
+        payload = data[pos + HDR_LEN:pos + HDR_LEN + payload_len]
+        if len(payload) < payload_len:
+            break
+
+        try:
+            if crc8_ccitt(payload) != payload_crc:
+                raise ValueError('invalid payload CRC')
+            if flags & FLAG_STORED:
+                raw = payload
+            else:
+                raw = block_decompress(payload, raw_len)
+        except (ValueError, IndexError):
+            pos += 1
+            stats['skipped'] += 1
+            continue
+
+        if next_seq is not None and seq != next_seq:
+            stats['lost'] += (seq - next_seq) & 0xFF
+        next_seq = (seq + 1) & 0xFF
+
+        out += raw
+        pos += HDR_LEN + payload_len
+        stats['frames'] += 1
+
+    stats['skipped'] += len(data) - pos
+
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decompress modem traces captured with trace compression enabled.',
+        allow_abbrev=False)
+    parser.add_argument('input', help='Compressed trace file')
+    parser.add_argument('output', help='Output file for the raw modem traces')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    stats = {'frames': 0, 'skipped': 0, 'lost': 0}
+    raw = decompress(data, stats)
+
+    with open(args.output, 'wb') as f:
+        f.write(raw)
+
+    ratio = 100 * len(data) / len(raw) if raw else 0
+    print(f'{stats["frames"]} frames, {len(data)} -> {len(raw)} bytes ({ratio:.1f}%)')
+    if stats['skipped']:
+        print(f'{stats["skipped"]} bytes outside of valid frames skipped')
+    if stats['lost']:
+        print(f'{stats["lost"]} frames missing from the sequence')
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
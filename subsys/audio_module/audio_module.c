@@ -11,6 +11,7 @@
 #include <ctype.h>
 #include <zephyr/kernel.h>
 #include <zephyr/shell/shell.h>
+#include <zephyr/sys/math_extras.h>
 
 #include "data_fifo.h"
 
@@ -20,6 +21,18 @@ LOG_MODULE_REGISTER(audio_module, CONFIG_AUDIO_MODULE_LOG_LEVEL);
 /* Define a timeout to prevent system locking */
 #define LOCK_TIMEOUT_US (K_USEC(100))
 
+#if defined(CONFIG_AUDIO_MODULE_STATS)
+#define STATS_INC(handle, counter) ((handle)->stats.counter++)
+#else
+#define STATS_INC(handle, counter)
+#endif /* CONFIG_AUDIO_MODULE_STATS */
+
+#if defined(CONFIG_AUDIO_MODULE_SHELL)
+/* List of the open modules. */
+static sys_slist_t open_modules;
+static K_MUTEX_DEFINE(open_modules_mutex);
+#endif /* CONFIG_AUDIO_MODULE_SHELL */
+
 /**
  * @brief Helper function to validate the module state.
  *
@@ -135,28 +148,136 @@ static bool validate_parameters(struct audio_module_parameters const *const para
 }
 
 /**
- * @brief General callback for releasing the data when inter-module data
- *        passing.
+ * @brief Take an audio data block from the module's data slab.
+ *
+ * @param handle      [in/out]  The handle for this modules instance.
+ * @param audio_data  [out]     Pointer to the audio data to configure for the block.
+ * @param block       [out]     Pointer to the block, holding a single reference.
+ * @param timeout     [in]      Waiting period for a free block.
  *
- * @param handle      [in/out]  The handle of the sending modules instance.
- * @param audio_data  [in]      Pointer to the audio data to release.
+ * @return 0 if successful, error otherwise.
  */
-static void audio_data_release_cb(struct audio_module_handle_private *handle,
-				  struct audio_data const *const audio_data)
+static int block_alloc(struct audio_module_handle *handle, struct audio_data *audio_data,
+		       struct audio_module_block **block, k_timeout_t timeout)
 {
 	int ret;
-	struct audio_module_handle *hdl = (struct audio_module_handle *)handle;
 
-	ret = k_sem_take(&hdl->sem, K_NO_WAIT);
+	ret = k_mem_slab_alloc(handle->thread.data_slab, (void **)block, timeout);
 	if (ret) {
-		LOG_ERR("Failed to take semaphore for data release callback function");
-		return;
+		return ret;
 	}
 
-	if (k_sem_count_get(&hdl->sem) == 0) {
+	atomic_set(&(*block)->refs, 1);
+	(*block)->slab = handle->thread.data_slab;
+
+	audio_data->data = (*block)->data;
+	audio_data->data_size = handle->thread.data_size;
+	memset(&audio_data->meta, 0, sizeof(struct audio_metadata));
+
+	return 0;
+}
+
+/**
+ * @brief Release a reference to an audio data block, the block is freed with the last one.
+ *
+ * @param block  [in/out]  Pointer to the block.
+ */
+static void block_release(struct audio_module_block *block)
+{
+	if (atomic_dec(&block->refs) == 1) {
 		/* Audio data has been consumed by all modules so now can free the data memory. */
-		k_mem_slab_free(hdl->thread.data_slab, (void **)&audio_data->data);
+		k_mem_slab_free(block->slab, block);
+	}
+}
+
+/**
+ * @brief Release a consumed message and the audio data it holds.
+ *
+ * @param fifo  [in/out]  The FIFO the message was taken from.
+ * @param msg   [in/out]  Pointer to the message.
+ */
+static void message_release(struct data_fifo *fifo, struct audio_module_message *msg)
+{
+	if (msg->response_cb != NULL) {
+		msg->response_cb((struct audio_module_handle_private *)msg->tx_handle,
+				 &msg->audio_data);
 	}
+
+	if (msg->block != NULL) {
+		block_release(msg->block);
+	}
+
+	data_fifo_block_free(fifo, msg);
+}
+
+/**
+ * @brief Check the deadline of a received message before the audio data is processed.
+ *
+ * @note Late audio data is either dropped or flagged as bad data for the module to conceal.
+ *       Otherwise, the module's thread takes the deadline of the audio data.
+ *
+ * @param handle  [in/out]  The handle for this modules instance.
+ * @param msg     [in/out]  Pointer to the received message.
+ *
+ * @return true if the audio data should be processed, false if it should be dropped.
+ */
+static bool deadline_check(struct audio_module_handle *handle, struct audio_module_message *msg)
+{
+	struct audio_metadata *meta = &msg->audio_data.meta;
+	int32_t remaining_us;
+
+	if (meta->deadline_us == 0) {
+		return true;
+	}
+
+	remaining_us = (int32_t)(meta->deadline_us - audio_module_time_us_get());
+	if (remaining_us < 0) {
+		STATS_INC(handle, late);
+
+		if (handle->description->drop_late) {
+			STATS_INC(handle, dropped);
+
+			LOG_DBG("Module %s dropped audio data %d us late", handle->name,
+				-remaining_us);
+			return false;
+		}
+
+		meta->bad_data = true;
+		remaining_us = 0;
+	}
+
+#if defined(CONFIG_AUDIO_MODULE_DEADLINE_SCHEDULING)
+	/* Let the modules with more urgent audio data run first. */
+	k_thread_deadline_set(k_current_get(),
+			      (int)MIN(k_us_to_cyc_ceil64(remaining_us), INT32_MAX));
+	k_yield();
+#endif /* CONFIG_AUDIO_MODULE_DEADLINE_SCHEDULING */
+
+	return true;
+}
+
+/**
+ * @brief Update the module's statistics after processing audio data.
+ *
+ * @param handle       [in/out]  The handle for this modules instance.
+ * @param start        [in]      Cycle count when the processing started.
+ * @param deadline_us  [in]      The deadline of the audio data, or 0 if none.
+ */
+static void stats_update(struct audio_module_handle *handle, uint32_t start, uint32_t deadline_us)
+{
+#if defined(CONFIG_AUDIO_MODULE_STATS)
+	struct audio_module_stats *stats = &handle->stats;
+	uint32_t time_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	size_t bucket = time_us ? 32 - u32_count_leading_zeros(time_us) : 0;
+
+	stats->processed++;
+	stats->max_us = MAX(stats->max_us, time_us);
+	stats->histogram[MIN(bucket, ARRAY_SIZE(stats->histogram) - 1)]++;
+
+	if (deadline_us != 0 && (int32_t)(deadline_us - audio_module_time_us_get()) < 0) {
+		stats->overruns++;
+	}
+#endif /* CONFIG_AUDIO_MODULE_STATS */
 }
 
 /**
@@ -165,13 +286,15 @@ static void audio_data_release_cb(struct audio_module_handle_private *handle,
  * @param tx_handle            [in/out]  The handle for the sending module instance.
  * @param rx_handle            [in/out]  The handle for the receiving module instance.
  * @param audio_data           [in]      Pointer to the audio data to send to the module.
+ * @param block                [in]      Pointer to the block holding the audio data or NULL.
+ *                                       A reference is handed over to the receiving module.
  * @param data_in_response_cb  [in]      A pointer to a callback to run when the buffer is
  *                                       fully consumed.
  *
  * @return 0 if successful, error otherwise.
  */
 static int data_tx(struct audio_module_handle *tx_handle, struct audio_module_handle *rx_handle,
-		   struct audio_data const *const audio_data,
+		   struct audio_data const *const audio_data, struct audio_module_block *block,
 		   audio_module_response_cb data_in_response_cb)
 {
 	int ret;
@@ -189,11 +312,12 @@ static int data_tx(struct audio_module_handle *tx_handle, struct audio_module_ha
 		memcpy(&data_msg_rx->audio_data, audio_data, sizeof(struct audio_data));
 		data_msg_rx->tx_handle = tx_handle;
 		data_msg_rx->response_cb = data_in_response_cb;
+		data_msg_rx->block = block;
 
 		ret = data_fifo_block_lock(rx_handle->thread.msg_rx, (void **)&data_msg_rx,
 					   sizeof(struct audio_module_message));
 		if (ret) {
-			data_fifo_block_free(rx_handle->thread.msg_rx, (void **)&data_msg_rx);
+			data_fifo_block_free(rx_handle->thread.msg_rx, data_msg_rx);
 
 			LOG_WRN("Module %s failed to queue audio data, ret %d", rx_handle->name,
 				ret);
@@ -216,11 +340,13 @@ static int data_tx(struct audio_module_handle *tx_handle, struct audio_module_ha
  *
  * @param handle      [in/out]  The handle for this modules instance.
  * @param audio_data  [in]      A pointer to the audio data.
+ * @param block       [in]      Pointer to the block holding the audio data, a reference is
+ *                              handed over to the message.
  *
  * @return 0 if successful, error otherwise.
  */
 static int tx_fifo_put(struct audio_module_handle *handle,
-		       struct audio_data const *const audio_data)
+		       struct audio_data const *const audio_data, struct audio_module_block *block)
 {
 	int ret;
 	struct audio_module_message *data_msg_tx;
@@ -236,7 +362,8 @@ static int tx_fifo_put(struct audio_module_handle *handle,
 	/* Configure audio data. */
 	memcpy(&data_msg_tx->audio_data, audio_data, sizeof(struct audio_data));
 	data_msg_tx->tx_handle = handle;
-	data_msg_tx->response_cb = audio_data_release_cb;
+	data_msg_tx->response_cb = NULL;
+	data_msg_tx->block = block;
 
 	/* Send audio data to modules output message queue. */
 	ret = data_fifo_block_lock(handle->thread.msg_tx, (void **)&data_msg_tx,
@@ -245,12 +372,7 @@ static int tx_fifo_put(struct audio_module_handle *handle,
 		LOG_ERR("Failed to send audio data to output of module %s, ret %d", handle->name,
 			ret);
 
-		data_fifo_block_free(handle->thread.msg_tx, (void **)&data_msg_tx);
-
-		ret = k_sem_take(&handle->sem, K_NO_WAIT);
-		if (ret) {
-			LOG_ERR("Failed to take semaphore for TX FIFO put");
-		}
+		data_fifo_block_free(handle->thread.msg_tx, data_msg_tx);
 
 		return ret;
 	}
@@ -261,81 +383,65 @@ static int tx_fifo_put(struct audio_module_handle *handle,
 /**
  * @brief Send the audio data item to all connected modules.
  *
+ * @note Every receiver takes its own reference to the block, so any number of blocks can be
+ *       in flight between the modules. The destinations list is walked without locking; a
+ *       module connected or disconnected meanwhile may or may not receive this audio data.
+ *
  * @param handle      [in/out]  The handle for this modules instance.
  * @param audio_data  [in]      A pointer to the audio data.
+ * @param block       [in]      Pointer to the block holding the audio data, the caller's
+ *                              reference is released once the audio data has been sent.
  *
  * @return 0 if successful, error otherwise.
  */
 static int send_to_connected_modules(struct audio_module_handle *handle,
-				     struct audio_data const *const audio_data)
+				     struct audio_data const *const audio_data,
+				     struct audio_module_block *block)
 {
 	int ret;
+	int err = 0;
 	struct audio_module_handle *handle_to;
 
 	if (handle->dest_count == 0) {
 		LOG_WRN("Nowhere to send the audio data from module %s so releasing it",
 			handle->name);
-
-		k_mem_slab_free(handle->thread.data_slab, (void **)audio_data->data);
-
-		return 0;
 	}
 
-	/* We need to ensure that all receiving modules have got the audio data.
-	 * This is so the first receiver cannot free the audio data before all receivers
-	 * have all gotten the audio data.
+	/* Send to all internally connected modules. The caller's reference keeps the block
+	 * alive until all receiving modules have got their references.
 	 */
-	ret = k_mutex_lock(&handle->dest_mutex, LOCK_TIMEOUT_US);
-	if (ret) {
-		LOG_ERR("Failed to take MUTEX lock in time");
-		return ret;
-	}
-
-	/* Here the semaphore is used as a count of the number of audio data items out in the
-	 * connected modules.
-	 */
-	ret = k_sem_init(&handle->sem, handle->dest_count, handle->dest_count);
-	if (ret) {
-		LOG_ERR("Failed to initiate semaphore");
-		return ret;
-	}
-
-	/* Send to all internally connected modules. */
 	SYS_SLIST_FOR_EACH_CONTAINER(&handle->handle_dest_list, handle_to, node) {
-		ret = data_tx(handle, handle_to, audio_data, &audio_data_release_cb);
+		atomic_inc(&block->refs);
+
+		ret = data_tx(handle, handle_to, audio_data, block, NULL);
 		if (ret) {
+			atomic_dec(&block->refs);
+
 			LOG_ERR("Failed to send audio data to module %s from %s, ret %d",
 				handle_to->name, handle->name, ret);
-
-			return ret;
+			err = ret;
 		}
 	}
 
-	ret = k_mutex_unlock(&handle->dest_mutex);
-	if (ret) {
-		LOG_ERR("Failed to release MUTEX");
-		return ret;
-	}
-
 	/* Send to this module's TX FIFO for extraction by an external
 	 * process with audio_module_rx().
 	 */
 	if (handle->use_tx_queue && handle->thread.msg_tx) {
-		ret = tx_fifo_put(handle, audio_data);
+		atomic_inc(&block->refs);
+
+		ret = tx_fifo_put(handle, audio_data, block);
 		if (ret) {
+			atomic_dec(&block->refs);
+
 			LOG_ERR("Failed to send audio data on module %s TX message queue",
 				handle->name);
-
-			ret = k_sem_take(&handle->sem, K_NO_WAIT);
-			if (ret) {
-				LOG_ERR("Failed to take semaphore");
-			}
-
-			return ret;
+			err = ret;
 		}
 	}
 
-	return 0;
+	block_release(block);
+
+	return err;
 }
 
 /**
@@ -353,7 +459,7 @@ static void module_thread_input(struct audio_module_handle *handle, void *p2, vo
 {
 	int ret;
 	struct audio_data audio_data;
-	void *data;
+	struct audio_module_block *block;
 
 	__ASSERT(handle != NULL, "Module task has NULL handle");
 	__ASSERT(handle->description->functions->data_process != NULL,
@@ -361,24 +467,19 @@ static void module_thread_input(struct audio_module_handle *handle, void *p2, vo
 
 	/* Execute thread */
 	while (1) {
-		data = NULL;
-
 		/* Get a new output buffer.
 		 * Since this input module generates data within itself, the module itself
-		 * will control the data flow.
+		 * will control the data flow, waiting for the connected modules to release
+		 * the audio data in flight.
 		 */
-		ret = k_mem_slab_alloc(handle->thread.data_slab, (void **)&data, K_NO_WAIT);
-		__ASSERT(ret, "No free data for module %s, ret %d", handle->name, ret);
-
-		/* Configure new audio data. */
-		audio_data.data = data;
-		audio_data.data_size = handle->thread.data_size;
+		ret = block_alloc(handle, &audio_data, &block, K_FOREVER);
+		__ASSERT(ret == 0, "No free data for module %s, ret %d", handle->name, ret);
 
 		/* Process the input audio data */
 		ret = handle->description->functions->data_process(
 			(struct audio_module_handle_private *)handle, NULL, &audio_data);
 		if (ret) {
-			k_mem_slab_free(handle->thread.data_slab, (void **)(&data));
+			block_release(block);
 
 			LOG_ERR("Data process error in module %s, ret %d", handle->name, ret);
 			continue;
@@ -387,7 +488,7 @@ static void module_thread_input(struct audio_module_handle *handle, void *p2, vo
 		LOG_DBG("Module %s received new audio data ", handle->name);
 
 		/* Send input audio data to next module(s). */
-		send_to_connected_modules(handle, &audio_data);
+		send_to_connected_modules(handle, &audio_data, block);
 	}
 
 	CODE_UNREACHABLE;
@@ -410,6 +511,7 @@ static void module_thread_output(struct audio_module_handle *handle, void *p2, v
 
 	struct audio_module_message *msg_rx;
 	size_t size;
+	uint32_t start;
 
 	__ASSERT(handle != NULL, "Module task has NULL handle");
 	__ASSERT(handle->description->functions->data_process != NULL,
@@ -427,30 +529,25 @@ static void module_thread_output(struct audio_module_handle *handle, void *p2, v
 		 */
 		ret = data_fifo_pointer_last_filled_get(handle->thread.msg_rx, (void **)&msg_rx,
 							&size, K_FOREVER);
-		__ASSERT(ret, "Module %s error in getting last filled", handle->name);
+		__ASSERT(ret == 0, "Module %s error in getting last filled", handle->name);
 
 		LOG_DBG("Module %s new audio data received", handle->name);
 
+		if (!deadline_check(handle, msg_rx)) {
+			message_release(handle->thread.msg_rx, msg_rx);
+			continue;
+		}
+
 		/* Process the input audio data and output from the audio system. */
+		start = k_cycle_get_32();
 		ret = handle->description->functions->data_process(
 			(struct audio_module_handle_private *)handle, &msg_rx->audio_data, NULL);
+		stats_update(handle, start, msg_rx->audio_data.meta.deadline_us);
 		if (ret) {
-			if (msg_rx->response_cb != NULL) {
-				msg_rx->response_cb(
-					(struct audio_module_handle_private *)msg_rx->tx_handle,
-					&msg_rx->audio_data);
-			}
-
 			LOG_ERR("Data process error in module %s, ret %d", handle->name, ret);
-			continue;
 		}
 
-		if (msg_rx->response_cb != NULL) {
-			msg_rx->response_cb((struct audio_module_handle_private *)msg_rx->tx_handle,
-					    &msg_rx->audio_data);
-		}
-
-		data_fifo_block_free(handle->thread.msg_rx, (void **)&msg_rx);
+		message_release(handle->thread.msg_rx, msg_rx);
 	}
 
 	CODE_UNREACHABLE;
@@ -471,8 +568,9 @@ static void module_thread_in_out(struct audio_module_handle *handle, void *p2, v
 	int ret;
 	struct audio_module_message *msg_rx;
 	struct audio_data audio_data;
-	void *data;
+	struct audio_module_block *block;
 	size_t size;
+	uint32_t start;
 
 	__ASSERT(handle != NULL, "Module task has NULL handle");
 	__ASSERT(handle->description->functions->data_process != NULL,
@@ -480,8 +578,6 @@ static void module_thread_in_out(struct audio_module_handle *handle, void *p2, v
 
 	/* Execute thread. */
 	while (1) {
-		data = NULL;
-
 		LOG_DBG("Module %s is waiting for audio data", handle->name);
 
 		/* Get a new input message.
@@ -490,47 +586,59 @@ static void module_thread_in_out(struct audio_module_handle *handle, void *p2, v
 		 */
 		ret = data_fifo_pointer_last_filled_get(handle->thread.msg_rx, (void **)&msg_rx,
 							&size, K_FOREVER);
-		__ASSERT(ret, "Module %s error in getting last filled", handle->name);
+		__ASSERT(ret == 0, "Module %s error in getting last filled", handle->name);
 
 		LOG_DBG("Module %s new audio data received", handle->name);
 
-		/* Get a new output buffer. */
-		ret = k_mem_slab_alloc(handle->thread.data_slab, (void **)&data, K_NO_WAIT);
-		__ASSERT(ret, "No free data buffer for module %s, dropping input, ret %d",
-			 handle->name, ret);
+		if (!deadline_check(handle, msg_rx)) {
+			message_release(handle->thread.msg_rx, msg_rx);
+			continue;
+		}
 
-		/* Configure new audio audio_data. */
-		audio_data.data = data;
-		audio_data.data_size = handle->thread.data_size;
+		block = msg_rx->block;
+
+		if (handle->description->in_place && block != NULL &&
+		    atomic_get(&block->refs) == 1) {
+			/* No other module holds the input audio data, so process it in place
+			 * and pass the message's reference on with the output.
+			 */
+			msg_rx->block = NULL;
+			memcpy(&audio_data, &msg_rx->audio_data, sizeof(struct audio_data));
+		} else {
+			/* Get a new output buffer. */
+			ret = block_alloc(handle, &audio_data, &block, K_NO_WAIT);
+			if (ret) {
+				STATS_INC(handle, dropped);
+				message_release(handle->thread.msg_rx, msg_rx);
+
+				LOG_WRN("No free data buffer for module %s, dropping input, ret %d",
+					handle->name, ret);
+				continue;
+			}
+
+			/* The output carries on the input metadata unless the module changes it. */
+			memcpy(&audio_data.meta, &msg_rx->audio_data.meta,
+			       sizeof(struct audio_metadata));
+		}
 
 		/* Process the input audio data into the output audio data. */
+		start = k_cycle_get_32();
 		ret = handle->description->functions->data_process(
 			(struct audio_module_handle_private *)handle, &msg_rx->audio_data,
 			&audio_data);
+		stats_update(handle, start, msg_rx->audio_data.meta.deadline_us);
 		if (ret) {
-			if (msg_rx->response_cb != NULL) {
-				msg_rx->response_cb(
-					(struct audio_module_handle_private *)(msg_rx->tx_handle),
-					&msg_rx->audio_data);
-			}
-
-			data_fifo_block_free(handle->thread.msg_rx, (void **)(&msg_rx));
-
-			k_mem_slab_free(handle->thread.data_slab, (void **)(&data));
+			message_release(handle->thread.msg_rx, msg_rx);
+			block_release(block);
 
 			LOG_ERR("Data process error in module %s, ret %d", handle->name, ret);
 			continue;
 		}
 
 		/* Send processed audio data to next module(s). */
-		send_to_connected_modules(handle, &audio_data);
-
-		if (msg_rx->response_cb != NULL) {
-			msg_rx->response_cb((struct audio_module_handle_private *)msg_rx->tx_handle,
-					    &msg_rx->audio_data);
-		}
+		send_to_connected_modules(handle, &audio_data, block);
 
-		data_fifo_block_free(handle->thread.msg_rx, (void **)&msg_rx);
+		message_release(handle->thread.msg_rx, msg_rx);
 	}
 
 	CODE_UNREACHABLE;
@@ -629,6 +737,12 @@ int audio_module_open(struct audio_module_parameters const *const parameters,
 
 	handle->state = AUDIO_MODULE_STATE_CONFIGURED;
 
+#if defined(CONFIG_AUDIO_MODULE_SHELL)
+	k_mutex_lock(&open_modules_mutex, K_FOREVER);
+	sys_slist_append(&open_modules, &handle->open_node);
+	k_mutex_unlock(&open_modules_mutex);
+#endif /* CONFIG_AUDIO_MODULE_SHELL */
+
 	k_thread_start(handle->thread_id);
 
 	LOG_DBG("Thread started");
@@ -670,11 +784,17 @@ int audio_module_close(struct audio_module_handle *handle)
 
 	/*
 	 * TODO: How to return all the data to the slab items?
-	 *       Test the semaphore and wait for it to be zero.
+	 *       Release the block references held by the emptied messages.
 	 */
 
 	k_thread_abort(handle->thread_id);
 
+#if defined(CONFIG_AUDIO_MODULE_SHELL)
+	k_mutex_lock(&open_modules_mutex, K_FOREVER);
+	sys_slist_find_and_remove(&open_modules, &handle->open_node);
+	k_mutex_unlock(&open_modules_mutex);
+#endif /* CONFIG_AUDIO_MODULE_SHELL */
+
 	LOG_DBG("Closed module %s", handle->name);
 
 	return 0;
@@ -1017,7 +1137,7 @@ int audio_module_data_tx(struct audio_module_handle *handle,
 		return -EINVAL;
 	}
 
-	return data_tx((void *)NULL, handle, audio_data, response_cb);
+	return data_tx((void *)NULL, handle, audio_data, NULL, response_cb);
 }
 
 int audio_module_data_rx(struct audio_module_handle *handle, struct audio_data *audio_data,
@@ -1073,7 +1193,7 @@ int audio_module_data_rx(struct audio_module_handle *handle, struct audio_data *
 		       msg_tx->audio_data.data_size);
 	}
 
-	data_fifo_block_free(handle->thread.msg_tx, (void **)&msg_tx);
+	message_release(handle->thread.msg_tx, msg_tx);
 
 	return ret;
 }
@@ -1124,7 +1244,7 @@ int audio_module_data_tx_rx(struct audio_module_handle *handle_tx,
 		return -EINVAL;
 	}
 
-	ret = data_tx(NULL, handle_tx, audio_data_tx, NULL);
+	ret = data_tx(NULL, handle_tx, audio_data_tx, NULL, NULL);
 	if (ret) {
 		LOG_ERR("Failed to send audio data to module %s, ret %d", handle_tx->name, ret);
 		return ret;
@@ -1132,7 +1252,7 @@ int audio_module_data_tx_rx(struct audio_module_handle *handle_tx,
 
 	LOG_DBG("Wait for message on module %s TX queue", handle_rx->name);
 
-	ret = data_fifo_pointer_last_filled_get(handle_rx->thread.msg_rx, (void **)&msg_rx,
+	ret = data_fifo_pointer_last_filled_get(handle_rx->thread.msg_tx, (void **)&msg_rx,
 						&msg_rx_size, timeout);
 	if (ret) {
 		LOG_ERR("Failed to retrieve audio data from module %s, ret %d", handle_rx->name,
@@ -1152,7 +1272,7 @@ int audio_module_data_tx_rx(struct audio_module_handle *handle_tx,
 		       msg_rx->audio_data.data_size);
 	}
 
-	data_fifo_block_free(handle_rx->thread.msg_rx, (void **)&msg_rx);
+	message_release(handle_rx->thread.msg_tx, msg_rx);
 
 	return ret;
 };
@@ -1212,3 +1332,104 @@ int audio_module_number_channels_calculate(uint32_t locations, int8_t *number_ch
 
 	return 0;
 }
+
+uint32_t audio_module_time_us_get(void)
+{
+	return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+#if defined(CONFIG_AUDIO_MODULE_STATS)
+int audio_module_stats_get(struct audio_module_handle const *const handle,
+			   struct audio_module_stats *stats)
+{
+	if (handle == NULL || stats == NULL) {
+		LOG_ERR("Input parameter is NULL");
+		return -EINVAL;
+	}
+
+	if (!state_not_undefined(handle->state)) {
+		LOG_WRN("Module state is invalid");
+		return -ECANCELED;
+	}
+
+	memcpy(stats, &handle->stats, sizeof(struct audio_module_stats));
+
+	return 0;
+}
+
+int audio_module_stats_reset(struct audio_module_handle *handle)
+{
+	if (handle == NULL) {
+		LOG_ERR("Module handle is NULL");
+		return -EINVAL;
+	}
+
+	if (!state_not_undefined(handle->state)) {
+		LOG_WRN("Module state is invalid");
+		return -ECANCELED;
+	}
+
+	memset(&handle->stats, 0, sizeof(struct audio_module_stats));
+
+	return 0;
+}
+#endif /* CONFIG_AUDIO_MODULE_STATS */
+
+#if defined(CONFIG_AUDIO_MODULE_SHELL)
+static int cmd_stats(const struct shell *shell, size_t argc, char **argv)
+{
+	struct audio_module_handle *handle;
+	struct audio_module_stats stats;
+	size_t last;
+
+	k_mutex_lock(&open_modules_mutex, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&open_modules, handle, open_node) {
+		memcpy(&stats, &handle->stats, sizeof(struct audio_module_stats));
+		last = ARRAY_SIZE(stats.histogram) - 1;
+
+		shell_print(shell, "%s: processed %u, late %u, dropped %u, overruns %u, max %u us",
+			    handle->name, stats.processed, stats.late, stats.dropped,
+			    stats.overruns, stats.max_us);
+
+		for (size_t i = 0; i < last; i++) {
+			if (stats.histogram[i]) {
+				shell_print(shell, "  < %u us: %u", (uint32_t)BIT(i), stats.histogram[i]);
+			}
+		}
+
+		if (stats.histogram[last]) {
+			shell_print(shell, "  >= %u us: %u", (uint32_t)BIT(last - 1),
+				    stats.histogram[last]);
+		}
+	}
+
+	k_mutex_unlock(&open_modules_mutex);
+
+	return 0;
+}
+
+static int cmd_reset(const struct shell *shell, size_t argc, char **argv)
+{
+	struct audio_module_handle *handle;
+
+	k_mutex_lock(&open_modules_mutex, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&open_modules, handle, open_node) {
+		memset(&handle->stats, 0, sizeof(struct audio_module_stats));
+	}
+
+	k_mutex_unlock(&open_modules_mutex);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_audio_module,
+	SHELL_CMD_ARG(stats, NULL, "Print the timing statistics of the open modules",
+		      cmd_stats, 1, 0),
+	SHELL_CMD_ARG(reset, NULL, "Reset the timing statistics of the open modules",
+		      cmd_reset, 1, 0),
+	SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(audio_module, &sub_audio_module, "Audio module commands", NULL);
+#endif /* CONFIG_AUDIO_MODULE_SHELL */
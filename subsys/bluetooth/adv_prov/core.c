@@ -14,6 +14,10 @@ enum provider_set {
 	PROVIDER_SET_SD
 };
 
+enum {
+	CACHE_VALID,
+};
+
 
 static void get_section_ptrs(enum provider_set set,
 			     const struct bt_le_adv_prov_provider **start,
@@ -75,6 +79,74 @@ static void update_common_feedback(struct bt_le_adv_prov_feedback *common_fb,
 	common_fb->grace_period_s = MAX(common_fb->grace_period_s, fb->grace_period_s);
 }
 
+static bool cache_valid(const struct bt_le_adv_prov_provider *p,
+			const struct bt_le_adv_prov_adv_state *state)
+{
+	const struct bt_le_adv_prov_cache *cache = p->cache;
+
+	switch (p->update) {
+	case BT_LE_ADV_PROV_UPDATE_ROTATION:
+		if (state->rpa_rotated) {
+			return false;
+		}
+		__fallthrough;
+
+	case BT_LE_ADV_PROV_UPDATE_SESSION:
+		if (state->new_adv_session) {
+			return false;
+		}
+		__fallthrough;
+
+	case BT_LE_ADV_PROV_UPDATE_STATIC:
+		return atomic_test_bit(&cache->flags, CACHE_VALID) &&
+		       (cache->pairing_mode == state->pairing_mode) &&
+		       (cache->in_grace_period == state->in_grace_period);
+
+	case BT_LE_ADV_PROV_UPDATE_ALWAYS:
+	default:
+		return false;
+	}
+}
+
+static int get_provider_data(const struct bt_le_adv_prov_provider *p, struct bt_data *d,
+			     const struct bt_le_adv_prov_adv_state *state,
+			     struct bt_le_adv_prov_feedback *fb)
+{
+	struct bt_le_adv_prov_cache *cache = p->cache;
+	int err;
+
+	if (cache && cache_valid(p, state)) {
+		*d = cache->data;
+		*fb = cache->fb;
+
+		return cache->err;
+	}
+
+	memset(fb, 0, sizeof(*fb));
+
+	if (!cache) {
+		return p->get_data(d, state, fb);
+	}
+
+	/* Set before the callback, so that a change reported meanwhile is not lost. */
+	atomic_set_bit(&cache->flags, CACHE_VALID);
+
+	err = p->get_data(d, state, fb);
+	if (err && (err != -ENOENT)) {
+		atomic_clear_bit(&cache->flags, CACHE_VALID);
+
+		return err;
+	}
+
+	cache->data = *d;
+	cache->fb = *fb;
+	cache->err = err;
+	cache->pairing_mode = state->pairing_mode;
+	cache->in_grace_period = state->in_grace_period;
+
+	return err;
+}
+
 static int get_providers_data(enum provider_set set, struct bt_data *d, size_t *d_len,
 			      const struct bt_le_adv_prov_adv_state *state,
 			      struct bt_le_adv_prov_feedback *fb)
@@ -94,8 +166,7 @@ static int get_providers_data(enum provider_set set, struct bt_data *d, size_t *
 	memset(&common_fb, 0, sizeof(common_fb));
 
 	for (const struct bt_le_adv_prov_provider *p = start; p < end; p++) {
-		memset(fb, 0, sizeof(*fb));
-		err = p->get_data(&d[pos], state, fb);
+		err = get_provider_data(p, &d[pos], state, fb);
 
 		if (!err) {
 			pos++;
@@ -128,3 +199,10 @@ int bt_le_adv_prov_get_sd(struct bt_data *sd, size_t *sd_len,
 {
 	return get_providers_data(PROVIDER_SET_SD, sd, sd_len, state, fb);
 }
+
+void bt_le_adv_prov_data_changed(const struct bt_le_adv_prov_provider *provider)
+{
+	__ASSERT_NO_MSG(provider->cache);
+
+	atomic_clear_bit(&provider->cache->flags, CACHE_VALID);
+}
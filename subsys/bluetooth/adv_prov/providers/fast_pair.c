@@ -95,6 +95,8 @@ static int get_data(struct bt_data *ad, const struct bt_le_adv_prov_adv_state *s
 					   BT_FAST_PAIR_NOT_DISC_ADV_TYPE_SHOW_UI_IND :
 					   BT_FAST_PAIR_NOT_DISC_ADV_TYPE_HIDE_UI_IND;
 		adv_config.not_disc.battery_mode = adv_battery_mode;
+		/* The salt is regenerated together with the RPA. */
+		adv_config.not_disc.keep_salt = !state->rpa_rotated && !state->new_adv_session;
 	}
 
 	if (IS_ENABLED(CONFIG_BT_ADV_PROV_FAST_PAIR_STOP_DISCOVERABLE_ON_RPA_ROTATION)) {
@@ -114,4 +116,7 @@ static int get_data(struct bt_data *ad, const struct bt_le_adv_prov_adv_state *s
 	return bt_fast_pair_adv_data_fill(ad, buf, sizeof(buf), adv_config);
 }
 
+/* The data is not cached, as the payload depends on battery data and Account Keys that change
+ * outside of the provider. The Account Key Filter is cached by the Fast Pair service.
+ */
 BT_LE_ADV_PROV_AD_PROVIDER_REGISTER(fast_pair, get_data);
@@ -9,6 +9,9 @@
 
 #include <bluetooth/adv_prov.h>
 
+/* The appearance can only be changed at runtime if it is dynamic. */
+#define UPDATE_POLICY (IS_ENABLED(CONFIG_BT_DEVICE_APPEARANCE_DYNAMIC) ?	\
+		       BT_LE_ADV_PROV_UPDATE_ALWAYS : BT_LE_ADV_PROV_UPDATE_STATIC)
 
 static int get_data(struct bt_data *d, const struct bt_le_adv_prov_adv_state *state,
 		    struct bt_le_adv_prov_feedback *fb)
@@ -31,7 +34,7 @@ static int get_data(struct bt_data *d, const struct bt_le_adv_prov_adv_state *st
 }
 
 #if CONFIG_BT_ADV_PROV_GAP_APPEARANCE_SD
-BT_LE_ADV_PROV_SD_PROVIDER_REGISTER(gap_appearance, get_data);
+BT_LE_ADV_PROV_SD_PROVIDER_REGISTER_CACHED(gap_appearance, get_data, UPDATE_POLICY);
 #else
-BT_LE_ADV_PROV_AD_PROVIDER_REGISTER(gap_appearance, get_data);
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(gap_appearance, get_data, UPDATE_POLICY);
 #endif /* CONFIG_BT_ADV_PROV_GAP_APPEARANCE_SD */
@@ -11,12 +11,6 @@
 
 static bool enabled = true;
 
-
-void bt_le_adv_prov_swift_pair_enable(bool enable)
-{
-	enabled = enable;
-}
-
 static int get_data(struct bt_data *ad, const struct bt_le_adv_prov_adv_state *state,
 		    struct bt_le_adv_prov_feedback *fb)
 {
@@ -44,4 +38,10 @@ static int get_data(struct bt_data *ad, const struct bt_le_adv_prov_adv_state *s
 	return 0;
 }
 
-BT_LE_ADV_PROV_AD_PROVIDER_REGISTER(swift_pair, get_data);
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(swift_pair, get_data, BT_LE_ADV_PROV_UPDATE_STATIC);
+
+void bt_le_adv_prov_swift_pair_enable(bool enable)
+{
+	enabled = enable;
+	bt_le_adv_prov_data_changed(&swift_pair);
+}
@@ -60,4 +60,5 @@ static int get_data(struct bt_data *ad, const struct bt_le_adv_prov_adv_state *s
 	return err;
 }
 
-BT_LE_ADV_PROV_AD_PROVIDER_REGISTER(tx_power, get_data);
+/* The TX power of the advertising set is read once per advertising session. */
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(tx_power, get_data, BT_LE_ADV_PROV_UPDATE_SESSION);
@@ -9,100 +9,141 @@
 
 LOG_MODULE_REGISTER(bt_conn_ctx, CONFIG_BT_CONN_CTX_LOG_LEVEL);
 
-static void bt_conn_ctx_mem_free(struct k_mem_slab *mem_slab, void **data)
-{
-	k_mem_slab_free(mem_slab, *data);
-	*data = NULL;
-}
+enum {
+	/* The context is allocated, and holds a reference to itself. */
+	CTX_ALLOCATED,
+};
 
-void *bt_conn_ctx_alloc(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
+static struct bt_conn_ctx *ctx_find(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
 {
-	__ASSERT_NO_MSG(conn != NULL);
-	__ASSERT_NO_MSG(ctx_lib != NULL);
+	uint8_t index = bt_conn_index(conn);
 
-	int err = -ENOMEM;
-	struct bt_conn_ctx *ctx;
+	__ASSERT_NO_MSG(index < bt_conn_ctx_count(ctx_lib));
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
+	return &ctx_lib->ctx[index];
+}
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-		ctx = &ctx_lib->ctx[i];
+/* Free the context data memory once the context is freed and the last
+ * reference is released.
+ */
+static void ctx_destroy(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn_ctx *ctx)
+{
+	k_spinlock_key_t key = k_spin_lock(&ctx_lib->lock);
 
-		if (!ctx->conn && !ctx->data) {
-			err = k_mem_slab_alloc(ctx_lib->mem_slab,
-					       &ctx->data,
-					       K_NO_WAIT);
-			if (!err) {
-				ctx->conn = conn;
+	if (!atomic_get(&ctx->ref) && ctx->data) {
+		k_mem_slab_free(ctx_lib->mem_slab, ctx->data);
+		ctx->data = NULL;
+		ctx->conn = NULL;
+	}
 
-				LOG_DBG("The memory for the connection context "
-					"has been allocated, conn %p, index: %u",
-					(void *)conn, i);
+	k_spin_unlock(&ctx_lib->lock, key);
+}
 
-				return ctx->data;
+static void ctx_unref(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn_ctx *ctx)
+{
+	if (atomic_dec(&ctx->ref) == 1) {
+		ctx_destroy(ctx_lib, ctx);
+	}
+}
 
-			} else {
-				break;
-			}
+static struct bt_conn_ctx *ctx_ref(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn_ctx *ctx)
+{
+	atomic_val_t ref;
 
+	do {
+		ref = atomic_get(&ctx->ref);
+		if (!ref) {
+			return NULL;
 		}
+	} while (!atomic_cas(&ctx->ref, ref, ref + 1));
+
+	/* A freed context can still be referenced until its last reference is
+	 * released, but it must not be found.
+	 */
+	if (!atomic_test_bit(&ctx->flags, CTX_ALLOCATED)) {
+		ctx_unref(ctx_lib, ctx);
+		return NULL;
 	}
 
-	LOG_WRN("Memory can not be allocated");
-	k_mutex_unlock(ctx_lib->mutex);
-
-	return NULL;
+	return ctx;
 }
 
-int bt_conn_ctx_free(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
+void *bt_conn_ctx_alloc(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
 {
 	__ASSERT_NO_MSG(conn != NULL);
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
+	struct bt_conn_ctx *ctx = ctx_find(ctx_lib, conn);
+	k_spinlock_key_t key;
+	int err;
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
+	key = k_spin_lock(&ctx_lib->lock);
 
-		if (ctx->conn == conn) {
-			bt_conn_ctx_mem_free(ctx_lib->mem_slab, &ctx->data);
-			ctx->conn = NULL;
-			ctx->data = NULL;
+	if (atomic_get(&ctx->ref)) {
+		k_spin_unlock(&ctx_lib->lock, key);
+		LOG_WRN("Memory already allocated for conn %p", (void *)conn);
+		return NULL;
+	}
+
+	if (ctx->data) {
+		/* The last reference was released, but the memory is not freed yet. */
+		k_mem_slab_free(ctx_lib->mem_slab, ctx->data);
+		ctx->data = NULL;
+	}
 
-			LOG_DBG("The context memory for the connection "
-				"has been released, conn %p index %u",
-				(void *)conn, i);
+	err = k_mem_slab_alloc(ctx_lib->mem_slab, &ctx->data, K_NO_WAIT);
+	if (err) {
+		ctx->data = NULL;
+		k_spin_unlock(&ctx_lib->lock, key);
+		LOG_WRN("Memory can not be allocated");
+		return NULL;
+	}
 
-			k_mutex_unlock(ctx_lib->mutex);
+	ctx->conn = conn;
+	/* One reference for the allocation, and one for the caller. */
+	atomic_set(&ctx->ref, 2);
+	atomic_set_bit(&ctx->flags, CTX_ALLOCATED);
 
-			return 0;
-		}
+	k_spin_unlock(&ctx_lib->lock, key);
+
+	LOG_DBG("The memory for the connection context has been allocated, conn %p, index: %u",
+		(void *)conn, bt_conn_index(conn));
+
+	return ctx->data;
+}
+
+int bt_conn_ctx_free(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
+{
+	__ASSERT_NO_MSG(conn != NULL);
+	__ASSERT_NO_MSG(ctx_lib != NULL);
+
+	struct bt_conn_ctx *ctx = ctx_find(ctx_lib, conn);
+
+	if (ctx->conn != conn || !atomic_test_and_clear_bit(&ctx->flags, CTX_ALLOCATED)) {
+		LOG_WRN("There is no allocated memory for this connection");
+		return -EINVAL;
 	}
 
-	LOG_WRN("There is no allocated memory for this connection");
-	k_mutex_unlock(ctx_lib->mutex);
+	ctx_unref(ctx_lib, ctx);
 
-	return  -EINVAL;
+	LOG_DBG("The context memory for the connection has been released, conn %p index %u",
+		(void *)conn, bt_conn_index(conn));
+
+	return 0;
 }
 
 void bt_conn_ctx_free_all(struct bt_conn_ctx_lib *ctx_lib)
 {
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
-
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+	for (size_t i = 0; i < bt_conn_ctx_count(ctx_lib); i++) {
 		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
 
-		if (ctx->data != NULL) {
-			k_mem_slab_free(ctx_lib->mem_slab, (void *)ctx->data);
-			ctx->conn = NULL;
-			ctx->data = NULL;
+		if (atomic_test_and_clear_bit(&ctx->flags, CTX_ALLOCATED)) {
+			ctx_unref(ctx_lib, ctx);
 		}
 	}
 
-	k_mutex_unlock(ctx_lib->mutex);
-
 	LOG_DBG("All allocated memory has been released");
 }
 
@@ -111,23 +152,14 @@ void *bt_conn_ctx_get(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
 	__ASSERT_NO_MSG(conn != NULL);
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
+	struct bt_conn_ctx *ctx = ctx_ref(ctx_lib, ctx_find(ctx_lib, conn));
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
-
-		if (ctx->conn == conn) {
-			LOG_DBG("Memory block found for the connection");
-
-			return ctx->data;
-		}
+	if (!ctx) {
+		LOG_WRN("No memory block for connection");
+		return NULL;
 	}
 
-	LOG_WRN("No memory block for connection");
-
-	k_mutex_unlock(ctx_lib->mutex);
-
-	return NULL;
+	return ctx->data;
 }
 
 const struct bt_conn_ctx *bt_conn_ctx_get_by_id(struct bt_conn_ctx_lib *ctx_lib, uint8_t id)
@@ -135,17 +167,7 @@ const struct bt_conn_ctx *bt_conn_ctx_get_by_id(struct bt_conn_ctx_lib *ctx_lib,
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 	__ASSERT_NO_MSG(id < bt_conn_ctx_count(ctx_lib));
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
-
-	struct bt_conn_ctx *ctx = &ctx_lib->ctx[id];
-
-	if (ctx_lib->ctx[id].conn != NULL) {
-		return ctx;
-	}
-
-	k_mutex_unlock(ctx_lib->mutex);
-
-	return NULL;
+	return ctx_ref(ctx_lib, &ctx_lib->ctx[id]);
 }
 
 void bt_conn_ctx_release(struct bt_conn_ctx_lib *ctx_lib, void *ctx_data)
@@ -153,12 +175,11 @@ void bt_conn_ctx_release(struct bt_conn_ctx_lib *ctx_lib, void *ctx_data)
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 	__ASSERT_NO_MSG(ctx_data != NULL);
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+	for (size_t i = 0; i < bt_conn_ctx_count(ctx_lib); i++) {
 		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
 
 		if (ctx->data == ctx_data) {
-			k_mutex_unlock(ctx_lib->mutex);
-
+			ctx_unref(ctx_lib, ctx);
 			return;
 		}
 	}
@@ -6,44 +6,75 @@
 
 #include <errno.h>
 #include <bluetooth/gatt_pool.h>
+#include <zephyr/sys/math_extras.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(bt_gatt_pool, CONFIG_BT_GATT_POOL_LOG_LEVEL);
 
 
+struct uuid_el {
+	/* Number of attributes that use the UUID. */
+	uint16_t refs;
+	/* Index + 1 of the next UUID in the hash bucket, 0 if none. */
+	uint8_t next;
+};
+
 struct svc_el_pool {
 	void *elements;
 	atomic_t *locks;
+	/* Reference counts and hash buckets, only used by the UUID pools. */
+	struct uuid_el *uuid_els;
+	uint8_t *buckets;
+	size_t el_size;
+	size_t el_cnt;
 };
 
 #if CONFIG_BT_GATT_UUID16_POOL_SIZE != 0
 static struct bt_uuid_16 uuid_16_tab[CONFIG_BT_GATT_UUID16_POOL_SIZE];
 static ATOMIC_DEFINE(uuid_16_locks, ARRAY_SIZE(uuid_16_tab));
+static struct uuid_el uuid_16_els[ARRAY_SIZE(uuid_16_tab)];
+static uint8_t uuid_16_buckets[ARRAY_SIZE(uuid_16_tab)];
 #define BT_UUID_16_TAB uuid_16_tab
 #define BT_UUID_16_LOCKS uuid_16_locks
+#define BT_UUID_16_ELS uuid_16_els
+#define BT_UUID_16_BUCKETS uuid_16_buckets
 #else
 #define BT_UUID_16_TAB NULL
 #define BT_UUID_16_LOCKS NULL
+#define BT_UUID_16_ELS NULL
+#define BT_UUID_16_BUCKETS NULL
 #endif
 
 #if CONFIG_BT_GATT_UUID32_POOL_SIZE != 0
 static struct bt_uuid_32 uuid_32_tab[CONFIG_BT_GATT_UUID32_POOL_SIZE];
 static ATOMIC_DEFINE(uuid_32_locks, ARRAY_SIZE(uuid_32_tab));
+static struct uuid_el uuid_32_els[ARRAY_SIZE(uuid_32_tab)];
+static uint8_t uuid_32_buckets[ARRAY_SIZE(uuid_32_tab)];
 #define BT_UUID_32_TAB uuid_32_tab
 #define BT_UUID_32_LOCKS uuid_32_locks
+#define BT_UUID_32_ELS uuid_32_els
+#define BT_UUID_32_BUCKETS uuid_32_buckets
 #else
 #define BT_UUID_32_TAB NULL
 #define BT_UUID_32_LOCKS NULL
+#define BT_UUID_32_ELS NULL
+#define BT_UUID_32_BUCKETS NULL
 #endif
 
 #if CONFIG_BT_GATT_UUID128_POOL_SIZE != 0
 static struct bt_uuid_128 uuid_128_tab[CONFIG_BT_GATT_UUID128_POOL_SIZE];
 static ATOMIC_DEFINE(uuid_128_locks, ARRAY_SIZE(uuid_128_tab));
+static struct uuid_el uuid_128_els[ARRAY_SIZE(uuid_128_tab)];
+static uint8_t uuid_128_buckets[ARRAY_SIZE(uuid_128_tab)];
 #define BT_UUID_128_TAB uuid_128_tab
 #define BT_UUID_128_LOCKS uuid_128_locks
+#define BT_UUID_128_ELS uuid_128_els
+#define BT_UUID_128_BUCKETS uuid_128_buckets
 #else
 #define BT_UUID_128_TAB NULL
 #define BT_UUID_128_LOCKS NULL
+#define BT_UUID_128_ELS NULL
+#define BT_UUID_128_BUCKETS NULL
 #endif
 
 #if CONFIG_BT_GATT_CHRC_POOL_SIZE != 0
@@ -59,20 +90,37 @@ static ATOMIC_DEFINE(chrc_locks, ARRAY_SIZE(chrc_tab));
 static struct svc_el_pool uuid_16_pool = {
 	.elements = BT_UUID_16_TAB,
 	.locks = BT_UUID_16_LOCKS,
+	.uuid_els = BT_UUID_16_ELS,
+	.buckets = BT_UUID_16_BUCKETS,
+	.el_size = sizeof(struct bt_uuid_16),
+	.el_cnt = CONFIG_BT_GATT_UUID16_POOL_SIZE,
 };
 static struct svc_el_pool uuid_32_pool = {
 	.elements = BT_UUID_32_TAB,
 	.locks = BT_UUID_32_LOCKS,
+	.uuid_els = BT_UUID_32_ELS,
+	.buckets = BT_UUID_32_BUCKETS,
+	.el_size = sizeof(struct bt_uuid_32),
+	.el_cnt = CONFIG_BT_GATT_UUID32_POOL_SIZE,
 };
 static struct svc_el_pool uuid_128_pool = {
 	.elements = BT_UUID_128_TAB,
 	.locks = BT_UUID_128_LOCKS,
+	.uuid_els = BT_UUID_128_ELS,
+	.buckets = BT_UUID_128_BUCKETS,
+	.el_size = sizeof(struct bt_uuid_128),
+	.el_cnt = CONFIG_BT_GATT_UUID128_POOL_SIZE,
 };
 static struct svc_el_pool chrc_pool = {
 	.elements = BT_GATT_CHRC_TAB,
 	.locks = BT_GATT_CHRC_LOCKS,
+	.el_size = sizeof(struct bt_gatt_chrc),
+	.el_cnt = CONFIG_BT_GATT_CHRC_POOL_SIZE,
 };
 
+/* Protects the UUID reference counts and hash buckets. */
+static struct k_spinlock uuid_lock;
+
 static struct bt_uuid const * const uuid_primary = BT_UUID_GATT_PRIMARY;
 static struct bt_uuid const * const uuid_chrc = BT_UUID_GATT_CHRC;
 static struct bt_uuid const * const uuid_ccc = BT_UUID_GATT_CCC;
@@ -88,75 +136,89 @@ static struct bt_uuid const * const uuid_ccc = BT_UUID_GATT_CCC;
 #define ADDR_2_INDEX(pool, el)                                                 \
 	((((uint32_t)el) - ((uint32_t)pool)) / (sizeof(pool[0])))
 
-static size_t free_element_find(struct svc_el_pool *el_pool, size_t el_cnt)
+static void *el_get(struct svc_el_pool *el_pool, size_t ind)
 {
-	__ASSERT((el_pool->elements != NULL) && (el_pool->locks != NULL),
-		 "Pool uninitialized");
-
-	for (size_t i = 0; i < el_cnt; i++) {
-		if (!atomic_test_and_set_bit(el_pool->locks, i)) {
-			return i;
-		}
-	}
-	return el_cnt;
+	return (uint8_t *)el_pool->elements + ind * el_pool->el_size;
 }
 
-static int uuid_16_get(struct bt_uuid **uuid, struct svc_el_pool *uuid_pool)
+static size_t free_element_find(struct svc_el_pool *el_pool)
 {
-	size_t ind = free_element_find(uuid_pool,
-				       CONFIG_BT_GATT_UUID16_POOL_SIZE);
+	__ASSERT(!el_pool->el_cnt ||
+		 ((el_pool->elements != NULL) && (el_pool->locks != NULL)),
+		 "Pool uninitialized");
 
-	if (ind >= CONFIG_BT_GATT_UUID16_POOL_SIZE) {
-		LOG_ERR("No more UUID16s in the pool!");
-		return -ENOMEM;
+	/* Check a whole word of the lock mask at a time. */
+	for (size_t i = 0; i < el_pool->el_cnt; i += ATOMIC_BITS) {
+		atomic_t *locks = &el_pool->locks[ATOMIC_ELEM(i)];
+		atomic_val_t val = atomic_get(locks);
+
+		while (~val) {
+			size_t ind = i + u64_count_trailing_zeros((unsigned long)~val);
+
+			if (ind >= el_pool->el_cnt) {
+				break;
+			}
+
+			if (!atomic_test_and_set_bit(el_pool->locks, ind)) {
+				return ind;
+			}
+
+			/* Taken by another thread in the meantime. */
+			val = atomic_get(locks);
+		}
 	}
 
-	*uuid = (struct bt_uuid *)
-		&((struct bt_uuid_16 *) uuid_pool->elements)[ind];
-	return 0;
+	return el_pool->el_cnt;
 }
 
-static int uuid_32_get(struct bt_uuid **uuid, struct svc_el_pool *uuid_pool)
+static struct svc_el_pool *uuid_pool_get(uint8_t type)
 {
-	size_t ind = free_element_find(uuid_pool,
-				       CONFIG_BT_GATT_UUID32_POOL_SIZE);
-
-	if (ind >= CONFIG_BT_GATT_UUID32_POOL_SIZE) {
-		LOG_ERR("No more UUID32s in the pool!");
-		return -ENOMEM;
+	switch (type) {
+	case BT_UUID_TYPE_16:
+		return &uuid_16_pool;
+	case BT_UUID_TYPE_32:
+		return &uuid_32_pool;
+	case BT_UUID_TYPE_128:
+		return &uuid_128_pool;
+	default:
+		return NULL;
 	}
-
-	*uuid = (struct bt_uuid *)
-		&((struct bt_uuid_32 *) uuid_pool->elements)[ind];
-	return 0;
 }
 
-static int uuid_128_get(struct bt_uuid **uuid, struct svc_el_pool *uuid_pool)
+static uint8_t *uuid_bucket_get(struct svc_el_pool *uuid_pool,
+				struct bt_uuid const *uuid)
 {
-	size_t ind = free_element_find(uuid_pool,
-				       CONFIG_BT_GATT_UUID128_POOL_SIZE);
+	uint32_t hash;
 
-	if (ind >= CONFIG_BT_GATT_UUID128_POOL_SIZE) {
-		LOG_ERR("No more UUID128s in the pool!");
-		return -ENOMEM;
+	switch (uuid->type) {
+	case BT_UUID_TYPE_16:
+		hash = BT_UUID_16(uuid)->val;
+		break;
+	case BT_UUID_TYPE_32:
+		hash = BT_UUID_32(uuid)->val;
+		break;
+	default:
+		/* FNV-1a, as vendor-specific UUIDs often differ in a few bytes. */
+		hash = 2166136261U;
+		for (size_t i = 0; i < sizeof(BT_UUID_128(uuid)->val); i++) {
+			hash = (hash ^ BT_UUID_128(uuid)->val[i]) * 16777619U;
+		}
+		break;
 	}
 
-	*uuid = (struct bt_uuid *)
-		&((struct bt_uuid_128 *) uuid_pool->elements)[ind];
-	return 0;
+	return &uuid_pool->buckets[hash % uuid_pool->el_cnt];
 }
 
 static int chrc_get(struct bt_gatt_chrc **chrc)
 {
-	size_t ind = free_element_find(&chrc_pool,
-				       CONFIG_BT_GATT_CHRC_POOL_SIZE);
+	size_t ind = free_element_find(&chrc_pool);
 
 	if (ind >= CONFIG_BT_GATT_CHRC_POOL_SIZE) {
 		LOG_ERR("No more chrc descriptors in the pool!");
 		return -ENOMEM;
 	}
 
-	*chrc = &((struct bt_gatt_chrc *) chrc_pool.elements)[ind];
+	*chrc = el_get(&chrc_pool, ind);
 	return 0;
 }
 
@@ -167,73 +229,99 @@ static void chrc_release(struct bt_gatt_chrc const *chrc)
 			 ADDR_2_INDEX(BT_GATT_CHRC_TAB, chrc));
 }
 
+/* Attributes with the same UUID share one pool element, which is reference
+ * counted. The registered UUIDs are looked up in a hash table.
+ */
 static int uuid_register(struct bt_uuid **dest_uuid,
 			 struct bt_uuid const *src_uuid)
 {
-	int ret = -EINVAL;
+	struct svc_el_pool *uuid_pool = uuid_pool_get(src_uuid->type);
+	k_spinlock_key_t key;
+	uint8_t *bucket;
+	size_t ind;
 
 	__ASSERT(*dest_uuid == NULL, "Overriding attribute UUID!");
 
-	switch (src_uuid->type) {
-	case BT_UUID_TYPE_16:
-		ret = uuid_16_get(dest_uuid, &uuid_16_pool);
-		if (!ret) {
-			memcpy(*dest_uuid, src_uuid, sizeof(struct bt_uuid_16));
-		}
-		break;
+	if (!uuid_pool) {
+		LOG_ERR("Unknown UUID type");
+		return -EINVAL;
+	}
 
-	case BT_UUID_TYPE_32:
-		ret = uuid_32_get(dest_uuid, &uuid_32_pool);
-		if (!ret) {
-			memcpy(*dest_uuid, src_uuid, sizeof(struct bt_uuid_32));
-		}
-		break;
+	if (!uuid_pool->el_cnt) {
+		LOG_ERR("No more UUIDs of type %u in the pool!", src_uuid->type);
+		return -ENOMEM;
+	}
 
-	case BT_UUID_TYPE_128:
-		ret = uuid_128_get(dest_uuid, &uuid_128_pool);
-		if (!ret) {
-			memcpy(*dest_uuid, src_uuid,
-			       sizeof(struct bt_uuid_128));
+	key = k_spin_lock(&uuid_lock);
+
+	bucket = uuid_bucket_get(uuid_pool, src_uuid);
+	for (uint8_t n = *bucket; n; n = uuid_pool->uuid_els[n - 1].next) {
+		struct uuid_el *uuid_el = &uuid_pool->uuid_els[n - 1];
+		struct bt_uuid *uuid = el_get(uuid_pool, n - 1);
+
+		if (uuid_el->refs < UINT16_MAX && !bt_uuid_cmp(uuid, src_uuid)) {
+			uuid_el->refs++;
+			k_spin_unlock(&uuid_lock, key);
+
+			*dest_uuid = uuid;
+			return 0;
 		}
-		break;
+	}
 
-	default:
-		LOG_ERR("Unknown UUID type");
-		break;
+	ind = free_element_find(uuid_pool);
+	if (ind >= uuid_pool->el_cnt) {
+		k_spin_unlock(&uuid_lock, key);
+		LOG_ERR("No more UUIDs of type %u in the pool!", src_uuid->type);
+		return -ENOMEM;
 	}
-	return ret;
+
+	*dest_uuid = el_get(uuid_pool, ind);
+	memcpy(*dest_uuid, src_uuid, uuid_pool->el_size);
+
+	uuid_pool->uuid_els[ind].refs = 1;
+	uuid_pool->uuid_els[ind].next = *bucket;
+	*bucket = ind + 1;
+
+	k_spin_unlock(&uuid_lock, key);
+
+	return 0;
 }
 
 static void uuid_unregister(struct bt_uuid const *uuid)
 {
-	switch (uuid->type) {
-	case BT_UUID_TYPE_16:
-		EL_IN_POOL_VERIFY(BT_UUID_16_TAB, uuid);
-#if CONFIG_BT_GATT_UUID16_POOL_SIZE != 0
-		atomic_clear_bit(uuid_16_pool.locks,
-				 ADDR_2_INDEX(BT_UUID_16_TAB, uuid));
-#endif
-		break;
+	struct svc_el_pool *uuid_pool = uuid_pool_get(uuid->type);
+	k_spinlock_key_t key;
+	uint8_t *link;
+	size_t ind;
 
-	case BT_UUID_TYPE_32:
-		EL_IN_POOL_VERIFY(BT_UUID_32_TAB, uuid);
-#if CONFIG_BT_GATT_UUID32_POOL_SIZE != 0
-		atomic_clear_bit(uuid_32_pool.locks,
-				 ADDR_2_INDEX(BT_UUID_32_TAB, uuid));
-#endif
-		break;
+	if (!uuid_pool) {
+		__ASSERT(false, "Unknown UUID type");
+		return;
+	}
 
-	case BT_UUID_TYPE_128:
-		EL_IN_POOL_VERIFY(BT_UUID_128_TAB, uuid);
-#if CONFIG_BT_GATT_UUID128_POOL_SIZE != 0
-		atomic_clear_bit(uuid_128_pool.locks,
-				 ADDR_2_INDEX(BT_UUID_128_TAB, uuid));
-#endif
-		break;
+	ind = ((uint8_t *)uuid - (uint8_t *)uuid_pool->elements) /
+	      uuid_pool->el_size;
+	__ASSERT(((uint8_t *)uuid >= (uint8_t *)uuid_pool->elements) &&
+		 (ind < uuid_pool->el_cnt),
+		 "Element does not belong to the pool");
 
-	default:
-		__ASSERT(false, "Unknown UUID type");
+	key = k_spin_lock(&uuid_lock);
+
+	if (--uuid_pool->uuid_els[ind].refs) {
+		k_spin_unlock(&uuid_lock, key);
+		return;
 	}
+
+	/* Unlink the UUID from its hash bucket before releasing it. */
+	for (link = uuid_bucket_get(uuid_pool, uuid); *link != ind + 1;
+	     link = &uuid_pool->uuid_els[*link - 1].next) {
+		__ASSERT_NO_MSG(*link);
+	}
+	*link = uuid_pool->uuid_els[ind].next;
+
+	atomic_clear_bit(uuid_pool->locks, ind);
+
+	k_spin_unlock(&uuid_lock, key);
 }
 
 /** @brief Free a single attribute.
@@ -400,6 +488,59 @@ int bt_gatt_pool_ccc_alloc(struct bt_gatt_pool *gp,
 	return 0;
 }
 
+int bt_gatt_pool_attrs_alloc(struct bt_gatt_pool *gp,
+			     struct bt_gatt_attr const *attrs, size_t count)
+{
+	int ret = 0;
+	size_t start;
+
+	if (!gp || !gp->svc.attrs || !attrs) {
+		LOG_ERR("Invalid attribute");
+		return -EINVAL;
+	}
+	if ((gp->svc.attr_count + count) > gp->attr_array_size) {
+		LOG_ERR("No space left on given svc");
+		return -ENOSPC;
+	}
+
+	start = gp->svc.attr_count;
+
+	for (size_t i = 0; (i < count) && !ret; i++) {
+		struct bt_gatt_attr const *attr = &attrs[i];
+
+		if (!bt_uuid_cmp(attr->uuid, uuid_primary)) {
+			ret = bt_gatt_pool_svc_alloc(gp, attr->user_data);
+		} else if (!bt_uuid_cmp(attr->uuid, uuid_chrc)) {
+			struct bt_gatt_chrc const *chrc = attr->user_data;
+
+			/* The declaration is followed by the value attribute. */
+			if ((++i >= count) ||
+			    bt_uuid_cmp(attrs[i].uuid, chrc->uuid)) {
+				LOG_ERR("No value attribute for characteristic");
+				ret = -EINVAL;
+				break;
+			}
+
+			ret = bt_gatt_pool_chrc_alloc(gp, chrc->properties,
+						      &attrs[i]);
+		} else if (!bt_uuid_cmp(attr->uuid, uuid_ccc)) {
+			ret = bt_gatt_pool_ccc_alloc(gp, attr->user_data,
+						     attr->perm);
+		} else {
+			ret = bt_gatt_pool_desc_alloc(gp, attr);
+		}
+	}
+
+	if (ret) {
+		/* Release the attributes taken so far. */
+		for (size_t n = start; n < gp->svc.attr_count; ++n) {
+			bt_gatt_pool_attr_free(&gp->svc.attrs[n]);
+		}
+		gp->svc.attr_count = start;
+	}
+
+	return ret;
+}
 
 void bt_gatt_pool_free(struct bt_gatt_pool *gp)
 {
@@ -18,6 +18,7 @@ void bt_mesh_light_ctrl_reg_target_set(struct bt_mesh_light_ctrl_reg *reg,
 	}
 	reg->transition_start = k_uptime_get();
 	reg->transition_time = transition_time;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
 }
 
 float bt_mesh_light_ctrl_reg_target_get(struct bt_mesh_light_ctrl_reg *reg)
@@ -4,10 +4,164 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <string.h>
 #include <bluetooth/mesh/light_ctrl_reg_spec.h>
 
 #define REG_INT CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL
 
+static uint16_t reg_interval(struct bt_mesh_light_ctrl_reg_spec *spec_reg)
+{
+	return spec_reg->interval ? spec_reg->interval : REG_INT;
+}
+
+#if defined(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_FIXED_POINT)
+
+/* Fixed-point values have 16 fractional bits. */
+#define FP_SHIFT 16
+#define FP_ONE BIT64(FP_SHIFT)
+#define FP_LIGHTNESS_MAX ((int64_t)UINT16_MAX << FP_SHIFT)
+
+static int64_t fp_from_float(float value)
+{
+	return (int64_t)(value * FP_ONE);
+}
+
+static bool reg_input_equal(struct bt_mesh_light_ctrl_reg_spec *spec_reg, float target)
+{
+	/* Compare the representations, so that no float operations are needed. */
+	return spec_reg->input.valid &&
+	       !memcmp(&spec_reg->input.measured, &spec_reg->reg.measured, sizeof(float)) &&
+	       !memcmp(&spec_reg->input.target, &target, sizeof(float)) &&
+	       !memcmp(&spec_reg->input.cfg, &spec_reg->reg.cfg, sizeof(spec_reg->reg.cfg));
+}
+
+/** @brief Update the regulator terms from the regulator input.
+ *
+ *  The terms are only calculated again if the input changed since the
+ *  previous step.
+ *
+ *  @return true if the input changed, false otherwise.
+ */
+static bool reg_terms_update(struct bt_mesh_light_ctrl_reg_spec *spec_reg)
+{
+	float target = bt_mesh_light_ctrl_reg_target_get(&spec_reg->reg);
+	const struct bt_mesh_light_ctrl_reg_cfg *cfg = &spec_reg->reg.cfg;
+	int64_t target_fp, error, accuracy, input;
+	float kp, ki;
+
+	if (reg_input_equal(spec_reg, target)) {
+		return false;
+	}
+
+	spec_reg->input.cfg = *cfg;
+	spec_reg->input.measured = spec_reg->reg.measured;
+	spec_reg->input.target = target;
+	spec_reg->input.valid = true;
+
+	target_fp = fp_from_float(target);
+	error = target_fp - fp_from_float(spec_reg->reg.measured);
+	/* Accuracy should be in percent and both up and down: */
+	accuracy = (target_fp * fp_from_float(cfg->accuracy)) / (2 * 100 * FP_ONE);
+
+	if (error > accuracy) {
+		input = error - accuracy;
+	} else if (error < -accuracy) {
+		input = error + accuracy;
+	} else {
+		input = 0;
+	}
+
+	if (input >= 0) {
+		kp = cfg->kp.up;
+		ki = cfg->ki.up;
+	} else {
+		kp = cfg->kp.down;
+		ki = cfg->ki.down;
+	}
+
+	/* The integral term is scaled by the step interval: */
+	spec_reg->i_step = ((input * fp_from_float(ki)) >> FP_SHIFT) * reg_interval(spec_reg) /
+			   MSEC_PER_SEC;
+	spec_reg->p = (input * fp_from_float(kp)) >> FP_SHIFT;
+
+	return true;
+}
+
+static void reg_step(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct bt_mesh_light_ctrl_reg_spec *spec_reg = CONTAINER_OF(
+		dwork, struct bt_mesh_light_ctrl_reg_spec, timer);
+	bool changed;
+	int64_t i;
+
+	if (!spec_reg->enabled) {
+		/* The regulator might be disabled asynchronously. */
+		return;
+	}
+
+	changed = reg_terms_update(spec_reg);
+	i = spec_reg->i + spec_reg->i_step;
+
+	if (i >= 0) {
+		/* Drop the negative flag as soon as the internal sum becomes positive. */
+		spec_reg->neg = false;
+	}
+
+	if (!spec_reg->neg) {
+		i = CLAMP(i, 0, FP_LIGHTNESS_MAX);
+	}
+
+	/* With an unchanged input and internal sum, all following steps would give the same
+	 * output. This happens when the error is inside the accuracy band, or when the output
+	 * is saturated.
+	 */
+	spec_reg->suspended = !changed && i == spec_reg->i;
+	spec_reg->i = i;
+
+	spec_reg->reg.updated(&spec_reg->reg, (float)(i + spec_reg->p) / FP_ONE);
+
+	/* The input may have been updated during the step. */
+	if (spec_reg->suspended &&
+	    reg_input_equal(spec_reg, bt_mesh_light_ctrl_reg_target_get(&spec_reg->reg))) {
+#if CONFIG_BT_MESH_LIGHT_CTRL_AMB_LIGHT_LEVEL_TIMEOUT
+		/* Step once the measured value times out, to let the user reset it. */
+		k_work_reschedule(&spec_reg->timer,
+				  K_SECONDS(CONFIG_BT_MESH_LIGHT_CTRL_AMB_LIGHT_LEVEL_TIMEOUT));
+#endif
+		return;
+	}
+
+	spec_reg->suspended = false;
+	k_work_reschedule(&spec_reg->timer, K_MSEC(reg_interval(spec_reg)));
+}
+
+static void internal_sum_recover(struct bt_mesh_light_ctrl_reg_spec *spec_reg, uint16_t lightness)
+{
+	spec_reg->input.valid = false;
+	(void)reg_terms_update(spec_reg);
+
+	/* Recalculate the internal sum so that it is equal to the passed lightness level at the
+	 * next regulator step.
+	 */
+	spec_reg->i = ((int64_t)lightness << FP_SHIFT) - spec_reg->i_step;
+	/* Allow the internal sum to be negative until it becomes positive. */
+	spec_reg->neg = true;
+}
+
+void bt_mesh_light_ctrl_reg_spec_input_changed(struct bt_mesh_light_ctrl_reg *reg)
+{
+	struct bt_mesh_light_ctrl_reg_spec *spec_reg = CONTAINER_OF(
+		reg, struct bt_mesh_light_ctrl_reg_spec, reg);
+
+	if (spec_reg->enabled && spec_reg->suspended) {
+		spec_reg->suspended = false;
+		k_work_reschedule(&spec_reg->timer, K_MSEC(reg_interval(spec_reg)));
+	}
+}
+
+#else
+
 struct reg_terms {
 	float i;
 	float p;
@@ -39,7 +193,7 @@ static struct reg_terms reg_terms_calc(struct bt_mesh_light_ctrl_reg_spec *spec_
 	}
 
 	return (struct reg_terms){
-		.i = ((input) * (ki) * ((float)REG_INT / (float)MSEC_PER_SEC)),
+		.i = ((input) * (ki) * ((float)reg_interval(spec_reg) / (float)MSEC_PER_SEC)),
 		.p = input * kp,
 	};
 }
@@ -56,7 +210,7 @@ static void reg_step(struct k_work *work)
 		return;
 	}
 
-	k_work_reschedule(&spec_reg->timer, K_MSEC(REG_INT));
+	k_work_reschedule(&spec_reg->timer, K_MSEC(reg_interval(spec_reg)));
 
 	reg_terms = reg_terms_calc(spec_reg);
 	spec_reg->i += reg_terms.i;
@@ -89,12 +243,14 @@ static void internal_sum_recover(struct bt_mesh_light_ctrl_reg_spec *spec_reg, u
 	spec_reg->neg = true;
 }
 
+#endif
+
 void bt_mesh_light_ctrl_reg_spec_start(struct bt_mesh_light_ctrl_reg *reg, uint16_t lightness)
 {
 	struct bt_mesh_light_ctrl_reg_spec *spec_reg = CONTAINER_OF(
 		reg, struct bt_mesh_light_ctrl_reg_spec, reg);
 	spec_reg->enabled = true;
-	k_work_schedule(&spec_reg->timer, K_MSEC(REG_INT));
+	k_work_schedule(&spec_reg->timer, K_MSEC(reg_interval(spec_reg)));
 	internal_sum_recover(spec_reg, lightness);
 }
 
@@ -104,6 +260,9 @@ void bt_mesh_light_ctrl_reg_spec_stop(struct bt_mesh_light_ctrl_reg *reg)
 		reg, struct bt_mesh_light_ctrl_reg_spec, reg);
 	spec_reg->i = 0;
 	spec_reg->enabled = false;
+#if defined(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_FIXED_POINT)
+	spec_reg->suspended = false;
+#endif
 	k_work_cancel_delayable(&spec_reg->timer);
 }
 
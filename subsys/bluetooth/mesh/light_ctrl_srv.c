@@ -364,6 +364,14 @@ static void reg_updated(struct bt_mesh_light_ctrl_reg *reg, float value)
 		output = lvl;
 	}
 
+	/* The configured level changes along the fade, so a regulator that
+	 * suspends its steps on a stable output must keep stepping until the
+	 * transition is complete.
+	 */
+	if (atomic_test_bit(&srv->flags, FLAG_TRANSITION)) {
+		bt_mesh_light_ctrl_reg_input_changed(reg);
+	}
+
 	if (!atomic_test_and_clear_bit(&srv->flags, FLAG_REGULATOR) &&
 	    output == srv->reg_prev) {
 		return;
@@ -413,6 +421,10 @@ static void transition_start(struct bt_mesh_light_ctrl_srv *srv,
 	if (srv->reg) {
 		atomic_set_bit(&srv->flags, FLAG_REGULATOR);
 		bt_mesh_light_ctrl_reg_target_set(srv->reg, lux_getf(srv), fade_time);
+		/* The target may be unchanged, but the output follows the
+		 * light level of the new state:
+		 */
+		bt_mesh_light_ctrl_reg_input_changed(srv->reg);
 	}
 #endif
 }
@@ -529,6 +541,15 @@ static void reg_start(struct bt_mesh_light_ctrl_srv *srv)
 #endif
 }
 
+static void reg_input_changed(struct bt_mesh_light_ctrl_srv *srv)
+{
+#if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
+	if (srv->reg) {
+		bt_mesh_light_ctrl_reg_input_changed(srv->reg);
+	}
+#endif
+}
+
 static void reg_stop(struct bt_mesh_light_ctrl_srv *srv)
 {
 #if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
@@ -998,6 +1019,8 @@ static int handle_sensor_status(struct bt_mesh_model *model, struct bt_mesh_msg_
 #endif
 			if (!atomic_test_and_set_bit(&srv->flags, FLAG_AMBIENT_LUXLEVEL_SET)) {
 				reg_start(srv);
+			} else {
+				reg_input_changed(srv);
 			}
 			continue;
 		}
@@ -1362,6 +1385,8 @@ static int handle_prop_set(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *
 		return err;
 	}
 
+	reg_input_changed(srv);
+
 	(void)prop_tx(srv, ctx, id);
 	(void)prop_tx(srv, NULL, id);
 
@@ -1387,6 +1412,8 @@ static int handle_prop_set_unack(struct bt_mesh_model *model, struct bt_mesh_msg
 		return err;
 	}
 
+	reg_input_changed(srv);
+
 	(void)prop_tx(srv, NULL, id);
 
 	if (IS_ENABLED(CONFIG_BT_MESH_SCENE_SRV)) {
@@ -1507,6 +1534,7 @@ static void scene_recall(struct bt_mesh_model *model, const uint8_t data[],
 		srv->reg->cfg = scene->reg;
 	}
 #endif
+	reg_input_changed(srv);
 	if (scene->enabled) {
 		if (!is_enabled(srv)) {
 			ctrl_enable(srv);
@@ -226,6 +226,46 @@ int sensor_value_decode(struct net_buf_simple *buf,
 	return 0;
 }
 
+int sensor_value_encode_cached(struct net_buf_simple *buf,
+			       const struct bt_mesh_sensor_type *type,
+			       const struct sensor_value *values,
+			       struct bt_mesh_sensor_enc_cache *cache)
+{
+	size_t values_size = type->channel_count * sizeof(values[0]);
+	struct net_buf_simple_state state;
+	uint8_t len;
+	int err;
+
+	/* The encoding only depends on the value, reuse it if the value is unchanged. */
+	if (cache->len && !memcmp(cache->value, values, values_size)) {
+		if (net_buf_simple_tailroom(buf) < cache->len) {
+			return -ENOMEM;
+		}
+
+		net_buf_simple_add_mem(buf, cache->data, cache->len);
+		return 0;
+	}
+
+	net_buf_simple_save(buf, &state);
+
+	err = sensor_value_encode(buf, type, values);
+	if (err) {
+		return err;
+	}
+
+	len = buf->len - state.len;
+	if (len > sizeof(cache->data)) {
+		cache->len = 0;
+		return 0;
+	}
+
+	memcpy(cache->data, &buf->data[state.len], len);
+	memcpy(cache->value, values, values_size);
+	cache->len = len;
+
+	return 0;
+}
+
 int sensor_ch_encode(struct net_buf_simple *buf,
 		     const struct bt_mesh_sensor_format *format,
 		     const struct sensor_value *value)
@@ -245,19 +285,45 @@ int sensor_status_encode(struct net_buf_simple *buf,
 			 const struct sensor_value *values)
 {
 	const struct bt_mesh_sensor_type *type = sensor->type;
-	size_t size = 0;
 	int err;
 
-	for (uint32_t i = 0; i < type->channel_count; ++i) {
-		size += type->channels[i].format->size;
+	err = sensor_status_id_encode(buf, sensor_value_len(type), type->id);
+	if (err) {
+		return err;
 	}
 
-	err = sensor_status_id_encode(buf, size, type->id);
+	return sensor_value_encode(buf, type, values);
+}
+
+int sensor_status_encode_cached(struct net_buf_simple *buf,
+				struct bt_mesh_sensor *sensor,
+				const struct sensor_value *values)
+{
+#if defined(CONFIG_BT_MESH_SENSOR_SRV_VALUE_CACHE)
+	const struct bt_mesh_sensor_type *type = sensor->type;
+	int err;
+
+	err = sensor_status_id_encode(buf, sensor_value_len(type), type->id);
 	if (err) {
 		return err;
 	}
 
-	return sensor_value_encode(buf, type, values);
+	return sensor_value_encode_cached(buf, type, values, &sensor->state.enc);
+#else
+	return sensor_status_encode(buf, sensor, values);
+#endif
+}
+
+uint8_t sensor_status_len(const struct bt_mesh_sensor_type *type)
+{
+	uint8_t len = sensor_value_len(type);
+
+	/* Marshalled Sensor Data format A has a two byte header, format B a three byte header. */
+	if ((len > 0 && len <= 16) && type->id < 2048) {
+		return 2 + len;
+	}
+
+	return 3 + len;
 }
 
 const struct bt_mesh_sensor_format *
@@ -286,14 +352,10 @@ int sensor_column_value_encode(struct net_buf_simple *buf,
 	return sensor_value_encode(buf, sensor->type, values);
 }
 
-int sensor_column_encode(struct net_buf_simple *buf,
-			 struct bt_mesh_sensor_srv *srv,
-			 struct bt_mesh_sensor *sensor,
-			 struct bt_mesh_msg_ctx *ctx,
-			 const struct bt_mesh_sensor_column *col)
+int sensor_column_header_encode(struct net_buf_simple *buf,
+				const struct bt_mesh_sensor *sensor,
+				const struct bt_mesh_sensor_column *col)
 {
-	int col_index = col - sensor->series.columns;
-
 	const struct bt_mesh_sensor_format *col_format;
 	const uint64_t width_million =
 		(col->end.val1 - col->start.val1) * 1000000ULL +
@@ -317,7 +379,19 @@ int sensor_column_encode(struct net_buf_simple *buf,
 	}
 
 	/* The sensor columns are transmitted as start+width, not start+end: */
-	err = sensor_ch_encode(buf, col_format, &width);
+	return sensor_ch_encode(buf, col_format, &width);
+}
+
+int sensor_column_encode(struct net_buf_simple *buf,
+			 struct bt_mesh_sensor_srv *srv,
+			 struct bt_mesh_sensor *sensor,
+			 struct bt_mesh_msg_ctx *ctx,
+			 const struct bt_mesh_sensor_column *col)
+{
+	int col_index = col - sensor->series.columns;
+	int err;
+
+	err = sensor_column_header_encode(buf, sensor, col);
 	if (err) {
 		return err;
 	}
@@ -133,6 +133,11 @@ int sensor_status_encode(struct net_buf_simple *buf,
 			 const struct bt_mesh_sensor *sensor,
 			 const struct sensor_value *values);
 
+int sensor_status_encode_cached(struct net_buf_simple *buf,
+				struct bt_mesh_sensor *sensor,
+				const struct sensor_value *values);
+uint8_t sensor_status_len(const struct bt_mesh_sensor_type *type);
+
 int sensor_status_id_encode(struct net_buf_simple *buf, uint8_t len, uint16_t id);
 void sensor_status_id_decode(struct net_buf_simple *buf, uint8_t *len, uint16_t *id);
 
@@ -144,6 +149,10 @@ void sensor_descriptor_encode(struct net_buf_simple *buf,
 int sensor_value_encode(struct net_buf_simple *buf,
 			const struct bt_mesh_sensor_type *type,
 			const struct sensor_value *values);
+int sensor_value_encode_cached(struct net_buf_simple *buf,
+			       const struct bt_mesh_sensor_type *type,
+			       const struct sensor_value *values,
+			       struct bt_mesh_sensor_enc_cache *cache);
 int sensor_value_decode(struct net_buf_simple *buf,
 			const struct bt_mesh_sensor_type *type,
 			struct sensor_value *values);
@@ -160,6 +169,9 @@ int sensor_column_value_encode(struct net_buf_simple *buf,
 			       struct bt_mesh_sensor *sensor,
 			       struct bt_mesh_msg_ctx *ctx,
 			       uint32_t column_index);
+int sensor_column_header_encode(struct net_buf_simple *buf,
+				const struct bt_mesh_sensor *sensor,
+				const struct bt_mesh_sensor_column *col);
 int sensor_column_encode(struct net_buf_simple *buf,
 			 struct bt_mesh_sensor_srv *srv,
 			 struct bt_mesh_sensor *sensor,
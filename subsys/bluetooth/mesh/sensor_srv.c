@@ -24,13 +24,22 @@ LOG_MODULE_REGISTER(bt_mesh_sensor_srv);
 static struct bt_mesh_sensor *sensor_get(struct bt_mesh_sensor_srv *srv,
 					 uint16_t id)
 {
-	struct bt_mesh_sensor *sensor;
+	int lo = 0;
+	int hi = srv->sensor_count - 1;
+
+	while (lo <= hi) {
+		int mid = lo + (hi - lo) / 2;
+		struct bt_mesh_sensor *sensor = srv->sensors_by_id[mid];
 
-	SENSOR_FOR_EACH(&srv->sensors, sensor)
-	{
 		if (sensor->type->id == id) {
 			return sensor;
 		}
+
+		if (sensor->type->id < id) {
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
 	}
 
 	return NULL;
@@ -116,7 +125,7 @@ static int buf_status_add(struct bt_mesh_sensor_srv *srv,
 
 	net_buf_simple_save(buf, &state);
 
-	err = sensor_status_encode(buf, sensor, value);
+	err = sensor_status_encode_cached(buf, sensor, value);
 	if (err) {
 		LOG_WRN("Sensor value encode for 0x%04x: %d", sensor->type->id, err);
 		/* sensor_status_encode() could have encoded a part of Marshaled Sensor Data into
@@ -235,6 +244,80 @@ column_get(const struct bt_mesh_sensor_series *series,
 	return NULL;
 }
 
+static int series_column_encode(struct net_buf_simple *buf,
+				struct bt_mesh_sensor_srv *srv,
+				struct bt_mesh_sensor *sensor,
+				struct bt_mesh_msg_ctx *ctx,
+				uint32_t col_index)
+{
+#if CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE > 0
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+	struct bt_mesh_sensor_series_cache *entry;
+	int err;
+
+	err = sensor->series.get(srv, sensor, ctx, col_index, value);
+	if (err) {
+		return err;
+	}
+
+	entry = &srv->series_cache[(sensor->type->id + col_index) %
+				   CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE];
+
+	if (entry->sensor != sensor || entry->column != col_index) {
+		struct net_buf_simple header;
+
+		net_buf_simple_init_with_data(&header, entry->header,
+					      sizeof(entry->header));
+		net_buf_simple_reset(&header);
+
+		if (sensor->type->channel_count > 2) {
+			err = sensor_column_header_encode(
+				&header, sensor, &sensor->series.columns[col_index]);
+			if (err) {
+				entry->sensor = NULL;
+				return err;
+			}
+		}
+
+		entry->sensor = sensor;
+		entry->column = col_index;
+		entry->header_len = header.len;
+		entry->value.len = 0;
+	}
+
+	if (net_buf_simple_tailroom(buf) < entry->header_len) {
+		return -ENOMEM;
+	}
+
+	net_buf_simple_add_mem(buf, entry->header, entry->header_len);
+
+	return sensor_value_encode_cached(buf, sensor->type, value,
+					  &entry->value);
+#else
+	if (sensor->type->channel_count > 2) {
+		return sensor_column_encode(buf, srv, sensor, ctx,
+					    &sensor->series.columns[col_index]);
+	}
+
+	return sensor_column_value_encode(buf, srv, sensor, ctx, col_index);
+#endif
+}
+
+static void enc_cache_clear(struct bt_mesh_sensor_srv *srv,
+			    struct bt_mesh_sensor *sensor)
+{
+#if defined(CONFIG_BT_MESH_SENSOR_SRV_VALUE_CACHE)
+	sensor->state.enc.len = 0;
+#endif
+#if CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE > 0
+	for (size_t i = 0; i < ARRAY_SIZE(srv->series_cache); ++i) {
+		if (srv->series_cache[i].sensor == sensor) {
+			srv->series_cache[i].value.len = 0;
+		}
+	}
+#endif
+}
+
 static int handle_column_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
 			     struct net_buf_simple *buf)
 {
@@ -271,8 +354,7 @@ static int handle_column_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx
 			goto respond;
 		}
 
-		err = sensor_column_value_encode(&rsp, srv, sensor, ctx,
-						 col_index);
+		err = series_column_encode(&rsp, srv, sensor, ctx, col_index);
 		if (err) {
 			LOG_WRN("Failed encoding sensor column: %d", err);
 			return err;
@@ -309,7 +391,8 @@ static int handle_column_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx
 		goto respond;
 	}
 
-	err = sensor_column_encode(&rsp, srv, sensor, ctx, col);
+	err = series_column_encode(&rsp, srv, sensor, ctx,
+				   col - sensor->series.columns);
 	if (err) {
 		LOG_WRN("Failed encoding sensor column: %d", err);
 		return err;
@@ -384,8 +467,8 @@ static int handle_series_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx
 		}
 
 		for (uint32_t i = start; i <= end; i++) {
-			int err = sensor_column_value_encode(&rsp, srv, sensor,
-							     ctx, i);
+			int err = series_column_encode(&rsp, srv, sensor, ctx,
+						       i);
 
 			if (err) {
 				LOG_WRN("Column encode failed");
@@ -436,7 +519,7 @@ static int handle_series_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx
 
 		LOG_DBG("Column #%u", i);
 
-		int err = sensor_column_encode(&rsp, srv, sensor, ctx, col);
+		int err = series_column_encode(&rsp, srv, sensor, ctx, i);
 
 		if (err) {
 			LOG_WRN("Failed encoding: %d", err);
@@ -872,28 +955,31 @@ static uint16_t min_int_get(const struct bt_mesh_sensor *sensor,
 	return DIV_ROUND_UP(min_int, pub_int);
 }
 
-/** @brief Conditionally add a sensor value to a publication.
+/** @brief Check whether a sensor value should be added to a publication.
  *
- *  A sensor message will be added to the publication if its minimum interval
- *  has expired and the value is outside its delta threshold or the
+ *  A sensor message should be added to the publication if its minimum
+ *  interval has expired and the value is outside its delta threshold or the
  *  publication interval has expired.
  *
  *  @param srv         Server sending the publication.
- *  @param s           Sensor to add data of.
+ *  @param s           Sensor to check.
  *  @param period_div  Server's original period divisor.
  *  @param base_period Server's original base period.
+ *  @param value       Sensor value buffer, filled with the sensor value if
+ *                     it should be published.
+ *
+ *  @return true if the sensor value should be published, false otherwise.
  */
-static void pub_msg_add(struct bt_mesh_sensor_srv *srv,
+static bool pub_msg_due(struct bt_mesh_sensor_srv *srv,
 			struct bt_mesh_sensor *s, uint8_t period_div,
-			uint32_t base_period)
+			uint32_t base_period, struct sensor_value *value)
 {
-	struct net_buf_simple_state state;
 	uint16_t min_int = min_int_get(s, period_div, base_period);
 	uint16_t delta = srv->seq - s->state.seq;
 	int err;
 
 	if (delta < min_int) {
-		return;
+		return false;
 	}
 
 	if (!s->state.configured &&
@@ -901,14 +987,12 @@ static void pub_msg_add(struct bt_mesh_sensor_srv *srv,
 		/** Don't publish a sensor value with not configured sensor cadence state more
 		 * frequently than base periodic publication.
 		 */
-		return;
+		return false;
 	}
 
-	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX] = {};
-
 	err = value_get(srv, s, NULL, value);
 	if (err) {
-		return;
+		return false;
 	}
 
 	if (s->state.configured) {
@@ -916,12 +1000,28 @@ static void pub_msg_add(struct bt_mesh_sensor_srv *srv,
 		uint16_t interval = pub_int_get(s, period_div);
 
 		if (!delta_triggered && delta < interval) {
-			return;
+			return false;
 		}
 	}
 
+	return true;
+}
+
+/** @brief Add a sensor value to a publication.
+ *
+ *  @param srv   Server sending the publication.
+ *  @param s     Sensor to add data of.
+ *  @param value Sensor value to add.
+ */
+static void pub_msg_add(struct bt_mesh_sensor_srv *srv,
+			struct bt_mesh_sensor *s,
+			const struct sensor_value *value)
+{
+	struct net_buf_simple_state state;
+	int err;
+
 	net_buf_simple_save(srv->pub.msg, &state);
-	err = sensor_status_encode(srv->pub.msg, s, value);
+	err = sensor_status_encode_cached(srv->pub.msg, s, value);
 	if (err) {
 		LOG_WRN("Pub sensor value encode for 0x%04x: %d", s->type->id, err);
 		net_buf_simple_restore(srv->pub.msg, &state);
@@ -932,6 +1032,87 @@ static void pub_msg_add(struct bt_mesh_sensor_srv *srv,
 	s->state.seq = srv->seq;
 }
 
+#if defined(CONFIG_BT_MESH_SENSOR_SRV_PUB_UNSEGMENTED)
+/** @brief Add the sensor values that fit in an unsegmented message to a
+ *         publication.
+ *
+ *  The sensors that have waited the longest since their previous publication
+ *  are added first. The other sensors stay due, and are considered again in
+ *  the next publication.
+ *
+ *  @param srv         Server sending the publication.
+ *  @param period_div  Server's original period divisor.
+ *  @param base_period Server's original base period.
+ */
+static void pub_msg_pack(struct bt_mesh_sensor_srv *srv, uint8_t period_div,
+			 uint32_t base_period)
+{
+	NET_BUF_SIMPLE_DEFINE(scratch, BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN);
+	const size_t room_max = BT_MESH_SDU_UNSEG_MAX - srv->pub.msg->len;
+	bool due[CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX] = {};
+	bool add[CONFIG_BT_MESH_SENSOR_SRV_SENSORS_MAX] = {};
+	size_t room = room_max;
+
+	for (int i = 0; i < srv->sensor_count; ++i) {
+		struct bt_mesh_sensor *s = srv->sensors_by_id[i];
+		struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX] = {};
+
+		if (!pub_msg_due(srv, s, period_div, base_period, value)) {
+			continue;
+		}
+
+		/* Keep the value in the sensor's encoded value cache until it
+		 * is added to the publication.
+		 */
+		net_buf_simple_reset(&scratch);
+		due[i] = !sensor_value_encode_cached(&scratch, s->type, value,
+						     &s->state.enc) &&
+			 s->state.enc.len;
+	}
+
+	while (room > 0) {
+		uint16_t next_delta = 0;
+		int next = -1;
+		uint8_t len;
+
+		for (int i = 0; i < srv->sensor_count; ++i) {
+			uint16_t delta = srv->seq - srv->sensors_by_id[i]->state.seq;
+
+			if (due[i] && (next < 0 || delta > next_delta)) {
+				next = i;
+				next_delta = delta;
+			}
+		}
+
+		if (next < 0) {
+			break;
+		}
+
+		due[next] = false;
+		len = sensor_status_len(srv->sensors_by_id[next]->type);
+
+		/* A sensor value that doesn't fit in an unsegmented message
+		 * on its own is published alone.
+		 */
+		if (len > room && room < room_max) {
+			continue;
+		}
+
+		add[next] = true;
+		room -= MIN(len, room);
+	}
+
+	/* The sensor values must be sorted by sensor ID in the message: */
+	for (int i = 0; i < srv->sensor_count; ++i) {
+		struct bt_mesh_sensor *s = srv->sensors_by_id[i];
+
+		if (add[i]) {
+			pub_msg_add(srv, s, s->state.enc.value);
+		}
+	}
+}
+#endif
+
 static int update_handler(struct bt_mesh_model *model)
 {
 	struct bt_mesh_sensor_srv *srv = model->user_data;
@@ -956,9 +1137,19 @@ static int update_handler(struct bt_mesh_model *model)
 
 	srv->pub.fast_period = true;
 
+#if defined(CONFIG_BT_MESH_SENSOR_SRV_PUB_UNSEGMENTED)
+	pub_msg_pack(srv, period_div, base_period);
+#endif
+
 	SENSOR_FOR_EACH(&srv->sensors, s)
 	{
-		pub_msg_add(srv, s, period_div, base_period);
+#if !defined(CONFIG_BT_MESH_SENSOR_SRV_PUB_UNSEGMENTED)
+		struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX] = {};
+
+		if (pub_msg_due(srv, s, period_div, base_period, value)) {
+			pub_msg_add(srv, s, value);
+		}
+#endif
 
 		/** Update the publication divisor to a new value. This is needed to take new
 		 * changes in a sensor cadence state, .e.g. when the cadence decreased.
@@ -1006,6 +1197,7 @@ static int sensor_srv_init(struct bt_mesh_model *model)
 		}
 
 		sys_slist_append(&srv->sensors, &best->state.node);
+		srv->sensors_by_id[count] = best;
 		LOG_DBG("Sensor 0x%04x", best->type->id);
 		min_id = best->type->id + 1;
 	}
@@ -1043,6 +1235,7 @@ static void sensor_srv_reset(struct bt_mesh_model *model)
 		s->state.min_int = 0;
 		s->state.configured = false;
 		memset(&s->state.threshold, 0, sizeof(s->state.threshold));
+		enc_cache_clear(srv, s);
 	}
 
 	srv->pub.period_div = 0;
@@ -1150,7 +1343,7 @@ int bt_mesh_sensor_srv_pub(struct bt_mesh_sensor_srv *srv,
 				 BT_MESH_SENSOR_STATUS_MAXLEN);
 	bt_mesh_model_msg_init(&msg, BT_MESH_SENSOR_OP_STATUS);
 
-	err = sensor_status_encode(&msg, sensor, value);
+	err = sensor_status_encode_cached(&msg, sensor, value);
 	if (err) {
 		return err;
 	}
@@ -1172,6 +1365,9 @@ int bt_mesh_sensor_srv_sample(struct bt_mesh_sensor_srv *srv,
 	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX] = {};
 	int err;
 
+	/* A new sample is taken, drop the encodings of the previous values. */
+	enc_cache_clear(srv, sensor);
+
 	err = value_get(srv, sensor, NULL, value);
 	if (err) {
 		return -EBUSY;
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdlib.h>
+#include <bluetooth/mesh/transition.h>
+
+#define STEP_INTERVAL CONFIG_BT_MESH_TRANSITION_STEP_INTERVAL
+
+static void tick(struct k_work *work);
+
+/* All running transitions share a single timer. */
+static K_WORK_DELAYABLE_DEFINE(timer, tick);
+static sys_slist_t transitions;
+/* Protects the list of running transitions and their state, as transitions
+ * are started and stopped from the Bluetooth RX thread, and stepped on the
+ * system workqueue.
+ */
+static struct k_spinlock lock;
+
+/* Align step times to a common interval, so that transitions started at
+ * different times step together, with a single wakeup.
+ */
+static int64_t tick_align(int64_t time)
+{
+	return ROUND_UP(time, STEP_INTERVAL);
+}
+
+static int32_t value_at(const struct bt_mesh_transition *trans, int64_t elapsed)
+{
+	int64_t delta = (int64_t)trans->target - trans->start;
+
+	return trans->start + (delta * elapsed) / trans->duration;
+}
+
+/* Find the time of the next step, the first time the value changes after the
+ * present value. No steps are needed until then, not even at the end of the
+ * delay.
+ */
+static void due_update(struct bt_mesh_transition *trans)
+{
+	uint64_t distance = llabs((int64_t)trans->target - trans->start);
+	uint64_t moved = llabs((int64_t)trans->present - trans->start);
+	int64_t next;
+
+	if (trans->begin_pending) {
+		/* The begin handler needs a wakeup at the end of the delay. */
+		trans->due = tick_align(trans->start_time);
+		return;
+	}
+
+	if (moved >= distance) {
+		/* The value doesn't change, only the end of the transition is due. */
+		next = trans->duration;
+	} else {
+		next = MIN(DIV_ROUND_UP((moved + 1) * trans->duration, distance),
+			   trans->duration);
+	}
+
+	trans->due = tick_align(trans->start_time + next);
+}
+
+static void timer_update(void)
+{
+	struct bt_mesh_transition *trans;
+	int64_t due = INT64_MAX;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&transitions, trans, node) {
+		due = MIN(due, trans->due);
+	}
+
+	if (due == INT64_MAX) {
+		k_work_cancel_delayable(&timer);
+		return;
+	}
+
+	k_work_reschedule(&timer, K_MSEC(MAX(0, due - k_uptime_get())));
+}
+
+static struct bt_mesh_transition *next_due(int64_t now)
+{
+	struct bt_mesh_transition *trans;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&transitions, trans, node) {
+		if (trans->due <= now) {
+			return trans;
+		}
+	}
+
+	return NULL;
+}
+
+static void tick(struct k_work *work)
+{
+	struct bt_mesh_transition *trans;
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key;
+	int32_t value;
+
+	key = k_spin_lock(&lock);
+
+	/* The step handlers are called without the lock, and may start and
+	 * stop any transition, so the list is searched again after each step.
+	 * A stepped transition is never due again in the same tick.
+	 */
+	while ((trans = next_due(now))) {
+		if (trans->begin_pending) {
+			trans->begin_pending = false;
+			due_update(trans);
+			value = trans->present;
+
+			k_spin_unlock(&lock, key);
+			trans->begin(trans, value);
+			key = k_spin_lock(&lock);
+			continue;
+		}
+
+		if (now - trans->start_time >= trans->duration) {
+			value = trans->target;
+			trans->running = false;
+			sys_slist_find_and_remove(&transitions, &trans->node);
+		} else {
+			value = value_at(trans, now - trans->start_time);
+		}
+
+		if (value == trans->present && trans->running) {
+			due_update(trans);
+			continue;
+		}
+
+		trans->present = value;
+		if (trans->running) {
+			due_update(trans);
+		}
+
+		k_spin_unlock(&lock, key);
+		trans->step(trans, value);
+		key = k_spin_lock(&lock);
+	}
+
+	timer_update();
+	k_spin_unlock(&lock, key);
+}
+
+void bt_mesh_transition_start(struct bt_mesh_transition *trans, int32_t present,
+			      int32_t target,
+			      const struct bt_mesh_model_transition *transition)
+{
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key;
+	bool begin_now;
+
+	key = k_spin_lock(&lock);
+
+	if (trans->running) {
+		sys_slist_find_and_remove(&transitions, &trans->node);
+	}
+
+	trans->begin_pending = false;
+
+	trans->start = present;
+	trans->present = present;
+	trans->target = target;
+
+	if (!bt_mesh_model_transition_time(transition)) {
+		trans->running = false;
+		trans->present = target;
+		timer_update();
+		k_spin_unlock(&lock, key);
+
+		trans->step(trans, target);
+		return;
+	}
+
+	begin_now = trans->begin && !transition->delay;
+
+	trans->running = true;
+	trans->begin_pending = trans->begin && transition->delay;
+	trans->start_time = now + transition->delay;
+	trans->duration = transition->time;
+	due_update(trans);
+	sys_slist_append(&transitions, &trans->node);
+	timer_update();
+
+	k_spin_unlock(&lock, key);
+
+	if (begin_now) {
+		trans->begin(trans, present);
+	}
+}
+
+void bt_mesh_transition_stop(struct bt_mesh_transition *trans)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+
+	if (trans->running) {
+		trans->running = false;
+		sys_slist_find_and_remove(&transitions, &trans->node);
+		timer_update();
+	}
+
+	k_spin_unlock(&lock, key);
+}
+
+uint32_t bt_mesh_transition_remaining_get(const struct bt_mesh_transition *trans)
+{
+	uint32_t remaining = 0;
+	k_spinlock_key_t key;
+	int64_t elapsed;
+
+	key = k_spin_lock(&lock);
+
+	if (trans->running) {
+		elapsed = MAX(0, k_uptime_get() - trans->start_time);
+		remaining = trans->duration - MIN(elapsed, trans->duration);
+	}
+
+	k_spin_unlock(&lock, key);
+
+	return remaining;
+}
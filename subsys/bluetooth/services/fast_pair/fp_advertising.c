@@ -37,10 +37,25 @@ enum fp_field_type {
 	FP_FIELD_TYPE_HIDE_BATTERY_UI_INDICATION = 0b0100,
 };
 
+#define AK_FILTER_MAX_SIZE			BIT_MASK(LEN_BITS)
+
 static const uint16_t fast_pair_uuid = FP_SERVICE_UUID;
 static const uint8_t version_and_flags;
 static const uint8_t empty_account_key_list;
 
+/* Account Key Filter of the last not discoverable advertising data. The filter is reused as long
+ * as the salt, the Account Keys and the battery data used to generate it do not change.
+ */
+static struct {
+	bool valid;
+	uint16_t salt;
+	bool has_battery_info;
+	uint8_t battery_info[FP_CRYPTO_BATTERY_INFO_LEN];
+	size_t account_key_cnt;
+	struct fp_account_key ak[CONFIG_BT_FAST_PAIR_STORAGE_ACCOUNT_KEY_MAX];
+	uint8_t filter[AK_FILTER_MAX_SIZE];
+} ak_filter_cache;
+
 static int check_adv_config_range(struct bt_fast_pair_adv_config fp_adv_config)
 {
 	if ((fp_adv_config.mode >= BT_FAST_PAIR_ADV_MODE_COUNT) || (fp_adv_config.mode < 0)) {
@@ -146,9 +161,61 @@ static void fp_adv_data_fill_battery_info(uint8_t *battery_info,
 	}
 }
 
+static bool ak_filter_cache_match(const struct fp_account_key *ak, size_t account_key_cnt,
+				  uint16_t salt, const uint8_t *battery_info)
+{
+	if (!ak_filter_cache.valid || (ak_filter_cache.salt != salt) ||
+	    (ak_filter_cache.account_key_cnt != account_key_cnt) ||
+	    (ak_filter_cache.has_battery_info != (battery_info != NULL))) {
+		return false;
+	}
+
+	if (battery_info && memcmp(ak_filter_cache.battery_info, battery_info,
+				   sizeof(ak_filter_cache.battery_info))) {
+		return false;
+	}
+
+	return !memcmp(ak_filter_cache.ak, ak, account_key_cnt * sizeof(ak[0]));
+}
+
+static int ak_filter_get(uint8_t *out, const struct fp_account_key *ak, size_t account_key_cnt,
+			 uint16_t salt, const uint8_t *battery_info)
+{
+	size_t ak_filter_size = fp_crypto_account_key_filter_size(account_key_cnt);
+	int err;
+
+	__ASSERT_NO_MSG(ak_filter_size <= sizeof(ak_filter_cache.filter));
+
+	if (ak_filter_cache_match(ak, account_key_cnt, salt, battery_info)) {
+		memcpy(out, ak_filter_cache.filter, ak_filter_size);
+		return 0;
+	}
+
+	ak_filter_cache.valid = false;
+
+	err = fp_crypto_account_key_filter(out, ak, account_key_cnt, salt, battery_info);
+	if (err) {
+		return err;
+	}
+
+	ak_filter_cache.salt = salt;
+	ak_filter_cache.has_battery_info = (battery_info != NULL);
+	if (battery_info) {
+		memcpy(ak_filter_cache.battery_info, battery_info,
+		       sizeof(ak_filter_cache.battery_info));
+	}
+	ak_filter_cache.account_key_cnt = account_key_cnt;
+	memcpy(ak_filter_cache.ak, ak, account_key_cnt * sizeof(ak[0]));
+	memcpy(ak_filter_cache.filter, out, ak_filter_size);
+	ak_filter_cache.valid = true;
+
+	return 0;
+}
+
 static int fp_adv_data_fill_non_discoverable(struct net_buf_simple *buf, size_t account_key_cnt,
 					     enum fp_field_type ak_filter_type,
-					     enum bt_fast_pair_adv_battery_mode adv_battery_mode)
+					     enum bt_fast_pair_adv_battery_mode adv_battery_mode,
+					     bool keep_salt)
 {
 	uint8_t battery_info[FP_CRYPTO_BATTERY_INFO_LEN];
 	bool add_battery_info = ((adv_battery_mode != BT_FAST_PAIR_ADV_BATTERY_MODE_NONE) &&
@@ -169,6 +236,8 @@ static int fp_adv_data_fill_non_discoverable(struct net_buf_simple *buf, size_t
 	}
 
 	if (account_key_cnt == 0) {
+		/* Do not keep copies of removed Account Keys. */
+		memset(&ak_filter_cache, 0, sizeof(ak_filter_cache));
 		net_buf_simple_add_u8(buf, empty_account_key_list);
 	} else {
 		struct fp_account_key ak[CONFIG_BT_FAST_PAIR_STORAGE_ACCOUNT_KEY_MAX];
@@ -177,9 +246,13 @@ static int fp_adv_data_fill_non_discoverable(struct net_buf_simple *buf, size_t
 		uint16_t salt;
 		int err;
 
-		err = sys_csrand_get(&salt, sizeof(salt));
-		if (err) {
-			return err;
+		if (keep_salt && ak_filter_cache.valid) {
+			salt = ak_filter_cache.salt;
+		} else {
+			err = sys_csrand_get(&salt, sizeof(salt));
+			if (err) {
+				return err;
+			}
 		}
 
 		err = fp_storage_ak_get(ak, &account_key_get_cnt);
@@ -193,12 +266,11 @@ static int fp_adv_data_fill_non_discoverable(struct net_buf_simple *buf, size_t
 
 		BUILD_ASSERT(sizeof(uint8_t) == FIELD_LEN_TYPE_SIZE);
 
-		__ASSERT_NO_MSG(ak_filter_size <= BIT_MASK(LEN_BITS));
+		__ASSERT_NO_MSG(ak_filter_size <= AK_FILTER_MAX_SIZE);
 		net_buf_simple_add_u8(buf, ENCODE_FIELD_LEN_TYPE(ak_filter_size, ak_filter_type));
 
-		err = fp_crypto_account_key_filter(net_buf_simple_add(buf, ak_filter_size), ak,
-						   account_key_cnt, salt,
-						   add_battery_info ? battery_info : NULL);
+		err = ak_filter_get(net_buf_simple_add(buf, ak_filter_size), ak, account_key_cnt,
+				    salt, add_battery_info ? battery_info : NULL);
 		if (err) {
 			return err;
 		}
@@ -262,7 +334,8 @@ int bt_fast_pair_adv_data_fill(struct bt_data *bt_adv_data, uint8_t *buf, size_t
 			ak_filter_type = FP_FIELD_TYPE_HIDE_PAIRING_UI_INDICATION;
 		}
 		err = fp_adv_data_fill_non_discoverable(&nb, account_key_cnt, ak_filter_type,
-							fp_adv_config.not_disc.battery_mode);
+							fp_adv_config.not_disc.battery_mode,
+							fp_adv_config.not_disc.keep_salt);
 	}
 
 	if (!err) {
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/__assert.h>
 #include <zephyr/sys/atomic.h>
 #include <zephyr/settings/settings.h>
@@ -27,6 +28,16 @@ static uint8_t account_key_ids[ACCOUNT_KEY_CNT];
 static uint8_t account_key_count;
 
 static uint8_t account_key_order[ACCOUNT_KEY_CNT];
+/* Protects the Account Key order, which is updated by the Bluetooth thread and saved
+ * from the system workqueue.
+ */
+static K_MUTEX_DEFINE(ak_order_mutex);
+
+#define AK_ORDER_SAVE_DELAY K_MSEC(CONFIG_BT_FAST_PAIR_STORAGE_AK_ORDER_SAVE_DELAY)
+
+static void ak_order_save_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(ak_order_save_work, ak_order_save_work_handler);
 
 static int settings_set_err;
 static bool reset_prepare;
@@ -154,7 +165,7 @@ static uint8_t next_account_key_id(void)
 	return bump_ak_id(get_least_recent_key_id());
 }
 
-static void ak_order_update_ram(uint8_t used_id)
+static bool ak_order_update_ram(uint8_t used_id)
 {
 	bool id_found = false;
 	size_t found_idx;
@@ -167,6 +178,11 @@ static void ak_order_update_ram(uint8_t used_id)
 		}
 	}
 
+	if (id_found && (found_idx == 0)) {
+		/* The key is already the most recently used one. */
+		return false;
+	}
+
 	if (id_found) {
 		for (size_t i = found_idx; i > 0; i--) {
 			account_key_order[i] = account_key_order[i - 1];
@@ -177,6 +193,69 @@ static void ak_order_update_ram(uint8_t used_id)
 		}
 	}
 	account_key_order[0] = used_id;
+
+	return true;
+}
+
+/* Cancel a deferred save, and wait for a save that is already running. This must not be
+ * called from the save work handler.
+ */
+static void ak_order_save_cancel(void)
+{
+	struct k_work_sync sync;
+
+	(void)k_work_cancel_delayable_sync(&ak_order_save_work, &sync);
+}
+
+static int ak_order_write(void)
+{
+	int err;
+
+	k_mutex_lock(&ak_order_mutex, K_FOREVER);
+	err = settings_save_one(SETTINGS_AK_ORDER_FULL_NAME, account_key_order,
+				sizeof(account_key_order));
+	k_mutex_unlock(&ak_order_mutex);
+
+	if (err) {
+		LOG_ERR("Unable to save new Account Key order in Settings. "
+			"Not propagating the error and keeping updated Account Key "
+			"order in RAM. After the Settings error the Account Key "
+			"order may change at reboot.");
+	}
+
+	return err;
+}
+
+static int ak_order_save(void)
+{
+	/* The order is saved now, drop any deferred save. A save that is already running
+	 * completes first, so that it can't overwrite this one with an older order.
+	 */
+	ak_order_save_cancel();
+
+	return ak_order_write();
+}
+
+static void ak_order_save_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	if (!atomic_get(&settings_loaded)) {
+		return;
+	}
+
+	(void)ak_order_write();
+}
+
+static void ak_order_save_deferred(void)
+{
+	if (CONFIG_BT_FAST_PAIR_STORAGE_AK_ORDER_SAVE_DELAY == 0) {
+		(void)ak_order_save();
+		return;
+	}
+
+	/* Consecutive updates within the delay are coalesced into a single write. */
+	(void)k_work_schedule(&ak_order_save_work, AK_ORDER_SAVE_DELAY);
 }
 
 static int commit_ak_order(void)
@@ -205,7 +284,7 @@ static int commit_ak_order(void)
 				__ASSERT_NO_MSG(false);
 				return -EINVAL;
 			}
-			ak_order_update_ram(id);
+			(void)ak_order_update_ram(id);
 			ak_order_update_count++;
 			/* Start loop again to check whether after update no existent AK has been
 			 * lost. Set iterator to -1 to start next iteration with iterator equal to 0
@@ -319,22 +398,23 @@ int fp_storage_ak_find(struct fp_account_key *account_key,
 		return -EINVAL;
 	}
 
+	/* Try the most recently used keys first, as they are the most likely to match. */
 	for (size_t i = 0; i < account_key_count; i++) {
-		if (account_key_check_cb(&account_key_list[i], context)) {
-			int err;
-
-			ak_order_update_ram(account_key_ids[i]);
-			err = settings_save_one(SETTINGS_AK_ORDER_FULL_NAME, account_key_order,
-						sizeof(account_key_order));
-			if (err) {
-				LOG_ERR("Unable to save new Account Key order in Settings. "
-					"Not propagating the error and keeping updated Account Key "
-					"order in RAM. After the Settings error the Account Key "
-					"order may change at reboot.");
+		uint8_t index = account_key_id_to_idx(account_key_order[i]);
+
+		if (account_key_check_cb(&account_key_list[index], context)) {
+			bool order_updated;
+
+			k_mutex_lock(&ak_order_mutex, K_FOREVER);
+			order_updated = ak_order_update_ram(account_key_ids[index]);
+			k_mutex_unlock(&ak_order_mutex);
+
+			if (order_updated) {
+				ak_order_save_deferred();
 			}
 
 			if (account_key) {
-				*account_key = account_key_list[i];
+				*account_key = account_key_list[index];
 			}
 
 			return 0;
@@ -402,21 +482,19 @@ int fp_storage_ak_save(const struct fp_account_key *account_key)
 		account_key_count++;
 	}
 
-	ak_order_update_ram(id);
-	err = settings_save_one(SETTINGS_AK_ORDER_FULL_NAME, account_key_order,
-				sizeof(account_key_order));
-	if (err) {
-		LOG_ERR("Unable to save new Account Key order in Settings. "
-			"Not propagating the error and keeping updated Account Key "
-			"order in RAM. After the Settings error the Account Key "
-			"order may change at reboot.");
-	}
+	k_mutex_lock(&ak_order_mutex, K_FOREVER);
+	(void)ak_order_update_ram(id);
+	k_mutex_unlock(&ak_order_mutex);
+
+	(void)ak_order_save();
 
 	return 0;
 }
 
 void fp_storage_ak_ram_clear(void)
 {
+	ak_order_save_cancel();
+
 	memset(account_key_list, 0, sizeof(account_key_list));
 	memset(account_key_ids, 0, sizeof(account_key_ids));
 	account_key_count = 0;
@@ -481,6 +559,7 @@ static int fp_storage_ak_reset(void)
 
 static void reset_prepare_set(void)
 {
+	ak_order_save_cancel();
 	atomic_set(&settings_loaded, false);
 	reset_prepare = true;
 }
@@ -67,8 +67,10 @@ int fp_storage_ak_count(void);
 int fp_storage_ak_get(struct fp_account_key *buf, size_t *key_count);
 
 /** Iterate over stored Account Keys to find a key that matches user-defined conditions.
- *  If such a key is found, the iteration process stops and this function returns.
- *  Found key is marked as recently used by storage module.
+ *  Keys are checked from the most recently used one. If such a key is found, the iteration
+ *  process stops and this function returns. Found key is marked as recently used by storage
+ *  module. Saving the updated key usage order is deferred by
+ *  CONFIG_BT_FAST_PAIR_STORAGE_AK_ORDER_SAVE_DELAY.
  *
  * @param[out] account_key Found Account Key. It is possible to pass NULL pointer if the found
  *                         key value is irrelevant.
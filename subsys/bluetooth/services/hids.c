@@ -126,6 +126,7 @@ static ssize_t hids_protocol_mode_write(struct bt_conn *conn,
 	struct bt_hids_pm_data *pm = attr->user_data;
 	struct bt_hids *hids = CONTAINER_OF(pm, struct bt_hids, pm);
 	uint8_t const *new_pm = (uint8_t const *)buf;
+	ssize_t ret = len;
 
 	struct bt_hids_conn_data *conn_data =
 		bt_conn_ctx_get(hids->conn_ctx, conn);
@@ -138,11 +139,13 @@ static ssize_t hids_protocol_mode_write(struct bt_conn *conn,
 	uint8_t *cur_pm = &conn_data->pm_ctx_value;
 
 	if (offset > 0) {
-		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		ret = BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		goto out;
 	}
 
 	if (len > sizeof(uint8_t)) {
-		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+		ret = BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+		goto out;
 	}
 
 	switch (*new_pm) {
@@ -159,14 +162,16 @@ static ssize_t hids_protocol_mode_write(struct bt_conn *conn,
 		}
 		break;
 	default:
-		return BT_GATT_ERR(BT_ATT_ERR_NOT_SUPPORTED);
+		ret = BT_GATT_ERR(BT_ATT_ERR_NOT_SUPPORTED);
+		goto out;
 	}
 
 	memcpy(cur_pm + offset, new_pm, len);
 
+out:
 	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
 
-	return len;
+	return ret;
 }
 
 static ssize_t hids_protocol_mode_read(struct bt_conn *conn,
@@ -309,6 +314,7 @@ static ssize_t hids_outp_rep_write(struct bt_conn *conn,
 						 struct bt_hids,
 						 outp_rep_group.reports);
 	uint8_t *rep_data;
+	ssize_t ret = len;
 
 	struct bt_hids_conn_data *conn_data =
 		bt_conn_ctx_get(hids->conn_ctx, conn);
@@ -321,7 +327,8 @@ static ssize_t hids_outp_rep_write(struct bt_conn *conn,
 	rep_data = conn_data->outp_rep_ctx + rep->offset;
 
 	if (offset + len > rep->size) {
-		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		ret = BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		goto out;
 	}
 	memcpy(rep_data + offset, buf, len);
 
@@ -333,9 +340,10 @@ static ssize_t hids_outp_rep_write(struct bt_conn *conn,
 		rep->handler(&report, conn, true);
 	}
 
+out:
 	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
 
-	return len;
+	return ret;
 }
 
 static ssize_t hids_outp_rep_ref_read(struct bt_conn *conn,
@@ -412,6 +420,7 @@ static ssize_t hids_feat_rep_write(struct bt_conn *conn,
 						 struct bt_hids,
 						 feat_rep_group.reports);
 	uint8_t *rep_data;
+	ssize_t ret = len;
 
 	struct bt_hids_conn_data *conn_data =
 		bt_conn_ctx_get(hids->conn_ctx, conn);
@@ -424,7 +433,8 @@ static ssize_t hids_feat_rep_write(struct bt_conn *conn,
 	rep_data = conn_data->feat_rep_ctx + rep->offset;
 
 	if (offset + len > rep->size) {
-		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		ret = BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		goto out;
 	}
 	memcpy(rep_data + offset, buf, len);
 
@@ -436,9 +446,10 @@ static ssize_t hids_feat_rep_write(struct bt_conn *conn,
 		rep->handler(&report, conn, true);
 	}
 
+out:
 	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
 
-	return len;
+	return ret;
 }
 
 static ssize_t hids_feat_rep_ref_read(struct bt_conn *conn,
@@ -642,6 +653,7 @@ static ssize_t hids_boot_kb_outp_report_write(struct bt_conn *conn,
 	struct bt_hids *hids = CONTAINER_OF(rep, struct bt_hids,
 						 boot_kb_outp_rep);
 	uint8_t *rep_data;
+	ssize_t ret = len;
 
 	struct bt_hids_conn_data *conn_data =
 		bt_conn_ctx_get(hids->conn_ctx, conn);
@@ -654,7 +666,8 @@ static ssize_t hids_boot_kb_outp_report_write(struct bt_conn *conn,
 	rep_data = conn_data->hids_boot_kb_outp_rep_ctx;
 
 	if (offset + len > sizeof(uint8_t)) {
-		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		ret = BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+		goto out;
 	}
 	memcpy(rep_data + offset, buf, len);
 
@@ -667,9 +680,10 @@ static ssize_t hids_boot_kb_outp_report_write(struct bt_conn *conn,
 		rep->handler(&report, conn, true);
 	}
 
+out:
 	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
 
-	return len;
+	return ret;
 }
 
 static ssize_t hids_info_read(struct bt_conn *conn,
@@ -1329,13 +1343,13 @@ int bt_hids_boot_kb_inp_rep_send(struct bt_hids *hids_obj,
 		return -EACCES;
 	}
 
-	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids_obj->conn_ctx, conn);
-
-	if (len > sizeof(conn_data->hids_boot_kb_inp_rep_ctx)) {
+	if (len > SIZEOF_FIELD(struct bt_hids_conn_data, hids_boot_kb_inp_rep_ctx)) {
 		return -EINVAL;
 	}
 
+	struct bt_hids_conn_data *conn_data =
+		bt_conn_ctx_get(hids_obj->conn_ctx, conn);
+
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
 		return -EINVAL;
@@ -81,6 +81,62 @@ BT_GATT_PRIMARY_SERVICE(BT_UUID_NUS_SERVICE),
 			       NULL, on_receive, NULL),
 );
 
+#if defined(CONFIG_BT_NUS_STREAM)
+static struct bt_nus_stream streams[CONFIG_BT_MAX_CONN];
+
+static void stream_on_sent(struct bt_conn *conn, void *user_data)
+{
+	bt_nus_stream_sent(user_data);
+	on_sent(conn, NULL);
+}
+
+static int stream_notify(struct bt_nus_stream *stream, const uint8_t *data, uint16_t len)
+{
+	struct bt_gatt_notify_params params = {
+		.attr = &nus_svc.attrs[2],
+		.data = data,
+		.len = len,
+		.func = stream_on_sent,
+		.user_data = stream,
+	};
+
+	if (!bt_gatt_is_subscribed(stream->conn, params.attr, BT_GATT_CCC_NOTIFY)) {
+		return -EINVAL;
+	}
+
+	return bt_gatt_notify_cb(stream->conn, &params);
+}
+
+static uint16_t stream_max_len(struct bt_nus_stream *stream)
+{
+	return bt_nus_get_mtu(stream->conn);
+}
+
+static const struct bt_nus_stream_transport stream_transport = {
+	.send = stream_notify,
+	.max_len = stream_max_len,
+};
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	if (!err && streams[bt_conn_index(conn)].transport) {
+		bt_nus_stream_open(&streams[bt_conn_index(conn)], conn);
+	}
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	if (streams[bt_conn_index(conn)].transport) {
+		bt_nus_stream_close(&streams[bt_conn_index(conn)]);
+	}
+}
+
+BT_CONN_CB_DEFINE(nus_conn_callbacks) = {
+	.connected = connected,
+	.disconnected = disconnected,
+};
+#endif /* CONFIG_BT_NUS_STREAM */
+
 int bt_nus_init(struct bt_nus_cb *callbacks)
 {
 	if (callbacks) {
@@ -89,6 +145,12 @@ int bt_nus_init(struct bt_nus_cb *callbacks)
 		nus_cb.send_enabled = callbacks->send_enabled;
 	}
 
+#if defined(CONFIG_BT_NUS_STREAM)
+	for (size_t i = 0; i < ARRAY_SIZE(streams); i++) {
+		bt_nus_stream_init(&streams[i], &stream_transport);
+	}
+#endif
+
 	return 0;
 }
 
@@ -111,3 +173,20 @@ int bt_nus_send(struct bt_conn *conn, const uint8_t *data, uint16_t len)
 		return -EINVAL;
 	}
 }
+
+#if defined(CONFIG_BT_NUS_STREAM)
+int bt_nus_stream_send(struct bt_conn *conn, const uint8_t *data, uint16_t len,
+		       k_timeout_t timeout)
+{
+	if (!conn) {
+		return -EINVAL;
+	}
+
+	return bt_nus_stream_write(&streams[bt_conn_index(conn)], data, len, timeout);
+}
+
+const struct bt_nus_stream_stats *bt_nus_stream_stats_get(struct bt_conn *conn)
+{
+	return &streams[bt_conn_index(conn)].stats;
+}
+#endif /* CONFIG_BT_NUS_STREAM */
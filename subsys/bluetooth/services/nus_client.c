@@ -67,6 +67,59 @@ static void on_sent(struct bt_conn *conn, uint8_t err,
 	}
 }
 
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM)
+static void stream_on_sent(struct bt_conn *conn, void *user_data)
+{
+	bt_nus_stream_sent(user_data);
+}
+
+static int stream_write(struct bt_nus_stream *stream, const uint8_t *data, uint16_t len)
+{
+	struct bt_nus_client *nus_c = CONTAINER_OF(stream, struct bt_nus_client, stream);
+
+	return bt_gatt_write_without_response_cb(stream->conn, nus_c->handles.rx, data, len,
+						 false, stream_on_sent, stream);
+}
+
+static uint16_t stream_max_len(struct bt_nus_stream *stream)
+{
+	/* Write Without Response carries up to ATT_MTU - 3 bytes. */
+	return bt_gatt_get_mtu(stream->conn) - 3;
+}
+
+static const struct bt_nus_stream_transport stream_transport = {
+	.send = stream_write,
+	.max_len = stream_max_len,
+};
+
+static sys_slist_t clients = SYS_SLIST_STATIC_INIT(&clients);
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	struct bt_nus_client *nus_c;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&clients, nus_c, node) {
+		if (nus_c->stream.conn == conn) {
+			bt_nus_stream_close(&nus_c->stream);
+		}
+	}
+}
+
+BT_CONN_CB_DEFINE(nus_c_conn_callbacks) = {
+	.disconnected = disconnected,
+};
+
+int bt_nus_client_stream_send(struct bt_nus_client *nus_c, const uint8_t *data,
+			      uint16_t len, k_timeout_t timeout)
+{
+	if (!nus_c->conn) {
+		return -ENOTCONN;
+	}
+
+	return bt_nus_stream_write(&nus_c->stream, data, len, timeout);
+}
+#endif /* CONFIG_BT_NUS_CLIENT_STREAM */
+
 int bt_nus_client_init(struct bt_nus_client *nus_c,
 		       const struct bt_nus_client_init_param *nus_c_init)
 {
@@ -80,6 +133,11 @@ int bt_nus_client_init(struct bt_nus_client *nus_c,
 
 	memcpy(&nus_c->cb, &nus_c_init->cb, sizeof(nus_c->cb));
 
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM)
+	bt_nus_stream_init(&nus_c->stream, &stream_transport);
+	sys_slist_append(&clients, &nus_c->node);
+#endif
+
 	return 0;
 }
 
@@ -124,6 +182,12 @@ int bt_nus_handles_assign(struct bt_gatt_dm *dm,
 		return -ENOTSUP;
 	}
 	LOG_DBG("Getting handles from NUS service.");
+
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM)
+	/* Nothing is written to the old handles from now on. */
+	bt_nus_stream_close(&nus_c->stream);
+#endif
+
 	memset(&nus_c->handles, 0xFF, sizeof(nus_c->handles));
 
 	/* NUS TX Characteristic */
@@ -166,6 +230,11 @@ int bt_nus_handles_assign(struct bt_gatt_dm *dm,
 
 	/* Assign connection instance. */
 	nus_c->conn = bt_gatt_dm_conn_get(dm);
+
+#if defined(CONFIG_BT_NUS_CLIENT_STREAM)
+	bt_nus_stream_open(&nus_c->stream, nus_c->conn);
+#endif
+
 	return 0;
 }
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <bluetooth/services/nus_stream.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(bt_nus_stream, CONFIG_BT_NUS_STREAM_CORE_LOG_LEVEL);
+
+#define MAX_IN_FLIGHT CONFIG_BT_NUS_STREAM_MAX_IN_FLIGHT
+/* Time to wait before retrying when the stack is out of buffers, and no PDU
+ * is in flight to trigger the retry.
+ */
+#define RETRY_DELAY K_MSEC(10)
+
+enum {
+	STREAM_OPEN,
+	/* Data claimed from the ring buffer is being sent. */
+	STREAM_SENDING,
+	/* The stream was closed while sending, and the ring buffer must be
+	 * reset once the claimed data is finished.
+	 */
+	STREAM_RESET,
+};
+
+static void stream_send(struct k_work *work)
+{
+	struct bt_nus_stream *stream = CONTAINER_OF(k_work_delayable_from_work(work),
+						    struct bt_nus_stream, work);
+	k_spinlock_key_t key;
+	uint32_t len;
+	uint16_t max;
+	uint8_t *data;
+	bool reset;
+	int err;
+
+	while (atomic_test_bit(&stream->flags, STREAM_OPEN) &&
+	       atomic_get(&stream->in_flight) < MAX_IN_FLIGHT) {
+		max = stream->transport->max_len(stream);
+
+		key = k_spin_lock(&stream->lock);
+
+		/* While PDUs are in flight, the data is held back until it fills a
+		 * whole PDU. The completion of the PDUs in flight sends the rest.
+		 */
+		len = ring_buf_size_get(&stream->rb);
+		if (!len || (len < max && atomic_get(&stream->in_flight))) {
+			k_spin_unlock(&stream->lock, key);
+			return;
+		}
+
+		/* The claimed data may be shorter at the end of the buffer. */
+		len = ring_buf_get_claim(&stream->rb, &data, max);
+		atomic_set_bit(&stream->flags, STREAM_SENDING);
+
+		k_spin_unlock(&stream->lock, key);
+
+		atomic_inc(&stream->in_flight);
+		err = stream->transport->send(stream, data, len);
+		if (err) {
+			atomic_dec(&stream->in_flight);
+		}
+
+		key = k_spin_lock(&stream->lock);
+		ring_buf_get_finish(&stream->rb, err == -ENOMEM ? 0 : len);
+		atomic_clear_bit(&stream->flags, STREAM_SENDING);
+		reset = atomic_test_and_clear_bit(&stream->flags, STREAM_RESET);
+		if (reset) {
+			ring_buf_reset(&stream->rb);
+		}
+		k_spin_unlock(&stream->lock, key);
+
+		if (reset) {
+			/* Wake up a writer held back by the reset. */
+			k_sem_give(&stream->space);
+			return;
+		}
+
+		if (err == -ENOMEM) {
+			if (!atomic_get(&stream->in_flight)) {
+				k_work_reschedule(&stream->work, RETRY_DELAY);
+			}
+
+			return;
+		}
+
+		if (err) {
+			LOG_WRN("Dropped %u bytes (err %d)", len, err);
+		} else {
+			stream->stats.bytes += len;
+			stream->stats.pdus++;
+		}
+
+		k_sem_give(&stream->space);
+	}
+}
+
+void bt_nus_stream_init(struct bt_nus_stream *stream,
+			const struct bt_nus_stream_transport *transport)
+{
+	stream->transport = transport;
+	stream->conn = NULL;
+	ring_buf_init(&stream->rb, sizeof(stream->buf), stream->buf);
+	k_sem_init(&stream->space, 0, 1);
+	k_work_init_delayable(&stream->work, stream_send);
+	atomic_set(&stream->in_flight, 0);
+	atomic_set(&stream->flags, 0);
+}
+
+void bt_nus_stream_open(struct bt_nus_stream *stream, struct bt_conn *conn)
+{
+	bt_nus_stream_close(stream);
+
+	stream->conn = conn;
+	memset(&stream->stats, 0, sizeof(stream->stats));
+	atomic_set(&stream->in_flight, 0);
+	atomic_set_bit(&stream->flags, STREAM_OPEN);
+}
+
+void bt_nus_stream_close(struct bt_nus_stream *stream)
+{
+	k_spinlock_key_t key;
+
+	atomic_clear_bit(&stream->flags, STREAM_OPEN);
+	k_work_cancel_delayable(&stream->work);
+
+	/* The data claimed by a send in progress can't be reset under it, so the
+	 * reset is left to the send.
+	 */
+	key = k_spin_lock(&stream->lock);
+	if (atomic_test_bit(&stream->flags, STREAM_SENDING)) {
+		atomic_set_bit(&stream->flags, STREAM_RESET);
+	} else {
+		ring_buf_reset(&stream->rb);
+	}
+	k_spin_unlock(&stream->lock, key);
+
+	/* Wake up a blocked writer. */
+	k_sem_give(&stream->space);
+}
+
+int bt_nus_stream_write(struct bt_nus_stream *stream, const uint8_t *data,
+			uint16_t len, k_timeout_t timeout)
+{
+	k_spinlock_key_t key;
+	uint16_t written = 0;
+	uint32_t put;
+
+	while (atomic_test_bit(&stream->flags, STREAM_OPEN)) {
+		/* Space freed from now on wakes up the writer. */
+		k_sem_reset(&stream->space);
+
+		/* Data of a closed stream pending reset holds back new data. */
+		key = k_spin_lock(&stream->lock);
+		put = atomic_test_bit(&stream->flags, STREAM_RESET) ? 0 :
+		      ring_buf_put(&stream->rb, &data[written], len - written);
+		k_spin_unlock(&stream->lock, key);
+
+		written += put;
+		if (put) {
+			k_work_schedule(&stream->work, K_NO_WAIT);
+		}
+
+		if (written == len || k_sem_take(&stream->space, timeout)) {
+			return written;
+		}
+	}
+
+	return written ? written : -ENOTCONN;
+}
+
+void bt_nus_stream_sent(struct bt_nus_stream *stream)
+{
+	if (atomic_dec(&stream->in_flight) <= 0) {
+		/* Completion of a PDU sent before the stream was opened. */
+		atomic_set(&stream->in_flight, 0);
+	}
+
+	if (atomic_test_bit(&stream->flags, STREAM_OPEN)) {
+		k_work_schedule(&stream->work, K_NO_WAIT);
+	}
+}
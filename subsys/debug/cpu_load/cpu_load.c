@@ -4,7 +4,6 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 #include <debug/cpu_load.h>
-#include <zephyr/shell/shell.h>
 #ifdef DPPI_PRESENT
 #include <nrfx_dppi.h>
 #else
@@ -17,6 +16,8 @@
 #include <debug/ppi_trace.h>
 #include <zephyr/logging/log.h>
 
+#include "cpu_load_private.h"
+
 LOG_MODULE_REGISTER(cpu_load, CONFIG_CPU_LOAD_LOG_LEVEL);
 
 /* Convert event address to associated publish register */
@@ -211,6 +212,11 @@ int cpu_load_init(void)
 	return ret;
 }
 
+bool cpu_load_is_ready(void)
+{
+	return ready;
+}
+
 void cpu_load_reset(void)
 {
 	nrfx_timer_clear(&timer);
@@ -249,51 +255,3 @@ uint32_t cpu_load_get(void)
 
 	return (uint32_t)load;
 }
-
-static int cmd_cpu_load_get(const struct shell *shell, size_t argc, char **argv)
-{
-	uint32_t load;
-	uint32_t percent;
-	uint32_t fraction;
-
-	if (!ready) {
-		shell_error(shell, "Not initialized.");
-		return 0;
-	}
-
-	load = cpu_load_get();
-	percent = load / 1000;
-	fraction = load % 1000;
-
-	shell_print(shell, "CPU load:%d,%03d%%", percent, fraction);
-
-	return 0;
-}
-
-static int cmd_cpu_load_reset(const struct shell *shell,
-				size_t argc, char **argv)
-{
-	int err;
-
-	err = cpu_load_init();
-	if (err != 0) {
-		shell_error(shell, "Init failed (err:%d)", err);
-		return 0;
-	}
-
-	cpu_load_reset();
-
-	return 0;
-}
-
-SHELL_STATIC_SUBCMD_SET_CREATE(sub_cmd_cpu_load,
-	SHELL_CMD_ARG(get, NULL, "Get load", cmd_cpu_load_get, 1, 0),
-	SHELL_CMD_ARG(reset, NULL, "Reset measurement",
-			cmd_cpu_load_reset, 1, 0),
-	SHELL_CMD_ARG(init, NULL, "Init",
-			cmd_cpu_load_reset, 1, 0),
-	SHELL_SUBCMD_SET_END
-);
-
-SHELL_COND_CMD_ARG_REGISTER(CONFIG_CPU_LOAD_CMDS, cpu_load, &sub_cmd_cpu_load,
-			"CPU load", cmd_cpu_load_get, 1, 1);
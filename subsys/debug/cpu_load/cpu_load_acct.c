@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <string.h>
+#include <debug/cpu_load.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+#ifdef CONFIG_CPU_LOAD_ACCOUNTING_EVENTS
+#include <debug/cpu_load_acct_event.h>
+#endif
+
+LOG_MODULE_REGISTER(cpu_load_acct, CONFIG_CPU_LOAD_ACCOUNTING_LOG_LEVEL);
+
+#define THREAD_SLOTS CONFIG_CPU_LOAD_ACCOUNTING_THREADS
+
+/* One slot per IRQ line and one for exceptions that are not IRQs. */
+#define ISR_SLOTS (CONFIG_NUM_IRQS + 1)
+#define ISR_SLOT_OTHER CONFIG_NUM_IRQS
+
+/* Depth of tracked ISR nesting. Deeper ISRs are charged to the outer one. */
+#define ISR_NESTING_MAX 4
+
+#define TOP_N CONFIG_CPU_LOAD_ACCOUNTING_TOP_N
+#define HISTORY_SIZE CONFIG_CPU_LOAD_ACCOUNTING_HISTORY
+#define SAMPLE_INTERVAL CONFIG_CPU_LOAD_ACCOUNTING_SAMPLE_INTERVAL
+
+struct acct_counter {
+	uint64_t cycles;
+	uint64_t sampled;
+	uint32_t count;
+};
+
+struct thread_slot {
+	const struct k_thread *thread;
+	struct acct_counter cnt;
+};
+
+static struct k_spinlock lock;
+
+/* Threads are placed using open addressing on the thread pointer, the last
+ * slot collects threads that did not fit in the table and the threads that
+ * exited. Slots of exited threads are marked with a tombstone, so that the
+ * probing sequence of the other threads is not broken, and reused.
+ */
+#define THREAD_SLOT_FREED ((const struct k_thread *)UINTPTR_MAX)
+
+static struct thread_slot threads[THREAD_SLOTS + 1];
+static struct acct_counter isrs[ISR_SLOTS];
+
+static struct acct_counter *cur = &threads[THREAD_SLOTS].cnt;
+static struct acct_counter *preempted[ISR_NESTING_MAX];
+static uint8_t isr_depth;
+static uint32_t last_cyc;
+static uint64_t total;
+static uint64_t total_sampled;
+
+static struct cpu_load_acct_sample history[HISTORY_SIZE];
+static size_t history_head;
+static size_t history_cnt;
+
+static struct k_work_delayable sample_work;
+
+
+static struct thread_slot *thread_slot_find(const struct k_thread *thread,
+					     struct thread_slot **free_slot)
+{
+	size_t idx = ((uintptr_t)thread / sizeof(void *)) % THREAD_SLOTS;
+
+	for (size_t i = 0; i < THREAD_SLOTS; i++) {
+		struct thread_slot *slot = &threads[idx];
+
+		if (slot->thread == thread) {
+			return slot;
+		}
+
+		if ((slot->thread == THREAD_SLOT_FREED) && (*free_slot == NULL)) {
+			*free_slot = slot;
+		}
+
+		if (slot->thread == NULL) {
+			if (*free_slot == NULL) {
+				*free_slot = slot;
+			}
+			break;
+		}
+
+		idx = (idx + 1) % THREAD_SLOTS;
+	}
+
+	return NULL;
+}
+
+static struct thread_slot *thread_slot_get(const struct k_thread *thread)
+{
+	struct thread_slot *free_slot = NULL;
+	struct thread_slot *slot = thread_slot_find(thread, &free_slot);
+
+	if (slot) {
+		return slot;
+	}
+
+	if (free_slot) {
+		free_slot->thread = thread;
+		return free_slot;
+	}
+
+	return &threads[THREAD_SLOTS];
+}
+
+static size_t isr_slot_idx(void)
+{
+#if defined(CONFIG_CPU_CORTEX_M)
+	int32_t irq = (int32_t)__get_IPSR() - 16;
+
+	if ((irq >= 0) && (irq < CONFIG_NUM_IRQS)) {
+		return irq;
+	}
+#endif
+	return ISR_SLOT_OTHER;
+}
+
+/* Charge cycles elapsed since the last context change to the current one. */
+static inline void charge(void)
+{
+	uint32_t now = k_cycle_get_32();
+	uint32_t delta = now - last_cyc;
+
+	last_cyc = now;
+	cur->cycles += delta;
+	total += delta;
+}
+
+void sys_trace_thread_switched_out_user(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	charge();
+
+	k_spin_unlock(&lock, key);
+}
+
+void sys_trace_thread_switched_in_user(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	charge();
+	cur = &thread_slot_get(k_current_get())->cnt;
+	cur->count++;
+
+	k_spin_unlock(&lock, key);
+}
+
+void sys_trace_thread_abort_user(struct k_thread *thread)
+{
+	struct thread_slot *free_slot = NULL;
+	struct acct_counter *shared = &threads[THREAD_SLOTS].cnt;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	struct thread_slot *slot = thread_slot_find(thread, &free_slot);
+
+	if (slot) {
+		charge();
+
+		/* Keep the cycles of the exited thread in the totals. */
+		shared->cycles += slot->cnt.cycles;
+		shared->sampled += slot->cnt.sampled;
+		shared->count += slot->cnt.count;
+
+		if (cur == &slot->cnt) {
+			cur = shared;
+		}
+
+		for (size_t i = 0; i < MIN(isr_depth, ISR_NESTING_MAX); i++) {
+			if (preempted[i] == &slot->cnt) {
+				preempted[i] = shared;
+			}
+		}
+
+		memset(&slot->cnt, 0, sizeof(slot->cnt));
+		slot->thread = THREAD_SLOT_FREED;
+	}
+
+	k_spin_unlock(&lock, key);
+}
+
+void sys_trace_isr_enter_user(int nested_interrupts)
+{
+	ARG_UNUSED(nested_interrupts);
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	charge();
+
+	if (isr_depth < ISR_NESTING_MAX) {
+		preempted[isr_depth] = cur;
+		cur = &isrs[isr_slot_idx()];
+		cur->count++;
+	}
+	isr_depth++;
+
+	k_spin_unlock(&lock, key);
+}
+
+void sys_trace_isr_exit_user(int nested_interrupts)
+{
+	ARG_UNUSED(nested_interrupts);
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	charge();
+
+	if (isr_depth > 0) {
+		isr_depth--;
+		if (isr_depth < ISR_NESTING_MAX) {
+			cur = preempted[isr_depth];
+		}
+	}
+
+	k_spin_unlock(&lock, key);
+}
+
+static void thread_entry_fill(struct cpu_load_acct_entry *entry,
+			      const struct thread_slot *slot)
+{
+	entry->type = CPU_LOAD_ACCT_THREAD;
+	entry->thread = slot->thread;
+}
+
+static void isr_entry_fill(struct cpu_load_acct_entry *entry, size_t idx)
+{
+	entry->type = CPU_LOAD_ACCT_ISR;
+	entry->irq = (idx == ISR_SLOT_OTHER) ? CPU_LOAD_ACCT_IRQ_OTHER : idx;
+}
+
+void cpu_load_acct_foreach(cpu_load_acct_cb_t cb, void *user_data)
+{
+	struct cpu_load_acct_entry entry;
+	k_spinlock_key_t key;
+
+	for (size_t i = 0; i < ARRAY_SIZE(threads); i++) {
+		key = k_spin_lock(&lock);
+		if (cur == &threads[i].cnt) {
+			charge();
+		}
+		if (threads[i].thread == THREAD_SLOT_FREED) {
+			k_spin_unlock(&lock, key);
+			continue;
+		}
+		thread_entry_fill(&entry, &threads[i]);
+		entry.cycles = threads[i].cnt.cycles;
+		entry.count = threads[i].cnt.count;
+		k_spin_unlock(&lock, key);
+
+		if (entry.cycles > 0) {
+			cb(&entry, user_data);
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(isrs); i++) {
+		key = k_spin_lock(&lock);
+		isr_entry_fill(&entry, i);
+		entry.cycles = isrs[i].cycles;
+		entry.count = isrs[i].count;
+		k_spin_unlock(&lock, key);
+
+		if (entry.cycles > 0) {
+			cb(&entry, user_data);
+		}
+	}
+}
+
+uint64_t cpu_load_acct_total_get(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	uint64_t ret;
+
+	charge();
+	ret = total;
+
+	k_spin_unlock(&lock, key);
+
+	return ret;
+}
+
+void cpu_load_acct_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	memset(threads, 0, sizeof(threads));
+	memset(isrs, 0, sizeof(isrs));
+	total = 0;
+	total_sampled = 0;
+	history_head = 0;
+	history_cnt = 0;
+	last_cyc = k_cycle_get_32();
+
+	/* Reset is called from a thread, nested ISRs are not in progress. */
+	isr_depth = 0;
+	cur = &thread_slot_get(k_current_get())->cnt;
+
+	k_spin_unlock(&lock, key);
+}
+
+static void top_insert(struct cpu_load_acct_sample *sample,
+		       const struct cpu_load_acct_entry *entry)
+{
+	size_t pos = sample->count;
+
+	if ((pos == TOP_N) && (sample->top[TOP_N - 1].cycles >= entry->cycles)) {
+		return;
+	}
+
+	if (pos == TOP_N) {
+		pos--;
+	} else {
+		sample->count++;
+	}
+
+	while ((pos > 0) && (sample->top[pos - 1].cycles < entry->cycles)) {
+		sample->top[pos] = sample->top[pos - 1];
+		pos--;
+	}
+
+	sample->top[pos] = *entry;
+}
+
+static void counter_sample(struct cpu_load_acct_sample *sample,
+			   struct acct_counter *cnt,
+			   struct cpu_load_acct_entry *entry)
+{
+	entry->cycles = cnt->cycles - cnt->sampled;
+	entry->count = cnt->count;
+	cnt->sampled = cnt->cycles;
+
+	if (entry->cycles > 0) {
+		top_insert(sample, entry);
+	}
+}
+
+#ifdef CONFIG_CPU_LOAD_ACCOUNTING_EVENTS
+static void submit_events(const struct cpu_load_acct_sample *sample)
+{
+	for (size_t i = 0; i < sample->count; i++) {
+		const struct cpu_load_acct_entry *entry = &sample->top[i];
+		struct cpu_load_acct_event *event = new_cpu_load_acct_event();
+
+		event->type = entry->type;
+		event->id = (entry->type == CPU_LOAD_ACCT_THREAD) ?
+			    (uint32_t)(uintptr_t)entry->thread : entry->irq;
+		event->load = (uint32_t)((100000 * entry->cycles) /
+					 MAX(sample->window, 1));
+		APP_EVENT_SUBMIT(event);
+	}
+}
+#endif
+
+void cpu_load_acct_sample(void)
+{
+	struct cpu_load_acct_sample sample = {0};
+	struct cpu_load_acct_entry entry;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	charge();
+
+	/* Every step below is bounded by the size of the accounting tables. */
+	for (size_t i = 0; i < ARRAY_SIZE(threads); i++) {
+		if (threads[i].thread == THREAD_SLOT_FREED) {
+			continue;
+		}
+		thread_entry_fill(&entry, &threads[i]);
+		counter_sample(&sample, &threads[i].cnt, &entry);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(isrs); i++) {
+		isr_entry_fill(&entry, i);
+		counter_sample(&sample, &isrs[i], &entry);
+	}
+
+	sample.window = (uint32_t)MIN(total - total_sampled, UINT32_MAX);
+	sample.timestamp = k_uptime_get();
+	total_sampled = total;
+
+	history_head = (history_head + 1) % HISTORY_SIZE;
+	history[history_head] = sample;
+	history_cnt = MIN(history_cnt + 1, HISTORY_SIZE);
+
+	k_spin_unlock(&lock, key);
+
+#ifdef CONFIG_CPU_LOAD_ACCOUNTING_EVENTS
+	submit_events(&sample);
+#endif
+}
+
+int cpu_load_acct_history_get(size_t idx, struct cpu_load_acct_sample *sample)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	int err = 0;
+
+	if (idx < history_cnt) {
+		*sample = history[(history_head + HISTORY_SIZE - idx) % HISTORY_SIZE];
+	} else {
+		err = -ENOENT;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	return err;
+}
+
+static void sample_work_fn(struct k_work *work)
+{
+	cpu_load_acct_sample();
+	k_work_reschedule(&sample_work, K_MSEC(SAMPLE_INTERVAL));
+}
+
+static int cpu_load_acct_init(void)
+{
+	cpu_load_acct_reset();
+
+	if (SAMPLE_INTERVAL > 0) {
+		k_work_init_delayable(&sample_work, sample_work_fn);
+		k_work_schedule(&sample_work, K_MSEC(SAMPLE_INTERVAL));
+	}
+
+	return 0;
+}
+
+SYS_INIT(cpu_load_acct_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
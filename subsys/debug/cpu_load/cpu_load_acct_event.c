@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdio.h>
+
+#include <debug/cpu_load.h>
+#include <debug/cpu_load_acct_event.h>
+
+
+static void log_cpu_load_acct_event(const struct app_event_header *aeh)
+{
+	const struct cpu_load_acct_event *event = cast_cpu_load_acct_event(aeh);
+
+	APP_EVENT_MANAGER_LOG(aeh, "%s 0x%08x load: %03u,%03u%%",
+			(event->type == CPU_LOAD_ACCT_THREAD) ? "thread" : "irq",
+			event->id, event->load / 1000, event->load % 1000);
+}
+
+static void profile_cpu_load_acct_event(struct log_event_buf *buf,
+					const struct app_event_header *aeh)
+{
+	const struct cpu_load_acct_event *event = cast_cpu_load_acct_event(aeh);
+
+	nrf_profiler_log_encode_uint8(buf, event->type);
+	nrf_profiler_log_encode_uint32(buf, event->id);
+	nrf_profiler_log_encode_uint32(buf, event->load);
+}
+
+APP_EVENT_INFO_DEFINE(cpu_load_acct_event,
+		  ENCODE(NRF_PROFILER_ARG_U8, NRF_PROFILER_ARG_U32,
+			 NRF_PROFILER_ARG_U32),
+		  ENCODE("type", "id", "load"),
+		  profile_cpu_load_acct_event);
+
+APP_EVENT_TYPE_DEFINE(cpu_load_acct_event,
+		  log_cpu_load_acct_event,
+		  &cpu_load_acct_event_info,
+		  APP_EVENT_FLAGS_CREATE());
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef __CPU_LOAD_PRIVATE_H
+#define __CPU_LOAD_PRIVATE_H
+
+#include <stdbool.h>
+
+/** @brief Check if the TIMER-based measurement is initialized. */
+bool cpu_load_is_ready(void);
+
+#endif /* __CPU_LOAD_PRIVATE_H */
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <debug/cpu_load.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+#include "cpu_load_private.h"
+
+#if defined(CONFIG_CPU_LOAD)
+static int cmd_cpu_load_get(const struct shell *shell, size_t argc, char **argv)
+{
+	uint32_t load;
+	uint32_t percent;
+	uint32_t fraction;
+
+	if (!cpu_load_is_ready()) {
+		shell_error(shell, "Not initialized.");
+		return 0;
+	}
+
+	load = cpu_load_get();
+	percent = load / 1000;
+	fraction = load % 1000;
+
+	shell_print(shell, "CPU load:%d,%03d%%", percent, fraction);
+
+	return 0;
+}
+
+static int cmd_cpu_load_reset(const struct shell *shell,
+				size_t argc, char **argv)
+{
+	int err;
+
+	err = cpu_load_init();
+	if (err != 0) {
+		shell_error(shell, "Init failed (err:%d)", err);
+		return 0;
+	}
+
+	cpu_load_reset();
+
+	return 0;
+}
+#endif /* defined(CONFIG_CPU_LOAD) */
+
+#if defined(CONFIG_CPU_LOAD_ACCOUNTING)
+static uint32_t acct_load(uint64_t cycles, uint64_t total)
+{
+	return (total > 0) ? (uint32_t)((100000 * cycles) / total) : 0;
+}
+
+static void acct_entry_print(const struct shell *shell,
+			     const struct cpu_load_acct_entry *entry,
+			     uint64_t total)
+{
+	uint32_t load = acct_load(entry->cycles, total);
+
+	if (entry->type == CPU_LOAD_ACCT_ISR) {
+		if (entry->irq == CPU_LOAD_ACCT_IRQ_OTHER) {
+			shell_print(shell, "  isr   %-24s %3u,%03u%% %10u",
+				    "other", load / 1000, load % 1000,
+				    entry->count);
+		} else {
+			shell_print(shell, "  isr   %-24u %3u,%03u%% %10u",
+				    entry->irq, load / 1000, load % 1000,
+				    entry->count);
+		}
+		return;
+	}
+
+	const char *name = NULL;
+
+	if (entry->thread == NULL) {
+		name = "other";
+	} else if (IS_ENABLED(CONFIG_THREAD_NAME)) {
+		name = k_thread_name_get((struct k_thread *)entry->thread);
+	}
+
+	if ((name != NULL) && (name[0] != '\0')) {
+		shell_print(shell, "  thread %-23s %3u,%03u%% %10u",
+			    name, load / 1000, load % 1000, entry->count);
+	} else {
+		shell_print(shell, "  thread %-23p %3u,%03u%% %10u",
+			    (void *)entry->thread, load / 1000, load % 1000,
+			    entry->count);
+	}
+}
+
+struct acct_print_ctx {
+	const struct shell *shell;
+	enum cpu_load_acct_type type;
+	uint64_t total;
+};
+
+static void acct_print_cb(const struct cpu_load_acct_entry *entry,
+			  void *user_data)
+{
+	struct acct_print_ctx *ctx = user_data;
+
+	if (entry->type == ctx->type) {
+		acct_entry_print(ctx->shell, entry, ctx->total);
+	}
+}
+
+static int acct_print(const struct shell *shell, enum cpu_load_acct_type type)
+{
+	struct acct_print_ctx ctx = {
+		.shell = shell,
+		.type = type,
+		.total = cpu_load_acct_total_get(),
+	};
+
+	shell_print(shell, "  %-30s %8s %10s", "context", "load", "entries");
+	cpu_load_acct_foreach(acct_print_cb, &ctx);
+
+	return 0;
+}
+
+static int cmd_cpu_load_threads(const struct shell *shell,
+				size_t argc, char **argv)
+{
+	return acct_print(shell, CPU_LOAD_ACCT_THREAD);
+}
+
+static int cmd_cpu_load_isrs(const struct shell *shell,
+			     size_t argc, char **argv)
+{
+	return acct_print(shell, CPU_LOAD_ACCT_ISR);
+}
+
+static int cmd_cpu_load_top(const struct shell *shell,
+			    size_t argc, char **argv)
+{
+	struct cpu_load_acct_sample sample;
+
+	for (size_t i = 0; cpu_load_acct_history_get(i, &sample) == 0; i++) {
+		shell_print(shell, "Sample at %lld ms:", sample.timestamp);
+
+		for (size_t j = 0; j < sample.count; j++) {
+			acct_entry_print(shell, &sample.top[j], sample.window);
+		}
+	}
+
+	return 0;
+}
+
+static int cmd_cpu_load_acct_reset(const struct shell *shell,
+				   size_t argc, char **argv)
+{
+	cpu_load_acct_reset();
+
+	return 0;
+}
+#endif /* defined(CONFIG_CPU_LOAD_ACCOUNTING) */
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_cmd_cpu_load,
+#if defined(CONFIG_CPU_LOAD)
+	SHELL_CMD_ARG(get, NULL, "Get load", cmd_cpu_load_get, 1, 0),
+	SHELL_CMD_ARG(reset, NULL, "Reset measurement",
+			cmd_cpu_load_reset, 1, 0),
+	SHELL_CMD_ARG(init, NULL, "Init",
+			cmd_cpu_load_reset, 1, 0),
+#endif
+#if defined(CONFIG_CPU_LOAD_ACCOUNTING)
+	SHELL_CMD_ARG(threads, NULL, "Per-thread load since accounting reset",
+			cmd_cpu_load_threads, 1, 0),
+	SHELL_CMD_ARG(isrs, NULL, "Per-ISR load since accounting reset",
+			cmd_cpu_load_isrs, 1, 0),
+	SHELL_CMD_ARG(top, NULL, "Recent top-N samples",
+			cmd_cpu_load_top, 1, 0),
+	SHELL_CMD_ARG(acct_reset, NULL, "Reset accounting",
+			cmd_cpu_load_acct_reset, 1, 0),
+#endif
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_COND_CMD_ARG_REGISTER(CONFIG_CPU_LOAD_CMDS, cpu_load, &sub_cmd_cpu_load,
+			"CPU load",
+			COND_CODE_1(CONFIG_CPU_LOAD, (cmd_cpu_load_get), (NULL)),
+			1, 1);
@@ -21,6 +21,14 @@ static sys_slist_t emds_dynamic_entries;
 static struct emds_fs emds_flash;
 static emds_store_cb_t app_store_cb;
 
+#if defined(CONFIG_EMDS_DIRTY_TRACKING)
+/* Registered entries in ascending size order, with the address of the allocation table
+ * entry of the copy written by the prepare (0 if there is none).
+ */
+static struct emds_flash_keep_entry entry_states[CONFIG_EMDS_DIRTY_TRACKING_MAX_ENTRIES];
+static size_t entry_state_cnt;
+#endif
+
 static int emds_fs_init(void)
 {
 	int rc;
@@ -91,6 +99,90 @@ static int emds_entries_size(uint32_t *size)
 	return entries;
 }
 
+static uint32_t entry_store_time(const struct emds_entry *entry)
+{
+	size_t block_size = emds_flash.flash_params->write_block_size;
+
+	return NRFX_CEIL_DIV(entry->len, block_size) *
+			CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US
+	       + NRFX_CEIL_DIV(emds_flash.ate_size, block_size) *
+			CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US
+	       + CONFIG_EMDS_FLASH_TIME_ENTRY_OVERHEAD_US;
+}
+
+#if defined(CONFIG_EMDS_DIRTY_TRACKING)
+static int entry_state_add(const struct emds_entry *entry)
+{
+	size_t pos = entry_state_cnt;
+
+	if (entry_state_cnt == ARRAY_SIZE(entry_states)) {
+		return -ENOMEM;
+	}
+
+	while ((pos > 0) && (entry_states[pos - 1].entry->len > entry->len)) {
+		entry_states[pos] = entry_states[pos - 1];
+		pos--;
+	}
+
+	entry_states[pos].entry = entry;
+	entry_states[pos].ate_addr = 0;
+	entry_state_cnt++;
+
+	return 0;
+}
+
+static int entry_states_build(void)
+{
+	struct emds_dynamic_entry *ch;
+	int rc;
+
+	entry_state_cnt = 0;
+
+	STRUCT_SECTION_FOREACH(emds_entry, entry) {
+		rc = entry_state_add(entry);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&emds_dynamic_entries, ch, node) {
+		rc = entry_state_add(&ch->entry);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static bool entry_is_dirty(const struct emds_flash_keep_entry *state)
+{
+	return (state->ate_addr == 0) ||
+	       !emds_flash_entry_cmp(&emds_flash, state->ate_addr,
+				     state->entry->data, state->entry->len);
+}
+
+static void dirty_entries_store(void)
+{
+	for (size_t i = 0; i < entry_state_cnt; i++) {
+		const struct emds_entry *entry = entry_states[i].entry;
+
+		if (!entry_is_dirty(&entry_states[i])) {
+			continue;
+		}
+
+		ssize_t len = emds_flash_write(&emds_flash,
+					       entry->id, entry->data, entry->len);
+		if (len < 0) {
+			LOG_ERR("Write entry: (%d) error (%d)", entry->id, len);
+		} else if (len != entry->len) {
+			LOG_ERR("Write entry: (%d) failed (%d:%d)",
+				entry->id, entry->len, len);
+		}
+	}
+}
+#endif /* defined(CONFIG_EMDS_DIRTY_TRACKING) */
+
 int emds_init(emds_store_cb_t cb)
 {
 	int rc;
@@ -151,6 +243,9 @@ int emds_store(void)
 	/* Start the emergency data storage process. */
 	LOG_DBG("Emergency Data Storeage released");
 
+#if defined(CONFIG_EMDS_DIRTY_TRACKING)
+	dirty_entries_store();
+#else
 	STRUCT_SECTION_FOREACH(emds_entry, ch) {
 		ssize_t len = emds_flash_write(&emds_flash,
 					       ch->id, ch->data, ch->len);
@@ -177,6 +272,7 @@ int emds_store(void)
 				ch->entry.id, ch->entry.len, len);
 		}
 	}
+#endif
 
 	emds_ready = false;
 
@@ -252,7 +348,17 @@ int emds_prepare(void)
 
 	(void)emds_entries_size(&size);
 
+#if defined(CONFIG_EMDS_DIRTY_TRACKING)
+	rc = entry_states_build();
+	if (rc) {
+		return rc;
+	}
+
+	/* Reserve space for all entries, as any of them may change before the store. */
+	rc = emds_flash_prepare_keep(&emds_flash, size, entry_states, entry_state_cnt);
+#else
 	rc = emds_flash_prepare(&emds_flash, size);
+#endif
 	if (rc) {
 		return rc;
 	}
@@ -264,26 +370,28 @@ int emds_prepare(void)
 
 uint32_t emds_store_time_get(void)
 {
-	size_t block_size = emds_flash.flash_params->write_block_size;
 	uint32_t store_time_us = CONFIG_EMDS_FLASH_TIME_BASE_OVERHEAD_US;
 
+#if defined(CONFIG_EMDS_DIRTY_TRACKING)
+	if (emds_ready) {
+		for (size_t i = 0; i < entry_state_cnt; i++) {
+			if (entry_is_dirty(&entry_states[i])) {
+				store_time_us += entry_store_time(entry_states[i].entry);
+			}
+		}
+
+		return store_time_us;
+	}
+#endif
 
 	STRUCT_SECTION_FOREACH(emds_entry, ch) {
-		store_time_us += NRFX_CEIL_DIV(ch->len, block_size) *
-					CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US
-			       + NRFX_CEIL_DIV(emds_flash.ate_size, block_size) *
-					CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US
-			       + CONFIG_EMDS_FLASH_TIME_ENTRY_OVERHEAD_US;
+		store_time_us += entry_store_time(ch);
 	}
 
 	struct emds_dynamic_entry *ch;
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&emds_dynamic_entries, ch, node) {
-		store_time_us += NRFX_CEIL_DIV(ch->entry.len, block_size) *
-					CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US
-			       + NRFX_CEIL_DIV(emds_flash.ate_size, block_size) *
-					CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US
-			       + CONFIG_EMDS_FLASH_TIME_ENTRY_OVERHEAD_US;
+		store_time_us += entry_store_time(&ch->entry);
 	}
 
 	return store_time_us;
@@ -158,6 +158,11 @@ static int flash_direct_write(const struct device *dev, off_t offset, const void
 	return 0;
 }
 
+/* Flash write function, either the direct NVMC write used by the emergency store or the flash
+ * driver write used while the application is running.
+ */
+typedef int (*flash_wrt_t)(const struct device *dev, off_t offset, const void *data, size_t len);
+
 static size_t align_size(struct emds_fs *fs, size_t len)
 {
 	uint8_t write_block_size = fs->flash_params->write_block_size;
@@ -168,13 +173,13 @@ static size_t align_size(struct emds_fs *fs, size_t len)
 	return (len + (write_block_size - 1U)) & ~(write_block_size - 1U);
 }
 
-static int ate_wrt(struct emds_fs *fs, const struct emds_ate *entry)
+static int ate_wrt(struct emds_fs *fs, const struct emds_ate *entry, flash_wrt_t wrt)
 {
 	if (sizeof(struct emds_ate) % fs->flash_params->write_block_size) {
 		return -EINVAL;
 	}
 
-	int rc = flash_direct_write(fs->flash_dev, fs->ate_wra, entry, sizeof(struct emds_ate));
+	int rc = wrt(fs->flash_dev, fs->ate_wra, entry, sizeof(struct emds_ate));
 
 	if (rc) {
 		return rc;
@@ -184,7 +189,7 @@ static int ate_wrt(struct emds_fs *fs, const struct emds_ate *entry)
 	return 0;
 }
 
-static int data_wrt(struct emds_fs *fs, const void *data, size_t len)
+static int data_wrt(struct emds_fs *fs, const void *data, size_t len, flash_wrt_t wrt)
 {
 	const uint8_t *data8 = (const uint8_t *)data;
 	int rc;
@@ -204,7 +209,7 @@ static int data_wrt(struct emds_fs *fs, const void *data, size_t len)
 	blen = temp_len & ~(fs->flash_params->write_block_size - 1U);
 	/* Writes multiples of 4 bytes to flash */
 	if (blen > 0) {
-		rc = flash_direct_write(fs->flash_dev, offset, data8, blen);
+		rc = wrt(fs->flash_dev, offset, data8, blen);
 		if (rc) {
 			return rc;
 		}
@@ -218,8 +223,7 @@ static int data_wrt(struct emds_fs *fs, const void *data, size_t len)
 		(void)memcpy(buf, data8, temp_len);
 		(void)memset(buf + temp_len, fs->flash_params->erase_value,
 			     fs->flash_params->write_block_size - temp_len);
-		rc = flash_direct_write(fs->flash_dev, offset, buf,
-					fs->flash_params->write_block_size);
+		rc = wrt(fs->flash_dev, offset, buf, fs->flash_params->write_block_size);
 		if (rc) {
 			return rc;
 		}
@@ -257,7 +261,8 @@ static int is_ate_valid(const struct emds_ate *entry)
 	return entry->crc8 == crc8_ccitt(0xff, entry, offsetof(struct emds_ate, crc8));
 }
 
-static int entry_wrt(struct emds_fs *fs, uint16_t id, const void *data, size_t len)
+static int entry_wrt(struct emds_fs *fs, uint16_t id, const void *data, size_t len,
+		     flash_wrt_t wrt)
 {
 	int rc;
 	struct emds_ate entry;
@@ -267,12 +272,12 @@ static int entry_wrt(struct emds_fs *fs, uint16_t id, const void *data, size_t l
 	entry.len = (uint16_t)len;
 	entry.crc8_data = crc8_ccitt(0xff, data, len);
 	entry.crc8 = crc8_ccitt(0xff, &entry, offsetof(struct emds_ate, crc8));
-	rc = data_wrt(fs, data, len);
+	rc = data_wrt(fs, data, len, wrt);
 	if (rc) {
 		return rc;
 	}
 
-	rc = ate_wrt(fs, &entry);
+	rc = ate_wrt(fs, &entry, wrt);
 	if (rc) {
 		return rc;
 	}
@@ -363,11 +368,11 @@ static int ate_last_recover(struct emds_fs *fs)
 	return 0;
 }
 
-static int old_entries_invalidate(struct emds_fs *fs)
+static int old_entries_invalidate(struct emds_fs *fs, uint32_t ate_wra)
 {
 	int rc = 0;
 	uint8_t inval_buf[fs->ate_size];
-	uint32_t addr = fs->ate_wra + fs->ate_size;
+	uint32_t addr = ate_wra + fs->ate_size;
 
 	memset(inval_buf, 0, sizeof(inval_buf));
 	while (addr <= (fs->offset + fs->sector_cnt * fs->sector_size) - fs->ate_size) {
@@ -468,7 +473,7 @@ ssize_t emds_flash_write(struct emds_fs *fs, uint16_t id, const void *data, size
 		return 0;
 	}
 
-	int rc = entry_wrt(fs, id, data, len);
+	int rc = entry_wrt(fs, id, data, len, flash_direct_write);
 
 	if (rc) {
 		return rc;
@@ -531,7 +536,7 @@ int emds_flash_prepare(struct emds_fs *fs, int byte_size)
 		return -ENOMEM;
 	}
 
-	int rc = old_entries_invalidate(fs);
+	int rc = old_entries_invalidate(fs, fs->ate_wra);
 
 	if (rc) {
 		return rc;
@@ -546,6 +551,93 @@ int emds_flash_prepare(struct emds_fs *fs, int byte_size)
 	return 0;
 }
 
+int emds_flash_prepare_keep(struct emds_fs *fs, int byte_size,
+			    struct emds_flash_keep_entry *entries, size_t count)
+{
+	uint32_t ate_wra;
+	int rc;
+
+	if (!fs->is_initialized) {
+		LOG_ERR("EMDS flash not initialized");
+		return -EACCES;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		entries[i].ate_addr = 0;
+	}
+
+	/* Fall back to the plain prepare if the area cannot hold the copies and the next writes. */
+	if (2 * byte_size > (fs->sector_cnt * fs->sector_size) - fs->ate_size) {
+		return emds_flash_prepare(fs, byte_size);
+	}
+
+	if (fs->force_erase || (2 * byte_size > emds_flash_free_space_get(fs))) {
+		rc = emds_flash_clear(fs);
+		if (rc) {
+			return rc;
+		}
+
+		fs->force_erase = false;
+	}
+
+	/* The copies are written before the prior entries are invalidated, so the allocation
+	 * table holds invalidated entries followed by valid ones even if this is interrupted.
+	 */
+	ate_wra = fs->ate_wra;
+
+	for (size_t i = 0; i < count; i++) {
+		const struct emds_entry *entry = entries[i].entry;
+		uint32_t ate_addr = fs->ate_wra;
+
+		if (entry->len == 0) {
+			continue;
+		}
+
+		rc = entry_wrt(fs, entry->id, entry->data, entry->len, flash_write);
+		if (rc) {
+			return rc;
+		}
+
+		entries[i].ate_addr = ate_addr;
+	}
+
+	rc = old_entries_invalidate(fs, ate_wra);
+	if (rc) {
+		return rc;
+	}
+
+	fs->is_prepeared = true;
+	return 0;
+}
+
+bool emds_flash_entry_cmp(struct emds_fs *fs, uint32_t ate_addr, const void *data, size_t len)
+{
+	const uint8_t *data8 = (const uint8_t *)data;
+	struct emds_ate entry;
+	uint8_t buf[EMDS_FLASH_BLOCK_SIZE * 8];
+	uint32_t addr;
+
+	if ((ate_check(fs, ate_addr, &entry) != ATE_TYPE_VALID) || (entry.len != len)) {
+		return false;
+	}
+
+	addr = fs->offset + entry.offset;
+	while (len) {
+		size_t bytes_to_cmp = MIN(sizeof(buf), len);
+
+		if (flash_read(fs->flash_dev, addr, buf, bytes_to_cmp) ||
+		    memcmp(data8, buf, bytes_to_cmp)) {
+			return false;
+		}
+
+		len -= bytes_to_cmp;
+		addr += bytes_to_cmp;
+		data8 += bytes_to_cmp;
+	}
+
+	return true;
+}
+
 ssize_t emds_flash_free_space_get(struct emds_fs *fs)
 {
 	ssize_t space = fs->ate_wra - (fs->data_wra_offset + fs->offset);
@@ -10,6 +10,7 @@
 #include <sys/types.h>
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
+#include <emds/emds.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -118,6 +119,51 @@ ssize_t emds_flash_read(struct emds_fs *fs, uint16_t id, void *data, size_t len)
  */
 int emds_flash_prepare(struct emds_fs *fs, int byte_size);
 
+/** @brief Entry that is written by @ref emds_flash_prepare_keep. */
+struct emds_flash_keep_entry {
+	/** Entry to write. */
+	const struct emds_entry *entry;
+
+	/** Address of the allocation table entry of the written copy, or 0 if no copy
+	 *  was written.
+	 */
+	uint32_t ate_addr;
+};
+
+/**
+ * @brief Prepare EMDS file system for next write events, keeping a copy of the given entries.
+ *
+ * Works as @ref emds_flash_prepare, but the current data of the given entries is written with
+ * the flash driver before all prior entries are invalidated, so it can still be read after the
+ * next write events. The flash area is cleared first if it cannot hold the copies and
+ * @p byte_size more bytes.
+ *
+ * If the flash area cannot hold twice @p byte_size bytes, no copies are written and the
+ * address of every entry is set to 0.
+ *
+ * @param fs Pointer to file system
+ * @param byte_size Total number of bytes of the given entries, including the allocation
+ * table entries
+ * @param entries Entries to write
+ * @param count Number of entries
+ *
+ * @retval 0 on success or negative error code
+ */
+int emds_flash_prepare_keep(struct emds_fs *fs, int byte_size,
+			    struct emds_flash_keep_entry *entries, size_t count);
+
+/**
+ * @brief Check if a stored entry holds the given data.
+ *
+ * @param fs Pointer to file system
+ * @param ate_addr Address of the allocation table entry of the stored entry
+ * @param data Pointer to the data to compare
+ * @param len Number of bytes to compare
+ *
+ * @retval true if the stored entry is valid and holds the same data, false otherwise
+ */
+bool emds_flash_entry_cmp(struct emds_fs *fs, uint32_t ate_addr, const void *data, size_t len);
+
 /**
  * @brief Get remaining raw space on the flash device.
  *
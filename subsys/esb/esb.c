@@ -28,6 +28,7 @@
 
 #include "esb_peripherals.h"
 #include "esb_ppi_api.h"
+#include "esb_tx_queue.h"
 
 LOG_MODULE_REGISTER(esb, CONFIG_ESB_LOG_LEVEL);
 
@@ -114,26 +115,6 @@ struct pipe_info {
 	bool ack_payload; /* State of the transmission of ACK payloads. */
 };
 
-/* Structure used by the PRX to organize ACK payloads for multiple pipes. */
-struct payload_wrap {
-	/* Pointer to the ACK payload. */
-	struct esb_payload  *p_payload;
-	/* Value used to determine if the current payload pointer is used. */
-	bool in_use;
-	/* Pointer to the next ACK payload queued on the same pipe. */
-	struct payload_wrap *p_next;
-};
-
-/* First-in, first-out queue of payloads to be transmitted. */
-struct payload_tx_fifo {
-	 /* Payload queue */
-	struct esb_payload *payload[CONFIG_ESB_TX_FIFO_SIZE];
-
-	uint32_t back;	/* Back of the queue (last in). */
-	uint32_t front;	/* Front of queue (first out). */
-	uint32_t count;	/* Number of elements in the queue. */
-};
-
 /* First-in, first-out queue of received payloads. */
 struct payload_rx_fifo {
 	 /* Payload queue */
@@ -188,6 +169,19 @@ struct esb_radio_pdu {
 	uint8_t data[];
 } __packed;
 
+/* Payload queued for transmission or as an acknowledgment payload.
+ *
+ * The data is stored in the radio PDU format, so the radio reads it directly
+ * from the slot and only the header is written before the transmission.
+ */
+struct tx_slot {
+	uint8_t pipe;	/* Pipe used for this payload. */
+	uint8_t length;	/* Payload length. */
+	uint8_t pid;	/* PID assigned when the payload was written. */
+	uint8_t noack;	/* No acknowledgment requested. */
+	uint8_t pdu[sizeof(struct esb_radio_pdu) + CONFIG_ESB_MAX_PAYLOAD_LENGTH] __aligned(4);
+};
+
 /* Enhanced ShockBurst address.
  *
  * Enhanced ShockBurst addresses consist of a base address and a prefix
@@ -226,10 +220,15 @@ static struct esb_address esb_addr = {
 };
 
 static esb_event_handler event_handler;
-static struct esb_payload *current_payload;
+static struct tx_slot *current_slot;
+/* The slot in flight was popped or flushed by the user. It stays queued until
+ * the transmission ends and is removed even if the transmission fails.
+ */
+static volatile bool current_slot_dropped;
 
 /* FIFOs and buffers */
-static struct payload_tx_fifo tx_fifo;
+static struct esb_tx_queue tx_queue;
+static struct tx_slot tx_slots[CONFIG_ESB_TX_FIFO_SIZE];
 static struct payload_rx_fifo rx_fifo;
 
 static uint8_t tx_payload_buffer[CONFIG_ESB_MAX_PAYLOAD_LENGTH +
@@ -237,10 +236,6 @@ static uint8_t tx_payload_buffer[CONFIG_ESB_MAX_PAYLOAD_LENGTH +
 static uint8_t rx_payload_buffer[CONFIG_ESB_MAX_PAYLOAD_LENGTH +
 				 sizeof(struct esb_radio_pdu)];
 
-/* Random access buffer variables for ACK payload handling */
-struct payload_wrap ack_pl_wrap[CONFIG_ESB_TX_FIFO_SIZE];
-struct payload_wrap *ack_pl_wrap_pipe[CONFIG_ESB_PIPE_COUNT];
-
 /* Run time variables */
 static uint8_t pids[CONFIG_ESB_PIPE_COUNT];
 static struct pipe_info rx_pipe_info[CONFIG_ESB_PIPE_COUNT];
@@ -249,6 +244,13 @@ static volatile uint32_t retransmits_remaining;
 static volatile uint32_t last_tx_attempts;
 static volatile uint32_t wait_for_ack_timeout_us;
 
+#if defined(CONFIG_ESB_STATS)
+static struct esb_stats stats;
+static uint64_t ack_latency_us_total;
+static uint32_t ack_latency_count;
+static uint32_t tx_start_cyc;
+#endif /* defined(CONFIG_ESB_STATS) */
+
 static uint32_t radio_shorts_common = RADIO_SHORTS_COMMON;
 
 static const mpsl_fem_event_t rx_event = {
@@ -690,9 +692,7 @@ static bool update_radio_parameters(void)
 
 static void reset_fifos(void)
 {
-	tx_fifo.back = 0;
-	tx_fifo.front = 0;
-	tx_fifo.count = 0;
+	esb_tx_queue_flush(&tx_queue);
 
 	rx_fifo.back = 0;
 	rx_fifo.front = 0;
@@ -702,43 +702,92 @@ static void reset_fifos(void)
 static void initialize_fifos(void)
 {
 	static struct esb_payload rx_payload[CONFIG_ESB_RX_FIFO_SIZE];
-	static struct esb_payload tx_payload[CONFIG_ESB_TX_FIFO_SIZE];
 
+	esb_tx_queue_init(&tx_queue);
 	reset_fifos();
 
-	for (size_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
-		tx_fifo.payload[i] = &tx_payload[i];
-	}
-
 	for (size_t i = 0; i < CONFIG_ESB_RX_FIFO_SIZE; i++) {
 		rx_fifo.payload[i] = &rx_payload[i];
 	}
 
-	for (size_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
-		ack_pl_wrap[i].p_payload = &tx_payload[i];
-		ack_pl_wrap[i].in_use = false;
-		ack_pl_wrap[i].p_next = 0;
+#if defined(CONFIG_ESB_STATS)
+	memset(&stats, 0, sizeof(stats));
+	ack_latency_us_total = 0;
+	ack_latency_count = 0;
+#endif /* defined(CONFIG_ESB_STATS) */
+}
+
+/* The current slot is being transmitted and must stay in the queue. */
+static bool tx_in_flight(void)
+{
+	return (esb_state == ESB_STATE_PTX_TX) ||
+	       (esb_state == ESB_STATE_PTX_TX_ACK) ||
+	       (esb_state == ESB_STATE_PTX_RX_ACK);
+}
+
+/* Pipes whose first slot is the ACK payload in flight in PRX mode. The radio
+ * sends it with the ACK, and sends it again with the ACK to a retransmit,
+ * until the next packet on the pipe confirms it and removes it from the queue.
+ */
+static uint32_t ack_payload_pipes(void)
+{
+	uint32_t pipes = 0;
+
+	if (esb_cfg.mode != ESB_MODE_PRX) {
+		return 0;
 	}
 
 	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
-		ack_pl_wrap_pipe[i] = 0;
+		if (rx_pipe_info[i].ack_payload) {
+			pipes |= BIT(i);
+		}
 	}
+
+	return pipes;
 }
 
-static void tx_fifo_remove_last(void)
+static void tx_slot_remove_current(void)
 {
-	if (tx_fifo.count == 0) {
+	unsigned int key = irq_lock();
+
+	(void)esb_tx_queue_pop(&tx_queue, current_slot->pipe);
+
+	irq_unlock(key);
+}
+
+static void stats_tx_start(void)
+{
+#if defined(CONFIG_ESB_STATS)
+	tx_start_cyc = k_cycle_get_32();
+#endif /* defined(CONFIG_ESB_STATS) */
+}
+
+static void stats_tx_done(bool success, bool acked)
+{
+#if defined(CONFIG_ESB_STATS)
+	if (!success) {
+		stats.tx_failed++;
 		return;
 	}
 
-	unsigned int key = irq_lock();
+	stats.tx_success++;
+
+	if (acked) {
+		uint32_t latency = k_cyc_to_us_floor32(k_cycle_get_32() - tx_start_cyc);
 
-	tx_fifo.count--;
-	if (++tx_fifo.front >= CONFIG_ESB_TX_FIFO_SIZE) {
-		tx_fifo.front = 0;
+		stats.ack_latency_us_last = latency;
+		stats.ack_latency_us_max = MAX(stats.ack_latency_us_max, latency);
+		ack_latency_us_total += latency;
+		ack_latency_count++;
 	}
+#endif /* defined(CONFIG_ESB_STATS) */
+}
 
-	irq_unlock(key);
+static void stats_retransmit(void)
+{
+#if defined(CONFIG_ESB_STATS)
+	stats.retransmits++;
+#endif /* defined(CONFIG_ESB_STATS) */
 }
 
 /*  Function to push the content of the rx_buffer to the RX FIFO.
@@ -758,6 +807,9 @@ static bool rx_fifo_push_rfbuf(uint8_t pipe, uint8_t pid)
 	struct esb_radio_pdu *rx_pdu = (struct esb_radio_pdu *)rx_payload_buffer;
 
 	if (rx_fifo.count >= CONFIG_ESB_RX_FIFO_SIZE) {
+#if defined(CONFIG_ESB_STATS)
+		stats.rx_dropped++;
+#endif /* defined(CONFIG_ESB_STATS) */
 		return false;
 	}
 
@@ -787,6 +839,10 @@ static bool rx_fifo_push_rfbuf(uint8_t pipe, uint8_t pid)
 	}
 	rx_fifo.count++;
 
+#if defined(CONFIG_ESB_STATS)
+	stats.rx_fifo_max = MAX(stats.rx_fifo_max, rx_fifo.count);
+#endif /* defined(CONFIG_ESB_STATS) */
+
 	return true;
 }
 
@@ -827,19 +883,29 @@ static void start_tx_transaction(void)
 {
 	bool ack = true;
 	bool is_tx_idle = false;
-	struct esb_radio_pdu *pdu = (struct esb_radio_pdu *)tx_payload_buffer;
+	struct esb_radio_pdu *pdu;
+	int pipe;
+
 	last_tx_attempts = 1;
-	/* Prepare the payload */
-	current_payload = tx_fifo.payload[tx_fifo.front];
+
+	/* Select the pipe to serve. The payload data is already in place,
+	 * only the PDU header is filled in here.
+	 */
+	pipe = esb_tx_queue_schedule(&tx_queue);
+	__ASSERT_NO_MSG(pipe >= 0);
+
+	current_slot = &tx_slots[esb_tx_queue_peek(&tx_queue, pipe)];
+	current_slot_dropped = false;
+	pdu = (struct esb_radio_pdu *)current_slot->pdu;
+
+	stats_tx_start();
 
 	switch (esb_cfg.protocol) {
 	case ESB_PROTOCOL_ESB:
 		memset(&pdu->type.fixed_pdu, 0, sizeof(pdu->type.fixed_pdu));
-		update_rf_payload_format(current_payload->length);
+		update_rf_payload_format(current_slot->length);
 
-		pdu->type.fixed_pdu.pid = current_payload->pid;
-
-		memcpy(pdu->data, current_payload->data, current_payload->length);
+		pdu->type.fixed_pdu.pid = current_slot->pid;
 
 		nrf_radio_shorts_set(NRF_RADIO,
 				     (radio_shorts_common | NRF_RADIO_SHORT_DISABLED_RXEN_MASK));
@@ -853,13 +919,11 @@ static void start_tx_transaction(void)
 
 	case ESB_PROTOCOL_ESB_DPL:
 		memset(&pdu->type.dpl_pdu, 0, sizeof(pdu->type.dpl_pdu));
-		ack = !current_payload->noack || !esb_cfg.selective_auto_ack;
-
-		pdu->type.dpl_pdu.length = current_payload->length;
-		pdu->type.dpl_pdu.pid = current_payload->pid;
-		pdu->type.dpl_pdu.no_ack = current_payload->noack ? 0x00 : 0x01;
+		ack = !current_slot->noack || !esb_cfg.selective_auto_ack;
 
-		memcpy(pdu->data, current_payload->data, current_payload->length);
+		pdu->type.dpl_pdu.length = current_slot->length;
+		pdu->type.dpl_pdu.pid = current_slot->pid;
+		pdu->type.dpl_pdu.no_ack = current_slot->noack ? 0x00 : 0x01;
 
 		/* Handling ack if noack is set to false or if
 		 * selective auto ack is turned off
@@ -908,8 +972,8 @@ static void start_tx_transaction(void)
 		break;
 	}
 
-	nrf_radio_txaddress_set(NRF_RADIO, current_payload->pipe);
-	nrf_radio_rxaddresses_set(NRF_RADIO, BIT(current_payload->pipe));
+	nrf_radio_txaddress_set(NRF_RADIO, current_slot->pipe);
+	nrf_radio_rxaddresses_set(NRF_RADIO, BIT(current_slot->pipe));
 	nrf_radio_frequency_set(NRF_RADIO, (RADIO_BASE_FREQUENCY + esb_addr.rf_channel));
 
 	update_radio_tx_power();
@@ -942,9 +1006,10 @@ static void on_radio_end_tx_noack(void)
 	esb_ppi_for_wait_for_rx_clear();
 
 	interrupt_flags |= INT_TX_SUCCESS_MSK;
-	tx_fifo_remove_last();
+	stats_tx_done(true, false);
+	tx_slot_remove_current();
 
-	if (tx_fifo.count == 0) {
+	if (esb_tx_queue_count(&tx_queue) == 0) {
 		esb_state = ESB_STATE_PTX_TXIDLE;
 		NVIC_SetPendingIRQ(ESB_EVT_IRQ);
 	} else {
@@ -959,9 +1024,10 @@ static void on_radio_disabled_tx_noack(void)
 	esb_ppi_for_txrx_clear(false, false);
 
 	interrupt_flags |= INT_TX_SUCCESS_MSK;
-	tx_fifo_remove_last();
+	stats_tx_done(true, false);
+	tx_slot_remove_current();
 
-	if (tx_fifo.count == 0) {
+	if (esb_tx_queue_count(&tx_queue) == 0) {
 		esb_state = ESB_STATE_IDLE;
 		NVIC_SetPendingIRQ(ESB_EVT_IRQ);
 	} else {
@@ -1034,7 +1100,8 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 		interrupt_flags |= INT_TX_SUCCESS_MSK;
 		last_tx_attempts = esb_cfg.retransmit_count - retransmits_remaining + 1;
 
-		tx_fifo_remove_last();
+		stats_tx_done(true, true);
+		tx_slot_remove_current();
 
 		if ((esb_cfg.protocol != ESB_PROTOCOL_ESB) && (rx_pdu->type.dpl_pdu.length > 0)) {
 			if (rx_fifo_push_rfbuf(
@@ -1043,7 +1110,8 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 			}
 		}
 
-		if ((tx_fifo.count == 0) || (esb_cfg.tx_mode == ESB_TXMODE_MANUAL)) {
+		if ((esb_tx_queue_count(&tx_queue) == 0) ||
+		    (esb_cfg.tx_mode == ESB_TXMODE_MANUAL)) {
 			esb_state = ESB_STATE_IDLE;
 			NVIC_SetPendingIRQ(ESB_EVT_IRQ);
 		} else {
@@ -1059,12 +1127,19 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 			 */
 			last_tx_attempts = esb_cfg.retransmit_count + 1;
 			interrupt_flags |= INT_TX_FAILED_MSK;
+			stats_tx_done(false, false);
+
+			if (current_slot_dropped) {
+				tx_slot_remove_current();
+			}
 
 			esb_state = ESB_STATE_IDLE;
 			NVIC_SetPendingIRQ(ESB_EVT_IRQ);
 		} else {
 			bool radio_started = true;
 
+			stats_retransmit();
+
 			nrf_radio_event_clear(NRF_RADIO, NRF_RADIO_EVENT_READY);
 
 			/* There are still more retransmits left, TX mode should
@@ -1073,9 +1148,9 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 			 */
 			nrf_radio_shorts_set(NRF_RADIO,
 				(radio_shorts_common | NRF_RADIO_SHORT_DISABLED_RXEN_MASK));
-			update_rf_payload_format(current_payload->length);
+			update_rf_payload_format(current_slot->length);
 
-			nrf_radio_packetptr_set(NRF_RADIO, tx_payload_buffer);
+			nrf_radio_packetptr_set(NRF_RADIO, current_slot->pdu);
 
 			on_radio_disabled = on_radio_disabled_tx;
 			esb_state = ESB_STATE_PTX_TX_ACK;
@@ -1141,45 +1216,41 @@ static void clear_events_restart_rx(void)
 	radio_start();
 }
 
-static void on_radio_disabled_rx_dpl(bool retransmit_payload,
-				     struct pipe_info *pipe_info)
+/* Select the ACK payload for the pipe the packet was received on.
+ *
+ * ACK payloads are queued in their slots in the radio PDU format, so the ACK
+ * is prepared by writing the header only and pointing the radio to the slot.
+ *
+ * @retval PDU to send as the ACK.
+ */
+static struct esb_radio_pdu *on_radio_disabled_rx_dpl(bool retransmit_payload,
+						      struct pipe_info *pipe_info)
 {
 	struct esb_radio_pdu *tx_pdu = (struct esb_radio_pdu *)tx_payload_buffer;
 	struct esb_radio_pdu *rx_pdu = (struct esb_radio_pdu *)rx_payload_buffer;
-
+	struct tx_slot *ack_slot;
 	uint32_t pipe = nrf_radio_rxmatch_get(NRF_RADIO);
+	int slot = esb_tx_queue_peek(&tx_queue, pipe);
 
-	if (tx_fifo.count > 0 && ack_pl_wrap_pipe[pipe] != 0) {
-		current_payload = ack_pl_wrap_pipe[pipe]->p_payload;
-
-		/* Pipe stays in ACK with payload until TX FIFO is empty */
-		/* Do not report TX success on first ack payload or retransmit */
-		if (pipe_info->ack_payload == true && !retransmit_payload) {
-			ack_pl_wrap_pipe[pipe]->in_use = false;
-			ack_pl_wrap_pipe[pipe] = ack_pl_wrap_pipe[pipe]->p_next;
-			tx_fifo.count--;
-			if (tx_fifo.count > 0 && ack_pl_wrap_pipe[pipe] != 0) {
-				current_payload = ack_pl_wrap_pipe[pipe]->p_payload;
-			} else {
-				current_payload = 0;
-			}
+	/* Pipe stays in ACK with payload until its queue is empty */
+	/* Do not report TX success on first ack payload or retransmit */
+	if ((slot >= 0) && pipe_info->ack_payload && !retransmit_payload) {
+		(void)esb_tx_queue_pop(&tx_queue, pipe);
+		slot = esb_tx_queue_peek(&tx_queue, pipe);
 
-			/* ACK payloads also require TX_DS */
-			/* (page 40 of the 'nRF24LE1_Product_Specification_rev1_6.pdf') */
-			interrupt_flags |= INT_TX_SUCCESS_MSK;
-		}
+		/* ACK payloads also require TX_DS */
+		/* (page 40 of the 'nRF24LE1_Product_Specification_rev1_6.pdf') */
+		interrupt_flags |= INT_TX_SUCCESS_MSK;
+		stats_tx_done(true, false);
+	}
 
-		if (current_payload != 0) {
-			pipe_info->ack_payload = true;
-			update_rf_payload_format(current_payload->length);
+	if (slot >= 0) {
+		ack_slot = &tx_slots[slot];
+		tx_pdu = (struct esb_radio_pdu *)ack_slot->pdu;
 
-			tx_pdu->type.dpl_pdu.length = current_payload->length;
-			memcpy(tx_pdu->data, current_payload->data, current_payload->length);
-		} else {
-			pipe_info->ack_payload = false;
-			update_rf_payload_format(0);
-			tx_pdu->type.dpl_pdu.length = 0;
-		}
+		pipe_info->ack_payload = true;
+		update_rf_payload_format(ack_slot->length);
+		tx_pdu->type.dpl_pdu.length = ack_slot->length;
 	} else {
 		pipe_info->ack_payload = false;
 		update_rf_payload_format(0);
@@ -1188,6 +1259,8 @@ static void on_radio_disabled_rx_dpl(bool retransmit_payload,
 
 	tx_pdu->type.dpl_pdu.pid = rx_pdu->type.dpl_pdu.pid;
 	tx_pdu->type.dpl_pdu.no_ack = rx_pdu->type.dpl_pdu.no_ack;
+
+	return tx_pdu;
 }
 
 static void on_radio_disabled_rx(void)
@@ -1204,6 +1277,9 @@ static void on_radio_disabled_rx(void)
 	}
 
 	if (rx_fifo.count >= CONFIG_ESB_RX_FIFO_SIZE) {
+#if defined(CONFIG_ESB_STATS)
+		stats.rx_dropped++;
+#endif /* defined(CONFIG_ESB_STATS) */
 		clear_events_restart_rx();
 		return;
 	}
@@ -1228,7 +1304,7 @@ static void on_radio_disabled_rx(void)
 
 		switch (esb_cfg.protocol) {
 		case ESB_PROTOCOL_ESB_DPL:
-			on_radio_disabled_rx_dpl(retransmit_payload, pipe_info);
+			tx_pdu = on_radio_disabled_rx_dpl(retransmit_payload, pipe_info);
 			break;
 
 		case ESB_PROTOCOL_ESB:
@@ -1526,19 +1602,12 @@ bool esb_is_idle(void)
 	return (esb_state == ESB_STATE_IDLE);
 }
 
-static struct payload_wrap *find_free_payload_cont(void)
-{
-	for (int i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
-		if (!ack_pl_wrap[i].in_use) {
-			return &ack_pl_wrap[i];
-		}
-	}
-
-	return 0;
-}
-
 int esb_write_payload(const struct esb_payload *payload)
 {
+	struct tx_slot *tx_slot;
+	unsigned int key;
+	int slot;
+
 	if (!esb_initialized) {
 		return -EACCES;
 	}
@@ -1553,51 +1622,33 @@ int esb_write_payload(const struct esb_payload *payload)
 		return -EMSGSIZE;
 	}
 
-	if (tx_fifo.count >= CONFIG_ESB_TX_FIFO_SIZE) {
-		return -ENOMEM;
-	}
-
 	if (payload->pipe >= CONFIG_ESB_PIPE_COUNT) {
 		return -EINVAL;
 	}
 
-	unsigned int key = irq_lock();
-
-	if (esb_cfg.mode == ESB_MODE_PTX) {
-		memcpy(tx_fifo.payload[tx_fifo.back], payload, sizeof(struct esb_payload));
-
-		pids[payload->pipe] = (pids[payload->pipe] + 1) % (PID_MAX + 1);
-		tx_fifo.payload[tx_fifo.back]->pid = pids[payload->pipe];
-
-		if (++tx_fifo.back >= CONFIG_ESB_TX_FIFO_SIZE) {
-			tx_fifo.back = 0;
-		}
+	key = irq_lock();
+	slot = esb_tx_queue_alloc(&tx_queue);
+	irq_unlock(key);
 
-		tx_fifo.count++;
-	} else {
-		struct payload_wrap *new_ack_payload = find_free_payload_cont();
+	if (slot < 0) {
+		return -ENOMEM;
+	}
 
-		if (new_ack_payload != 0) {
-			new_ack_payload->in_use = true;
-			new_ack_payload->p_next = 0;
-			memcpy(new_ack_payload->p_payload, payload, sizeof(struct esb_payload));
+	/* The slot is not visible to the radio until it is queued, so the data
+	 * is copied with interrupts enabled.
+	 */
+	tx_slot = &tx_slots[slot];
+	tx_slot->pipe = payload->pipe;
+	tx_slot->length = payload->length;
+	tx_slot->noack = payload->noack;
+	memcpy(((struct esb_radio_pdu *)tx_slot->pdu)->data, payload->data, payload->length);
 
-			pids[payload->pipe] = (pids[payload->pipe] + 1) % (PID_MAX + 1);
-			new_ack_payload->p_payload->pid = pids[payload->pipe];
+	key = irq_lock();
 
-			if (ack_pl_wrap_pipe[payload->pipe] == 0) {
-				ack_pl_wrap_pipe[payload->pipe] = new_ack_payload;
-			} else {
-				struct payload_wrap *pl = ack_pl_wrap_pipe[payload->pipe];
+	pids[payload->pipe] = (pids[payload->pipe] + 1) % (PID_MAX + 1);
+	tx_slot->pid = pids[payload->pipe];
 
-				while (pl->p_next != 0) {
-					pl = (struct payload_wrap *)pl->p_next;
-				}
-				pl->p_next = (struct payload_wrap *)new_ack_payload;
-			}
-			tx_fifo.count++;
-		}
-	}
+	esb_tx_queue_push(&tx_queue, payload->pipe, slot);
 
 	irq_unlock(key);
 
@@ -1652,7 +1703,7 @@ int esb_start_tx(void)
 		return -EBUSY;
 	}
 
-	if (tx_fifo.count == 0) {
+	if (esb_tx_queue_count(&tx_queue) == 0) {
 		return -ENODATA;
 	}
 
@@ -1731,10 +1782,16 @@ int esb_flush_tx(void)
 	}
 
 	unsigned int key = irq_lock();
+	uint32_t ack_pipes = ack_payload_pipes();
 
-	tx_fifo.count = 0;
-	tx_fifo.back = 0;
-	tx_fifo.front = 0;
+	if (tx_in_flight()) {
+		esb_tx_queue_flush_keep(&tx_queue, BIT(current_slot->pipe));
+		current_slot_dropped = true;
+	} else if (ack_pipes) {
+		esb_tx_queue_flush_keep(&tx_queue, ack_pipes);
+	} else {
+		esb_tx_queue_flush(&tx_queue);
+	}
 
 	irq_unlock(key);
 
@@ -1743,28 +1800,46 @@ int esb_flush_tx(void)
 
 int esb_pop_tx(void)
 {
+	int err = 0;
+
 	if (!esb_initialized) {
 		return -EACCES;
 	}
-	if (tx_fifo.count == 0) {
-		return -ENODATA;
-	}
 
 	unsigned int key = irq_lock();
 
-	if (++tx_fifo.back >= CONFIG_ESB_TX_FIFO_SIZE) {
-		tx_fifo.back = 0;
+	if (tx_in_flight()) {
+		/* The first item is the one in flight, remove it when the
+		 * transmission ends.
+		 */
+		if (current_slot_dropped) {
+			err = -EBUSY;
+		} else {
+			current_slot_dropped = true;
+		}
+	} else {
+		int pipe = esb_tx_queue_schedule(&tx_queue);
+
+		if (pipe < 0) {
+			err = -ENODATA;
+		} else if (ack_payload_pipes() & BIT(pipe)) {
+			/* The ACK payload in flight is removed by the next
+			 * packet on the pipe.
+			 */
+			err = -EBUSY;
+		} else {
+			(void)esb_tx_queue_pop(&tx_queue, pipe);
+		}
 	}
-	tx_fifo.count--;
 
 	irq_unlock(key);
 
-	return 0;
+	return err;
 }
 
 bool esb_tx_full(void)
 {
-	return tx_fifo.count >= CONFIG_ESB_TX_FIFO_SIZE;
+	return esb_tx_queue_full(&tx_queue);
 }
 
 int esb_flush_rx(void)
@@ -1779,7 +1854,11 @@ int esb_flush_rx(void)
 	rx_fifo.back = 0;
 	rx_fifo.front = 0;
 
-	memset(rx_pipe_info, 0, sizeof(rx_pipe_info));
+	/* The ACK payload state tracks the TX queue, and is kept. */
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		rx_pipe_info[i].crc = 0;
+		rx_pipe_info[i].pid = 0;
+	}
 
 	irq_unlock(key);
 
@@ -1972,3 +2051,59 @@ int esb_reuse_pid(uint8_t pipe)
 
 	return 0;
 }
+
+int esb_set_tx_pipe_weight(uint8_t pipe, uint8_t weight)
+{
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+
+	unsigned int key = irq_lock();
+	int err = esb_tx_queue_weight_set(&tx_queue, pipe, weight);
+
+	irq_unlock(key);
+
+	return err;
+}
+
+#if defined(CONFIG_ESB_STATS)
+int esb_stats_get(struct esb_stats *esb_stats)
+{
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (esb_stats == NULL) {
+		return -EINVAL;
+	}
+
+	unsigned int key = irq_lock();
+
+	*esb_stats = stats;
+
+	esb_stats->ack_latency_us_avg = ack_latency_count ?
+		(uint32_t)(ack_latency_us_total / ack_latency_count) : 0;
+	esb_stats->tx_fifo_count = esb_tx_queue_count(&tx_queue);
+	esb_stats->tx_fifo_max = tx_queue.count_max;
+	esb_stats->rx_fifo_count = rx_fifo.count;
+
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		esb_stats->tx_pipe_count[i] = esb_tx_queue_pipe_count(&tx_queue, i);
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+void esb_stats_reset(void)
+{
+	unsigned int key = irq_lock();
+
+	memset(&stats, 0, sizeof(stats));
+	ack_latency_us_total = 0;
+	ack_latency_count = 0;
+	tx_queue.count_max = esb_tx_queue_count(&tx_queue);
+
+	irq_unlock(key);
+}
+#endif /* defined(CONFIG_ESB_STATS) */
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+#include "esb_tx_queue.h"
+
+BUILD_ASSERT(CONFIG_ESB_TX_FIFO_SIZE < ESB_TX_QUEUE_NONE, "TX FIFO too large");
+
+static void pipes_reset(struct esb_tx_queue *q)
+{
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		q->pipe[i].head = ESB_TX_QUEUE_NONE;
+		q->pipe[i].tail = ESB_TX_QUEUE_NONE;
+		q->pipe[i].count = 0;
+		q->pipe[i].credit = 0;
+	}
+}
+
+void esb_tx_queue_flush(struct esb_tx_queue *q)
+{
+	for (size_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
+		q->next[i] = i + 1;
+	}
+
+	q->next[CONFIG_ESB_TX_FIFO_SIZE - 1] = ESB_TX_QUEUE_NONE;
+	q->free = 0;
+	q->count = 0;
+	q->sched_pipe = 0;
+
+	pipes_reset(q);
+}
+
+void esb_tx_queue_flush_keep(struct esb_tx_queue *q, uint32_t keep_pipes)
+{
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		struct esb_tx_queue_pipe *p = &q->pipe[i];
+		uint8_t slot = p->head;
+
+		if ((keep_pipes & BIT(i)) && (slot != ESB_TX_QUEUE_NONE)) {
+			slot = q->next[p->head];
+			q->next[p->head] = ESB_TX_QUEUE_NONE;
+			p->tail = p->head;
+			q->count -= p->count - 1;
+			p->count = 1;
+		} else {
+			p->head = ESB_TX_QUEUE_NONE;
+			p->tail = ESB_TX_QUEUE_NONE;
+			q->count -= p->count;
+			p->count = 0;
+			p->credit = 0;
+		}
+
+		while (slot != ESB_TX_QUEUE_NONE) {
+			uint8_t next = q->next[slot];
+
+			esb_tx_queue_free(q, slot);
+			slot = next;
+		}
+	}
+}
+
+void esb_tx_queue_init(struct esb_tx_queue *q)
+{
+	esb_tx_queue_flush(q);
+
+	q->count_max = 0;
+
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		q->pipe[i].weight = 1;
+	}
+}
+
+int esb_tx_queue_alloc(struct esb_tx_queue *q)
+{
+	uint8_t slot = q->free;
+
+	if (slot == ESB_TX_QUEUE_NONE) {
+		return -ENOMEM;
+	}
+
+	q->free = q->next[slot];
+	q->next[slot] = ESB_TX_QUEUE_NONE;
+
+	return slot;
+}
+
+void esb_tx_queue_free(struct esb_tx_queue *q, uint8_t slot)
+{
+	q->next[slot] = q->free;
+	q->free = slot;
+}
+
+void esb_tx_queue_push(struct esb_tx_queue *q, uint8_t pipe, uint8_t slot)
+{
+	struct esb_tx_queue_pipe *p = &q->pipe[pipe];
+
+	q->next[slot] = ESB_TX_QUEUE_NONE;
+
+	if (p->tail == ESB_TX_QUEUE_NONE) {
+		p->head = slot;
+	} else {
+		q->next[p->tail] = slot;
+	}
+
+	p->tail = slot;
+	p->count++;
+
+	q->count++;
+	if (q->count > q->count_max) {
+		q->count_max = q->count;
+	}
+}
+
+int esb_tx_queue_peek(const struct esb_tx_queue *q, uint8_t pipe)
+{
+	uint8_t slot = q->pipe[pipe].head;
+
+	return (slot == ESB_TX_QUEUE_NONE) ? -ENODATA : slot;
+}
+
+int esb_tx_queue_pop(struct esb_tx_queue *q, uint8_t pipe)
+{
+	struct esb_tx_queue_pipe *p = &q->pipe[pipe];
+	uint8_t slot = p->head;
+
+	if (slot == ESB_TX_QUEUE_NONE) {
+		return -ENODATA;
+	}
+
+	p->head = q->next[slot];
+	if (p->head == ESB_TX_QUEUE_NONE) {
+		p->tail = ESB_TX_QUEUE_NONE;
+	}
+
+	p->count--;
+	if (p->credit > 0) {
+		p->credit--;
+	}
+
+	q->count--;
+
+	esb_tx_queue_free(q, slot);
+
+	return 0;
+}
+
+int esb_tx_queue_schedule(struct esb_tx_queue *q)
+{
+	struct esb_tx_queue_pipe *p = &q->pipe[q->sched_pipe];
+
+	if (q->count == 0) {
+		return -ENODATA;
+	}
+
+	if ((p->count > 0) && (p->credit > 0)) {
+		return q->sched_pipe;
+	}
+
+	/* Start a new round on the next pipe with pending packets. The current
+	 * pipe is checked last, so that it is served again only when it is
+	 * the only one with pending packets.
+	 */
+	for (size_t i = 1; i <= CONFIG_ESB_PIPE_COUNT; i++) {
+		uint8_t pipe = (q->sched_pipe + i) % CONFIG_ESB_PIPE_COUNT;
+
+		p = &q->pipe[pipe];
+		if (p->count > 0) {
+			q->sched_pipe = pipe;
+			p->credit = p->weight;
+
+			return pipe;
+		}
+	}
+
+	/* Not reachable, the count of pipe queues matches the total count. */
+	return -ENODATA;
+}
+
+int esb_tx_queue_weight_set(struct esb_tx_queue *q, uint8_t pipe, uint8_t weight)
+{
+	if ((pipe >= CONFIG_ESB_PIPE_COUNT) || (weight == 0)) {
+		return -EINVAL;
+	}
+
+	q->pipe[pipe].weight = weight;
+
+	return 0;
+}
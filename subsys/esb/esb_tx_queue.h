@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef ESB_TX_QUEUE_H_
+#define ESB_TX_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-pipe TX queues with weighted round-robin scheduling.
+ *
+ * The queue only links slot indices. The slot storage is owned by the user,
+ * so payloads are written once to their slot and referenced from there until
+ * they are removed. The module does no locking, the user is responsible for
+ * serializing the access.
+ */
+
+/* Marks the end of a slot list. */
+#define ESB_TX_QUEUE_NONE UINT8_MAX
+
+/* Queue of a single pipe. */
+struct esb_tx_queue_pipe {
+	uint8_t head;	/* First slot (next to transmit). */
+	uint8_t tail;	/* Last slot. */
+	uint8_t count;	/* Number of queued slots. */
+	uint8_t weight;	/* Packets served in a row when the pipe is scheduled. */
+	uint8_t credit;	/* Packets left in the current round. */
+};
+
+/* TX queue shared by all pipes. */
+struct esb_tx_queue {
+	uint8_t next[CONFIG_ESB_TX_FIFO_SIZE];	/* Slot links. */
+	uint8_t free;				/* First free slot. */
+	uint8_t count;				/* Number of queued slots. */
+	uint8_t count_max;			/* Maximum number of queued slots. */
+	uint8_t sched_pipe;			/* Pipe served in the current round. */
+	struct esb_tx_queue_pipe pipe[CONFIG_ESB_PIPE_COUNT];
+};
+
+/* Initialize the queue. All slots are free and all pipes have a weight of 1.
+ *
+ * @param q Queue.
+ */
+void esb_tx_queue_init(struct esb_tx_queue *q);
+
+/* Remove all queued slots. Pipe weights and the occupancy maximum are kept.
+ *
+ * @param q Queue.
+ */
+void esb_tx_queue_flush(struct esb_tx_queue *q);
+
+/* Remove all queued slots except the first slot of some pipes, for example
+ * the slots being transmitted. Pipe weights and the occupancy maximum are kept.
+ *
+ * @param q Queue.
+ * @param keep_pipes Bit mask of the pipes whose first slot is kept.
+ */
+void esb_tx_queue_flush_keep(struct esb_tx_queue *q, uint32_t keep_pipes);
+
+/* Allocate a free slot. The slot is not queued until esb_tx_queue_push()
+ * is called, so it can be filled without blocking other queue users.
+ *
+ * @param q Queue.
+ *
+ * @retval Slot index if successful.
+ * @retval -ENOMEM if there is no free slot.
+ */
+int esb_tx_queue_alloc(struct esb_tx_queue *q);
+
+/* Return an allocated slot that was not pushed.
+ *
+ * @param q Queue.
+ * @param slot Slot index.
+ */
+void esb_tx_queue_free(struct esb_tx_queue *q, uint8_t slot);
+
+/* Append an allocated slot to the queue of a pipe.
+ *
+ * @param q Queue.
+ * @param pipe Pipe.
+ * @param slot Slot index.
+ */
+void esb_tx_queue_push(struct esb_tx_queue *q, uint8_t pipe, uint8_t slot);
+
+/* Get the first slot queued on a pipe.
+ *
+ * @param q Queue.
+ * @param pipe Pipe.
+ *
+ * @retval Slot index if successful.
+ * @retval -ENODATA if the pipe queue is empty.
+ */
+int esb_tx_queue_peek(const struct esb_tx_queue *q, uint8_t pipe);
+
+/* Remove the first slot queued on a pipe and free it.
+ *
+ * @param q Queue.
+ * @param pipe Pipe.
+ *
+ * @retval 0 if successful.
+ * @retval -ENODATA if the pipe queue is empty.
+ */
+int esb_tx_queue_pop(struct esb_tx_queue *q, uint8_t pipe);
+
+/* Select the pipe to serve next.
+ *
+ * Pipes are served in a round-robin fashion. A scheduled pipe is kept until
+ * it has sent as many packets as its weight or its queue becomes empty.
+ * Calling the function again without popping a slot returns the same pipe.
+ *
+ * @param q Queue.
+ *
+ * @retval Pipe if successful.
+ * @retval -ENODATA if all queues are empty.
+ */
+int esb_tx_queue_schedule(struct esb_tx_queue *q);
+
+/* Set the scheduling weight of a pipe.
+ *
+ * @param q Queue.
+ * @param pipe Pipe.
+ * @param weight Weight, at least 1.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the arguments are invalid.
+ */
+int esb_tx_queue_weight_set(struct esb_tx_queue *q, uint8_t pipe, uint8_t weight);
+
+static inline uint8_t esb_tx_queue_count(const struct esb_tx_queue *q)
+{
+	return q->count;
+}
+
+static inline uint8_t esb_tx_queue_pipe_count(const struct esb_tx_queue *q, uint8_t pipe)
+{
+	return q->pipe[pipe].count;
+}
+
+static inline bool esb_tx_queue_full(const struct esb_tx_queue *q)
+{
+	return q->free == ESB_TX_QUEUE_NONE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESB_TX_QUEUE_H_ */
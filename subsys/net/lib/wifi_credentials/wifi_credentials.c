@@ -20,20 +20,55 @@ K_MUTEX_DEFINE(wifi_credentials_mutex);
 static char ssid_cache[CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES][WIFI_SSID_MAX_LEN];
 static size_t ssid_cache_lengths[CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES];
 
+/* Hash index over the SSID cache. Buckets and chain links hold index + 1, 0 ends a chain. */
+#define SSID_HASH_BUCKETS CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES
+
+BUILD_ASSERT(CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES < UINT16_MAX);
+
+static uint32_t ssid_hashes[CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES];
+static uint16_t ssid_buckets[SSID_HASH_BUCKETS];
+static uint16_t ssid_chain[CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES];
+
+#if CONFIG_WIFI_CREDENTIALS_CACHE_SIZE > 0
+/* Recently used credentials, so that they are not loaded from the backend again. */
+static struct wifi_credentials_personal creds_cache[CONFIG_WIFI_CREDENTIALS_CACHE_SIZE];
+/* Storage index + 1 of each cached entry, 0 if unused */
+static uint16_t creds_cache_idx[CONFIG_WIFI_CREDENTIALS_CACHE_SIZE];
+static uint32_t creds_cache_used[CONFIG_WIFI_CREDENTIALS_CACHE_SIZE];
+static uint32_t creds_cache_clock;
+#endif
+
+/**
+ * @brief Calculates the FNV-1a hash of an SSID.
+ */
+static uint32_t ssid_hash(const char *ssid, size_t ssid_len)
+{
+	uint32_t hash = 2166136261U;
+
+	for (size_t i = 0; i < ssid_len; ++i) {
+		hash ^= (uint8_t)ssid[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
 /**
  * @brief Finds index of given SSID if it exists.
  *
  * @param ssid		SSID to look for (buffer of WIFI_SSID_MAX_LEN length)
  * @return		index if entry is found, -1 otherwise
  */
-static inline ssize_t lookup_idx(const uint8_t *ssid, size_t ssid_len)
+static inline ssize_t lookup_idx(const char *ssid, size_t ssid_len)
 {
-	for (size_t i = 0; i < CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES; ++i) {
-		if (ssid_len != ssid_cache_lengths[i]) {
-			continue;
-		}
-		if (strncmp(ssid, ssid_cache[i], ssid_len) == 0) {
-			return i;
+	uint32_t hash = ssid_hash(ssid, ssid_len);
+
+	for (uint16_t i = ssid_buckets[hash % SSID_HASH_BUCKETS]; i != 0; i = ssid_chain[i - 1]) {
+		size_t idx = i - 1;
+
+		if (ssid_hashes[idx] == hash && ssid_cache_lengths[idx] == ssid_len &&
+		    memcmp(ssid, ssid_cache[idx], ssid_len) == 0) {
+			return idx;
 		}
 	}
 
@@ -84,10 +119,99 @@ static int init(void)
 	return 0;
 }
 
+/**
+ * @brief Removes an entry from the SSID hash index.
+ *
+ * @param idx credential index
+ */
+static void unlink_ssid(size_t idx)
+{
+	uint16_t *link = &ssid_buckets[ssid_hashes[idx] % SSID_HASH_BUCKETS];
+
+	while (*link != 0) {
+		if (*link == idx + 1) {
+			*link = ssid_chain[idx];
+			ssid_chain[idx] = 0;
+			return;
+		}
+		link = &ssid_chain[*link - 1];
+	}
+}
+
+#if CONFIG_WIFI_CREDENTIALS_CACHE_SIZE > 0
+static bool creds_cache_get(size_t idx, struct wifi_credentials_personal *buf)
+{
+	for (size_t i = 0; i < CONFIG_WIFI_CREDENTIALS_CACHE_SIZE; ++i) {
+		if (creds_cache_idx[i] == idx + 1) {
+			memcpy(buf, &creds_cache[i], sizeof(*buf));
+			creds_cache_used[i] = ++creds_cache_clock;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void creds_cache_put(size_t idx, const struct wifi_credentials_personal *buf)
+{
+	size_t slot = 0;
+
+	/* Replace the entry of the same index, or else a free or the least recently used one. */
+	for (size_t i = 0; i < CONFIG_WIFI_CREDENTIALS_CACHE_SIZE; ++i) {
+		if (creds_cache_idx[i] == idx + 1 || creds_cache_idx[i] == 0) {
+			slot = i;
+			break;
+		}
+		if (creds_cache_clock - creds_cache_used[i] >
+		    creds_cache_clock - creds_cache_used[slot]) {
+			slot = i;
+		}
+	}
+
+	memcpy(&creds_cache[slot], buf, sizeof(*buf));
+	creds_cache_idx[slot] = idx + 1;
+	creds_cache_used[slot] = ++creds_cache_clock;
+}
+
+static void creds_cache_drop(size_t idx)
+{
+	for (size_t i = 0; i < CONFIG_WIFI_CREDENTIALS_CACHE_SIZE; ++i) {
+		if (creds_cache_idx[i] == idx + 1) {
+			/* Do not leave the password in memory. */
+			memset(&creds_cache[i], 0, sizeof(creds_cache[i]));
+			creds_cache_idx[i] = 0;
+		}
+	}
+}
+
+static void creds_cache_clear(void)
+{
+	memset(creds_cache, 0, sizeof(creds_cache));
+	memset(creds_cache_idx, 0, sizeof(creds_cache_idx));
+}
+#else
+static inline bool creds_cache_get(size_t idx, struct wifi_credentials_personal *buf)
+{
+	return false;
+}
+
+static inline void creds_cache_put(size_t idx, const struct wifi_credentials_personal *buf) {}
+static inline void creds_cache_drop(size_t idx) {}
+static inline void creds_cache_clear(void) {}
+#endif /* CONFIG_WIFI_CREDENTIALS_CACHE_SIZE > 0 */
+
 void wifi_credentials_cache_ssid(size_t idx, const struct wifi_credentials_header *buf)
 {
+	if (is_entry_used(idx)) {
+		unlink_ssid(idx);
+	}
+
 	memcpy(ssid_cache[idx], buf->ssid, buf->ssid_len);
 	ssid_cache_lengths[idx] = buf->ssid_len;
+	ssid_hashes[idx] = ssid_hash(buf->ssid, buf->ssid_len);
+
+	ssid_chain[idx] = ssid_buckets[ssid_hashes[idx] % SSID_HASH_BUCKETS];
+	ssid_buckets[ssid_hashes[idx] % SSID_HASH_BUCKETS] = idx + 1;
 }
 
 /**
@@ -97,13 +221,18 @@ void wifi_credentials_cache_ssid(size_t idx, const struct wifi_credentials_heade
  */
 void wifi_credentials_uncache_ssid(size_t idx)
 {
+	if (is_entry_used(idx)) {
+		unlink_ssid(idx);
+	}
+
 	ssid_cache_lengths[idx] = 0;
+	creds_cache_drop(idx);
 }
 
 int wifi_credentials_get_by_ssid_personal_struct(const char *ssid, size_t ssid_len,
 						 struct wifi_credentials_personal *buf)
 {
-	int ret;
+	int ret = 0;
 
 	if (ssid == NULL || ssid_len > WIFI_SSID_MAX_LEN || ssid_len == 0) {
 		LOG_ERR("Cannot retrieve WiFi credentials, SSID has invalid format");
@@ -125,11 +254,15 @@ int wifi_credentials_get_by_ssid_personal_struct(const char *ssid, size_t ssid_l
 		goto exit;
 	}
 
-	ret = wifi_credentials_load_entry(idx, buf, sizeof(struct wifi_credentials_personal));
+	bool cached = creds_cache_get(idx, buf);
 
-	if (ret) {
-		LOG_ERR("Failed to load WiFi credentials at index %d, err: %d", idx, ret);
-		goto exit;
+	if (!cached) {
+		ret = wifi_credentials_load_entry(idx, buf,
+						  sizeof(struct wifi_credentials_personal));
+		if (ret) {
+			LOG_ERR("Failed to load WiFi credentials at index %d, err: %d", idx, ret);
+			goto exit;
+		}
 	}
 
 	if (buf->header.type != WIFI_SECURITY_TYPE_NONE &&
@@ -141,6 +274,10 @@ int wifi_credentials_get_by_ssid_personal_struct(const char *ssid, size_t ssid_l
 		goto exit;
 	}
 
+	if (!cached) {
+		creds_cache_put(idx, buf);
+	}
+
 exit:
 	k_mutex_unlock(&wifi_credentials_mutex);
 
@@ -174,6 +311,9 @@ int wifi_credentials_set_personal_struct(const struct wifi_credentials_personal
 		}
 	}
 
+	/* The entry is loaded and validated again on the next read. */
+	creds_cache_drop(idx);
+
 	ret = wifi_credentials_store_entry(idx, creds, sizeof(struct wifi_credentials_personal));
 
 	if (ret) {
@@ -353,4 +493,35 @@ void wifi_credentials_for_each_ssid(wifi_credentials_ssid_cb cb, void *cb_arg)
 	k_mutex_unlock(&wifi_credentials_mutex);
 }
 
+int wifi_credentials_match_ssids(const struct wifi_credentials_ssid *ssids, size_t count,
+				 bool *matched)
+{
+	int found = 0;
+
+	if (count > 0 && (ssids == NULL || matched == NULL)) {
+		LOG_ERR("Cannot match SSIDs, list pointers cannot be NULL");
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&wifi_credentials_mutex, K_FOREVER);
+	for (size_t i = 0; i < count; ++i) {
+		matched[i] = ssids[i].ssid != NULL && ssids[i].ssid_len != 0 &&
+			     ssids[i].ssid_len <= WIFI_SSID_MAX_LEN &&
+			     lookup_idx(ssids[i].ssid, ssids[i].ssid_len) != -1;
+		if (matched[i]) {
+			found++;
+		}
+	}
+	k_mutex_unlock(&wifi_credentials_mutex);
+
+	return found;
+}
+
+void wifi_credentials_cache_invalidate(void)
+{
+	k_mutex_lock(&wifi_credentials_mutex, K_FOREVER);
+	creds_cache_clear();
+	k_mutex_unlock(&wifi_credentials_mutex);
+}
+
 SYS_INIT(init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
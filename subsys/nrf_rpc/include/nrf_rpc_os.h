@@ -42,6 +42,69 @@ int nrf_rpc_os_init(nrf_rpc_os_work_t callback);
 
 void nrf_rpc_os_thread_pool_send(const uint8_t *data, size_t len);
 
+/** @brief Thread pools handling incoming packets. */
+enum nrf_rpc_os_pool {
+	/** Pool of CONFIG_NRF_RPC_THREAD_POOL_SIZE threads. */
+	NRF_RPC_OS_POOL_DEFAULT,
+
+	/** Pool of CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO_SIZE threads. */
+	NRF_RPC_OS_POOL_HIGH_PRIO,
+};
+
+/** @brief Set the thread pool handling commands and events of a group.
+ *
+ * Packets are dispatched by the destination group ID from the nRF RPC packet
+ * header. Groups are handled by @ref NRF_RPC_OS_POOL_DEFAULT until set
+ * otherwise.
+ *
+ * @param group_id Local group ID, that is @c src_group_id of the group data
+ *                 assigned by nrf_rpc_init().
+ * @param pool Thread pool.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL The pool is not available.
+ */
+int nrf_rpc_os_group_pool_set(uint8_t group_id, enum nrf_rpc_os_pool pool);
+
+/** @brief Thread pool statistics. */
+struct nrf_rpc_os_pool_stats {
+	/** Number of handled packets. */
+	uint32_t handled;
+
+	/** Number of times a pool thread woke up to handle packets. A thread
+	 *  handles all queued packets per wakeup, so @c handled / @c wakeups
+	 *  is the average batch size.
+	 */
+	uint32_t wakeups;
+
+	/** Number of packets currently waiting in the queue. */
+	uint32_t depth;
+
+	/** Maximum number of packets waiting in the queue. */
+	uint32_t depth_max;
+
+	/** Maximum time a packet waited for a pool thread [us]. */
+	uint32_t wait_us_max;
+
+	/** Total time packets waited for a pool thread [us]. */
+	uint64_t wait_us_total;
+};
+
+/** @brief Get thread pool statistics.
+ *
+ * Available if CONFIG_NRF_RPC_THREAD_POOL_STATS is enabled.
+ *
+ * @param pool Thread pool.
+ * @param stats Statistics.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL The pool is not available.
+ */
+int nrf_rpc_os_pool_stats_get(enum nrf_rpc_os_pool pool, struct nrf_rpc_os_pool_stats *stats);
+
+/** @brief Reset statistics of all thread pools. */
+void nrf_rpc_os_pool_stats_reset(void);
+
 static inline int nrf_rpc_os_event_init(struct nrf_rpc_os_event *event)
 {
 	return k_sem_init(&event->sem, 0, 1);
@@ -7,30 +7,55 @@
 #define NRF_RPC_LOG_MODULE NRF_RPC_OS
 #include <nrf_rpc_log.h>
 
+#include <string.h>
+#include <zephyr/sys/atomic.h>
+
 #include "nrf_rpc_os.h"
 
 /* Maximum number of remote thread that this implementation allows. */
 #define MAX_REMOTE_THREADS 255
 
-/* Initial value contains ones (context free) on the
- * CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE most significant bits.
+/* nRF RPC packet header: source context, packet type, command or event ID,
+ * destination context, source group ID and destination group ID. Packets
+ * handed to the thread pool are addressed to a local group by the last one.
  */
-#define CONTEXT_MASK_INIT_VALUE						       \
-	(~(((atomic_val_t)1 << (8 * sizeof(atomic_val_t) -		       \
-				CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE)) - 1))
+#define HEADER_DST_GROUP_ID_OFFSET 5
+
+/* Group IDs are carried in a single byte of the header. */
+#define GROUP_ID_COUNT (UINT8_MAX + 1)
+
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO)
+#define POOL_COUNT 2
+#else
+#define POOL_COUNT 1
+#endif
 
 struct pool_start_msg {
 	const uint8_t *data;
 	size_t len;
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+	uint32_t timestamp;
+#endif
 };
 
-static nrf_rpc_os_work_t thread_pool_callback;
+struct pool {
+	struct k_msgq msgq;
+	struct pool_start_msg *msg_buf;
+	size_t msg_cnt;
+	struct k_thread *threads;
+	k_thread_stack_t (*stacks)[K_THREAD_STACK_LEN(CONFIG_NRF_RPC_THREAD_STACK_SIZE)];
+	size_t thread_cnt;
+	int priority;
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+	struct k_spinlock stats_lock;
+	struct nrf_rpc_os_pool_stats stats;
+#endif
+};
 
-static struct pool_start_msg pool_start_msg_buf[2];
-static struct k_msgq pool_start_msg;
+static nrf_rpc_os_work_t thread_pool_callback;
 
-static struct k_sem context_reserved;
-static atomic_t context_mask;
+static struct pool_start_msg
+	pool_start_msg_buf[CONFIG_NRF_RPC_THREAD_POOL_QUEUE_SIZE];
 
 static K_THREAD_STACK_ARRAY_DEFINE(pool_stacks,
 	CONFIG_NRF_RPC_THREAD_POOL_SIZE,
@@ -38,27 +63,116 @@ static K_THREAD_STACK_ARRAY_DEFINE(pool_stacks,
 
 static struct k_thread pool_threads[CONFIG_NRF_RPC_THREAD_POOL_SIZE];
 
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO)
+static struct pool_start_msg
+	high_prio_msg_buf[CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO_QUEUE_SIZE];
+
+static K_THREAD_STACK_ARRAY_DEFINE(high_prio_stacks,
+	CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO_SIZE,
+	CONFIG_NRF_RPC_THREAD_STACK_SIZE);
+
+static struct k_thread high_prio_threads[CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO_SIZE];
+
+/* Set bits mark groups handled by the high-priority pool. */
+static ATOMIC_DEFINE(high_prio_groups, GROUP_ID_COUNT);
+#endif
+
+static struct pool pools[POOL_COUNT] = {
+	[NRF_RPC_OS_POOL_DEFAULT] = {
+		.msg_buf = pool_start_msg_buf,
+		.msg_cnt = ARRAY_SIZE(pool_start_msg_buf),
+		.threads = pool_threads,
+		.stacks = pool_stacks,
+		.thread_cnt = ARRAY_SIZE(pool_threads),
+		.priority = CONFIG_NRF_RPC_THREAD_PRIORITY,
+	},
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO)
+	[NRF_RPC_OS_POOL_HIGH_PRIO] = {
+		.msg_buf = high_prio_msg_buf,
+		.msg_cnt = ARRAY_SIZE(high_prio_msg_buf),
+		.threads = high_prio_threads,
+		.stacks = high_prio_stacks,
+		.thread_cnt = ARRAY_SIZE(high_prio_threads),
+		.priority = CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO_PRIORITY,
+	},
+#endif
+};
+
+static struct k_sem context_reserved;
+
+/* Set bits mark free contexts. */
+static ATOMIC_DEFINE(context_free, CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE);
+
 BUILD_ASSERT(CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE > 0,
 	     "CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE must be greaten than zero");
-BUILD_ASSERT(CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE <= 8 * sizeof(atomic_val_t),
+BUILD_ASSERT(CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE < MAX_REMOTE_THREADS,
 	     "CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE too big");
 BUILD_ASSERT(sizeof(uint32_t) == sizeof(atomic_val_t),
 	     "Only atomic_val_t is implemented that is the same as uint32_t");
 
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+static void stats_enqueued(struct pool *pool)
+{
+	k_spinlock_key_t key = k_spin_lock(&pool->stats_lock);
+	uint32_t depth = k_msgq_num_used_get(&pool->msgq);
+
+	pool->stats.depth_max = MAX(pool->stats.depth_max, depth);
+
+	k_spin_unlock(&pool->stats_lock, key);
+}
+
+static void stats_dequeued(struct pool *pool, const struct pool_start_msg *msg, bool wakeup)
+{
+	uint32_t wait_us = k_cyc_to_us_floor32(k_cycle_get_32() - msg->timestamp);
+	k_spinlock_key_t key = k_spin_lock(&pool->stats_lock);
+
+	pool->stats.handled++;
+	pool->stats.wakeups += wakeup ? 1 : 0;
+	pool->stats.wait_us_total += wait_us;
+	pool->stats.wait_us_max = MAX(pool->stats.wait_us_max, wait_us);
+
+	k_spin_unlock(&pool->stats_lock, key);
+}
+#endif
+
 static void thread_pool_entry(void *p1, void *p2, void *p3)
 {
+	struct pool *pool = p1;
 	struct pool_start_msg msg;
+	bool wakeup;
 
 	do {
-		k_msgq_get(&pool_start_msg, &msg, K_FOREVER);
-		thread_pool_callback(msg.data, msg.len);
+		k_msgq_get(&pool->msgq, &msg, K_FOREVER);
+		wakeup = true;
+
+		/* Handle everything that was queued meanwhile before sleeping
+		 * again, so bursts of small packets cost a single wakeup.
+		 */
+		do {
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+			stats_dequeued(pool, &msg, wakeup);
+#endif
+			thread_pool_callback(msg.data, msg.len);
+			wakeup = false;
+		} while (k_msgq_get(&pool->msgq, &msg, K_NO_WAIT) == 0);
 	} while (1);
 }
 
+static struct pool *pool_get(const uint8_t *data, size_t len)
+{
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO)
+	if (len > HEADER_DST_GROUP_ID_OFFSET &&
+	    atomic_test_bit(high_prio_groups, data[HEADER_DST_GROUP_ID_OFFSET])) {
+		return &pools[NRF_RPC_OS_POOL_HIGH_PRIO];
+	}
+#endif
+
+	return &pools[NRF_RPC_OS_POOL_DEFAULT];
+}
+
 int nrf_rpc_os_init(nrf_rpc_os_work_t callback)
 {
 	int err;
-	int i;
 
 	__ASSERT_NO_MSG(callback != NULL);
 
@@ -70,32 +184,97 @@ int nrf_rpc_os_init(nrf_rpc_os_work_t callback)
 		return err;
 	}
 
-	atomic_set(&context_mask, CONTEXT_MASK_INIT_VALUE);
+	for (size_t i = 0; i < CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE; i++) {
+		atomic_set_bit(context_free, i);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(pools); i++) {
+		struct pool *pool = &pools[i];
 
-	k_msgq_init(&pool_start_msg, (char *)pool_start_msg_buf,
-		    sizeof(struct pool_start_msg),
-		    ARRAY_SIZE(pool_start_msg_buf));
+		k_msgq_init(&pool->msgq, (char *)pool->msg_buf,
+			    sizeof(struct pool_start_msg), pool->msg_cnt);
 
-	for (i = 0; i < CONFIG_NRF_RPC_THREAD_POOL_SIZE; i++) {
-		k_thread_create(&pool_threads[i], pool_stacks[i],
-			K_THREAD_STACK_SIZEOF(pool_stacks[i]),
-			thread_pool_entry,
-			NULL, NULL, NULL,
-			CONFIG_NRF_RPC_THREAD_PRIORITY, 0, K_NO_WAIT);
+		for (size_t j = 0; j < pool->thread_cnt; j++) {
+			k_thread_create(&pool->threads[j], pool->stacks[j],
+				K_THREAD_STACK_SIZEOF(pool->stacks[j]),
+				thread_pool_entry,
+				pool, NULL, NULL,
+				pool->priority, 0, K_NO_WAIT);
+		}
 	}
 
 	return 0;
 }
 
+int nrf_rpc_os_group_pool_set(uint8_t group_id, enum nrf_rpc_os_pool pool)
+{
+	switch (pool) {
+	case NRF_RPC_OS_POOL_DEFAULT:
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO)
+		atomic_clear_bit(high_prio_groups, group_id);
+#endif
+		return 0;
+
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_HIGH_PRIO)
+	case NRF_RPC_OS_POOL_HIGH_PRIO:
+		atomic_set_bit(high_prio_groups, group_id);
+		return 0;
+#endif
+
+	default:
+		return -EINVAL;
+	}
+}
+
 void nrf_rpc_os_thread_pool_send(const uint8_t *data, size_t len)
 {
 	struct pool_start_msg msg;
+	struct pool *pool = pool_get(data, len);
 
 	msg.data = data;
 	msg.len = len;
-	k_msgq_put(&pool_start_msg, &msg, K_FOREVER);
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+	msg.timestamp = k_cycle_get_32();
+#endif
+	k_msgq_put(&pool->msgq, &msg, K_FOREVER);
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+	stats_enqueued(pool);
+#endif
 }
 
+#if defined(CONFIG_NRF_RPC_THREAD_POOL_STATS)
+int nrf_rpc_os_pool_stats_get(enum nrf_rpc_os_pool pool, struct nrf_rpc_os_pool_stats *stats)
+{
+	struct pool *p;
+	k_spinlock_key_t key;
+
+	if ((size_t)pool >= ARRAY_SIZE(pools)) {
+		return -EINVAL;
+	}
+
+	p = &pools[pool];
+	key = k_spin_lock(&p->stats_lock);
+
+	*stats = p->stats;
+	stats->depth = k_msgq_num_used_get(&p->msgq);
+
+	k_spin_unlock(&p->stats_lock, key);
+
+	return 0;
+}
+
+void nrf_rpc_os_pool_stats_reset(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(pools); i++) {
+		k_spinlock_key_t key = k_spin_lock(&pools[i].stats_lock);
+
+		memset(&pools[i].stats, 0, sizeof(pools[i].stats));
+
+		k_spin_unlock(&pools[i].stats_lock, key);
+	}
+}
+#endif /* defined(CONFIG_NRF_RPC_THREAD_POOL_STATS) */
+
 void nrf_rpc_os_msg_set(struct nrf_rpc_os_msg *msg, const uint8_t *data,
 			size_t len)
 {
@@ -118,25 +297,34 @@ void nrf_rpc_os_msg_get(struct nrf_rpc_os_msg *msg, const uint8_t **data,
 
 uint32_t nrf_rpc_os_ctx_pool_reserve(void)
 {
-	uint32_t number;
-	atomic_val_t old_mask;
-	atomic_val_t new_mask;
-
 	k_sem_take(&context_reserved, K_FOREVER);
 
-	do {
-		old_mask = atomic_get(&context_mask);
-		number = __CLZ(old_mask);
-		new_mask = old_mask & ~(0x80000000u >> number);
-	} while (!atomic_cas(&context_mask, old_mask, new_mask));
+	/* The semaphore guarantees that a free context exists, but other
+	 * threads may take it first, so scan until one is claimed. Lower
+	 * numbers are preferred.
+	 */
+	while (true) {
+		for (size_t i = 0; i < ARRAY_SIZE(context_free); i++) {
+			atomic_val_t old_mask = atomic_get(&context_free[i]);
 
-	return number;
+			while (old_mask != 0) {
+				uint32_t bit = find_lsb_set(old_mask) - 1;
+
+				if (atomic_cas(&context_free[i], old_mask,
+					       old_mask & ~BIT(bit))) {
+					return i * ATOMIC_BITS + bit;
+				}
+
+				old_mask = atomic_get(&context_free[i]);
+			}
+		}
+	}
 }
 
 void nrf_rpc_os_ctx_pool_release(uint32_t number)
 {
 	__ASSERT_NO_MSG(number < CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE);
 
-	atomic_or(&context_mask, 0x80000000u >> number);
+	atomic_set_bit(context_free, number);
 	k_sem_give(&context_reserved);
 }
@@ -8,17 +8,27 @@
 #include <ei_run_classifier.h>
 
 static size_t prediction_idx;
+static size_t slice_init_count;
+static size_t slices_cached;
+static float next_slice_first_input;
 
 void ei_run_classifier_mock_init(void)
 {
 	prediction_idx = 0;
+	slice_init_count = 0;
+	slices_cached = 0;
+}
+
+size_t ei_run_classifier_mock_slice_init_count(void)
+{
+	return slice_init_count;
 }
 
 /* Input data must be ascending sequence of floats. Difference between
  * subsequent elements of input sequence equals 1. The first element
- * has value defined by ei_test_params.h (depends on current prediction idx).
+ * has value defined by the caller.
  */
-static void verify_data_read(signal_t *signal, const size_t prediction_idx,
+static void verify_data_read(signal_t *signal, const float first_input,
 			     const size_t chunk_size)
 {
 	size_t data_size = signal->total_length;
@@ -37,7 +47,7 @@ static void verify_data_read(signal_t *signal, const size_t prediction_idx,
 		zassert_ok(err, "get_data returned an error");
 	}
 
-	float value = EI_MOCK_GEN_FIRST_INPUT(prediction_idx);;
+	float value = first_input;
 
 	for (size_t off = 0; off < data_size; off++) {
 		zassert_within(data_buf[off], value, FLOAT_CMP_EPSILON,
@@ -46,19 +56,8 @@ static void verify_data_read(signal_t *signal, const size_t prediction_idx,
 	}
 }
 
-EI_IMPULSE_ERROR run_classifier(signal_t *signal,
-				ei_impulse_result_t *result,
-				bool debug)
+static void result_fill(ei_impulse_result_t *result)
 {
-	ARG_UNUSED(debug);
-
-	/* Test getting data. */
-	verify_data_read(signal, prediction_idx, 1);
-	verify_data_read(signal, prediction_idx,
-			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
-	verify_data_read(signal, prediction_idx,
-			 EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
-
 	/* Busy wait for predefined amount of time to simulate calculations. */
 	k_busy_wait(EI_MOCK_BUSY_WAIT_TIME);
 
@@ -88,6 +87,62 @@ EI_IMPULSE_ERROR run_classifier(signal_t *signal,
 		      "Wrong label");
 
 	prediction_idx++;
+}
+
+EI_IMPULSE_ERROR run_classifier(signal_t *signal,
+				ei_impulse_result_t *result,
+				bool debug)
+{
+	ARG_UNUSED(debug);
+
+	const float first_input = EI_MOCK_GEN_FIRST_INPUT(prediction_idx);
+
+	/* Test getting data. */
+	verify_data_read(signal, first_input, 1);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+
+	result_fill(result);
+
+	return EI_IMPULSE_OK;
+}
+
+void run_classifier_init(void)
+{
+	slice_init_count++;
+	slices_cached = 0;
+}
+
+/* The first slice after run_classifier_init starts where the whole input
+ * window would start. Every next slice must directly follow the previous one.
+ */
+EI_IMPULSE_ERROR run_classifier_continuous(signal_t *signal,
+					   ei_impulse_result_t *result,
+					   bool debug)
+{
+	ARG_UNUSED(debug);
+
+	const size_t slice_size = EI_CLASSIFIER_SLICE_SIZE *
+				  EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+	const float first_input = (slices_cached > 0) ?
+				  next_slice_first_input :
+				  EI_MOCK_GEN_FIRST_INPUT(prediction_idx);
+
+	zassert_true(slice_init_count > 0, "Classifier not initialized");
+	zassert_equal(signal->total_length, slice_size, "Wrong slice size");
+
+	/* Test getting data. */
+	verify_data_read(signal, first_input, 1);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+	verify_data_read(signal, first_input, slice_size);
+
+	next_slice_first_input = first_input + slice_size;
+	slices_cached++;
+
+	result_fill(result);
 
 	return EI_IMPULSE_OK;
 }
@@ -7,6 +7,11 @@
 #ifndef _EI_RUN_CLASSIFIER_MOCK_H_
 #define _EI_RUN_CLASSIFIER_MOCK_H_
 
+#include <stddef.h>
+
 void ei_run_classifier_mock_init(void);
 
+/* Number of run_classifier_init calls since the mock initialization. */
+size_t ei_run_classifier_mock_slice_init_count(void);
+
 #endif /* _EI_RUN_CLASSIFIER_MOCK_H_ */
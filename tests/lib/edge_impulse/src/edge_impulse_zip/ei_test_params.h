@@ -18,6 +18,11 @@
 #define EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE	300
 #define EI_CLASSIFIER_HAS_ANOMALY		1
 #define EI_CLASSIFIER_FREQUENCY			60
+#define EI_CLASSIFIER_RAW_SAMPLE_COUNT		\
+	(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+#define EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW	4
+#define EI_CLASSIFIER_SLICE_SIZE		\
+	(EI_CLASSIFIER_RAW_SAMPLE_COUNT / EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW)
 
 /* Mocked results. */
 static const char * const ei_classifier_inferencing_categories[] = {
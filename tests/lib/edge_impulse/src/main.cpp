@@ -25,12 +25,20 @@ static size_t prediction_idx;
 static K_SEM_DEFINE(test_sem, 0, 1)
 
 
+#if defined(CONFIG_EI_WRAPPER_DATA_TYPE_INT16)
+typedef int16_t data_t;
+#define add_data ei_wrapper_add_data_int16
+#else
+typedef float data_t;
+#define add_data ei_wrapper_add_data
+#endif
+
 static int add_input_data(const size_t pred_idx, const size_t frame_surplus)
 {
-	static float data_buf[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME];
+	static data_t data_buf[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME];
 
 	int err = 0;
-	float value = EI_MOCK_GEN_FIRST_INPUT(pred_idx);
+	data_t value = EI_MOCK_GEN_FIRST_INPUT(pred_idx);
 	size_t data_surplus =
 		      frame_surplus * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
 
@@ -42,7 +50,7 @@ static int add_input_data(const size_t pred_idx, const size_t frame_surplus)
 			value++;
 		}
 
-		err = ei_wrapper_add_data(data_buf, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+		err = add_data(data_buf, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
 		if (err) {
 			break;
 		}
@@ -158,6 +166,11 @@ static void *test_init(void)
 		      "Wrong window size");
 	zassert_true(ei_wrapper_get_window_size() % ei_wrapper_get_frame_size() == 0,
 		     "Wrong window and frame size combination");
+	zassert_equal(ei_wrapper_get_slice_size(),
+		      IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS) ?
+		      (EI_CLASSIFIER_SLICE_SIZE * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) :
+		      EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE,
+		      "Wrong slice size");
 	zassert_true(ei_wrapper_classifier_has_anomaly(), "Mocked library supports anomaly");
 	zassert_equal(ei_wrapper_get_classifier_frequency(), EI_CLASSIFIER_FREQUENCY,
 		      "Wrong classifier frequency");
@@ -187,6 +200,47 @@ ZTEST(suite0, test_basic)
 	run_basic_setup(prediction_idx, 1, 0, 0);
 }
 
+ZTEST(suite0, test_continuous)
+{
+	static const size_t slice_cnt = EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW + 1;
+	const size_t slice_frames = ei_wrapper_get_slice_size() / ei_wrapper_get_frame_size();
+	int err;
+
+	if (!IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS)) {
+		ztest_test_skip();
+	}
+
+	err = add_input_data(prediction_idx, slice_cnt * slice_frames);
+	zassert_ok(err, "Cannot add input data");
+
+	err = ei_wrapper_start_prediction(0, 0);
+	zassert_ok(err, "Cannot start prediction");
+	err = k_sem_take(&test_sem, EI_TEST_SEM_TIMEOUT);
+	zassert_ok(err, "Cannot take semaphore");
+
+	/* Shifting by a single slice reuses the features of the previous slices. */
+	for (size_t i = 0; i < slice_cnt; i++) {
+		err = ei_wrapper_start_prediction(0, slice_frames);
+		zassert_ok(err, "Cannot start prediction");
+		err = k_sem_take(&test_sem, EI_TEST_SEM_TIMEOUT);
+		zassert_ok(err, "Cannot take semaphore");
+	}
+
+	zassert_equal(ei_run_classifier_mock_slice_init_count(), 1,
+		      "Cached slices were reset");
+
+	/* Clearing the data resets the cached features. */
+	bool cancelled;
+
+	err = ei_wrapper_clear_data(&cancelled);
+	zassert_ok(err, "Cannot clear data");
+
+	run_basic_setup(prediction_idx, 1, 0, 0);
+
+	zassert_equal(ei_run_classifier_mock_slice_init_count(), 2,
+		      "Cached slices were not reset");
+}
+
 ZTEST(suite0, test_run_from_cb)
 {
 	int err;
@@ -234,12 +288,34 @@ ZTEST(suite0, test_data_add_fail)
 		       EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) == 0,
 		      "Wrong value of EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME");
 
-	float data_buf[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + 1] = {0.0};
-	int err = ei_wrapper_add_data(data_buf, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + 1);
+	data_t data_buf[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + 1] = {0};
+	int err = add_data(data_buf, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + 1);
 
 	zassert_true(err, "Expected error adding data with improper size");
 }
 
+ZTEST(suite0, test_data_type_mismatch)
+{
+	float data_float[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME] = {0.0};
+	int16_t data_int16[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME] = {0};
+	int8_t data_int8[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME] = {0};
+
+	if (!IS_ENABLED(CONFIG_EI_WRAPPER_DATA_TYPE_FLOAT)) {
+		zassert_equal(ei_wrapper_add_data(data_float, ARRAY_SIZE(data_float)), -ENOTSUP,
+			      "Float data accepted");
+	}
+
+	if (!IS_ENABLED(CONFIG_EI_WRAPPER_DATA_TYPE_INT16)) {
+		zassert_equal(ei_wrapper_add_data_int16(data_int16, ARRAY_SIZE(data_int16)),
+			      -ENOTSUP, "16-bit integer data accepted");
+	}
+
+	if (!IS_ENABLED(CONFIG_EI_WRAPPER_DATA_TYPE_INT8)) {
+		zassert_equal(ei_wrapper_add_data_int8(data_int8, ARRAY_SIZE(data_int8)),
+			      -ENOTSUP, "8-bit integer data accepted");
+	}
+}
+
 ZTEST(suite0, test_double_start)
 {
 	int err;
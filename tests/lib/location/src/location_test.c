@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 #include <unity.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,6 +32,8 @@ static struct rest_client_req_context rest_req_ctx = { 0 };
 static struct rest_client_resp_context rest_resp_ctx = { 0 };
 static bool location_callback_called_occurred;
 static bool location_callback_called_expected;
+static int64_t location_callback_uptime;
+static struct location_data location_callback_location;
 
 K_SEM_DEFINE(event_handler_called_sem, 0, 1);
 
@@ -139,6 +142,8 @@ void tearDown(void)
 static void location_event_handler(const struct location_event_data *event_data)
 {
 	location_callback_called_occurred = true;
+	location_callback_uptime = k_uptime_get();
+	location_callback_location = event_data->location;
 
 	TEST_ASSERT_EQUAL(test_location_event_data.id, event_data->id);
 	TEST_ASSERT_EQUAL(test_location_event_data.location.latitude,
@@ -736,6 +741,240 @@ void test_location_request_mode_all_cellular_error_gnss_timeout(void)
 	__cmock_nrf_modem_gnss_stop_ExpectAndReturn(0);
 }
 
+/* Test location request with accuracy threshold:
+ * - Cellular location does not meet the threshold so fallback to GNSS is done
+ * - GNSS times out so the cellular location is returned
+ * - Time to first fix is the time of both methods, not the full request timeout
+ */
+void test_location_request_accuracy_threshold_cellular_gnss_timeout(void)
+{
+	int err;
+	int64_t start_uptime;
+	int32_t ttff;
+
+	struct location_config config = { 0 };
+	enum location_method methods[] = {LOCATION_METHOD_CELLULAR, LOCATION_METHOD_GNSS};
+
+	location_config_defaults_set(&config, 2, methods);
+	config.accuracy_threshold = 100;
+	config.methods[0].cellular.cell_count = 2;
+	config.methods[1].gnss.timeout = 100;
+
+	test_location_event_data.id = LOCATION_EVT_LOCATION;
+	test_location_event_data.location.latitude = 61.50375;
+	test_location_event_data.location.longitude = 23.896979;
+	test_location_event_data.location.accuracy = 750.0;
+	test_location_event_data.location.datetime.valid = false;
+
+	location_callback_called_expected = true;
+
+	/***** First cellular positioning *****/
+
+	__cmock_nrf_modem_at_printf_ExpectAndReturn("AT%%NCELLMEAS=1", 0);
+	__cmock_nrf_modem_at_cmd_ExpectAndReturn(NULL, 0, "AT+CGACT?", 0);
+	__cmock_nrf_modem_at_cmd_IgnoreArg_buf();
+	__cmock_nrf_modem_at_cmd_IgnoreArg_len();
+	__cmock_nrf_modem_at_cmd_ReturnArrayThruPtr_buf(
+		(char *)cgact_resp_active, sizeof(cgact_resp_active));
+
+	start_uptime = k_uptime_get();
+	err = location_request(&config);
+	TEST_ASSERT_EQUAL(0, err);
+
+	cellular_rest_req_resp_handle();
+
+	/* Select cellular service to be used */
+	rest_req_ctx.url = "here.api"; /* Needs a fix once rest_req_ctx is verified */
+	rest_req_ctx.sec_tag = CONFIG_LOCATION_SERVICE_HERE_TLS_SEC_TAG;
+	rest_req_ctx.port = HTTPS_PORT;
+	rest_req_ctx.host = CONFIG_LOCATION_SERVICE_HERE_HOSTNAME;
+
+	/***** Then GNSS positioning, because accuracy is not sufficient *****/
+
+	__cmock_nrf_modem_gnss_event_handler_set_ExpectAndReturn(&method_gnss_event_handler, 0);
+	__cmock_nrf_modem_gnss_fix_interval_set_ExpectAndReturn(1, 0);
+	__cmock_nrf_modem_gnss_use_case_set_ExpectAndReturn(
+		NRF_MODEM_GNSS_USE_CASE_MULTIPLE_HOT_START, 0);
+	__cmock_nrf_modem_gnss_start_ExpectAndReturn(0);
+
+	/* TODO: Cannot determine the used system mode but it's set as zero by default in lte_lc */
+	__mock_nrf_modem_at_scanf_ExpectAndReturn(
+		"AT%XSYSTEMMODE?", "%%XSYSTEMMODE: %d,%d,%d,%d", 4);
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(1); /* LTE-M support */
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(1); /* NB-IoT support */
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(1); /* GNSS support */
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(0); /* LTE preference */
+
+	__cmock_nrf_modem_at_cmd_ExpectAndReturn(NULL, 0, "AT%%XMONITOR", 0);
+	__cmock_nrf_modem_at_cmd_IgnoreArg_buf();
+	__cmock_nrf_modem_at_cmd_IgnoreArg_len();
+	__cmock_nrf_modem_at_cmd_ReturnArrayThruPtr_buf(
+		(char *)xmonitor_resp, sizeof(xmonitor_resp));
+
+	__cmock_nrf_modem_gnss_stop_ExpectAndReturn(0);
+
+	/* Wait a bit so that NCELLMEAS is sent before we send response */
+	k_sleep(K_MSEC(100));
+
+	/* Trigger NCELLMEAS response which further triggers the rest of the location calculation */
+	at_monitor_dispatch(ncellmeas_resp);
+	k_sleep(K_MSEC(1));
+
+	at_monitor_dispatch("+CSCON: 0");
+
+	/* Wait for location_event_handler call for 3 seconds.
+	 * If it doesn't happen, next assert will fail the test.
+	 */
+	k_sem_take(&event_handler_called_sem, K_SECONDS(3));
+	TEST_ASSERT_EQUAL(location_callback_called_expected, location_callback_called_occurred);
+
+	/* Method timeouts are short, so the fix must come well before the request timeout */
+	ttff = (int32_t)(location_callback_uptime - start_uptime);
+	TEST_ASSERT_LESS_THAN(1000, ttff);
+
+	/* No further events are expected */
+	location_callback_called_expected = false;
+	location_callback_called_occurred = false;
+}
+
+/* Test location request with accuracy threshold and location fusion:
+ * - Cellular location does not meet the threshold so fallback to GNSS is done
+ * - GNSS location does not meet the threshold either
+ * - Both locations are weighted with the inverse of their variance and the fused location
+ *   is returned
+ */
+void test_location_request_accuracy_fusion_cellular_gnss(void)
+{
+	int err;
+	const double cellular_latitude = 61.50375;
+	const double cellular_longitude = 23.896979;
+	const double cellular_accuracy = 750.0;
+	const double gnss_latitude = 61.005;
+	const double gnss_longitude = 23.5;
+	const double gnss_accuracy = 200.0;
+	const double cellular_weight = 1.0 / (cellular_accuracy * cellular_accuracy);
+	const double gnss_weight = 1.0 / (gnss_accuracy * gnss_accuracy);
+	const double weight_sum = cellular_weight + gnss_weight;
+
+	struct location_config config = { 0 };
+	enum location_method methods[] = {LOCATION_METHOD_CELLULAR, LOCATION_METHOD_GNSS};
+
+	location_config_defaults_set(&config, 2, methods);
+	config.accuracy_threshold = 100;
+	config.accuracy_fusion = true;
+	config.methods[0].cellular.cell_count = 2;
+
+	test_location_event_data.id = LOCATION_EVT_LOCATION;
+	test_location_event_data.location.latitude = cellular_latitude;
+	test_location_event_data.location.longitude = cellular_longitude;
+	test_location_event_data.location.accuracy = cellular_accuracy;
+	test_location_event_data.location.datetime.valid = false;
+
+	location_callback_called_expected = true;
+
+	/***** First cellular positioning *****/
+
+	__cmock_nrf_modem_at_printf_ExpectAndReturn("AT%%NCELLMEAS=1", 0);
+	__cmock_nrf_modem_at_cmd_ExpectAndReturn(NULL, 0, "AT+CGACT?", 0);
+	__cmock_nrf_modem_at_cmd_IgnoreArg_buf();
+	__cmock_nrf_modem_at_cmd_IgnoreArg_len();
+	__cmock_nrf_modem_at_cmd_ReturnArrayThruPtr_buf(
+		(char *)cgact_resp_active, sizeof(cgact_resp_active));
+
+	err = location_request(&config);
+	TEST_ASSERT_EQUAL(0, err);
+
+	cellular_rest_req_resp_handle();
+
+	/* Select cellular service to be used */
+	rest_req_ctx.url = "here.api"; /* Needs a fix once rest_req_ctx is verified */
+	rest_req_ctx.sec_tag = CONFIG_LOCATION_SERVICE_HERE_TLS_SEC_TAG;
+	rest_req_ctx.port = HTTPS_PORT;
+	rest_req_ctx.host = CONFIG_LOCATION_SERVICE_HERE_HOSTNAME;
+
+	/***** Then GNSS positioning, because accuracy is not sufficient *****/
+
+	__cmock_nrf_modem_gnss_event_handler_set_ExpectAndReturn(&method_gnss_event_handler, 0);
+	__cmock_nrf_modem_gnss_fix_interval_set_ExpectAndReturn(1, 0);
+	__cmock_nrf_modem_gnss_use_case_set_ExpectAndReturn(
+		NRF_MODEM_GNSS_USE_CASE_MULTIPLE_HOT_START, 0);
+	__cmock_nrf_modem_gnss_start_ExpectAndReturn(0);
+
+	/* TODO: Cannot determine the used system mode but it's set as zero by default in lte_lc */
+	__mock_nrf_modem_at_scanf_ExpectAndReturn(
+		"AT%XSYSTEMMODE?", "%%XSYSTEMMODE: %d,%d,%d,%d", 4);
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(1); /* LTE-M support */
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(1); /* NB-IoT support */
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(1); /* GNSS support */
+	__mock_nrf_modem_at_scanf_ReturnVarg_int(0); /* LTE preference */
+
+	__cmock_nrf_modem_at_cmd_ExpectAndReturn(NULL, 0, "AT%%XMONITOR", 0);
+	__cmock_nrf_modem_at_cmd_IgnoreArg_buf();
+	__cmock_nrf_modem_at_cmd_IgnoreArg_len();
+	__cmock_nrf_modem_at_cmd_ReturnArrayThruPtr_buf(
+		(char *)xmonitor_resp, sizeof(xmonitor_resp));
+
+	/* Wait a bit so that NCELLMEAS is sent before we send response */
+	k_sleep(K_MSEC(100));
+
+	/* Trigger NCELLMEAS response which further triggers the rest of the location calculation */
+	at_monitor_dispatch(ncellmeas_resp);
+	k_sleep(K_MSEC(1));
+
+	at_monitor_dispatch("+CSCON: 0");
+	k_sleep(K_MSEC(1));
+
+	/* The fused location has the date and time of the most accurate location */
+	test_location_event_data.location.latitude =
+		(cellular_weight * cellular_latitude + gnss_weight * gnss_latitude) / weight_sum;
+	test_location_event_data.location.longitude =
+		cellular_longitude + gnss_weight * (gnss_longitude - cellular_longitude) / weight_sum;
+	test_location_event_data.location.accuracy = 1.0 / sqrt(weight_sum);
+	test_location_event_data.location.datetime.valid = true;
+	test_location_event_data.location.datetime.year = 2021;
+	test_location_event_data.location.datetime.month = 8;
+	test_location_event_data.location.datetime.day = 13;
+	test_location_event_data.location.datetime.hour = 12;
+	test_location_event_data.location.datetime.minute = 34;
+	test_location_event_data.location.datetime.second = 56;
+	test_location_event_data.location.datetime.ms = 789;
+
+	test_pvt_data.flags = NRF_MODEM_GNSS_PVT_FLAG_FIX_VALID;
+	test_pvt_data.latitude = gnss_latitude;
+	test_pvt_data.longitude = gnss_longitude;
+	test_pvt_data.accuracy = gnss_accuracy;
+	test_pvt_data.datetime.year = 2021;
+	test_pvt_data.datetime.month = 8;
+	test_pvt_data.datetime.day = 13;
+	test_pvt_data.datetime.hour = 12;
+	test_pvt_data.datetime.minute = 34;
+	test_pvt_data.datetime.seconds = 56;
+	test_pvt_data.datetime.ms = 789;
+
+	__cmock_nrf_modem_gnss_read_ExpectAndReturn(
+		NULL, sizeof(test_pvt_data), NRF_MODEM_GNSS_DATA_PVT, 0);
+	__cmock_nrf_modem_gnss_read_IgnoreArg_buf();
+	__cmock_nrf_modem_gnss_read_ReturnMemThruPtr_buf(&test_pvt_data, sizeof(test_pvt_data));
+	__cmock_nrf_modem_gnss_stop_ExpectAndReturn(0);
+	method_gnss_event_handler(NRF_MODEM_GNSS_EVT_PVT);
+
+	k_sem_take(&event_handler_called_sem, K_SECONDS(3));
+	TEST_ASSERT_EQUAL(location_callback_called_expected, location_callback_called_occurred);
+
+	/* The fused location is more accurate than any of the locations */
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, test_location_event_data.location.latitude,
+				 location_callback_location.latitude);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, test_location_event_data.location.longitude,
+				 location_callback_location.longitude);
+	TEST_ASSERT_FLOAT_WITHIN(0.1, test_location_event_data.location.accuracy,
+				 location_callback_location.accuracy);
+	TEST_ASSERT_TRUE(location_callback_location.accuracy < gnss_accuracy);
+
+	/* No further events are expected */
+	location_callback_called_expected = false;
+	location_callback_called_occurred = false;
+}
+
 /********* TESTS PERIODIC POSITIONING REQUESTS ***********************/
 
 /* Test periodic location request and cancel it once some iterations are done. */
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <unity.h>
+#include <zephyr/kernel.h>
+#include <zephyr/fff.h>
+#include <modem/nrf_modem_lib.h>
+#include <modem/trace_backend.h>
+
+#include "nrf_modem_lib_trace.h"
+#include "trace_compress.h"
+
+#include "cmock_trace_backend_mock.h"
+#include "cmock_nrf_modem.h"
+#include "cmock_nrf_modem_trace.h"
+#include "cmock_nrf_modem_os.h"
+
+DEFINE_FFF_GLOBALS;
+
+FAKE_VALUE_FUNC_VARARG(int, nrf_modem_at_printf, const char *, ...);
+
+/* It is required to be added to each test. That is because unity's
+ * main may return nonzero, while zephyr's main currently must
+ * return 0 in all cases (other values are reserved).
+ */
+extern int unity_main(void);
+
+extern void nrf_modem_lib_trace_init(void);
+
+#define FRAG_LEN 300
+#define FRAG_COUNT 2
+#define PROCESSED_TIMEOUT_MS 1000
+
+static uint8_t frag_data[FRAG_COUNT][FRAG_LEN];
+static struct nrf_modem_trace_data frags[FRAG_COUNT];
+
+static uint8_t stream[FRAG_COUNT * TRACE_COMPRESS_FRAME_MAX_LEN];
+static size_t stream_len;
+static uint8_t decoded[FRAG_COUNT * FRAG_LEN];
+
+static trace_backend_processed_cb backend_processed_cb;
+
+static size_t processed_lens[FRAG_COUNT];
+static atomic_t processed_count;
+
+static volatile bool frags_ready;
+static volatile int nrf_modem_trace_get_error;
+static volatile int trace_backend_write_error;
+/* Number of bytes the backend takes before it runs out of space, 0 if it has space. */
+static volatile size_t trace_backend_write_space;
+
+K_SEM_DEFINE(backend_deinit_sem, 0, 1);
+
+static int callback_evt;
+
+/* This is the override for the _weak callback. */
+void nrf_modem_lib_trace_callback(enum nrf_modem_lib_trace_event evt)
+{
+	callback_evt = evt;
+}
+
+void setUp(void)
+{
+	frags_ready = false;
+	nrf_modem_trace_get_error = 0;
+	trace_backend_write_error = 0;
+	trace_backend_write_space = 0;
+	stream_len = 0;
+	atomic_clear(&processed_count);
+	callback_evt = 0;
+
+	/* Fragments shaped like modem traces, so that they compress. */
+	for (size_t i = 0; i < FRAG_COUNT; i++) {
+		for (size_t j = 0; j < FRAG_LEN; j++) {
+			frag_data[i][j] = (j % 16 < 4) ? 0xef : (uint8_t)(i + j / 16);
+		}
+
+		frags[i].data = frag_data[i];
+		frags[i].len = FRAG_LEN;
+	}
+}
+
+static int trace_backend_init_stub(trace_backend_processed_cb trace_processed_cb,
+				   int cmock_num_calls)
+{
+	backend_processed_cb = trace_processed_cb;
+
+	return 0;
+}
+
+static int trace_backend_deinit_stub(int cmock_num_calls)
+{
+	k_sem_give(&backend_deinit_sem);
+
+	return 0;
+}
+
+static int nrf_modem_trace_get_stub(struct nrf_modem_trace_data **frags_out, size_t *n_frags,
+				    int timeout, int cmock_num_calls)
+{
+	/* Block until we receive new data or `nrf_modem_trace_get` error. */
+	while (!frags_ready) {
+		if (nrf_modem_trace_get_error) {
+			return nrf_modem_trace_get_error;
+		}
+		k_sleep(K_MSEC(1));
+	}
+
+	frags_ready = false;
+
+	*frags_out = frags;
+	*n_frags = FRAG_COUNT;
+
+	return 0;
+}
+
+static int nrf_modem_trace_processed_stub(size_t len, int cmock_num_calls)
+{
+	TEST_ASSERT_LESS_THAN(FRAG_COUNT, cmock_num_calls);
+
+	processed_lens[cmock_num_calls] = len;
+	atomic_inc(&processed_count);
+
+	return 0;
+}
+
+/* Store the written data like a backend does, and report the progress. */
+static int trace_backend_write_stub(const void *data, size_t len, int cmock_num_calls)
+{
+	if (trace_backend_write_error) {
+		return trace_backend_write_error;
+	}
+
+	if (trace_backend_write_space) {
+		len = MIN(len, trace_backend_write_space);
+		trace_backend_write_space -= len;
+		if (!trace_backend_write_space) {
+			trace_backend_write_error = -ENOSPC;
+		}
+	}
+
+	TEST_ASSERT_LESS_OR_EQUAL(sizeof(stream), stream_len + len);
+	memcpy(&stream[stream_len], data, len);
+	stream_len += len;
+
+	/* Progress on compressed frames must not be forwarded to the modem library. */
+	backend_processed_cb(len);
+
+	return (int)len;
+}
+
+static void trace_start(void)
+{
+	__cmock_trace_backend_init_Stub(trace_backend_init_stub);
+	__cmock_nrf_modem_trace_get_Stub(nrf_modem_trace_get_stub);
+	__cmock_nrf_modem_trace_processed_Stub(nrf_modem_trace_processed_stub);
+	__cmock_trace_backend_write_Stub(trace_backend_write_stub);
+	__cmock_trace_backend_deinit_Stub(trace_backend_deinit_stub);
+
+	nrf_modem_lib_trace_init();
+}
+
+static void trace_stop(void)
+{
+	nrf_modem_trace_get_error = -ESHUTDOWN;
+
+	k_sem_take(&backend_deinit_sem, K_FOREVER);
+}
+
+static void processed_wait(void)
+{
+	for (int i = 0; i < PROCESSED_TIMEOUT_MS; i++) {
+		if (atomic_get(&processed_count) == FRAG_COUNT) {
+			break;
+		}
+		k_sleep(K_MSEC(1));
+	}
+
+	TEST_ASSERT_EQUAL(FRAG_COUNT, atomic_get(&processed_count));
+
+	for (size_t i = 0; i < FRAG_COUNT; i++) {
+		TEST_ASSERT_EQUAL_size_t(FRAG_LEN, processed_lens[i]);
+	}
+}
+
+/* The stream must hold every fragment exactly once. */
+static void stream_verify(void)
+{
+	size_t in = 0;
+	size_t out = 0;
+
+	while (in < stream_len) {
+		size_t consumed;
+		int ret = trace_compress_frame_decode(&stream[in], stream_len - in, &decoded[out],
+						      sizeof(decoded) - out, &consumed);
+
+		TEST_ASSERT_GREATER_THAN(0, ret);
+		in += consumed;
+		out += ret;
+	}
+
+	TEST_ASSERT_EQUAL_size_t(sizeof(decoded), out);
+	for (size_t i = 0; i < FRAG_COUNT; i++) {
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(frag_data[i], &decoded[i * FRAG_LEN], FRAG_LEN);
+	}
+}
+
+/* Test that fragments are released to the modem library once they are compressed, and
+ * that the backend progress on compressed frames is not forwarded.
+ */
+void test_trace_compression_processed(void)
+{
+	trace_start();
+
+	frags_ready = true;
+	processed_wait();
+
+	trace_stop();
+
+	stream_verify();
+	TEST_ASSERT_TRUE(stream_len < sizeof(decoded));
+}
+
+/* Test that a frame partially written before the backend runs out of space is resumed
+ * where it stopped, and the fragment is not compressed again.
+ */
+void test_trace_compression_enospc_partial(void)
+{
+	int ret;
+
+	trace_start();
+
+	trace_backend_write_space = 16;
+	frags_ready = true;
+
+	ret = nrf_modem_lib_trace_processing_done_wait(K_FOREVER);
+	TEST_ASSERT_EQUAL(-ENOSPC, ret);
+	TEST_ASSERT_EQUAL(NRF_MODEM_LIB_TRACE_EVT_FULL, callback_evt);
+	TEST_ASSERT_EQUAL_size_t(16, stream_len);
+
+	/* Clear space and let the trace thread retry. */
+	trace_backend_write_error = 0;
+
+	__cmock_trace_backend_clear_ExpectAndReturn(0);
+	ret = nrf_modem_lib_trace_clear();
+	TEST_ASSERT_EQUAL(0, ret);
+
+	processed_wait();
+
+	trace_stop();
+
+	stream_verify();
+}
+
+int main(void)
+{
+	(void)unity_main();
+
+	return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <unity.h>
+#include <zephyr/kernel.h>
+
+#include "trace_backend.h"
+#include "trace_compress.h"
+
+extern struct nrf_modem_lib_trace_backend trace_backend;
+
+#define BACKEND_RAM_LENGTH CONFIG_NRF_MODEM_LIB_TRACE_BACKEND_RAM_LENGTH
+
+static uint8_t read_buf[BACKEND_RAM_LENGTH];
+static size_t processed_len;
+
+static int callback(size_t len)
+{
+	processed_len += len;
+
+	return 0;
+}
+
+/* It is required to be added to each test. That is because unity's
+ * main may return nonzero, while zephyr's main currently must
+ * return 0 in all cases (other values are reserved).
+ */
+extern int unity_main(void);
+
+void setUp(void)
+{
+	processed_len = 0;
+
+	TEST_ASSERT_EQUAL(0, trace_backend.init(callback));
+	TEST_ASSERT_EQUAL(0, trace_backend.clear());
+}
+
+static void data_fill(uint8_t *data, size_t len, uint32_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+}
+
+static void data_write(const uint8_t *data, size_t len)
+{
+	size_t processed_start = processed_len;
+
+	TEST_ASSERT_EQUAL(len, trace_backend.write(data, len));
+	TEST_ASSERT_EQUAL(len, processed_len - processed_start);
+}
+
+#define FRAME_RAW_LEN CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE
+#define FRAME_COUNT 8
+
+static struct trace_compress ctx;
+static uint8_t raw[FRAME_RAW_LEN];
+static uint8_t decoded[FRAME_RAW_LEN];
+
+/* Compress and write a frame of data generated from the seed. */
+static size_t frame_write(uint32_t seed)
+{
+	const uint8_t *frame;
+	size_t len;
+
+	data_fill(raw, sizeof(raw), seed);
+
+	TEST_ASSERT_EQUAL(sizeof(raw), trace_compress_feed(&ctx, raw, sizeof(raw)));
+	trace_compress_flush(&ctx);
+
+	frame = trace_compress_frame_get(&ctx, &len);
+	TEST_ASSERT_NOT_NULL(frame);
+
+	data_write(frame, len);
+	trace_compress_frame_release(&ctx);
+
+	return len;
+}
+
+/* Test that whole frames are dropped when the buffer is full, so that the buffer always
+ * starts at a frame boundary.
+ */
+void test_trace_backend_ram_oldest_drop_frames(void)
+{
+	size_t frame_lens[FRAME_COUNT];
+	size_t kept_len = 0;
+	size_t first_kept = FRAME_COUNT;
+	size_t data_size;
+	size_t offset = 0;
+
+	trace_compress_init(&ctx);
+
+	for (size_t i = 0; i < FRAME_COUNT; i++) {
+		frame_lens[i] = frame_write(i + 1);
+	}
+
+	/* The newest frames that fit into the buffer are kept. */
+	while (first_kept > 0 && kept_len + frame_lens[first_kept - 1] <= BACKEND_RAM_LENGTH) {
+		first_kept--;
+		kept_len += frame_lens[first_kept];
+	}
+	TEST_ASSERT_TRUE(first_kept > 0);
+
+	data_size = trace_backend.data_size();
+	TEST_ASSERT_EQUAL(kept_len, data_size);
+	TEST_ASSERT_EQUAL(data_size, trace_backend.read(read_buf, sizeof(read_buf)));
+
+	for (size_t i = first_kept; i < FRAME_COUNT; i++) {
+		size_t consumed;
+		int ret;
+
+		ret = trace_compress_frame_decode(&read_buf[offset], data_size - offset, decoded,
+						  sizeof(decoded), &consumed);
+		TEST_ASSERT_EQUAL(FRAME_RAW_LEN, ret);
+		TEST_ASSERT_EQUAL(frame_lens[i], consumed);
+
+		data_fill(raw, sizeof(raw), i + 1);
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, decoded, sizeof(raw));
+
+		offset += consumed;
+	}
+}
+
+/* Test that data which does not start with a frame, for example kept over a reset with
+ * another configuration, is dropped when the buffer is full.
+ */
+void test_trace_backend_ram_oldest_drop_not_a_frame(void)
+{
+	static uint8_t old_data[BACKEND_RAM_LENGTH - 1];
+	size_t frame_len;
+
+	memset(old_data, 0, sizeof(old_data));
+	data_write(old_data, sizeof(old_data));
+
+	trace_compress_init(&ctx);
+	frame_len = frame_write(1);
+
+	TEST_ASSERT_EQUAL(frame_len, trace_backend.data_size());
+	TEST_ASSERT_EQUAL(frame_len, trace_backend.read(read_buf, sizeof(read_buf)));
+	TEST_ASSERT_EQUAL(frame_len, trace_compress_frame_len(read_buf));
+}
+
+/* Test that after a read that stops inside a frame, only the rest of that frame is
+ * dropped when the buffer is full, and the complete frames after it are kept.
+ */
+void test_trace_backend_ram_oldest_drop_partial_read(void)
+{
+	size_t frame_lens[FRAME_COUNT];
+	size_t written = 0;
+	size_t count = 0;
+	size_t part_len;
+	size_t data_size;
+	size_t consumed;
+
+	trace_compress_init(&ctx);
+
+	/* Fill the buffer with whole frames. */
+	do {
+		frame_lens[count] = frame_write(count + 1);
+		written += frame_lens[count];
+		count++;
+	} while (written + FRAME_RAW_LEN + TRACE_COMPRESS_HDR_LEN <= BACKEND_RAM_LENGTH &&
+		 count < FRAME_COUNT - 1);
+	TEST_ASSERT_TRUE(count > 2);
+
+	/* Read the first frame and a part of the second one, including a part of its
+	 * header.
+	 */
+	part_len = frame_lens[0] + TRACE_COMPRESS_HDR_LEN / 2;
+	TEST_ASSERT_EQUAL(part_len, trace_backend.read(read_buf, part_len));
+
+	/* Writing a frame that does not fit drops the rest of the second frame only. */
+	while (trace_backend.data_size() + frame_lens[0] <= BACKEND_RAM_LENGTH) {
+		frame_lens[count] = frame_write(count + 1);
+		count++;
+		TEST_ASSERT_TRUE(count < FRAME_COUNT);
+	}
+	frame_lens[count] = frame_write(count + 1);
+	count++;
+
+	data_size = trace_backend.data_size();
+	TEST_ASSERT_EQUAL(data_size, trace_backend.read(read_buf, sizeof(read_buf)));
+
+	/* The buffer starts at the third frame, and every frame can be decoded. */
+	for (size_t i = 2, offset = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL(FRAME_RAW_LEN,
+				  trace_compress_frame_decode(&read_buf[offset], data_size - offset,
+							      decoded, sizeof(decoded), &consumed));
+		TEST_ASSERT_EQUAL(frame_lens[i], consumed);
+
+		data_fill(raw, sizeof(raw), i + 1);
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, decoded, sizeof(raw));
+
+		offset += consumed;
+	}
+}
+
+int main(void)
+{
+	(void)unity_main();
+
+	return 0;
+}
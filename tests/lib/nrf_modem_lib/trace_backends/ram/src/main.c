@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <unity.h>
+#include <zephyr/kernel.h>
+
+#include "trace_backend.h"
+
+extern struct nrf_modem_lib_trace_backend trace_backend;
+
+#define BACKEND_RAM_LENGTH CONFIG_NRF_MODEM_LIB_TRACE_BACKEND_RAM_LENGTH
+
+static uint8_t read_buf[BACKEND_RAM_LENGTH];
+static size_t processed_len;
+
+static int callback(size_t len)
+{
+	processed_len += len;
+
+	return 0;
+}
+
+/* It is required to be added to each test. That is because unity's
+ * main may return nonzero, while zephyr's main currently must
+ * return 0 in all cases (other values are reserved).
+ */
+extern int unity_main(void);
+
+void setUp(void)
+{
+	processed_len = 0;
+
+	TEST_ASSERT_EQUAL(0, trace_backend.init(callback));
+	TEST_ASSERT_EQUAL(0, trace_backend.clear());
+}
+
+static void data_fill(uint8_t *data, size_t len, uint32_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+}
+
+static void data_write(const uint8_t *data, size_t len)
+{
+	size_t processed_start = processed_len;
+
+	TEST_ASSERT_EQUAL(len, trace_backend.write(data, len));
+	TEST_ASSERT_EQUAL(len, processed_len - processed_start);
+}
+
+void test_trace_backend_write_ram(void)
+{
+	uint8_t data[100];
+
+	data_fill(data, sizeof(data), 1);
+	data_write(data, sizeof(data));
+
+	TEST_ASSERT_EQUAL(sizeof(data), trace_backend.data_size());
+	TEST_ASSERT_EQUAL(sizeof(data), trace_backend.read(read_buf, sizeof(read_buf)));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, read_buf, sizeof(data));
+	TEST_ASSERT_EQUAL(0, trace_backend.data_size());
+}
+
+/* Test that only as much of the oldest data as needed is dropped when the buffer is full. */
+void test_trace_backend_ram_oldest_drop(void)
+{
+	static uint8_t old_data[BACKEND_RAM_LENGTH];
+	uint8_t new_data[100];
+
+	data_fill(old_data, sizeof(old_data), 1);
+	data_fill(new_data, sizeof(new_data), 2);
+
+	data_write(old_data, sizeof(old_data));
+	data_write(new_data, sizeof(new_data));
+
+	TEST_ASSERT_EQUAL(BACKEND_RAM_LENGTH, trace_backend.data_size());
+	TEST_ASSERT_EQUAL(BACKEND_RAM_LENGTH, trace_backend.read(read_buf, sizeof(read_buf)));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(&old_data[sizeof(new_data)], read_buf,
+				      sizeof(old_data) - sizeof(new_data));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(new_data, &read_buf[sizeof(old_data) - sizeof(new_data)],
+				      sizeof(new_data));
+}
+
+int main(void)
+{
+	(void)unity_main();
+
+	return 0;
+}
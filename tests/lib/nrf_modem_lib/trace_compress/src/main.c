@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/crc.h>
+
+#include "trace_compress.h"
+
+#define BLOB_SIZE 8192
+#define THROUGHPUT_ROUNDS 8
+
+static struct trace_compress ctx;
+
+static uint8_t blob[BLOB_SIZE];
+static uint8_t stream[BLOB_SIZE + (BLOB_SIZE / 64) * TRACE_COMPRESS_HDR_LEN];
+static uint8_t decoded[BLOB_SIZE + CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE];
+
+static uint32_t rand_state;
+
+static uint32_t rand_next(void)
+{
+	rand_state = rand_state * 1103515245 + 12345;
+
+	return rand_state >> 16;
+}
+
+/* Fill the blob with records shaped like a modem trace capture: a short header with
+ * a trace ID from a small set, a running timestamp and a payload from a few templates.
+ */
+static void blob_trace_fill(void)
+{
+	static const uint8_t templates[][16] = {
+		{ 0x01, 0x00, 0x00, 0x00, 0x4c, 0x54, 0x45, 0x20, 0x52, 0x52, 0x43 },
+		{ 0x02, 0x10, 0x20, 0x30, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff },
+		{ 0x03, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+	};
+	uint32_t timestamp = 0;
+	size_t len = 0;
+
+	rand_state = 1;
+
+	while (len < sizeof(blob)) {
+		uint32_t r = rand_next();
+		uint8_t rec[8 + sizeof(templates[0])] = {
+			0xef, 0xbe, 0x00, 0x10 + (r & 0x7), timestamp & 0xff,
+			(timestamp >> 8) & 0xff, (timestamp >> 16) & 0xff, (r >> 4) & 0x3,
+		};
+		size_t rec_len = 8 + 8 + ((r >> 6) & 0x7);
+
+		memcpy(&rec[8], templates[(r >> 9) % ARRAY_SIZE(templates)], sizeof(templates[0]));
+		rec[9] = r >> 12;
+
+		rec_len = MIN(rec_len, sizeof(blob) - len);
+		memcpy(&blob[len], rec, rec_len);
+		len += rec_len;
+
+		timestamp += 1 + (r & 0x3f);
+	}
+}
+
+static void blob_random_fill(void)
+{
+	rand_state = 1;
+
+	for (size_t i = 0; i < sizeof(blob); i++) {
+		blob[i] = rand_next();
+	}
+}
+
+static size_t frame_take(uint8_t *out)
+{
+	size_t len;
+	const uint8_t *frame = trace_compress_frame_get(&ctx, &len);
+
+	if (!frame) {
+		return 0;
+	}
+
+	memcpy(out, frame, len);
+	trace_compress_frame_release(&ctx);
+
+	return len;
+}
+
+/* Compress the blob, fed in fragments of varying size like the modem does. */
+static size_t blob_compress(void)
+{
+	size_t in = 0;
+	size_t out = 0;
+
+	trace_compress_init(&ctx);
+
+	while (in < sizeof(blob)) {
+		size_t frag_len = MIN(1 + (in * 7) % 700, sizeof(blob) - in);
+
+		while (frag_len) {
+			size_t fed;
+
+			out += frame_take(&stream[out]);
+
+			fed = trace_compress_feed(&ctx, &blob[in], frag_len);
+			in += fed;
+			frag_len -= fed;
+		}
+	}
+
+	out += frame_take(&stream[out]);
+	trace_compress_flush(&ctx);
+	out += frame_take(&stream[out]);
+
+	zassert_true(out <= sizeof(stream), "Stream overflow");
+
+	return out;
+}
+
+static size_t stream_decode(const uint8_t *data, size_t len)
+{
+	size_t in = 0;
+	size_t out = 0;
+
+	while (true) {
+		size_t consumed;
+		int ret = trace_compress_frame_decode(&data[in], len - in, &decoded[out],
+						      sizeof(decoded) - out, &consumed);
+
+		in += consumed;
+		if (ret == -ENODATA) {
+			break;
+		}
+
+		zassert_true(ret > 0, "Decoding failed: %d", ret);
+		out += ret;
+	}
+
+	zassert_true(len - in < TRACE_COMPRESS_HDR_LEN, "Data left in the stream");
+
+	return out;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(stream, 0, sizeof(stream));
+	memset(decoded, 0, sizeof(decoded));
+}
+
+ZTEST(trace_compress, test_round_trip)
+{
+	size_t len;
+
+	blob_trace_fill();
+	len = blob_compress();
+
+	zassert_equal(stream_decode(stream, len), sizeof(blob), "Invalid decoded length");
+	zassert_mem_equal(decoded, blob, sizeof(blob), "Decoded data differs");
+
+	zassert_equal(ctx.stats.bytes_in, sizeof(blob), "Invalid input statistics");
+	zassert_equal(ctx.stats.bytes_out, len, "Invalid output statistics");
+	zassert_equal(ctx.stats.frames,
+		      DIV_ROUND_UP(sizeof(blob), CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE),
+		      "Invalid frame count");
+
+	TC_PRINT("Trace blob: %zu -> %zu bytes (%zu%%)\n", sizeof(blob), len,
+		 len * 100 / sizeof(blob));
+	zassert_true(len < sizeof(blob) * 3 / 4, "Trace data did not compress");
+}
+
+ZTEST(trace_compress, test_incompressible)
+{
+	size_t len;
+
+	blob_random_fill();
+	len = blob_compress();
+
+	zassert_equal(ctx.stats.frames_stored, ctx.stats.frames, "Random data compressed");
+	zassert_equal(len, sizeof(blob) + ctx.stats.frames * TRACE_COMPRESS_HDR_LEN,
+		      "Stored frames expanded more than their headers");
+
+	zassert_equal(stream_decode(stream, len), sizeof(blob), "Invalid decoded length");
+	zassert_mem_equal(decoded, blob, sizeof(blob), "Decoded data differs");
+}
+
+ZTEST(trace_compress, test_partial_frame)
+{
+	static const uint8_t data[] = "Short trace";
+	size_t len;
+
+	trace_compress_init(&ctx);
+	zassert_equal(trace_compress_feed(&ctx, data, sizeof(data)), sizeof(data),
+		      "Data not consumed");
+	zassert_is_null(trace_compress_frame_get(&ctx, &len), "Frame closed before flush");
+
+	trace_compress_flush(&ctx);
+	zassert_not_null(trace_compress_frame_get(&ctx, &len), "Frame not closed by flush");
+
+	/* No data is accepted until the closed frame is released. */
+	zassert_equal(trace_compress_feed(&ctx, data, sizeof(data)), 0, "Data consumed");
+
+	len = frame_take(stream);
+	zassert_equal(stream_decode(stream, len), sizeof(data), "Invalid decoded length");
+	zassert_mem_equal(decoded, data, sizeof(data), "Decoded data differs");
+}
+
+ZTEST(trace_compress, test_resync_after_overwrite)
+{
+	size_t len;
+	size_t first_len;
+	size_t decoded_len;
+
+	blob_trace_fill();
+	len = blob_compress();
+	first_len = trace_compress_frame_len(stream);
+
+	/* A backend overwriting the oldest data cuts the first frame. Decoding resumes at
+	 * the second frame.
+	 */
+	decoded_len = stream_decode(&stream[first_len / 2], len - first_len / 2);
+
+	zassert_equal(decoded_len,
+		      sizeof(blob) - CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE,
+		      "Invalid decoded length");
+	zassert_mem_equal(decoded, &blob[CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE],
+			  decoded_len, "Decoded data differs");
+}
+
+ZTEST(trace_compress, test_corrupted_frame)
+{
+	size_t len;
+	size_t first_len;
+	size_t consumed;
+	int ret;
+
+	blob_trace_fill();
+	len = blob_compress();
+	first_len = trace_compress_frame_len(stream);
+
+	/* A corrupted payload fails the CRC, the frame is skipped. */
+	stream[TRACE_COMPRESS_HDR_LEN + 1] ^= 0xff;
+
+	ret = trace_compress_frame_decode(stream, len, decoded, sizeof(decoded), &consumed);
+	zassert_equal(ret, CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE,
+		      "Second frame not decoded");
+	zassert_equal(consumed, first_len + trace_compress_frame_len(&stream[first_len]),
+		      "Invalid consumed length");
+	zassert_mem_equal(decoded, &blob[CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE],
+			  ret, "Decoded data differs");
+
+	/* An incomplete frame is kept until more data is available. */
+	ret = trace_compress_frame_decode(&stream[first_len],
+					  trace_compress_frame_len(&stream[first_len]) - 1, decoded,
+					  sizeof(decoded), &consumed);
+	zassert_equal(ret, -ENODATA, "Incomplete frame decoded");
+	zassert_equal(consumed, 0, "Incomplete frame consumed");
+}
+
+ZTEST(trace_compress, test_frame_len_oversized)
+{
+	uint8_t hdr[TRACE_COMPRESS_HDR_LEN];
+	size_t raw_len = CONFIG_NRF_MODEM_LIB_TRACE_COMPRESSION_FRAME_SIZE + 1;
+
+	blob_trace_fill();
+	blob_compress();
+	memcpy(hdr, stream, sizeof(hdr));
+	zassert_not_equal(trace_compress_frame_len(hdr), 0, "Valid header rejected");
+
+	/* A header with a valid CRC cannot claim more data than a frame holds, or a
+	 * backend would skip data beyond the frame.
+	 */
+	hdr[4] = raw_len & 0xff;
+	hdr[5] = raw_len >> 8;
+	hdr[9] = crc8_ccitt(0xFF, hdr, TRACE_COMPRESS_HDR_LEN - 1);
+	zassert_equal(trace_compress_frame_len(hdr), 0, "Oversized frame accepted");
+}
+
+ZTEST(trace_compress, test_throughput)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint64_t ns;
+	size_t len = 0;
+
+	blob_trace_fill();
+
+	start = k_cycle_get_32();
+	for (size_t i = 0; i < THROUGHPUT_ROUNDS; i++) {
+		len = blob_compress();
+	}
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(stream_decode(stream, len), sizeof(blob), "Invalid decoded length");
+
+	ns = k_cyc_to_ns_floor64(cycles);
+	if (ns == 0) {
+		TC_PRINT("Compression throughput: not measurable on this platform\n");
+		return;
+	}
+
+	TC_PRINT("Compression throughput: %u kB/s\n",
+		 (uint32_t)((uint64_t)sizeof(blob) * THROUGHPUT_ROUNDS * 1000000 / ns));
+}
+
+ZTEST_SUITE(trace_compress, NULL, NULL, before, NULL, NULL);
@@ -13,7 +13,8 @@
 #include "audio_module_test_common.h"
 
 K_THREAD_STACK_DEFINE(mod_stack, TEST_MOD_THREAD_STACK_SIZE);
-K_MEM_SLAB_DEFINE(data_slab, TEST_MOD_DATA_SIZE, FAKE_FIFO_MSG_QUEUE_SIZE, 4);
+K_MEM_SLAB_DEFINE(data_slab, AUDIO_MODULE_DATA_BLOCK_SIZE(TEST_MOD_DATA_SIZE), FAKE_FIFO_MSG_QUEUE_SIZE,
+		  4);
 
 static const char *test_base_name = "Test base name";
 
@@ -1015,6 +1016,7 @@ ZTEST(suite_audio_module_functional, test_data_rx_fnct)
 	memcpy(&data_msg_tx->audio_data, &audio_data_in, sizeof(struct audio_data));
 	data_msg_tx->tx_handle = NULL;
 	data_msg_tx->response_cb = NULL;
+	data_msg_tx->block = NULL;
 
 	ret = data_fifo_block_lock(handle.thread.msg_tx, (void **)&data_msg_tx,
 				   sizeof(struct audio_module_message));
@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "data_fifo.h"
+#include "audio_module/audio_module.h"
+
+/* The graph under test:
+ *
+ *   application -> decode -> gain -> mix -> application
+ *                        \-> monitor
+ *
+ * Each stage adds its own offset to the samples, the gain and mix stages process in place.
+ */
+#define FRAME_WORDS	(120)
+#define FRAME_SIZE	(FRAME_WORDS * sizeof(uint32_t))
+#define FRAMES_NUM	(500)
+#define PIPELINE_DEPTH	(4)
+#define FIFO_NUM	(2 * PIPELINE_DEPTH)
+#define SLAB_NUM	(2 * PIPELINE_DEPTH)
+#define STACK_SIZE	(1024)
+#define THREAD_PRIORITY (4)
+#define BLOCK_SIZE	AUDIO_MODULE_DATA_BLOCK_SIZE(FRAME_SIZE)
+#define MSG_SIZE	WB_UP(sizeof(struct audio_module_message))
+
+/* Deadline of the frames relative to when they are sent. */
+#define DEADLINE_US	 (USEC_PER_SEC)
+#define LATE_DEADLINE_US (-1000)
+
+#define DECODE_ADD  (1)
+#define GAIN_ADD    (2)
+#define MIX_ADD	    (4)
+#define MONITOR_ADD (0)
+
+struct audio_module_configuration {
+	uint32_t add;
+};
+
+struct audio_module_context {
+	struct audio_module_configuration config;
+
+	uint32_t frames;
+	uint32_t in_place;
+	uint32_t errors;
+
+	/* Flag to hold the audio data in the module until released by the test. */
+	bool hold;
+};
+
+static uint32_t sample(uint32_t seq, uint32_t i)
+{
+	return (seq << 8) | i;
+}
+
+static int config_set(struct audio_module_handle_private *handle,
+		      struct audio_module_configuration const *const configuration)
+{
+	struct audio_module_handle *hdl = (struct audio_module_handle *)handle;
+
+	hdl->context->config = *configuration;
+
+	return 0;
+}
+
+static int config_get(struct audio_module_handle_private const *const handle,
+		      struct audio_module_configuration *configuration)
+{
+	struct audio_module_handle *hdl = (struct audio_module_handle *)handle;
+
+	*configuration = hdl->context->config;
+
+	return 0;
+}
+
+static int stage_process(struct audio_module_handle_private *handle,
+			 struct audio_data const *const audio_data_rx,
+			 struct audio_data *audio_data_tx)
+{
+	struct audio_module_handle *hdl = (struct audio_module_handle *)handle;
+	struct audio_module_context *ctx = hdl->context;
+	const uint32_t *in = audio_data_rx->data;
+	uint32_t *out = audio_data_tx->data;
+
+	if (out == in) {
+		ctx->in_place++;
+	}
+
+	for (size_t i = 0; i < FRAME_WORDS; i++) {
+		out[i] = in[i] + ctx->config.add;
+	}
+
+	audio_data_tx->data_size = audio_data_rx->data_size;
+	audio_data_tx->meta = audio_data_rx->meta;
+	ctx->frames++;
+
+	return 0;
+}
+
+K_SEM_DEFINE(monitor_sem, 0, PIPELINE_DEPTH);
+
+static int monitor_process(struct audio_module_handle_private *handle,
+			   struct audio_data const *const audio_data_rx,
+			   struct audio_data *audio_data_tx)
+{
+	struct audio_module_handle *hdl = (struct audio_module_handle *)handle;
+	struct audio_module_context *ctx = hdl->context;
+	const uint32_t *in = audio_data_rx->data;
+	uint32_t seq = (in[0] - DECODE_ADD) >> 8;
+
+	if (ctx->hold) {
+		k_sem_take(&monitor_sem, K_FOREVER);
+	}
+
+	/* The decoded audio data must not be changed by the in place stages. */
+	for (size_t i = 0; i < FRAME_WORDS; i++) {
+		if (in[i] != sample(seq, i) + DECODE_ADD) {
+			ctx->errors++;
+			break;
+		}
+	}
+
+	ctx->frames++;
+
+	return 0;
+}
+
+static const struct audio_module_functions stage_functions = {
+	.configuration_set = config_set,
+	.configuration_get = config_get,
+	.data_process = stage_process,
+};
+
+static const struct audio_module_functions monitor_functions = {
+	.configuration_set = config_set,
+	.configuration_get = config_get,
+	.data_process = monitor_process,
+};
+
+static struct audio_module_description decode_description = {
+	.name = "Decode", .type = AUDIO_MODULE_TYPE_IN_OUT, .functions = &stage_functions};
+static struct audio_module_description in_place_description = {
+	.name = "In place",
+	.type = AUDIO_MODULE_TYPE_IN_OUT,
+	.functions = &stage_functions,
+	.in_place = true};
+static struct audio_module_description monitor_description = {
+	.name = "Monitor", .type = AUDIO_MODULE_TYPE_OUTPUT, .functions = &monitor_functions};
+
+#define MODULE_DEFINE(_name)                                                                       \
+	K_THREAD_STACK_DEFINE(_name##_stack, STACK_SIZE);                                          \
+	static uint8_t __aligned(4) _name##_slab_buf[SLAB_NUM * BLOCK_SIZE];                       \
+	static struct k_mem_slab _name##_slab;                                                     \
+	DATA_FIFO_DEFINE(_name##_fifo_rx, FIFO_NUM, MSG_SIZE);                                     \
+	DATA_FIFO_DEFINE(_name##_fifo_tx, FIFO_NUM, MSG_SIZE);                                     \
+	static struct audio_module_handle _name;                                                   \
+	static struct audio_module_context _name##_ctx
+
+MODULE_DEFINE(decode);
+MODULE_DEFINE(gain);
+MODULE_DEFINE(mix);
+MODULE_DEFINE(monitor);
+
+static void module_open(struct audio_module_handle *handle, struct audio_module_description *desc,
+			const char *name, struct audio_module_context *ctx, uint32_t add, int priority,
+			k_thread_stack_t *stack, struct k_mem_slab *slab, uint8_t *slab_buf,
+			struct data_fifo *fifo_rx, struct data_fifo *fifo_tx)
+{
+	struct audio_module_configuration config = {.add = add};
+	struct audio_module_parameters parameters = {
+		.description = desc,
+		.thread = {.stack = stack,
+			   .stack_size = STACK_SIZE,
+			   .priority = priority,
+			   .msg_rx = fifo_rx,
+			   .msg_tx = fifo_tx,
+			   .data_slab = slab,
+			   .data_size = FRAME_SIZE}};
+
+	zassert_ok(k_mem_slab_init(slab, slab_buf, BLOCK_SIZE, SLAB_NUM));
+	zassert_ok(data_fifo_init(fifo_rx));
+	zassert_ok(data_fifo_init(fifo_tx));
+	zassert_ok(audio_module_open(&parameters, &config, name, ctx, handle));
+}
+
+#define MODULE_OPEN(_name, _desc, _add, _priority)                                                 \
+	module_open(&_name, _desc, #_name, &_name##_ctx, _add, _priority, _name##_stack,           \
+		    &_name##_slab, _name##_slab_buf, &_name##_fifo_rx, &_name##_fifo_tx)
+
+static uint32_t tx_frames[PIPELINE_DEPTH][FRAME_WORDS];
+static uint32_t rx_frame[FRAME_WORDS];
+static struct audio_metadata rx_meta;
+static int32_t deadline_us;
+
+K_SEM_DEFINE(tx_free, PIPELINE_DEPTH, PIPELINE_DEPTH);
+
+static void tx_done(struct audio_module_handle_private *handle,
+		    struct audio_data const *const audio_data)
+{
+	k_sem_give(&tx_free);
+}
+
+static uint32_t now_us(void)
+{
+	return k_cyc_to_us_floor32(k_cycle_get_32());
+}
+
+static void frame_send(uint32_t seq)
+{
+	uint32_t *frame = tx_frames[seq % PIPELINE_DEPTH];
+	struct audio_data audio_data = {
+		.data = frame,
+		.data_size = FRAME_SIZE,
+	};
+
+	zassert_ok(k_sem_take(&tx_free, K_FOREVER));
+
+	for (size_t i = 0; i < FRAME_WORDS; i++) {
+		frame[i] = sample(seq, i);
+	}
+
+	audio_data.meta.data_rx_ts_us = now_us();
+	audio_data.meta.deadline_us = audio_module_time_us_get() + deadline_us;
+
+	zassert_ok(audio_module_data_tx(&decode, &audio_data, tx_done));
+}
+
+static uint32_t frame_receive(uint32_t seq)
+{
+	struct audio_data audio_data = {
+		.data = rx_frame,
+		.data_size = sizeof(rx_frame),
+	};
+
+	zassert_ok(audio_module_data_rx(&mix, &audio_data, K_MSEC(100)));
+
+	for (uint32_t i = 0; i < FRAME_WORDS; i++) {
+		zassert_equal(rx_frame[i], sample(seq, i) + DECODE_ADD + GAIN_ADD + MIX_ADD,
+			      "Frame %u corrupted at sample %u", seq, i);
+	}
+
+	rx_meta = audio_data.meta;
+
+	return now_us() - audio_data.meta.data_rx_ts_us;
+}
+
+static void stats_print(struct audio_module_handle *handle)
+{
+	struct audio_module_stats stats;
+	uint32_t sum = 0;
+
+	zassert_ok(audio_module_stats_get(handle, &stats));
+
+	TC_PRINT("%s: processed %u, max %u us\n", handle->name, stats.processed, stats.max_us);
+
+	for (size_t i = 0; i < ARRAY_SIZE(stats.histogram); i++) {
+		if (stats.histogram[i]) {
+			TC_PRINT("  < %u us: %u\n", (uint32_t)BIT(i), stats.histogram[i]);
+		}
+
+		sum += stats.histogram[i];
+	}
+
+	zassert_equal(sum, stats.processed);
+	zassert_equal(stats.late, 0);
+	zassert_equal(stats.overruns, 0);
+}
+
+/* A block freed by a wrong address is counted as free, but is then allocated outside of
+ * the buffer, so allocate every block again and check where it lies.
+ */
+static void blocks_check(struct k_mem_slab *slab, const void *buf, size_t block_size,
+			 uint32_t num)
+{
+	const uint8_t *start = buf;
+	void *blocks[MAX(SLAB_NUM, FIFO_NUM)];
+
+	zassert_equal(k_mem_slab_num_used_get(slab), 0);
+
+	for (uint32_t i = 0; i < num; i++) {
+		const uint8_t *block;
+
+		zassert_ok(k_mem_slab_alloc(slab, &blocks[i], K_NO_WAIT));
+
+		block = blocks[i];
+		zassert_true(block >= start && block < start + num * block_size,
+			     "Block %p outside of the buffer", block);
+		zassert_equal((block - start) % block_size, 0, "Block %p misaligned", block);
+	}
+
+	for (uint32_t i = 0; i < num; i++) {
+		k_mem_slab_free(slab, blocks[i]);
+	}
+}
+
+#define SLAB_CHECK(_name)                                                                          \
+	blocks_check(&_name##_slab, _name##_slab_buf, BLOCK_SIZE, SLAB_NUM)
+
+#define FIFO_CHECK(_fifo)                                                                          \
+	blocks_check(&(_fifo).mem_slab, (_fifo).slab_buffer, (_fifo).block_size_max,             \
+		     (_fifo).elements_max)
+
+#define MODULE_CHECK(_name)                                                                        \
+	do {                                                                                       \
+		SLAB_CHECK(_name);                                                                 \
+		FIFO_CHECK(_name##_fifo_rx);                                                       \
+		FIFO_CHECK(_name##_fifo_tx);                                                       \
+	} while (0)
+
+static void slabs_released(void)
+{
+	/* The monitor may still hold the last frames. */
+	k_sleep(K_MSEC(10));
+
+	MODULE_CHECK(decode);
+	MODULE_CHECK(gain);
+	MODULE_CHECK(mix);
+	FIFO_CHECK(monitor_fifo_rx);
+}
+
+static void *setup(void)
+{
+	/* The monitor releases the decoded audio data first, so the gain stage can
+	 * usually process it in place.
+	 */
+	MODULE_OPEN(decode, &decode_description, DECODE_ADD, THREAD_PRIORITY);
+	MODULE_OPEN(gain, &in_place_description, GAIN_ADD, THREAD_PRIORITY);
+	MODULE_OPEN(mix, &in_place_description, MIX_ADD, THREAD_PRIORITY);
+	MODULE_OPEN(monitor, &monitor_description, MONITOR_ADD, THREAD_PRIORITY - 1);
+
+	zassert_ok(audio_module_connect(&decode, &gain, false));
+	zassert_ok(audio_module_connect(&decode, &monitor, false));
+	zassert_ok(audio_module_connect(&gain, &mix, false));
+	zassert_ok(audio_module_connect(&mix, NULL, true));
+
+	zassert_ok(audio_module_start(&monitor));
+	zassert_ok(audio_module_start(&mix));
+	zassert_ok(audio_module_start(&gain));
+	zassert_ok(audio_module_start(&decode));
+
+	return NULL;
+}
+
+static void before(void *f)
+{
+	struct audio_module_handle *handles[] = {&decode, &gain, &mix, &monitor};
+
+	for (size_t i = 0; i < ARRAY_SIZE(handles); i++) {
+		struct audio_module_context *ctx = handles[i]->context;
+
+		ctx->frames = 0;
+		ctx->in_place = 0;
+		ctx->errors = 0;
+		ctx->hold = false;
+
+		zassert_ok(audio_module_stats_reset(handles[i]));
+	}
+
+	in_place_description.drop_late = false;
+	deadline_us = DEADLINE_US;
+}
+
+ZTEST(suite_audio_module_graph, test_benchmark)
+{
+	uint32_t start;
+	uint32_t elapsed;
+	uint32_t latency;
+	uint32_t latency_sum = 0;
+	uint32_t latency_max = 0;
+
+	start = now_us();
+
+	/* Keep the pipeline full, so several frames are in flight in the graph. */
+	for (uint32_t seq = 0; seq < FRAMES_NUM + PIPELINE_DEPTH; seq++) {
+		if (seq < FRAMES_NUM) {
+			frame_send(seq);
+		}
+
+		if (seq >= PIPELINE_DEPTH) {
+			latency = frame_receive(seq - PIPELINE_DEPTH);
+			latency_sum += latency;
+			latency_max = MAX(latency_max, latency);
+		}
+	}
+
+	elapsed = MAX(now_us() - start, 1);
+
+	TC_PRINT("%u frames in %u us, %u frames per second\n", FRAMES_NUM, elapsed,
+		 (uint32_t)((uint64_t)FRAMES_NUM * USEC_PER_SEC / elapsed));
+	TC_PRINT("End-to-end latency %u us average, %u us max\n", latency_sum / FRAMES_NUM,
+		 latency_max);
+	TC_PRINT("Processed in place: gain %u, mix %u of %u frames\n", gain_ctx.in_place,
+		 mix_ctx.in_place, FRAMES_NUM);
+
+	slabs_released();
+
+	stats_print(&decode);
+	stats_print(&gain);
+	stats_print(&mix);
+	stats_print(&monitor);
+
+	zassert_equal(decode_ctx.in_place, 0);
+	zassert_true(gain_ctx.in_place > 0 && mix_ctx.in_place > 0, "No zero-copy processing");
+	zassert_equal(monitor_ctx.frames, FRAMES_NUM);
+	zassert_equal(monitor_ctx.errors, 0, "Shared audio data modified in place");
+}
+
+/* A slow destination holds its buffers without stalling the rest of the graph. */
+ZTEST(suite_audio_module_graph, test_buffers_in_flight)
+{
+	monitor_ctx.hold = true;
+
+	for (uint32_t seq = 0; seq < PIPELINE_DEPTH; seq++) {
+		frame_send(seq);
+	}
+
+	for (uint32_t seq = 0; seq < PIPELINE_DEPTH; seq++) {
+		frame_receive(seq);
+	}
+
+	/* Every decoded frame is still referenced by the monitor, so the gain stage copies. */
+	zassert_equal(k_mem_slab_num_used_get(&decode_slab), PIPELINE_DEPTH);
+	zassert_equal(gain_ctx.in_place, 0);
+	zassert_equal(mix_ctx.in_place, PIPELINE_DEPTH);
+	zassert_equal(monitor_ctx.frames, 0);
+
+	for (uint32_t seq = 0; seq < PIPELINE_DEPTH; seq++) {
+		k_sem_give(&monitor_sem);
+	}
+
+	slabs_released();
+
+	zassert_equal(monitor_ctx.frames, PIPELINE_DEPTH);
+	zassert_equal(monitor_ctx.errors, 0);
+}
+
+/* Late frames are flagged as bad data, or dropped by the modules that cannot conceal them. */
+ZTEST(suite_audio_module_graph, test_late_frames)
+{
+	struct audio_module_stats stats;
+	struct audio_data audio_data = {
+		.data = rx_frame,
+		.data_size = sizeof(rx_frame),
+	};
+
+	frame_send(0);
+	frame_receive(0);
+	zassert_false(rx_meta.bad_data);
+
+	deadline_us = LATE_DEADLINE_US;
+	frame_send(1);
+	frame_receive(1);
+	zassert_true(rx_meta.bad_data, "Late frame not flagged");
+
+	zassert_ok(audio_module_stats_get(&mix, &stats));
+	zassert_equal(stats.processed, 2);
+	zassert_equal(stats.late, 1);
+	zassert_equal(stats.dropped, 0);
+
+	in_place_description.drop_late = true;
+	frame_send(2);
+	zassert_equal(audio_module_data_rx(&mix, &audio_data, K_MSEC(100)), -EAGAIN);
+
+	zassert_ok(audio_module_stats_get(&gain, &stats));
+	zassert_equal(stats.processed, 2);
+	zassert_equal(stats.late, 2);
+	zassert_equal(stats.dropped, 1);
+
+	slabs_released();
+
+	/* The monitor processes the late frames flagged as bad data. */
+	zassert_ok(audio_module_stats_get(&monitor, &stats));
+	zassert_equal(stats.processed, 3);
+	zassert_equal(stats.late, 2);
+	zassert_equal(monitor_ctx.errors, 0);
+}
+
+ZTEST_SUITE(suite_audio_module_graph, NULL, setup, before, NULL, NULL);
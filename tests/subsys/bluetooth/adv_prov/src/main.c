@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/adv_prov.h>
+
+#define GRACE_PERIOD_S 5
+
+enum prov {
+	PROV_ALWAYS,
+	PROV_ROTATION,
+	PROV_SESSION,
+	PROV_STATIC,
+	PROV_PAIRING,
+	PROV_COUNT
+};
+
+static uint8_t prov_data[PROV_COUNT];
+static uint32_t calls[PROV_COUNT];
+static uint32_t calls_base[PROV_COUNT];
+
+static int data_fill(enum prov prov, struct bt_data *d)
+{
+	calls[prov]++;
+
+	/* Cached data must stay valid until it is regenerated. */
+	prov_data[prov] = (uint8_t)calls[prov];
+
+	d->type = BT_DATA_MANUFACTURER_DATA;
+	d->data_len = sizeof(prov_data[prov]);
+	d->data = &prov_data[prov];
+
+	return 0;
+}
+
+static int get_always(struct bt_data *d, const struct bt_le_adv_prov_adv_state *state,
+		      struct bt_le_adv_prov_feedback *fb)
+{
+	return data_fill(PROV_ALWAYS, d);
+}
+
+static int get_rotation(struct bt_data *d, const struct bt_le_adv_prov_adv_state *state,
+			struct bt_le_adv_prov_feedback *fb)
+{
+	return data_fill(PROV_ROTATION, d);
+}
+
+static int get_session(struct bt_data *d, const struct bt_le_adv_prov_adv_state *state,
+		       struct bt_le_adv_prov_feedback *fb)
+{
+	return data_fill(PROV_SESSION, d);
+}
+
+static int get_static(struct bt_data *d, const struct bt_le_adv_prov_adv_state *state,
+		      struct bt_le_adv_prov_feedback *fb)
+{
+	fb->grace_period_s = GRACE_PERIOD_S;
+
+	return data_fill(PROV_STATIC, d);
+}
+
+static int get_pairing(struct bt_data *d, const struct bt_le_adv_prov_adv_state *state,
+		       struct bt_le_adv_prov_feedback *fb)
+{
+	if (!state->pairing_mode) {
+		calls[PROV_PAIRING]++;
+		return -ENOENT;
+	}
+
+	return data_fill(PROV_PAIRING, d);
+}
+
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER(a_always, get_always);
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(b_rotation, get_rotation,
+					   BT_LE_ADV_PROV_UPDATE_ROTATION);
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(c_session, get_session, BT_LE_ADV_PROV_UPDATE_SESSION);
+BT_LE_ADV_PROV_AD_PROVIDER_REGISTER_CACHED(d_static, get_static, BT_LE_ADV_PROV_UPDATE_STATIC);
+BT_LE_ADV_PROV_SD_PROVIDER_REGISTER_CACHED(e_pairing, get_pairing, BT_LE_ADV_PROV_UPDATE_STATIC);
+
+static struct bt_le_adv_prov_adv_state state;
+
+static void update(void)
+{
+	struct bt_data ad[4];
+	struct bt_data sd[1];
+	size_t ad_len = ARRAY_SIZE(ad);
+	size_t sd_len = ARRAY_SIZE(sd);
+	struct bt_le_adv_prov_feedback fb;
+
+	zassert_ok(bt_le_adv_prov_get_ad(ad, &ad_len, &state, &fb));
+	zassert_equal(ad_len, ARRAY_SIZE(ad));
+	zassert_equal(fb.grace_period_s, GRACE_PERIOD_S, "Cached feedback lost");
+
+	/* The cached data is the latest data. */
+	for (size_t i = 0; i < ad_len; i++) {
+		zassert_equal(ad[i].data_len, 1);
+		zassert_equal(ad[i].data[0], (uint8_t)calls[i]);
+	}
+
+	zassert_ok(bt_le_adv_prov_get_sd(sd, &sd_len, &state, &fb));
+	zassert_equal(sd_len, state.pairing_mode ? 1 : 0);
+
+	state.rpa_rotated = false;
+	state.new_adv_session = false;
+}
+
+static void calls_verify(uint32_t always, uint32_t rotation, uint32_t session,
+			 uint32_t static_cnt, uint32_t pairing)
+{
+	zassert_equal(calls[PROV_ALWAYS] - calls_base[PROV_ALWAYS], always);
+	zassert_equal(calls[PROV_ROTATION] - calls_base[PROV_ROTATION], rotation);
+	zassert_equal(calls[PROV_SESSION] - calls_base[PROV_SESSION], session);
+	zassert_equal(calls[PROV_STATIC] - calls_base[PROV_STATIC], static_cnt);
+	zassert_equal(calls[PROV_PAIRING] - calls_base[PROV_PAIRING], pairing);
+}
+
+ZTEST(adv_prov_test, test_update_policy)
+{
+	zassert_equal(bt_le_adv_prov_get_ad_prov_cnt(), 4);
+	zassert_equal(bt_le_adv_prov_get_sd_prov_cnt(), 1);
+
+	state.new_adv_session = true;
+	update();
+	calls_verify(1, 1, 1, 1, 1);
+
+	/* Only time-varying data is regenerated. */
+	update();
+	calls_verify(2, 1, 1, 1, 1);
+
+	state.rpa_rotated = true;
+	update();
+	calls_verify(3, 2, 1, 1, 1);
+
+	state.new_adv_session = true;
+	update();
+	calls_verify(4, 3, 2, 1, 1);
+
+	/* Changing the pairing mode regenerates all data. */
+	state.pairing_mode = true;
+	update();
+	calls_verify(5, 4, 3, 2, 2);
+
+	state.in_grace_period = true;
+	update();
+	calls_verify(6, 5, 4, 3, 3);
+
+	update();
+	calls_verify(7, 5, 4, 3, 3);
+}
+
+ZTEST(adv_prov_test, test_data_changed)
+{
+	update();
+	memcpy(calls_base, calls, sizeof(calls_base));
+
+	bt_le_adv_prov_data_changed(&d_static);
+	update();
+	calls_verify(1, 0, 0, 1, 0);
+
+	/* A provider that desists from providing data is cached too. */
+	bt_le_adv_prov_data_changed(&e_pairing);
+	update();
+	calls_verify(2, 0, 0, 1, 1);
+	update();
+	calls_verify(3, 0, 0, 1, 1);
+}
+
+static void before(void *f)
+{
+	/* Drop the data cached by the previous test. */
+	bt_le_adv_prov_data_changed(&b_rotation);
+	bt_le_adv_prov_data_changed(&c_session);
+	bt_le_adv_prov_data_changed(&d_static);
+	bt_le_adv_prov_data_changed(&e_pairing);
+
+	memcpy(calls_base, calls, sizeof(calls_base));
+	memset(&state, 0, sizeof(state));
+}
+
+ZTEST_SUITE(adv_prov_test, NULL, NULL, before, NULL, NULL);
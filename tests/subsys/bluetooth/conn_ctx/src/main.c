@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/conn_ctx.h>
+
+#define MAX_CLIENTS (CONFIG_BT_MAX_CONN - 1)
+#define CTX_SIZE 10
+#define BENCHMARK_ROUNDS 100
+
+struct test_ctx {
+	uint8_t data[CTX_SIZE];
+};
+
+BT_CONN_CTX_DEF(test, MAX_CLIENTS, sizeof(struct test_ctx));
+
+BUILD_ASSERT(BT_CONN_CTX_MEM_SIZE(MAX_CLIENTS, sizeof(struct test_ctx)) ==
+	     MAX_CLIENTS * 12);
+
+/* Connection objects are only used as handles. */
+static uint8_t conns[CONFIG_BT_MAX_CONN];
+
+uint8_t bt_conn_index(const struct bt_conn *conn)
+{
+	return (const uint8_t *)conn - conns;
+}
+
+static struct bt_conn *conn_get(int index)
+{
+	return (struct bt_conn *)&conns[index];
+}
+
+static struct bt_conn_ctx_lib *ctx_lib = &test_ctx_lib;
+
+static void teardown(void *f)
+{
+	bt_conn_ctx_free_all(ctx_lib);
+	zassert_equal(k_mem_slab_num_free_get(ctx_lib->mem_slab), MAX_CLIENTS,
+		      "Context memory leaked");
+}
+
+ZTEST(conn_ctx_test, test_alloc_get)
+{
+	struct test_ctx *ctx[MAX_CLIENTS];
+
+	zassert_equal(bt_conn_ctx_count(ctx_lib), CONFIG_BT_MAX_CONN);
+	zassert_equal(ctx_lib->max_clients, MAX_CLIENTS);
+
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		/* Allocate in reverse order, the contexts are indexed by connection. */
+		struct bt_conn *conn = conn_get(MAX_CLIENTS - 1 - i);
+
+		zassert_is_null(bt_conn_ctx_get(ctx_lib, conn));
+
+		ctx[i] = bt_conn_ctx_alloc(ctx_lib, conn);
+		zassert_not_null(ctx[i]);
+		memset(ctx[i], i, bt_conn_ctx_block_size_get(ctx_lib));
+		bt_conn_ctx_release(ctx_lib, ctx[i]);
+
+		/* Only one context per connection. */
+		zassert_is_null(bt_conn_ctx_alloc(ctx_lib, conn));
+	}
+
+	/* The context memory is sized for the maximum number of clients. */
+	zassert_is_null(bt_conn_ctx_alloc(ctx_lib, conn_get(MAX_CLIENTS)));
+
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		struct bt_conn *conn = conn_get(MAX_CLIENTS - 1 - i);
+		const struct bt_conn_ctx *by_id;
+		struct test_ctx *data;
+
+		data = bt_conn_ctx_get(ctx_lib, conn);
+		zassert_equal_ptr(data, ctx[i]);
+		zassert_equal(data->data[0], i);
+
+		/* References can be nested. */
+		by_id = bt_conn_ctx_get_by_id(ctx_lib, bt_conn_index(conn));
+		zassert_not_null(by_id);
+		zassert_equal_ptr(by_id->conn, conn);
+		zassert_equal_ptr(by_id->data, data);
+
+		bt_conn_ctx_release(ctx_lib, by_id->data);
+		bt_conn_ctx_release(ctx_lib, data);
+	}
+
+	zassert_is_null(bt_conn_ctx_get_by_id(ctx_lib, MAX_CLIENTS));
+}
+
+ZTEST(conn_ctx_test, test_free)
+{
+	struct bt_conn *conn = conn_get(0);
+	struct test_ctx *ctx;
+
+	ctx = bt_conn_ctx_alloc(ctx_lib, conn);
+	zassert_not_null(ctx);
+	bt_conn_ctx_release(ctx_lib, ctx);
+
+	zassert_ok(bt_conn_ctx_free(ctx_lib, conn));
+	zassert_is_null(bt_conn_ctx_get(ctx_lib, conn));
+	zassert_is_null(bt_conn_ctx_get_by_id(ctx_lib, 0));
+	zassert_equal(bt_conn_ctx_free(ctx_lib, conn), -EINVAL);
+	zassert_equal(bt_conn_ctx_free(ctx_lib, conn_get(1)), -EINVAL);
+	zassert_equal(k_mem_slab_num_free_get(ctx_lib->mem_slab), MAX_CLIENTS);
+
+	/* The slot can be reused. */
+	ctx = bt_conn_ctx_alloc(ctx_lib, conn);
+	zassert_not_null(ctx);
+	bt_conn_ctx_release(ctx_lib, ctx);
+}
+
+/* Verify that freed context data stays valid until the last reference is released. */
+ZTEST(conn_ctx_test, test_free_referenced)
+{
+	struct bt_conn *conn = conn_get(1);
+	struct test_ctx *ctx;
+	struct test_ctx *ref;
+
+	ctx = bt_conn_ctx_alloc(ctx_lib, conn);
+	zassert_not_null(ctx);
+	bt_conn_ctx_release(ctx_lib, ctx);
+
+	ref = bt_conn_ctx_get(ctx_lib, conn);
+	zassert_equal_ptr(ref, ctx);
+
+	zassert_ok(bt_conn_ctx_free(ctx_lib, conn));
+	zassert_is_null(bt_conn_ctx_get(ctx_lib, conn));
+	zassert_equal(k_mem_slab_num_free_get(ctx_lib->mem_slab), MAX_CLIENTS - 1);
+
+	/* The connection can't get a new context before the old one is released. */
+	zassert_is_null(bt_conn_ctx_alloc(ctx_lib, conn));
+
+	bt_conn_ctx_release(ctx_lib, ref);
+	zassert_equal(k_mem_slab_num_free_get(ctx_lib->mem_slab), MAX_CLIENTS);
+
+	/* Freeing all contexts works the same way. */
+	ctx = bt_conn_ctx_alloc(ctx_lib, conn);
+	zassert_not_null(ctx);
+
+	bt_conn_ctx_free_all(ctx_lib);
+	zassert_is_null(bt_conn_ctx_get(ctx_lib, conn));
+	zassert_equal(k_mem_slab_num_free_get(ctx_lib->mem_slab), MAX_CLIENTS - 1);
+
+	bt_conn_ctx_release(ctx_lib, ctx);
+	zassert_equal(k_mem_slab_num_free_get(ctx_lib->mem_slab), MAX_CLIENTS);
+}
+
+ZTEST(conn_ctx_test, test_get_benchmark)
+{
+	struct bt_conn *conn = conn_get(MAX_CLIENTS - 1);
+	struct test_ctx *ctx;
+	uint32_t start;
+	uint32_t cycles;
+
+	ctx = bt_conn_ctx_alloc(ctx_lib, conn);
+	zassert_not_null(ctx);
+	bt_conn_ctx_release(ctx_lib, ctx);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+		ctx = bt_conn_ctx_get(ctx_lib, conn);
+		zassert_not_null(ctx);
+		bt_conn_ctx_release(ctx_lib, ctx);
+	}
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("%u cycles per get and release\n", cycles / BENCHMARK_ROUNDS);
+}
+
+ZTEST_SUITE(conn_ctx_test, NULL, NULL, NULL, teardown, NULL);
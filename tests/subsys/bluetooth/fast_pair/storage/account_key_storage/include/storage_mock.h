@@ -26,6 +26,14 @@ extern "C" {
  */
 void storage_mock_clear(void);
 
+/** Get number of write operations.
+ *
+ * The counter is reset by @ref storage_mock_clear.
+ *
+ * @return Number of write operations performed on the mocked storage.
+ */
+size_t storage_mock_write_cnt_get(void);
+
 #ifdef __cplusplus
 }
 #endif
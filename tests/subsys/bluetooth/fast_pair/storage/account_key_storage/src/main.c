@@ -251,5 +251,83 @@ ZTEST(suite_fast_pair_storage, test_loop)
 	}
 }
 
+struct find_cnt_context {
+	uint8_t seed;
+	size_t check_cnt;
+};
+
+static bool account_key_find_cnt_cb(const struct fp_account_key *account_key, void *context)
+{
+	struct find_cnt_context *ctx = context;
+
+	ctx->check_cnt++;
+
+	return cu_check_account_key_seed(ctx->seed, account_key);
+}
+
+static size_t find_check_cnt(uint8_t seed)
+{
+	struct find_cnt_context ctx = {
+		.seed = seed,
+	};
+	int err;
+
+	err = fp_storage_ak_find(NULL, account_key_find_cnt_cb, &ctx);
+	zassert_ok(err, "Failed to find Account Key");
+
+	return ctx.check_cnt;
+}
+
+ZTEST(suite_fast_pair_storage, test_find_mru_order)
+{
+	static const uint8_t first_seed = 0;
+	static const size_t test_key_cnt = 3;
+
+	cu_account_keys_generate_and_store(first_seed, test_key_cnt);
+
+	/* The most recently saved key is checked first. */
+	zassert_equal(find_check_cnt(first_seed + test_key_cnt - 1), 1,
+		      "Most recently used key should be checked first");
+	zassert_equal(find_check_cnt(first_seed), test_key_cnt,
+		      "Least recently used key should be checked last");
+
+	/* A found key becomes the most recently used one. */
+	zassert_equal(find_check_cnt(first_seed), 1,
+		      "Most recently used key should be checked first");
+	zassert_equal(find_check_cnt(first_seed + test_key_cnt - 1), 2,
+		      "Invalid Account Key order");
+}
+
+ZTEST(suite_fast_pair_storage, test_order_save_deferred)
+{
+	static const uint8_t first_seed = 0;
+	static const size_t test_key_cnt = 3;
+	size_t write_cnt;
+
+	cu_account_keys_generate_and_store(first_seed, test_key_cnt);
+	write_cnt = storage_mock_write_cnt_get();
+
+	/* Order updates are not written right away. */
+	(void)find_check_cnt(first_seed);
+	(void)find_check_cnt(first_seed + 1);
+	(void)find_check_cnt(first_seed);
+	zassert_equal(storage_mock_write_cnt_get(), write_cnt, "Unexpected settings write");
+
+	/* Updates within the delay are written once. */
+	k_sleep(K_MSEC(2 * CONFIG_BT_FAST_PAIR_STORAGE_AK_ORDER_SAVE_DELAY));
+	zassert_equal(storage_mock_write_cnt_get(), write_cnt + 1,
+		      "Account Key order should be written once");
+
+	/* Using the most recently used key again does not change the order. */
+	(void)find_check_cnt(first_seed);
+	k_sleep(K_MSEC(2 * CONFIG_BT_FAST_PAIR_STORAGE_AK_ORDER_SAVE_DELAY));
+	zassert_equal(storage_mock_write_cnt_get(), write_cnt + 1, "Unexpected settings write");
+
+	/* The saved order is restored from storage. */
+	reload_keys_from_storage();
+	zassert_equal(find_check_cnt(first_seed), 1, "Account Key order not restored");
+	zassert_equal(find_check_cnt(first_seed + 1), 2, "Account Key order not restored");
+	zassert_equal(find_check_cnt(first_seed + 2), 3, "Account Key order not restored");
+}
 
 ZTEST_SUITE(suite_fast_pair_storage, NULL, NULL, before_fn, after_fn, NULL);
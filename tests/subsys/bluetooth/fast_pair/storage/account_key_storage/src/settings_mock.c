@@ -19,6 +19,7 @@ struct settings_data {
 };
 
 static sys_slist_t settings_list;
+static size_t write_cnt;
 
 
 void storage_mock_clear(void)
@@ -31,6 +32,13 @@ void storage_mock_clear(void)
 		k_free(data->name);
 		k_free(data);
 	}
+
+	write_cnt = 0;
+}
+
+size_t storage_mock_write_cnt_get(void)
+{
+	return write_cnt;
 }
 
 static ssize_t settings_mock_read_fn(void *back_end, void *data, size_t len)
@@ -75,6 +83,8 @@ static int settings_mock_save(struct settings_store *cs, const char *name, const
 
 	zassert_not_equal(name_len, max_name_len, "Too long settings key");
 
+	write_cnt++;
+
 	sys_snode_t *cur_node;
 
 	/* Update record if exists. */
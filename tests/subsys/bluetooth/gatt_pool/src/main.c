@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <bluetooth/gatt_pool.h>
+
+/* A HID service with many reports, each with a CCC and a report reference. */
+#define REPORTS 70
+#define REPORT_ATTRS 4
+#define HIDS_ATTRS (1 + REPORTS * REPORT_ATTRS)
+
+#define VND_CHRCS 9
+#define VND_UUID(_i) \
+	BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x6e400001, 0xb5a3, 0xf393, 0xe0a9, \
+					       0xe50e24dcca00 + (_i)))
+#define VND_ATTRS(_chrcs) (1 + (_chrcs) * 2)
+
+#define REPORT_PROPS (BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY)
+#define REPORT_PERM BT_GATT_PERM_READ
+#define CCC_PERM (BT_GATT_PERM_READ | BT_GATT_PERM_WRITE)
+
+#define HIDS_REPORT(_i, _)                                                      \
+	BT_GATT_CHARACTERISTIC(BT_UUID_HIDS_REPORT, REPORT_PROPS, REPORT_PERM,  \
+			       NULL, NULL, NULL),                               \
+	BT_GATT_CCC(NULL, CCC_PERM),                                            \
+	BT_GATT_DESCRIPTOR(BT_UUID_HIDS_REPORT_REF, BT_GATT_PERM_READ,          \
+			   NULL, NULL, NULL)
+
+#define VND_CHRC(_i, _) \
+	BT_GATT_CHARACTERISTIC(VND_UUID((_i) + 1), BT_GATT_CHRC_READ, \
+			       BT_GATT_PERM_READ, NULL, NULL, NULL)
+
+static const struct bt_gatt_attr hids_attrs[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_HIDS),
+	LISTIFY(REPORTS, HIDS_REPORT, (,))
+};
+
+static const struct bt_gatt_attr vnd_attrs[] = {
+	BT_GATT_PRIMARY_SERVICE(VND_UUID(0)),
+	LISTIFY(VND_CHRCS, VND_CHRC, (,))
+};
+
+BUILD_ASSERT(ARRAY_SIZE(hids_attrs) == HIDS_ATTRS);
+
+static struct bt_gatt_pool gp = BT_GATT_POOL_INIT(HIDS_ATTRS);
+static struct bt_gatt_pool gp_2 = BT_GATT_POOL_INIT(HIDS_ATTRS);
+static struct _bt_gatt_ccc ccc[REPORTS];
+
+static void teardown(void *f)
+{
+	bt_gatt_pool_free(&gp);
+	bt_gatt_pool_free(&gp_2);
+}
+
+static void hids_verify(struct bt_gatt_pool *pool)
+{
+	struct bt_uuid *report_uuid = pool->svc.attrs[2].uuid;
+
+	zassert_equal(pool->svc.attr_count, HIDS_ATTRS);
+	zassert_ok(bt_uuid_cmp(pool->svc.attrs[0].user_data, BT_UUID_HIDS));
+	zassert_ok(bt_uuid_cmp(report_uuid, BT_UUID_HIDS_REPORT));
+
+	for (size_t i = 1; i < HIDS_ATTRS; i += REPORT_ATTRS) {
+		const struct bt_gatt_attr *attrs = &pool->svc.attrs[i];
+		const struct bt_gatt_chrc *chrc = attrs[0].user_data;
+
+		zassert_ok(bt_uuid_cmp(attrs[0].uuid, BT_UUID_GATT_CHRC));
+		zassert_equal(chrc->properties, REPORT_PROPS);
+
+		/* All reports share one UUID from the pool. */
+		zassert_equal_ptr(chrc->uuid, report_uuid);
+		zassert_equal_ptr(attrs[1].uuid, report_uuid);
+		zassert_equal(attrs[1].perm, REPORT_PERM);
+
+		zassert_ok(bt_uuid_cmp(attrs[2].uuid, BT_UUID_GATT_CCC));
+		zassert_ok(bt_uuid_cmp(attrs[3].uuid, BT_UUID_HIDS_REPORT_REF));
+		zassert_equal_ptr(attrs[3].uuid, pool->svc.attrs[4].uuid);
+	}
+}
+
+ZTEST(gatt_pool_test, test_attrs_alloc)
+{
+	uint32_t start;
+	uint32_t cycles;
+
+	start = k_cycle_get_32();
+	zassert_ok(bt_gatt_pool_attrs_alloc(&gp, hids_attrs, ARRAY_SIZE(hids_attrs)));
+	cycles = k_cycle_get_32() - start;
+
+	hids_verify(&gp);
+
+	TC_PRINT("%u attributes in %u cycles, %u cycles per attribute\n", HIDS_ATTRS, cycles,
+		 cycles / HIDS_ATTRS);
+
+	/* The pool is released completely. */
+	bt_gatt_pool_free(&gp);
+	zassert_equal(gp.svc.attr_count, 0);
+	zassert_ok(bt_gatt_pool_attrs_alloc(&gp, hids_attrs, ARRAY_SIZE(hids_attrs)));
+}
+
+ZTEST(gatt_pool_test, test_single_alloc)
+{
+	uint32_t start;
+	uint32_t cycles;
+
+	start = k_cycle_get_32();
+	BT_GATT_POOL_SVC(&gp, BT_UUID_HIDS);
+	for (size_t i = 0; i < REPORTS; i++) {
+		BT_GATT_POOL_CHRC(&gp, BT_UUID_HIDS_REPORT, REPORT_PROPS, REPORT_PERM, NULL, NULL,
+				  NULL);
+		BT_GATT_POOL_CCC(&gp, ccc[i], NULL, CCC_PERM);
+		BT_GATT_POOL_DESC(&gp, BT_UUID_HIDS_REPORT_REF, BT_GATT_PERM_READ, NULL, NULL,
+				  NULL);
+	}
+	cycles = k_cycle_get_32() - start;
+
+	hids_verify(&gp);
+
+	TC_PRINT("%u attributes in %u cycles, %u cycles per attribute\n", HIDS_ATTRS, cycles,
+		 cycles / HIDS_ATTRS);
+}
+
+/* UUIDs shared between services stay valid until the last one is freed. */
+ZTEST(gatt_pool_test, test_shared_uuid)
+{
+	zassert_ok(bt_gatt_pool_attrs_alloc(&gp, hids_attrs, 1 + REPORT_ATTRS));
+	zassert_ok(bt_gatt_pool_attrs_alloc(&gp_2, hids_attrs, 1 + REPORT_ATTRS));
+	zassert_equal_ptr(gp.svc.attrs[0].user_data, gp_2.svc.attrs[0].user_data);
+	zassert_equal_ptr(gp.svc.attrs[2].uuid, gp_2.svc.attrs[2].uuid);
+
+	bt_gatt_pool_free(&gp);
+	zassert_ok(bt_uuid_cmp(gp_2.svc.attrs[0].user_data, BT_UUID_HIDS));
+	zassert_ok(bt_uuid_cmp(gp_2.svc.attrs[2].uuid, BT_UUID_HIDS_REPORT));
+	zassert_ok(bt_uuid_cmp(gp_2.svc.attrs[4].uuid, BT_UUID_HIDS_REPORT_REF));
+}
+
+/* A service that does not fit in the pool takes nothing from it. */
+ZTEST(gatt_pool_test, test_attrs_alloc_rollback)
+{
+	/* The service and all characteristics need one UUID128 each. */
+	BUILD_ASSERT(VND_CHRCS + 1 > CONFIG_BT_GATT_UUID128_POOL_SIZE);
+
+	zassert_equal(bt_gatt_pool_attrs_alloc(&gp, vnd_attrs, ARRAY_SIZE(vnd_attrs)), -ENOMEM);
+	zassert_equal(gp.svc.attr_count, 0);
+
+	zassert_ok(bt_gatt_pool_attrs_alloc(&gp, vnd_attrs,
+					    VND_ATTRS(CONFIG_BT_GATT_UUID128_POOL_SIZE - 1)));
+	zassert_equal(gp.svc.attr_count, VND_ATTRS(CONFIG_BT_GATT_UUID128_POOL_SIZE - 1));
+
+	/* A characteristic declaration without its value is rejected. */
+	zassert_equal(bt_gatt_pool_attrs_alloc(&gp_2, vnd_attrs, 2), -EINVAL);
+	zassert_equal(gp_2.svc.attr_count, 0);
+
+	zassert_equal(bt_gatt_pool_attrs_alloc(&gp_2, hids_attrs, HIDS_ATTRS + 1), -ENOSPC);
+}
+
+ZTEST_SUITE(gatt_pool_test, NULL, NULL, NULL, teardown, NULL);
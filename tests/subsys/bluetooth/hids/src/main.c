@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <bluetooth/services/hids.h>
+
+#define INPUT_REP_LEN  2
+#define OUTPUT_REP_LEN 2
+#define FEAT_REP_LEN   2
+
+BT_HIDS_DEF(hids, INPUT_REP_LEN, OUTPUT_REP_LEN, FEAT_REP_LEN);
+
+/* Connection objects are only used as handles. */
+static uint8_t conns[CONFIG_BT_MAX_CONN];
+
+/** Mocks ******************************************/
+
+uint8_t bt_conn_index(const struct bt_conn *conn)
+{
+	return (const uint8_t *)conn - conns;
+}
+
+int bt_uuid_cmp(const struct bt_uuid *u1, const struct bt_uuid *u2)
+{
+	if (u1->type != u2->type) {
+		return u1->type - u2->type;
+	}
+
+	if (u1->type == BT_UUID_TYPE_16) {
+		return (int)BT_UUID_16(u1)->val - (int)BT_UUID_16(u2)->val;
+	}
+
+	return memcmp(BT_UUID_128(u1)->val, BT_UUID_128(u2)->val, BT_UUID_SIZE_128);
+}
+
+ssize_t bt_gatt_attr_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+			  uint16_t buf_len, uint16_t offset, const void *value,
+			  uint16_t value_len)
+{
+	return 0;
+}
+
+ssize_t bt_gatt_attr_read_service(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+				  void *buf, uint16_t len, uint16_t offset)
+{
+	return 0;
+}
+
+ssize_t bt_gatt_attr_read_chrc(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+			       uint16_t len, uint16_t offset)
+{
+	return 0;
+}
+
+ssize_t bt_gatt_attr_read_ccc(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+			      uint16_t len, uint16_t offset)
+{
+	return 0;
+}
+
+ssize_t bt_gatt_attr_write_ccc(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			       const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+	return len;
+}
+
+bool bt_gatt_is_subscribed(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			   uint16_t ccc_type)
+{
+	return true;
+}
+
+int bt_gatt_notify_cb(struct bt_conn *conn, struct bt_gatt_notify_params *params)
+{
+	return 0;
+}
+
+int bt_gatt_service_register(struct bt_gatt_service *svc)
+{
+	return 0;
+}
+
+int bt_gatt_service_unregister(struct bt_gatt_service *svc)
+{
+	return 0;
+}
+
+/** End of mocks ***********************************/
+
+static struct bt_conn *conn_get(int index)
+{
+	return (struct bt_conn *)&conns[index];
+}
+
+static struct bt_gatt_attr *pm_attr_get(void)
+{
+	for (size_t i = 0; i < hids.gp.svc.attr_count; i++) {
+		struct bt_gatt_attr *attr = &hids.gp.svc.attrs[i];
+
+		if (attr->user_data == &hids.pm && attr->write) {
+			return attr;
+		}
+	}
+
+	return NULL;
+}
+
+static ssize_t attr_write(struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+			  uint16_t offset)
+{
+	return attr->write(conn_get(0), attr, buf, len, offset, 0);
+}
+
+/* Every handler must release its connection context reference, or the context is never
+ * destroyed after the disconnection and the connection can't get a new one.
+ */
+static void reconnect(void)
+{
+	zassert_ok(bt_hids_disconnected(&hids, conn_get(0)));
+	zassert_equal(k_mem_slab_num_free_get(hids.conn_ctx->mem_slab),
+		      CONFIG_BT_HIDS_MAX_CLIENT_COUNT, "Context reference leaked");
+	zassert_ok(bt_hids_connected(&hids, conn_get(0)));
+}
+
+static void *setup(void)
+{
+	struct bt_hids_init_param init = {
+		.inp_rep_group_init = {
+			.reports = {{.id = 1, .size = INPUT_REP_LEN}},
+			.cnt = 1,
+		},
+		.outp_rep_group_init = {
+			.reports = {{.id = 2, .size = OUTPUT_REP_LEN}},
+			.cnt = 1,
+		},
+		.feat_rep_group_init = {
+			.reports = {{.id = 3, .size = FEAT_REP_LEN}},
+			.cnt = 1,
+		},
+		.is_kb = true,
+	};
+
+	zassert_ok(bt_hids_init(&hids, &init));
+
+	return NULL;
+}
+
+static void before(void *f)
+{
+	zassert_ok(bt_hids_connected(&hids, conn_get(0)));
+}
+
+static void after(void *f)
+{
+	zassert_ok(bt_hids_disconnected(&hids, conn_get(0)));
+	zassert_equal(k_mem_slab_num_free_get(hids.conn_ctx->mem_slab),
+		      CONFIG_BT_HIDS_MAX_CLIENT_COUNT, "Context memory leaked");
+}
+
+ZTEST(hids_test, test_pm_write_invalid)
+{
+	struct bt_gatt_attr *attr = pm_attr_get();
+	uint8_t pm[] = {BT_HIDS_PM_BOOT, 0};
+	uint8_t invalid_pm = 0xff;
+
+	zassert_not_null(attr);
+
+	zassert_equal(attr_write(attr, pm, sizeof(pm), 0),
+		      BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN));
+	reconnect();
+
+	zassert_equal(attr_write(attr, pm, 1, 1), BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET));
+	reconnect();
+
+	zassert_equal(attr_write(attr, &invalid_pm, 1, 0),
+		      BT_GATT_ERR(BT_ATT_ERR_NOT_SUPPORTED));
+	reconnect();
+
+	zassert_equal(attr_write(attr, pm, 1, 0), 1);
+	reconnect();
+}
+
+ZTEST(hids_test, test_rep_write_bad_offset)
+{
+	struct bt_gatt_attr *attrs[] = {
+		&hids.gp.svc.attrs[hids.outp_rep_group.reports[0].att_ind],
+		&hids.gp.svc.attrs[hids.feat_rep_group.reports[0].att_ind],
+		&hids.gp.svc.attrs[hids.boot_kb_outp_rep.att_ind],
+	};
+	uint8_t rep[OUTPUT_REP_LEN] = {0};
+
+	for (size_t i = 0; i < ARRAY_SIZE(attrs); i++) {
+		zassert_equal(attr_write(attrs[i], rep, 1, OUTPUT_REP_LEN),
+			      BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET), "Report %zu", i);
+		reconnect();
+
+		zassert_equal(attr_write(attrs[i], rep, 1, 0), 1, "Report %zu", i);
+		reconnect();
+	}
+}
+
+ZTEST(hids_test, test_boot_kb_inp_rep_send_too_long)
+{
+	uint8_t rep[BT_HIDS_BOOT_KB_INPUT_REP_LEN + 1] = {0};
+
+	zassert_equal(bt_hids_boot_kb_inp_rep_send(&hids, conn_get(0), rep, sizeof(rep), NULL),
+		      -EINVAL);
+	reconnect();
+
+	zassert_ok(bt_hids_boot_kb_inp_rep_send(&hids, conn_get(0), rep, sizeof(rep) - 1, NULL));
+	reconnect();
+}
+
+ZTEST_SUITE(hids_test, NULL, setup, before, after, NULL);
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/mesh/light_ctrl_reg_spec.h>
+
+/* Largest allowed difference from the floating point regulator output. */
+#define OUTPUT_TOLERANCE 0.5f
+#define TARGET_LUX 500.0f
+#define AMBIENT_LUX 50.0f
+
+static struct bt_mesh_light_ctrl_reg_spec spec_reg = BT_MESH_LIGHT_CTRL_REG_SPEC_INIT;
+static struct bt_mesh_light_ctrl_reg *reg = &spec_reg.reg;
+
+static float output;
+static int update_count;
+/* Reset the measured value on the next update, as the Light LC Server does
+ * when the ambient light level times out.
+ */
+static bool measured_timeout;
+
+/* Floating point reference regulator, as defined by the specification. */
+static struct {
+	float i;
+	bool neg;
+	uint16_t interval;
+} ref;
+
+static void updated(struct bt_mesh_light_ctrl_reg *r, float value)
+{
+	output = value;
+	update_count++;
+
+	if (measured_timeout) {
+		measured_timeout = false;
+		r->measured = 0.0f;
+	}
+}
+
+static void ref_terms(float *i, float *p)
+{
+	float target = bt_mesh_light_ctrl_reg_target_get(reg);
+	float error = target - reg->measured;
+	float accuracy = (reg->cfg.accuracy * target) / (2 * 100.0f);
+	float input;
+
+	if (error > accuracy) {
+		input = error - accuracy;
+	} else if (error < -accuracy) {
+		input = error + accuracy;
+	} else {
+		input = 0.0f;
+	}
+
+	*i = input * (input >= 0 ? reg->cfg.ki.up : reg->cfg.ki.down) *
+	     ((float)ref.interval / MSEC_PER_SEC);
+	*p = input * (input >= 0 ? reg->cfg.kp.up : reg->cfg.kp.down);
+}
+
+static void ref_start(uint16_t lightness)
+{
+	float i, p;
+
+	ref_terms(&i, &p);
+	ref.i = lightness - i;
+	ref.neg = true;
+}
+
+static float ref_step(void)
+{
+	float i, p;
+
+	ref_terms(&i, &p);
+	ref.i += i;
+
+	if (ref.i >= 0) {
+		ref.neg = false;
+	}
+
+	if (!ref.neg) {
+		ref.i = CLAMP(ref.i, 0, UINT16_MAX);
+	}
+
+	return ref.i + p;
+}
+
+/* Check whether the next step is scheduled after the step interval, and not
+ * only at the ambient light level timeout.
+ */
+static bool step_pending(void)
+{
+	return k_work_delayable_is_pending(&spec_reg.timer) &&
+	       k_ticks_to_ms_ceil32(k_work_delayable_remaining_get(&spec_reg.timer)) <=
+		       ref.interval;
+}
+
+/* Run one regulator step, and return whether the next step is scheduled. */
+static bool reg_step(void)
+{
+	bool scheduled;
+
+	spec_reg.timer.work.handler(&spec_reg.timer.work);
+	scheduled = step_pending();
+	/* The test drives the steps, not the timer. */
+	k_work_cancel_delayable(&spec_reg.timer);
+
+	return scheduled;
+}
+
+static void reg_start(uint16_t interval, uint16_t lightness)
+{
+	spec_reg.interval = interval;
+	ref.interval = interval;
+
+	reg->start(reg, lightness);
+	k_work_cancel_delayable(&spec_reg.timer);
+	ref_start(lightness);
+}
+
+/* Simple model of a room: the luminaire adds to the ambient light. */
+static void measure(void)
+{
+	reg->measured = AMBIENT_LUX + CLAMP(output, 0, UINT16_MAX) / 100.0f;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+}
+
+static void compare_steps(int steps)
+{
+	for (int step = 0; step < steps; step++) {
+		float expected = ref_step();
+
+		reg_step();
+		zassert_within(output, expected, OUTPUT_TOLERANCE,
+			       "Step %d: expected %f, got %f", step, (double)expected,
+			       (double)output);
+		measure();
+	}
+}
+
+static void setup(void *f)
+{
+	struct bt_mesh_light_ctrl_reg_cfg cfg = {
+		.ki = { .up = 250.0f, .down = 25.0f },
+		.kp = { .up = 80.0f, .down = 80.0f },
+		.accuracy = 2.0f,
+	};
+
+	reg->cfg = cfg;
+	reg->updated = updated;
+	reg->measured = AMBIENT_LUX;
+	reg->init(reg);
+	bt_mesh_light_ctrl_reg_target_set(reg, TARGET_LUX, 0);
+
+	output = 0;
+	update_count = 0;
+	measured_timeout = false;
+}
+
+static void teardown(void *f)
+{
+	reg->stop(reg);
+}
+
+/* Verify that the fixed-point regulator follows the floating point reference. */
+ZTEST(light_ctrl_reg_fixed_test, test_float_reference)
+{
+	reg_start(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL, 0);
+	compare_steps(200);
+
+	/* Lower target, regulate down. */
+	bt_mesh_light_ctrl_reg_target_set(reg, TARGET_LUX / 2, 0);
+	compare_steps(200);
+
+	/* Start with a lightness level. */
+	reg->stop(reg);
+	reg_start(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL, 20000);
+	compare_steps(200);
+}
+
+/* Verify that the integral term is scaled by the step interval. */
+ZTEST(light_ctrl_reg_fixed_test, test_interval)
+{
+	const uint16_t intervals[] = { 10, 50, 100 };
+
+	for (int i = 0; i < ARRAY_SIZE(intervals); i++) {
+		reg->measured = AMBIENT_LUX;
+		output = 0;
+		reg_start(intervals[i], 0);
+		compare_steps(100);
+		reg->stop(reg);
+	}
+
+	/* With a constant error, the integral sum grows by Ki * U * T per step. */
+	reg->cfg.kp.up = 0.0f;
+	reg->cfg.accuracy = 0.0f;
+	reg->measured = TARGET_LUX - 1.0f;
+	reg_start(10, 0);
+	reg_step();
+	reg_step();
+	zassert_within(output, reg->cfg.ki.up * 10 / MSEC_PER_SEC, 0.01f, "Got %f",
+		       (double)output);
+}
+
+/* Verify that the regulator suspends its steps while the error is within the accuracy. */
+ZTEST(light_ctrl_reg_fixed_test, test_suspend_in_accuracy)
+{
+	int count;
+
+	reg_start(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL, 0);
+	compare_steps(200);
+
+	/* Keep the measured value within the accuracy of the target. */
+	reg->measured = TARGET_LUX + 1.0f;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+	zassert_true(reg_step(), "Regulator stopped on new input");
+	zassert_false(reg_step(), "Regulator not suspended");
+	zassert_true(spec_reg.suspended);
+
+	/* A new sample with the same value makes one step, without changing the output. */
+	count = update_count;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+	zassert_true(step_pending(), "Regulator not resumed");
+	zassert_false(reg_step(), "Regulator not suspended");
+	zassert_equal(update_count, count + 1);
+
+	/* A new value resumes the regulator, which gives the same output as the reference. */
+	reg->measured = TARGET_LUX - 50.0f;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+	zassert_true(step_pending(), "Regulator not resumed");
+	k_work_cancel_delayable(&spec_reg.timer);
+	zassert_false(spec_reg.suspended);
+
+	for (int i = 0; i < 5; i++) {
+		float expected = ref_step();
+
+		zassert_true(reg_step(), "Regulator suspended with an error");
+		zassert_within(output, expected, OUTPUT_TOLERANCE, "Expected %f, got %f",
+			       (double)expected, (double)output);
+	}
+
+	/* A new target resumes the regulator as well. */
+	reg->measured = TARGET_LUX;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+	zassert_true(reg_step(), "Regulator stopped on new input");
+	zassert_within(output, ref_step(), OUTPUT_TOLERANCE);
+	zassert_false(reg_step(), "Regulator not suspended");
+	zassert_true(spec_reg.suspended);
+	bt_mesh_light_ctrl_reg_target_set(reg, TARGET_LUX * 2, 0);
+	zassert_true(step_pending(), "Regulator not resumed");
+	k_work_cancel_delayable(&spec_reg.timer);
+	compare_steps(10);
+}
+
+/* Verify that the regulator suspends its steps while the output is saturated. */
+ZTEST(light_ctrl_reg_fixed_test, test_suspend_saturated)
+{
+	int steps = 0;
+
+	/* The target can't be reached, the output saturates. */
+	reg->measured = 0.0f;
+	reg_start(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL, 0);
+
+	while (reg_step()) {
+		zassert_true(++steps < 1000, "Regulator not suspended");
+		zassert_true(ref_step() >= 0.0f);
+	}
+
+	zassert_true(spec_reg.suspended);
+	zassert_true(output >= UINT16_MAX, "Output not saturated: %f", (double)output);
+	zassert_within(output, ref_step(), OUTPUT_TOLERANCE);
+
+	/* Stopping the regulator clears the suspension. */
+	reg->stop(reg);
+	zassert_false(spec_reg.suspended);
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+	zassert_false(k_work_delayable_is_pending(&spec_reg.timer));
+}
+
+/* Verify that a suspended regulator steps once the ambient light level times out. */
+ZTEST(light_ctrl_reg_fixed_test, test_suspend_timeout)
+{
+	int count;
+
+	reg_start(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL, 0);
+	compare_steps(200);
+
+	reg->measured = TARGET_LUX;
+	bt_mesh_light_ctrl_reg_input_changed(reg);
+	zassert_true(reg_step(), "Regulator stopped on new input");
+	(void)ref_step();
+
+	/* Let the timer run the suspended regulator. */
+	spec_reg.timer.work.handler(&spec_reg.timer.work);
+	zassert_true(spec_reg.suspended, "Regulator not suspended");
+	zassert_true(k_work_delayable_is_pending(&spec_reg.timer), "No timeout step");
+	zassert_false(step_pending(), "Regulator not suspended");
+
+	/* The measured value times out without new samples, and the regulator
+	 * resumes on the reset value.
+	 */
+	count = update_count;
+	measured_timeout = true;
+	k_sleep(K_SECONDS(CONFIG_BT_MESH_LIGHT_CTRL_AMB_LIGHT_LEVEL_TIMEOUT));
+	k_sleep(K_MSEC(CONFIG_BT_MESH_LIGHT_CTRL_REG_SPEC_INTERVAL / 2));
+
+	zassert_equal(update_count, count + 1, "No step at the timeout");
+	zassert_equal(reg->measured, 0.0f);
+	zassert_false(spec_reg.suspended, "Regulator suspended without a measured value");
+	zassert_true(step_pending(), "Regulator not resumed");
+	k_work_cancel_delayable(&spec_reg.timer);
+
+	compare_steps(10);
+}
+
+ZTEST_SUITE(light_ctrl_reg_fixed_test, NULL, NULL, setup, teardown, NULL);
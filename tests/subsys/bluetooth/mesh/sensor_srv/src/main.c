@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/mesh/models.h>
+#include <bluetooth/mesh/sensor_srv.h>
+#include <sensor.h> // private header from the source folder
+
+#define PUB_PERIOD_MS 1000
+
+/* Header of the Sensor Column Status message: opcode and sensor ID. */
+#define COLUMN_STATUS_HDR_LEN 3
+
+/** Mocks ******************************************/
+
+static struct {
+	struct bt_mesh_model *model;
+	uint8_t data[BT_MESH_TX_SDU_MAX];
+	size_t len;
+} sent_msg;
+
+static void msg_capture(struct bt_mesh_model *model, struct net_buf_simple *buf)
+{
+	zassert_true(buf->len <= sizeof(sent_msg.data), "Message too long");
+
+	sent_msg.model = model;
+	sent_msg.len = buf->len;
+	memcpy(sent_msg.data, buf->data, buf->len);
+}
+
+void bt_mesh_model_msg_init(struct net_buf_simple *msg, uint32_t opcode)
+{
+	net_buf_simple_init(msg, 0);
+
+	switch (BT_MESH_MODEL_OP_LEN(opcode)) {
+	case 1:
+		net_buf_simple_add_u8(msg, opcode);
+		break;
+	case 2:
+		net_buf_simple_add_be16(msg, opcode);
+		break;
+	case 3:
+		net_buf_simple_add_u8(msg, ((opcode >> 16) & 0xff));
+		net_buf_simple_add_le16(msg, opcode & 0xffff);
+		break;
+	}
+}
+
+int bt_mesh_model_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+		       struct net_buf_simple *msg, const struct bt_mesh_send_cb *cb, void *cb_data)
+{
+	msg_capture(model, msg);
+	return 0;
+}
+
+int bt_mesh_msg_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+		     struct net_buf_simple *buf)
+{
+	msg_capture(model, buf);
+	return 0;
+}
+
+int32_t bt_mesh_model_pub_period_get(struct bt_mesh_model *mod)
+{
+	return PUB_PERIOD_MS;
+}
+
+int bt_mesh_model_extend(struct bt_mesh_model *mod, struct bt_mesh_model *base_mod)
+{
+	return 0;
+}
+
+int bt_mesh_model_data_store(struct bt_mesh_model *model, bool vnd,
+			     const char *name, const void *data,
+			     size_t data_len)
+{
+	return 0;
+}
+
+/** End Mocks **************************************/
+
+/* Value of the first channel of every sensor and series column. */
+static int32_t sensor_val1;
+
+static void value_fill(const struct bt_mesh_sensor_type *type, struct sensor_value *value)
+{
+	for (int i = 0; i < type->channel_count; i++) {
+		value[i].val1 = sensor_val1 + i;
+		value[i].val2 = 0;
+	}
+}
+
+static int sensor_value_get(struct bt_mesh_sensor_srv *srv,
+			    struct bt_mesh_sensor *sensor,
+			    struct bt_mesh_msg_ctx *ctx,
+			    struct sensor_value *rsp)
+{
+	value_fill(sensor->type, rsp);
+	return 0;
+}
+
+static int series_value_get(struct bt_mesh_sensor_srv *srv,
+			    struct bt_mesh_sensor *sensor,
+			    struct bt_mesh_msg_ctx *ctx,
+			    uint32_t column_index,
+			    struct sensor_value *value)
+{
+	const struct bt_mesh_sensor_column *col = &sensor->series.columns[column_index];
+
+	value[0].val1 = sensor_val1;
+	value[0].val2 = 0;
+	value[1] = col->start;
+	value[2] = col->end;
+	return 0;
+}
+
+/* Sensors of the publishing server, with the length of their Marshalled
+ * Sensor Data in a Sensor Status message.
+ */
+
+/* 0x0016, 11 bytes */
+static struct bt_mesh_sensor power_range = {
+	.type = &bt_mesh_sensor_dev_power_range_spec,
+	.get = sensor_value_get,
+};
+
+/* 0x0042, 3 bytes */
+static struct bt_mesh_sensor motion = {
+	.type = &bt_mesh_sensor_motion_sensed,
+	.get = sensor_value_get,
+};
+
+/* 0x004E, 5 bytes */
+static struct bt_mesh_sensor light = {
+	.type = &bt_mesh_sensor_present_amb_light_level,
+	.get = sensor_value_get,
+};
+
+/* 0x004F, 3 bytes */
+static struct bt_mesh_sensor temp = {
+	.type = &bt_mesh_sensor_present_amb_temp,
+	.get = sensor_value_get,
+};
+
+static struct bt_mesh_sensor *const pub_sensors[] = {
+	&temp,
+	&motion,
+	&power_range,
+	&light,
+};
+
+static struct bt_mesh_sensor_srv pub_srv =
+	BT_MESH_SENSOR_SRV_INIT(pub_sensors, ARRAY_SIZE(pub_sensors));
+
+static struct bt_mesh_model pub_model = {
+	.user_data = &pub_srv,
+};
+
+static const struct bt_mesh_sensor_column columns[] = {
+	{ .start = { .val1 = 0 }, .end = { .val1 = 10 } },
+	{ .start = { .val1 = 10 }, .end = { .val1 = 20 } },
+};
+
+static struct bt_mesh_sensor runtime = {
+	.type = &bt_mesh_sensor_rel_runtime_in_a_dev_op_temp_range,
+	.get = sensor_value_get,
+	.series = {
+		.columns = columns,
+		.column_count = ARRAY_SIZE(columns),
+		.get = series_value_get,
+	},
+};
+
+static struct bt_mesh_sensor *const series_sensors[] = {
+	&runtime,
+};
+
+static struct bt_mesh_sensor_srv series_srv =
+	BT_MESH_SENSOR_SRV_INIT(series_sensors, ARRAY_SIZE(series_sensors));
+
+static struct bt_mesh_model series_model = {
+	.user_data = &series_srv,
+};
+
+static void srv_init(struct bt_mesh_model *model)
+{
+	struct bt_mesh_sensor_srv *srv = model->user_data;
+
+	for (int i = 0; i < srv->sensor_count; i++) {
+		memset(&srv->sensor_array[i]->state, 0,
+		       sizeof(srv->sensor_array[i]->state));
+	}
+
+#if CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE > 0
+	memset(srv->series_cache, 0, sizeof(srv->series_cache));
+#endif
+
+	zassert_ok(_bt_mesh_sensor_srv_cb.init(model));
+}
+
+static void op_call(struct bt_mesh_model *model, uint32_t opcode, struct net_buf_simple *buf)
+{
+	struct bt_mesh_msg_ctx ctx = {};
+
+	for (const struct bt_mesh_model_op *op = _bt_mesh_sensor_srv_op; op->func; op++) {
+		if (op->opcode == opcode) {
+			zassert_ok(op->func(model, &ctx, buf));
+			return;
+		}
+	}
+
+	zassert_unreachable("Unknown opcode 0x%06x", opcode);
+}
+
+static void status_expect(struct net_buf_simple *buf, struct bt_mesh_sensor *const *sensors,
+			  size_t count)
+{
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+
+	bt_mesh_model_msg_init(buf, BT_MESH_SENSOR_OP_STATUS);
+
+	for (size_t i = 0; i < count; i++) {
+		value_fill(sensors[i]->type, value);
+		zassert_ok(sensor_status_encode(buf, sensors[i], value));
+	}
+}
+
+static void pub_check(struct bt_mesh_sensor *const *sensors, size_t count)
+{
+	NET_BUF_SIMPLE_DEFINE(expected, BT_MESH_TX_SDU_MAX);
+
+	zassert_ok(pub_srv.pub.update(&pub_model));
+
+	status_expect(&expected, sensors, count);
+	zassert_equal(pub_srv.pub.msg->len, expected.len, "Wrong publication length");
+	zassert_mem_equal(pub_srv.pub.msg->data, expected.data, expected.len,
+			  "Wrong publication");
+}
+
+static void column_get(uint32_t col_index)
+{
+	NET_BUF_SIMPLE_DEFINE(buf, BT_MESH_SENSOR_MSG_MAXLEN_COLUMN_GET);
+
+	net_buf_simple_add_le16(&buf, runtime.type->id);
+	zassert_ok(sensor_ch_encode(&buf, bt_mesh_sensor_column_format_get(runtime.type),
+				    &columns[col_index].start));
+
+	op_call(&series_model, BT_MESH_SENSOR_OP_COLUMN_GET, &buf);
+	zassert_equal_ptr(sent_msg.model, &series_model, "No response");
+}
+
+static void column_status_expect(struct net_buf_simple *buf, uint32_t col_index)
+{
+	bt_mesh_model_msg_init(buf, BT_MESH_SENSOR_OP_COLUMN_STATUS);
+	net_buf_simple_add_le16(buf, runtime.type->id);
+	zassert_ok(sensor_column_encode(buf, &series_srv, &runtime, NULL, &columns[col_index]));
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(&sent_msg, 0, sizeof(sent_msg));
+	sensor_val1 = 10;
+
+	srv_init(&pub_model);
+	srv_init(&series_model);
+}
+
+ZTEST(sensor_srv_test, test_pub_all)
+{
+	Z_TEST_SKIP_IFDEF(CONFIG_BT_MESH_SENSOR_SRV_PUB_UNSEGMENTED);
+
+	/* All sensors are published in every period, in ID order. */
+	for (int i = 0; i < 2; i++) {
+		pub_check((struct bt_mesh_sensor *const[]){ &power_range, &motion, &light, &temp },
+			  4);
+	}
+}
+
+ZTEST(sensor_srv_test, test_pub_unsegmented)
+{
+	Z_TEST_SKIP_IFNDEF(CONFIG_BT_MESH_SENSOR_SRV_PUB_UNSEGMENTED);
+
+	/* The power range doesn't fit in an unsegmented message together with
+	 * any other sensor, and is published alone when it has waited the
+	 * longest.
+	 */
+	pub_check((struct bt_mesh_sensor *const[]){ &power_range }, 1);
+
+	/* The next sensors fill the message in the order of their previous
+	 * publication, and the temperature no longer fits.
+	 */
+	pub_check((struct bt_mesh_sensor *const[]){ &motion, &light }, 2);
+	zassert_true(pub_srv.pub.msg->len <= BT_MESH_SDU_UNSEG_MAX);
+
+	/* The temperature is published first. The power range and the light
+	 * level still don't fit, but the motion does.
+	 */
+	pub_check((struct bt_mesh_sensor *const[]){ &motion, &temp }, 2);
+	zassert_true(pub_srv.pub.msg->len <= BT_MESH_SDU_UNSEG_MAX);
+
+	/* The power range has now waited the longest. */
+	pub_check((struct bt_mesh_sensor *const[]){ &power_range }, 1);
+}
+
+ZTEST(sensor_srv_test, test_series_get)
+{
+	NET_BUF_SIMPLE_DEFINE(expected, BT_MESH_TX_SDU_MAX);
+	NET_BUF_SIMPLE_DEFINE(buf, BT_MESH_SENSOR_MSG_MAXLEN_SERIES_GET);
+
+	for (int i = 0; i < 3; i++) {
+		/* Change the values on the last round. */
+		sensor_val1 = (i < 2) ? 10 : 20;
+
+		bt_mesh_model_msg_init(&expected, BT_MESH_SENSOR_OP_SERIES_STATUS);
+		net_buf_simple_add_le16(&expected, runtime.type->id);
+		for (int j = 0; j < ARRAY_SIZE(columns); j++) {
+			zassert_ok(sensor_column_encode(&expected, &series_srv, &runtime, NULL,
+							&columns[j]));
+		}
+
+		net_buf_simple_reset(&buf);
+		net_buf_simple_add_le16(&buf, runtime.type->id);
+		op_call(&series_model, BT_MESH_SENSOR_OP_SERIES_GET, &buf);
+
+		zassert_equal(sent_msg.len, expected.len, "Wrong series length");
+		zassert_mem_equal(sent_msg.data, expected.data, expected.len, "Wrong series");
+	}
+}
+
+ZTEST(sensor_srv_test, test_series_cache)
+{
+#if CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE > 0
+	struct bt_mesh_sensor_series_cache *entry =
+		&series_srv.series_cache[runtime.type->id %
+					 CONFIG_BT_MESH_SENSOR_SRV_SERIES_CACHE_SIZE];
+	uint8_t value_len = sensor_value_len(runtime.type);
+	uint8_t fill[BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN];
+	uint8_t header_len;
+
+	BT_MESH_MODEL_BUF_DEFINE(expected, BT_MESH_SENSOR_OP_COLUMN_STATUS,
+				 BT_MESH_SENSOR_MSG_MAXLEN_COLUMN_STATUS);
+
+	/* The first Column Get fills the cache entry of the column. */
+	column_get(0);
+	column_status_expect(&expected, 0);
+	zassert_equal(sent_msg.len, expected.len, "Wrong column length");
+	zassert_mem_equal(sent_msg.data, expected.data, expected.len, "Wrong column");
+
+	header_len = expected.len - COLUMN_STATUS_HDR_LEN - value_len;
+	zassert_equal_ptr(entry->sensor, &runtime, "Column not cached");
+	zassert_equal(entry->column, 0, "Wrong column cached");
+	zassert_equal(entry->header_len, header_len, "Wrong header length");
+	zassert_equal(entry->value.len, value_len, "Wrong value length");
+
+	/* An unchanged column is served from the cache. */
+	memset(entry->header, 0xaa, entry->header_len);
+	memset(entry->value.data, 0xbb, entry->value.len);
+	column_get(0);
+	zassert_equal(sent_msg.len, expected.len, "Wrong column length");
+	memset(fill, 0xaa, sizeof(fill));
+	zassert_mem_equal(&sent_msg.data[COLUMN_STATUS_HDR_LEN], fill, header_len,
+			  "Header not cached");
+	memset(fill, 0xbb, sizeof(fill));
+	zassert_mem_equal(&sent_msg.data[COLUMN_STATUS_HDR_LEN + header_len], fill, value_len,
+			  "Value not cached");
+
+	/* A changed value is encoded again, while the column header is kept. */
+	sensor_val1 = 20;
+	column_get(0);
+	column_status_expect(&expected, 0);
+	memset(fill, 0xaa, sizeof(fill));
+	zassert_mem_equal(&sent_msg.data[COLUMN_STATUS_HDR_LEN], fill, header_len,
+			  "Header not cached");
+	zassert_mem_equal(&sent_msg.data[COLUMN_STATUS_HDR_LEN + header_len],
+			  &expected.data[COLUMN_STATUS_HDR_LEN + header_len], value_len,
+			  "Changed value not encoded");
+
+	/* A new sample drops the cached values of the sensor. */
+	memset(entry->value.data, 0xbb, entry->value.len);
+	zassert_ok(bt_mesh_sensor_srv_sample(&series_srv, &runtime));
+	zassert_equal_ptr(entry->sensor, &runtime, "Column header dropped");
+	zassert_equal(entry->value.len, 0, "Value cache not cleared by sample");
+
+	column_get(0);
+	zassert_mem_equal(&sent_msg.data[COLUMN_STATUS_HDR_LEN + header_len],
+			  &expected.data[COLUMN_STATUS_HDR_LEN + header_len], value_len,
+			  "Stale value after sample");
+
+	/* A reset drops the cached values too. */
+	zassert_equal(entry->value.len, value_len, "Value not cached");
+	_bt_mesh_sensor_srv_cb.reset(&series_model);
+	zassert_equal(entry->value.len, 0, "Value cache not cleared by reset");
+#else
+	ztest_test_skip();
+#endif
+}
+
+ZTEST(sensor_srv_test, test_value_cache)
+{
+#if defined(CONFIG_BT_MESH_SENSOR_SRV_VALUE_CACHE)
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+	uint8_t value_len = sensor_value_len(temp.type);
+	uint8_t fill[BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN];
+
+	NET_BUF_SIMPLE_DEFINE(expected, BT_MESH_TX_SDU_MAX);
+
+	status_expect(&expected, (struct bt_mesh_sensor *const[]){ &temp }, 1);
+
+	/* A sample fills the cache. */
+	zassert_ok(bt_mesh_sensor_srv_sample(&pub_srv, &temp));
+	zassert_equal(sent_msg.len, expected.len, "Wrong status length");
+	zassert_mem_equal(sent_msg.data, expected.data, expected.len, "Wrong status");
+	zassert_equal(temp.state.enc.len, value_len, "Value not cached");
+
+	/* An unchanged value is served from the cache. */
+	memset(temp.state.enc.data, 0xaa, temp.state.enc.len);
+	value_fill(temp.type, value);
+	zassert_ok(bt_mesh_sensor_srv_pub(&pub_srv, NULL, &temp, value));
+	memset(fill, 0xaa, sizeof(fill));
+	zassert_mem_equal(&sent_msg.data[sent_msg.len - value_len], fill, value_len,
+			  "Value not cached");
+
+	/* A new sample of the same value is encoded again. */
+	zassert_ok(bt_mesh_sensor_srv_sample(&pub_srv, &temp));
+	zassert_equal(sent_msg.len, expected.len, "Wrong status length");
+	zassert_mem_equal(sent_msg.data, expected.data, expected.len,
+			  "Stale value after sample");
+
+	/* A reset drops the cache. */
+	_bt_mesh_sensor_srv_cb.reset(&pub_model);
+	zassert_equal(temp.state.enc.len, 0, "Value cache not cleared by reset");
+#else
+	ztest_test_skip();
+#endif
+}
+
+ZTEST_SUITE(sensor_srv_test, NULL, NULL, before, NULL, NULL);
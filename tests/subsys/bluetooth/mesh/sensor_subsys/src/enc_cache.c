@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/mesh/properties.h>
+#include <bluetooth/mesh/sensor_types.h>
+#include <sensor.h> // private header from the source folder
+
+static void value_fill(const struct bt_mesh_sensor_type *type, struct sensor_value *value,
+		       int32_t val1)
+{
+	for (int i = 0; i < type->channel_count; i++) {
+		value[i].val1 = val1 + i;
+		value[i].val2 = 0;
+	}
+}
+
+ZTEST(sensor_enc_cache_test, test_value_encode_cached)
+{
+	const struct bt_mesh_sensor_type *type = &bt_mesh_sensor_present_amb_temp;
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+	struct bt_mesh_sensor_enc_cache cache = {};
+	int err;
+
+	NET_BUF_SIMPLE_DEFINE(expected, BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN);
+	NET_BUF_SIMPLE_DEFINE(buf, BT_MESH_SENSOR_ENCODED_VALUE_MAXLEN);
+
+	value_fill(type, value, 21);
+	zassert_ok(sensor_value_encode(&expected, type, value));
+
+	/* The first encoding fills the cache. */
+	err = sensor_value_encode_cached(&buf, type, value, &cache);
+	zassert_ok(err);
+	zassert_equal(cache.len, expected.len);
+	zassert_mem_equal(buf.data, expected.data, expected.len);
+	zassert_mem_equal(cache.data, expected.data, expected.len);
+
+	/* An unchanged value is served from the cache. */
+	memset(cache.data, 0xaa, cache.len);
+	net_buf_simple_reset(&buf);
+	err = sensor_value_encode_cached(&buf, type, value, &cache);
+	zassert_ok(err);
+	zassert_equal(buf.len, cache.len);
+	zassert_mem_equal(buf.data, cache.data, cache.len);
+
+	/* A changed value is encoded again. */
+	value_fill(type, value, 22);
+	net_buf_simple_reset(&expected);
+	zassert_ok(sensor_value_encode(&expected, type, value));
+	net_buf_simple_reset(&buf);
+	err = sensor_value_encode_cached(&buf, type, value, &cache);
+	zassert_ok(err);
+	zassert_equal(buf.len, expected.len);
+	zassert_mem_equal(buf.data, expected.data, expected.len);
+	zassert_mem_equal(cache.data, expected.data, expected.len);
+
+	/* An emptied cache is filled again. */
+	cache.len = 0;
+	net_buf_simple_reset(&buf);
+	err = sensor_value_encode_cached(&buf, type, value, &cache);
+	zassert_ok(err);
+	zassert_equal(cache.len, expected.len);
+	zassert_mem_equal(buf.data, expected.data, expected.len);
+
+	/* Cache hits respect the buffer size. */
+	net_buf_simple_reset(&buf);
+	net_buf_simple_add(&buf, net_buf_simple_tailroom(&buf) - cache.len + 1);
+	err = sensor_value_encode_cached(&buf, type, value, &cache);
+	zassert_equal(err, -ENOMEM);
+}
+
+ZTEST(sensor_enc_cache_test, test_status_encode_cached)
+{
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+
+	NET_BUF_SIMPLE_DEFINE(expected, BT_MESH_SENSOR_STATUS_MAXLEN);
+	NET_BUF_SIMPLE_DEFINE(buf, BT_MESH_SENSOR_STATUS_MAXLEN);
+
+	STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		struct bt_mesh_sensor sensor = { .type = type };
+
+		memset(value, 0, sizeof(value));
+
+		/* Skip the sensor types that can't represent zero. */
+		net_buf_simple_reset(&expected);
+		if (sensor_status_encode(&expected, &sensor, value)) {
+			continue;
+		}
+
+		zassert_equal(sensor_status_len(type), expected.len,
+			      "Wrong status length for 0x%04x", type->id);
+
+		for (int i = 0; i < 2; i++) {
+			net_buf_simple_reset(&buf);
+			zassert_ok(sensor_status_encode_cached(&buf, &sensor, value));
+			zassert_equal(buf.len, expected.len);
+			zassert_mem_equal(buf.data, expected.data, expected.len,
+					  "Wrong status for 0x%04x", type->id);
+		}
+	}
+}
+
+ZTEST_SUITE(sensor_enc_cache_test, NULL, NULL, NULL, NULL, NULL);
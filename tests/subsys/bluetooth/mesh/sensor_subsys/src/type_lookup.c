@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/mesh/properties.h>
+#include <bluetooth/mesh/sensor_types.h>
+#include <sensor.h> // private header from the source folder
+
+#define BENCHMARK_ROUNDS 100
+
+/* Reference implementation, walking the whole sensor type list. */
+static const struct bt_mesh_sensor_type *linear_type_get(uint16_t id)
+{
+	STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		if (type->id == id) {
+			return type;
+		}
+	}
+
+	return NULL;
+}
+
+ZTEST(sensor_type_lookup_test, test_sorted)
+{
+	const struct bt_mesh_sensor_type *prev = NULL;
+	int count = 0;
+
+	STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		if (prev) {
+			zassert_true(prev->id < type->id,
+				     "Sensor type 0x%04x is out of order after 0x%04x",
+				     type->id, prev->id);
+		}
+
+		prev = type;
+		count++;
+	}
+
+	zassert_true(count > 0, "No sensor types");
+}
+
+ZTEST(sensor_type_lookup_test, test_lookup)
+{
+	/* Every ID, known or not, gives the same result as the full list walk. */
+	for (uint32_t id = 0; id <= UINT16_MAX; id++) {
+		zassert_equal_ptr(bt_mesh_sensor_type_get(id), linear_type_get(id),
+				  "Wrong sensor type for 0x%04x", id);
+	}
+
+	STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		zassert_equal_ptr(bt_mesh_sensor_type_get(type->id), type,
+				  "Sensor type 0x%04x not found", type->id);
+	}
+}
+
+ZTEST(sensor_type_lookup_test, test_lookup_benchmark)
+{
+	const struct bt_mesh_sensor_type *last = NULL;
+	uint32_t linear_cycles;
+	uint32_t cycles;
+	uint32_t start;
+	int count;
+
+	STRUCT_SECTION_COUNT(bt_mesh_sensor_type, &count);
+
+	/* Look up the last type of the list and an unknown ID, the worst cases of a list walk. */
+	STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		last = type;
+	}
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+		zassert_not_null(linear_type_get(last->id));
+		zassert_is_null(linear_type_get(BT_MESH_PROP_ID_PROHIBITED));
+	}
+	linear_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+		zassert_not_null(bt_mesh_sensor_type_get(last->id));
+		zassert_is_null(bt_mesh_sensor_type_get(BT_MESH_PROP_ID_PROHIBITED));
+	}
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("%d sensor types: %u cycles per lookup, %u cycles with a list walk\n", count,
+		 cycles / (2 * BENCHMARK_ROUNDS), linear_cycles / (2 * BENCHMARK_ROUNDS));
+}
+
+ZTEST_SUITE(sensor_type_lookup_test, NULL, NULL, NULL, NULL, NULL);
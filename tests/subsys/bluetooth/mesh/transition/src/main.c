@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdlib.h>
+#include <zephyr/ztest.h>
+#include <bluetooth/mesh/transition.h>
+
+#define STEP_INTERVAL CONFIG_BT_MESH_TRANSITION_STEP_INTERVAL
+/* Number of elements recalling the same scene. */
+#define ELEM_COUNT 8
+
+struct test_trans {
+	struct bt_mesh_transition trans;
+	int64_t start_time;
+	uint32_t duration;
+	int32_t start;
+	int32_t target;
+	int32_t value;
+	int steps;
+	bool done;
+};
+
+static struct test_trans test_trans[ELEM_COUNT];
+
+/* Wakeups of the transition engine, counted as the distinct step times. */
+static int wakeups;
+static int64_t last_step_time;
+
+static void step(struct bt_mesh_transition *trans, int32_t value)
+{
+	struct test_trans *t = CONTAINER_OF(trans, struct test_trans, trans);
+	int64_t now = k_uptime_get();
+	int64_t delta = (int64_t)t->target - t->start;
+	int64_t elapsed;
+	int64_t expected;
+
+	if (now != last_step_time) {
+		last_step_time = now;
+		wakeups++;
+	}
+
+	zassert_false(t->done, "Step after the end of the transition");
+	zassert_not_equal(value, t->value, "Step without a new value");
+	zassert_true(now >= t->start_time, "Step during the delay");
+
+	elapsed = now - t->start_time;
+	if (elapsed >= t->duration) {
+		/* The end is aligned to the step interval. */
+		zassert_equal(value, t->target);
+		zassert_true(elapsed < t->duration + STEP_INTERVAL, "Late end: %lld ms",
+			     elapsed - t->duration);
+		t->done = true;
+	} else {
+		expected = t->start + (delta * elapsed) / t->duration;
+		/* One step of slack on each side, for timing jitter. */
+		zassert_true(llabs(value - expected) <= llabs(delta) / t->duration + 1,
+			     "Value %d at %lld ms, expected %lld", value, elapsed, expected);
+		/* The value always moves towards the target. */
+		zassert_true(delta > 0 ? value > t->value : value < t->value);
+	}
+
+	t->value = value;
+	t->steps++;
+
+	zassert_equal(bt_mesh_transition_present_get(trans), value);
+}
+
+static int begins;
+
+static void begin(struct bt_mesh_transition *trans, int32_t value)
+{
+	struct test_trans *t = CONTAINER_OF(trans, struct test_trans, trans);
+
+	zassert_true(k_uptime_get() >= t->start_time, "Begin during the delay");
+	zassert_equal(t->steps, 0, "Begin after a step");
+	zassert_equal(value, t->start);
+	begins++;
+}
+
+static void trans_start(struct test_trans *t, int32_t start, int32_t target,
+			const struct bt_mesh_model_transition *transition)
+{
+	t->start = start;
+	t->target = target;
+	t->value = start;
+	t->steps = 0;
+	t->done = false;
+	t->start_time = k_uptime_get() + (transition ? transition->delay : 0);
+	t->duration = transition ? transition->time : 0;
+
+	bt_mesh_transition_start(&t->trans, start, target, transition);
+}
+
+static void setup(void *f)
+{
+	for (int i = 0; i < ELEM_COUNT; i++) {
+		test_trans[i].trans = (struct bt_mesh_transition)BT_MESH_TRANSITION_INIT(step);
+	}
+
+	wakeups = 0;
+	last_step_time = -1;
+	begins = 0;
+}
+
+static void teardown(void *f)
+{
+	for (int i = 0; i < ELEM_COUNT; i++) {
+		bt_mesh_transition_stop(&test_trans[i].trans);
+	}
+}
+
+/* Verify that the interpolated values follow a straight line to the target. */
+ZTEST(transition_test, test_interpolation)
+{
+	const struct {
+		int32_t start;
+		int32_t target;
+		uint32_t time;
+	} params[] = {
+		{ 0, UINT16_MAX, 1000 },
+		{ UINT16_MAX, 0, 1000 },
+		{ INT16_MIN, INT16_MAX, 300 },
+		{ 100, -100, 2000 },
+		{ 0, 3, 1000 },
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(params); i++) {
+		struct bt_mesh_model_transition transition = { .time = params[i].time };
+		struct test_trans *t = &test_trans[0];
+
+		trans_start(t, params[i].start, params[i].target, &transition);
+		zassert_true(bt_mesh_transition_in_progress(&t->trans));
+		zassert_equal(bt_mesh_transition_target_get(&t->trans), params[i].target);
+
+		k_sleep(K_MSEC(params[i].time + STEP_INTERVAL));
+
+		zassert_true(t->done, "Transition %d did not end", i);
+		zassert_false(bt_mesh_transition_in_progress(&t->trans));
+		zassert_equal(bt_mesh_transition_remaining_get(&t->trans), 0);
+		zassert_equal(bt_mesh_transition_present_get(&t->trans), params[i].target);
+
+		/* Slow transitions only step when the value changes. */
+		zassert_true(t->steps <= MIN(abs(params[i].target - params[i].start),
+					     params[i].time / STEP_INTERVAL + 1),
+			     "Transition %d: %d steps", i, t->steps);
+	}
+}
+
+/* Verify that the value stays unchanged during the delay. */
+ZTEST(transition_test, test_delay)
+{
+	struct bt_mesh_model_transition transition = { .time = 200, .delay = 100 };
+	struct test_trans *t = &test_trans[0];
+
+	trans_start(t, 0, 1000, &transition);
+	zassert_equal(bt_mesh_transition_remaining_get(&t->trans), 200);
+
+	k_sleep(K_MSEC(90));
+	zassert_equal(t->steps, 0);
+	zassert_equal(bt_mesh_transition_remaining_get(&t->trans), 200);
+
+	k_sleep(K_MSEC(110));
+	zassert_true(t->steps > 0);
+	zassert_within(bt_mesh_transition_remaining_get(&t->trans), 100, 1);
+
+	k_sleep(K_MSEC(100 + STEP_INTERVAL));
+	zassert_true(t->done);
+
+	/* A delayed change without a transition time happens at the end of the delay. */
+	transition.time = 0;
+	trans_start(t, 1000, 0, &transition);
+	k_sleep(K_MSEC(90));
+	zassert_equal(t->steps, 0);
+	k_sleep(K_MSEC(10 + STEP_INTERVAL));
+	zassert_true(t->done);
+	zassert_equal(t->steps, 1);
+}
+
+/* Verify that instantaneous changes are applied before returning. */
+ZTEST(transition_test, test_instantaneous)
+{
+	struct bt_mesh_model_transition transition = { 0 };
+	struct test_trans *t = &test_trans[0];
+
+	trans_start(t, 0, 1000, NULL);
+	zassert_true(t->done);
+	zassert_false(bt_mesh_transition_in_progress(&t->trans));
+
+	trans_start(t, 1000, 0, &transition);
+	zassert_true(t->done);
+	zassert_equal(bt_mesh_transition_present_get(&t->trans), 0);
+}
+
+/* Verify that the begin handler is called once at the start of a transition,
+ * so that binary states need a single wakeup at the end of the delay.
+ */
+ZTEST(transition_test, test_begin)
+{
+	struct bt_mesh_model_transition transition = { .time = 200, .delay = 100 };
+	struct test_trans *t = &test_trans[0];
+
+	t->trans.begin = begin;
+
+	trans_start(t, 0, 1, &transition);
+	k_sleep(K_MSEC(90));
+	zassert_equal(begins, 0);
+
+	k_sleep(K_MSEC(10 + STEP_INTERVAL));
+	zassert_equal(begins, 1);
+	zassert_equal(t->steps, 0);
+
+	k_sleep(K_MSEC(200 + STEP_INTERVAL));
+	zassert_true(t->done);
+	zassert_equal(begins, 1);
+	zassert_equal(t->steps, 1);
+
+	/* Without a delay, the transition begins before returning. */
+	transition.delay = 0;
+	trans_start(t, 1, 0, &transition);
+	zassert_equal(begins, 2);
+	zassert_equal(t->steps, 0);
+
+	/* Instantaneous changes only step. */
+	trans_start(t, 0, 1, NULL);
+	zassert_equal(begins, 2);
+	zassert_true(t->done);
+}
+
+/* Verify that stopped and replaced transitions don't step again. */
+ZTEST(transition_test, test_stop)
+{
+	struct bt_mesh_model_transition transition = { .time = 1000 };
+	struct test_trans *t = &test_trans[0];
+	int32_t present;
+	int steps;
+
+	trans_start(t, 0, 10000, &transition);
+	k_sleep(K_MSEC(500));
+	bt_mesh_transition_stop(&t->trans);
+	zassert_false(bt_mesh_transition_in_progress(&t->trans));
+
+	present = bt_mesh_transition_present_get(&t->trans);
+	zassert_within(present, 5000, 2 * 10000 * STEP_INTERVAL / 1000);
+	steps = t->steps;
+	k_sleep(K_MSEC(1000));
+	zassert_equal(t->steps, steps);
+	zassert_equal(bt_mesh_transition_present_get(&t->trans), present);
+
+	/* Restart from the present value, then replace with a new target. */
+	trans_start(t, present, 0, &transition);
+	k_sleep(K_MSEC(500));
+	trans_start(t, bt_mesh_transition_present_get(&t->trans), 10000, &transition);
+	k_sleep(K_MSEC(1000 + STEP_INTERVAL));
+	zassert_true(t->done);
+}
+
+/* Verify that transitions started together share their wakeups, as when a
+ * scene is recalled on several elements.
+ */
+ZTEST(transition_test, test_coalesced_wakeups)
+{
+	struct bt_mesh_model_transition transition = { .time = 1000 };
+	int steps = 0;
+
+	for (int i = 0; i < ELEM_COUNT; i++) {
+		trans_start(&test_trans[i], 0, UINT16_MAX - i * 1000, &transition);
+	}
+
+	k_sleep(K_MSEC(1000 + STEP_INTERVAL));
+
+	for (int i = 0; i < ELEM_COUNT; i++) {
+		zassert_true(test_trans[i].done, "Transition %d did not end", i);
+		steps += test_trans[i].steps;
+	}
+
+	/* All elements step in the same wakeup, once per step interval. */
+	zassert_true(wakeups <= 1000 / STEP_INTERVAL + 1, "%d wakeups", wakeups);
+	zassert_true(steps >= ELEM_COUNT * wakeups - ELEM_COUNT, "%d steps", steps);
+	TC_PRINT("%d transitions: %d wakeups for %d steps\n", ELEM_COUNT, wakeups, steps);
+
+	/* Transitions started at different times step on the same interval. */
+	wakeups = 0;
+	for (int i = 0; i < ELEM_COUNT; i++) {
+		trans_start(&test_trans[i], 0, UINT16_MAX, &transition);
+		k_sleep(K_MSEC(STEP_INTERVAL / 4));
+	}
+
+	k_sleep(K_MSEC(1000 + STEP_INTERVAL));
+	zassert_true(wakeups <= (1000 + ELEM_COUNT * STEP_INTERVAL / 4) / STEP_INTERVAL + 2,
+		     "%d wakeups", wakeups);
+}
+
+ZTEST_SUITE(transition_test, NULL, NULL, setup, teardown, NULL);
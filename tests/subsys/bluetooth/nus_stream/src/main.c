@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <bluetooth/services/nus_stream.h>
+
+#define MTU 247
+#define PDU_LEN (MTU - 3)
+#define CHUNK_LEN 20
+#define DATA_LEN (4 * CONFIG_BT_NUS_STREAM_BUF_SIZE)
+#define CONN_INTERVAL K_USEC(7500)
+#define PDUS_PER_EVENT 2
+
+static struct bt_nus_stream stream;
+/* Connection objects are only used as handles. */
+static uint8_t conn;
+
+static uint8_t tx_data[DATA_LEN];
+static uint8_t rx_data[DATA_LEN];
+static size_t rx_len;
+static uint32_t pdus;
+static uint32_t full_pdus;
+static atomic_t pending;
+static atomic_t max_pending;
+
+static uint32_t events;
+
+static int fake_send(struct bt_nus_stream *s, const uint8_t *data, uint16_t len)
+{
+	atomic_val_t in_flight = atomic_inc(&pending) + 1;
+
+	zassert_true(len <= PDU_LEN);
+	zassert_true(rx_len + len <= sizeof(rx_data));
+
+	memcpy(&rx_data[rx_len], data, len);
+	rx_len += len;
+	pdus++;
+	if (len == PDU_LEN) {
+		full_pdus++;
+	}
+
+	if (in_flight > atomic_get(&max_pending)) {
+		atomic_set(&max_pending, in_flight);
+	}
+
+	return 0;
+}
+
+static uint16_t fake_max_len(struct bt_nus_stream *s)
+{
+	return PDU_LEN;
+}
+
+static const struct bt_nus_stream_transport fake_transport = {
+	.send = fake_send,
+	.max_len = fake_max_len,
+};
+
+/* A connection event sends a limited number of the PDUs in flight. */
+static void conn_event(struct k_timer *timer)
+{
+	int sent = MIN(atomic_get(&pending), PDUS_PER_EVENT);
+
+	for (int i = 0; i < sent; i++) {
+		atomic_dec(&pending);
+		bt_nus_stream_sent(&stream);
+	}
+
+	if (sent) {
+		events++;
+	}
+}
+
+K_TIMER_DEFINE(conn_timer, conn_event, NULL);
+
+static void drain(void)
+{
+	while (atomic_get(&pending) || ring_buf_size_get(&stream.rb)) {
+		conn_event(NULL);
+		k_sleep(K_MSEC(1));
+	}
+}
+
+static void verify_data(size_t len)
+{
+	zassert_equal(rx_len, len);
+	zassert_mem_equal(rx_data, tx_data, len);
+	zassert_equal(stream.stats.bytes, len);
+	zassert_equal(stream.stats.pdus, pdus);
+	zassert_true(atomic_get(&max_pending) <= CONFIG_BT_NUS_STREAM_MAX_IN_FLIGHT);
+}
+
+static void *setup(void)
+{
+	for (size_t i = 0; i < sizeof(tx_data); i++) {
+		tx_data[i] = i % 251;
+	}
+
+	bt_nus_stream_init(&stream, &fake_transport);
+
+	return NULL;
+}
+
+static void before(void *f)
+{
+	rx_len = 0;
+	pdus = 0;
+	full_pdus = 0;
+	events = 0;
+	atomic_set(&pending, 0);
+	atomic_set(&max_pending, 0);
+
+	bt_nus_stream_open(&stream, (struct bt_conn *)&conn);
+}
+
+static void after(void *f)
+{
+	k_timer_stop(&conn_timer);
+	bt_nus_stream_close(&stream);
+}
+
+/* Small writes are coalesced into full PDUs while PDUs are in flight. */
+ZTEST(nus_stream_test, test_coalescing)
+{
+	size_t len = 0;
+
+	while (len < CONFIG_BT_NUS_STREAM_BUF_SIZE) {
+		zassert_equal(bt_nus_stream_write(&stream, &tx_data[len], CHUNK_LEN, K_NO_WAIT),
+			      CHUNK_LEN);
+		len += CHUNK_LEN;
+		k_sleep(K_MSEC(1));
+
+		/* One connection event for every 10 chunks. */
+		if (!(len % (10 * CHUNK_LEN))) {
+			conn_event(NULL);
+		}
+	}
+
+	drain();
+	verify_data(len);
+
+	TC_PRINT("%u bytes in %u PDUs, %u full\n", (uint32_t)len, pdus, full_pdus);
+	zassert_true(pdus < len / CHUNK_LEN / 2, "Chunks not coalesced");
+	zassert_true(full_pdus > 0);
+}
+
+/* The writer waits for the PDUs in flight to free up space in the buffer. */
+ZTEST(nus_stream_test, test_backpressure)
+{
+	int written;
+
+	written = bt_nus_stream_write(&stream, tx_data, DATA_LEN, K_NO_WAIT);
+	zassert_true(written >= CONFIG_BT_NUS_STREAM_BUF_SIZE);
+	zassert_true(written < DATA_LEN);
+
+	/* Without connection events, the PDUs in flight are capped. */
+	k_sleep(K_MSEC(1));
+	zassert_equal(atomic_get(&pending), CONFIG_BT_NUS_STREAM_MAX_IN_FLIGHT);
+	written += bt_nus_stream_write(&stream, &tx_data[written], DATA_LEN - written, K_NO_WAIT);
+	zassert_equal(written, CONFIG_BT_NUS_STREAM_BUF_SIZE +
+			       PDU_LEN * CONFIG_BT_NUS_STREAM_MAX_IN_FLIGHT);
+
+	k_timer_start(&conn_timer, CONN_INTERVAL, CONN_INTERVAL);
+
+	zassert_equal(bt_nus_stream_write(&stream, &tx_data[written], DATA_LEN - written,
+					  K_FOREVER),
+		      DATA_LEN - written);
+
+	k_timer_stop(&conn_timer);
+	drain();
+	verify_data(DATA_LEN);
+}
+
+/* With a steady producer, every connection event carries full PDUs. */
+ZTEST(nus_stream_test, test_throughput)
+{
+	uint32_t events_start;
+
+	k_timer_start(&conn_timer, CONN_INTERVAL, CONN_INTERVAL);
+
+	for (size_t len = 0; len < DATA_LEN; len += CHUNK_LEN) {
+		zassert_equal(bt_nus_stream_write(&stream, &tx_data[len],
+						  MIN(CHUNK_LEN, DATA_LEN - len), K_FOREVER),
+			      MIN(CHUNK_LEN, DATA_LEN - len));
+	}
+
+	events_start = events;
+	k_timer_stop(&conn_timer);
+	drain();
+	verify_data(DATA_LEN);
+
+	TC_PRINT("%u bytes per connection event, %u bytes per PDU\n",
+		 (uint32_t)DATA_LEN / MAX(events, 1), (uint32_t)DATA_LEN / pdus);
+	zassert_true(events_start > 0);
+	zassert_true(full_pdus >= pdus / 2, "PDUs not filled");
+}
+
+ZTEST(nus_stream_test, test_closed)
+{
+	zassert_equal(bt_nus_stream_write(&stream, tx_data, CHUNK_LEN, K_NO_WAIT), CHUNK_LEN);
+
+	bt_nus_stream_close(&stream);
+	zassert_equal(bt_nus_stream_write(&stream, tx_data, CHUNK_LEN, K_NO_WAIT), -ENOTCONN);
+	zassert_equal(ring_buf_size_get(&stream.rb), 0);
+
+	/* Completions of PDUs sent before the stream was reopened are ignored. */
+	bt_nus_stream_open(&stream, (struct bt_conn *)&conn);
+	bt_nus_stream_sent(&stream);
+	zassert_equal(atomic_get(&stream.in_flight), 0);
+}
+
+ZTEST_SUITE(nus_stream_test, NULL, setup, before, after, NULL);
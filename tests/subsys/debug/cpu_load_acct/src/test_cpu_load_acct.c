@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <debug/cpu_load.h>
+
+#define STACK_SIZE 1024
+#define HEAVY_BUSY_US 20000
+#define LIGHT_BUSY_US 5000
+#define EXIT_BUSY_US 1000
+
+K_SEM_DEFINE(heavy_sem, 0, 1);
+K_SEM_DEFINE(light_sem, 0, 1);
+K_SEM_DEFINE(done_sem, 0, 2);
+
+static void busy_thread_fn(void *p1, void *p2, void *p3)
+{
+	struct k_sem *sem = p1;
+	uint32_t busy_us = POINTER_TO_UINT(p2);
+
+	while (true) {
+		k_sem_take(sem, K_FOREVER);
+		k_busy_wait(busy_us);
+		k_sem_give(&done_sem);
+	}
+}
+
+K_THREAD_DEFINE(heavy_thread, STACK_SIZE, busy_thread_fn,
+		&heavy_sem, UINT_TO_POINTER(HEAVY_BUSY_US), NULL,
+		K_PRIO_PREEMPT(1), 0, 0);
+K_THREAD_DEFINE(light_thread, STACK_SIZE, busy_thread_fn,
+		&light_sem, UINT_TO_POINTER(LIGHT_BUSY_US), NULL,
+		K_PRIO_PREEMPT(1), 0, 0);
+
+struct find_ctx {
+	const struct k_thread *thread;
+	uint64_t cycles;
+};
+
+static void find_cb(const struct cpu_load_acct_entry *entry, void *user_data)
+{
+	struct find_ctx *ctx = user_data;
+
+	if ((entry->type == CPU_LOAD_ACCT_THREAD) &&
+	    (entry->thread == ctx->thread)) {
+		ctx->cycles = entry->cycles;
+	}
+}
+
+static uint64_t thread_cycles_get(k_tid_t thread)
+{
+	struct find_ctx ctx = {
+		.thread = thread,
+	};
+
+	cpu_load_acct_foreach(find_cb, &ctx);
+
+	return ctx.cycles;
+}
+
+#define EXIT_THREADS (2 * CONFIG_CPU_LOAD_ACCOUNTING_THREADS)
+
+K_THREAD_STACK_DEFINE(exit_stack, STACK_SIZE);
+static struct k_thread exit_threads[EXIT_THREADS];
+
+static void exit_thread_fn(void *p1, void *p2, void *p3)
+{
+	uint64_t *cycles = p1;
+
+	k_busy_wait(EXIT_BUSY_US);
+	*cycles = thread_cycles_get(k_current_get());
+}
+
+static uint64_t exit_thread_run(struct k_thread *thread)
+{
+	uint64_t cycles = 0;
+	k_tid_t tid = k_thread_create(thread, exit_stack,
+				      K_THREAD_STACK_SIZEOF(exit_stack),
+				      exit_thread_fn, &cycles, NULL, NULL,
+				      K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+
+	zassert_ok(k_thread_join(tid, K_SECONDS(1)), "Thread join timeout");
+	zassert_equal(thread_cycles_get(tid), 0, "Exited thread accounted");
+
+	return cycles;
+}
+
+static void run_load(void)
+{
+	k_sem_give(&heavy_sem);
+	k_sem_give(&light_sem);
+	zassert_ok(k_sem_take(&done_sem, K_SECONDS(1)), "Heavy thread timeout");
+	zassert_ok(k_sem_take(&done_sem, K_SECONDS(1)), "Light thread timeout");
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	cpu_load_acct_reset();
+}
+
+ZTEST(cpu_load_acct, test_thread_accounting)
+{
+	uint64_t heavy;
+	uint64_t light;
+	uint64_t total;
+	uint64_t expected = k_us_to_cyc_floor64(HEAVY_BUSY_US);
+
+	run_load();
+
+	heavy = thread_cycles_get(heavy_thread);
+	light = thread_cycles_get(light_thread);
+	total = cpu_load_acct_total_get();
+
+	zassert_true(heavy >= expected, "Unexpected heavy cycles:%llu", heavy);
+	zassert_true(light < heavy, "Unexpected light cycles:%llu", light);
+	zassert_true(total >= heavy + light, "Unexpected total:%llu", total);
+}
+
+ZTEST(cpu_load_acct, test_top_n_history)
+{
+	struct cpu_load_acct_sample sample;
+	int err;
+
+	err = cpu_load_acct_history_get(0, &sample);
+	zassert_equal(err, -ENOENT, "Unexpected err:%d", err);
+
+	run_load();
+	cpu_load_acct_sample();
+
+	err = cpu_load_acct_history_get(0, &sample);
+	zassert_equal(err, 0, "Unexpected err:%d", err);
+	zassert_equal(sample.count, 2, "Unexpected count:%u", sample.count);
+	zassert_equal(sample.top[0].type, CPU_LOAD_ACCT_THREAD, NULL);
+	zassert_equal(sample.top[0].thread, heavy_thread, NULL);
+	zassert_true(sample.top[0].cycles >= sample.top[1].cycles, NULL);
+	zassert_true(sample.window >= sample.top[0].cycles, NULL);
+
+	/* Idle window does not charge the busy threads again. */
+	k_sleep(K_MSEC(10));
+	cpu_load_acct_sample();
+
+	err = cpu_load_acct_history_get(0, &sample);
+	zassert_equal(err, 0, "Unexpected err:%d", err);
+	for (size_t i = 0; i < sample.count; i++) {
+		zassert_not_equal(sample.top[i].thread, heavy_thread, NULL);
+	}
+
+	err = cpu_load_acct_history_get(1, &sample);
+	zassert_equal(err, 0, "Unexpected err:%d", err);
+	zassert_equal(sample.top[0].thread, heavy_thread, NULL);
+
+	err = cpu_load_acct_history_get(2, &sample);
+	zassert_equal(err, -ENOENT, "Unexpected err:%d", err);
+}
+
+ZTEST(cpu_load_acct, test_thread_exit)
+{
+	uint64_t shared = thread_cycles_get(NULL);
+	uint64_t expected = k_us_to_cyc_floor64(EXIT_BUSY_US);
+	uint64_t cycles;
+
+	/* Slots of exited threads are reused, so every thread is accounted
+	 * separately even if more threads than the table size were created.
+	 */
+	for (int i = 0; i < EXIT_THREADS; i++) {
+		cycles = exit_thread_run(&exit_threads[i]);
+		zassert_true(cycles >= expected, "Thread %d not accounted", i);
+	}
+
+	/* Cycles of the exited threads are kept in the shared entry. */
+	zassert_true(thread_cycles_get(NULL) >= shared + EXIT_THREADS * expected,
+		     "Unexpected shared cycles");
+}
+
+ZTEST_SUITE(cpu_load_acct, NULL, NULL, before, NULL, NULL);
@@ -22,7 +22,8 @@ enum test_states {
 	EMDS_TS_STORE_DATA,
 	EMDS_TS_CLEAR_FLASH,
 	EMDS_TS_NO_STORE,
-	EMDS_TS_SEVERAL_STORE
+	EMDS_TS_SEVERAL_STORE,
+	EMDS_TS_DIRTY_STORE
 };
 
 static int iteration;
@@ -30,11 +31,17 @@ static int iteration;
 static enum test_states state[] = {
 	EMDS_TS_EMPTY_FLASH,
 	EMDS_TS_STORE_DATA,
+	EMDS_TS_DIRTY_STORE,
 	EMDS_TS_SEVERAL_STORE,
 	EMDS_TS_CLEAR_FLASH,
 	EMDS_TS_EMPTY_FLASH,
 	EMDS_TS_NO_STORE,
+#if defined(CONFIG_EMDS_DIRTY_TRACKING)
+	/* Unchanged entries are carried forward by the prepare. */
+	EMDS_TS_STORE_DATA,
+#else
 	EMDS_TS_EMPTY_FLASH,
+#endif
 	EMDS_TS_CLEAR_FLASH,
 };
 
@@ -69,6 +76,8 @@ static char *print_state(enum test_states s)
 		return "SEVERAL_STORE";
 	case EMDS_TS_NO_STORE:
 		return "NO_STORE";
+	case EMDS_TS_DIRTY_STORE:
+		return "DIRTY_STORE";
 	default:
 		return "UNKNOWN";
 	}
@@ -152,6 +161,16 @@ static void load_flash(void)
 			  "Data has changed");
 }
 
+static void load_prepared(void)
+{
+	/* Only the entries that are stored after the prepare are invalidated. */
+	if (IS_ENABLED(CONFIG_EMDS_DIRTY_TRACKING)) {
+		load_flash();
+	} else {
+		load_empty_flash();
+	}
+}
+
 static void prepare(void)
 {
 	zassert_equal(emds_store(), -ECANCELED, "Prepare must be done before store");
@@ -163,13 +182,10 @@ static void prepare(void)
 	zassert_true(emds_is_ready(), "EMDS should be ready");
 }
 
-static void store(void)
+static void store_current(void)
 {
 	zassert_true(emds_is_ready(), "Store should be ready to execute");
 
-	memcpy(d_data, expect_d_data, sizeof(expect_d_data));
-	memcpy(s_data, expect_s_data, sizeof(expect_s_data));
-
 #if defined(CONFIG_BT) && !defined(CONFIG_BT_LL_SW_SPLIT)
 	/* Disable bluetooth and mpsl scheduler if bluetooth is enabled. */
 	(void) sdc_disable(); // Replace with bt_disable when added.
@@ -194,6 +210,21 @@ static void store(void)
 	       store_time_us, estimate_store_time_us);
 }
 
+static void store(void)
+{
+	memcpy(d_data, expect_d_data, sizeof(expect_d_data));
+	memcpy(s_data, expect_s_data, sizeof(expect_s_data));
+
+	store_current();
+}
+
+static uint32_t entry_store_time_us(size_t len)
+{
+	return NRFX_CEIL_DIV(len, 4) * CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US +
+	       NRFX_CEIL_DIV(8, 4) * CONFIG_EMDS_FLASH_TIME_WRITE_ONE_WORD_US +
+	       CONFIG_EMDS_FLASH_TIME_ENTRY_OVERHEAD_US;
+}
+
 static void clear(void)
 {
 	zassert_equal(emds_clear(), 0, "Clear failed");
@@ -239,6 +270,13 @@ static bool pragma_several_store(const void *s)
 	return *state == EMDS_TS_SEVERAL_STORE;
 }
 
+static bool pragma_dirty_store(const void *s)
+{
+	const enum test_states *state = s;
+
+	return *state == EMDS_TS_DIRTY_STORE;
+}
+
 #if CONFIG_SETTINGS
 static int emds_test_settings_set(const char *name, size_t len,
 				  settings_read_cb read_cb, void *cb_arg)
@@ -303,18 +341,60 @@ ZTEST(no_store, test_no_store)
 {
 	load_flash();
 	prepare();
-	load_empty_flash();
+	load_prepared();
 }
 
 ZTEST(several_store, test_several_store)
 {
 	load_flash();
 	prepare();
-	load_empty_flash();
+	load_prepared();
 	store();
 	load_flash();
 	prepare();
-	load_empty_flash();
+	load_prepared();
+	store();
+	load_flash();
+}
+
+ZTEST(dirty_store, test_dirty_store)
+{
+	static const uint8_t changed_d_data[10] = { 0x55 };
+	uint32_t worst_case_us = emds_store_time_get();
+
+	if (!IS_ENABLED(CONFIG_EMDS_DIRTY_TRACKING)) {
+		ztest_test_skip();
+	}
+
+	load_flash();
+	prepare();
+
+	/* All entries match the copies carried forward by the prepare. */
+	zassert_equal(emds_store_time_get(), CONFIG_EMDS_FLASH_TIME_BASE_OVERHEAD_US,
+		      "Unchanged entries are accounted");
+
+	d_data[1][0]++;
+	zassert_equal(emds_store_time_get(),
+		      CONFIG_EMDS_FLASH_TIME_BASE_OVERHEAD_US +
+		      entry_store_time_us(sizeof(d_data[1])),
+		      "Only the changed entry should be accounted");
+	d_data[1][0]--;
+
+	memcpy(d_data[2], changed_d_data, sizeof(changed_d_data));
+	store_current();
+	zassert_equal(emds_store_time_get(), worst_case_us,
+		      "All entries should be accounted when not ready");
+
+	/* The changed entry is stored, the others are read from the carried forward copies. */
+	memset(d_data, 0, sizeof(d_data));
+	memset(s_data, 0, sizeof(s_data));
+	zassert_equal(emds_load(), 0, "Load failed");
+	zassert_mem_equal(d_data, expect_d_data, sizeof(d_data[0]) * 2, "Data has changed");
+	zassert_mem_equal(d_data[2], changed_d_data, sizeof(changed_d_data),
+			  "Changed data not stored");
+	zassert_mem_equal(s_data, expect_s_data, sizeof(expect_s_data), "Data has changed");
+
+	prepare();
 	store();
 	load_flash();
 }
@@ -325,6 +405,7 @@ ZTEST_SUITE(store_data, pragma_store_data, NULL, NULL, NULL, NULL);
 ZTEST_SUITE(clear_flash, pragma_clear_flash, NULL, NULL, NULL, NULL);
 ZTEST_SUITE(no_store, pragma_no_store, NULL, NULL, NULL, NULL);
 ZTEST_SUITE(several_store, pragma_several_store, NULL, NULL, NULL, NULL);
+ZTEST_SUITE(dirty_store, pragma_dirty_store, NULL, NULL, NULL, NULL);
 
 void test_main(void)
 {
@@ -660,4 +660,129 @@ ZTEST(emds_flash_tests, test_write_speed)
 	zassert_true(store_time_us < 13000, "Storing 1024 bytes took to long time");
 }
 
+ZTEST(emds_flash_tests, test_keep_on_prepare)
+{
+	char data_old[9] = "Deadbeef";
+	char data_in[9] = "Livebeef";
+	char data_new[9] = "Beefbeef";
+	char data_out[9] = {0};
+	struct emds_entry entries[] = {
+		{0, (uint8_t *)data_in, sizeof(data_in)},
+		{2, (uint8_t *)data_in, sizeof(data_in)},
+		{4, (uint8_t *)data_in, sizeof(data_in)},
+	};
+	struct emds_flash_keep_entry keep[ARRAY_SIZE(entries)];
+	int byte_size = ARRAY_SIZE(entries) * (align_size(sizeof(data_in)) + sizeof(struct test_ate));
+
+	for (size_t i = 0; i < ARRAY_SIZE(keep); i++) {
+		keep[i].entry = &entries[i];
+	}
+
+	flash_clear();
+	device_reset();
+
+	uint32_t idx = m_test_fd.ate_idx_start;
+
+	for (size_t i = 0; i < 5; i++) {
+		entry_write(idx, i, data_old, sizeof(data_old));
+		idx -= sizeof(struct test_ate);
+	}
+
+	zassert_false(emds_flash_init(&ctx), "Error when initializing");
+	zassert_false(emds_flash_prepare_keep(&ctx, byte_size, keep, ARRAY_SIZE(keep)),
+		      "Error when preparing");
+
+	for (size_t i = 0; i < ARRAY_SIZE(keep); i++) {
+		zassert_not_equal(keep[i].ate_addr, 0, "Copy not written");
+		zassert_true(emds_flash_entry_cmp(&ctx, keep[i].ate_addr, data_in, sizeof(data_in)),
+			     "Copy does not hold the current data");
+	}
+
+	for (size_t i = 0; i < 5; i++) {
+		ssize_t len = emds_flash_read(&ctx, i, data_out, sizeof(data_out));
+
+		if (i % 2) {
+			zassert_false(len > 0, "Should not be able to read");
+		} else {
+			zassert_equal(len, sizeof(data_in), "Could not read");
+			zassert_false(memcmp(data_in, data_out, sizeof(data_in)), "Not same data");
+		}
+	}
+
+	/* Replace one of the entries and check that the new copy is read back. */
+	zassert_equal(emds_flash_write(&ctx, 2, data_new, sizeof(data_new)), sizeof(data_new),
+		      "Could not write");
+
+	/* The copies are written after the invalidated entries, which passes the recovery. */
+	device_reset();
+	zassert_false(emds_flash_init(&ctx), "Error when initializing");
+	zassert_false(ctx.force_erase, "Force erase should be false");
+
+	zassert_equal(emds_flash_read(&ctx, 2, data_out, sizeof(data_out)), sizeof(data_new),
+		      "Could not read");
+	zassert_false(memcmp(data_new, data_out, sizeof(data_new)), "Not same data");
+	zassert_equal(emds_flash_read(&ctx, 4, data_out, sizeof(data_out)), sizeof(data_in),
+		      "Could not read");
+	zassert_false(memcmp(data_in, data_out, sizeof(data_in)), "Not same data");
+
+	zassert_false(emds_flash_prepare_keep(&ctx, byte_size, keep, ARRAY_SIZE(keep)),
+		      "Error when preparing");
+
+	device_reset();
+	zassert_false(emds_flash_init(&ctx), "Error when initializing");
+	zassert_false(ctx.force_erase, "Force erase should be false");
+
+	/* The area must hold the copies and the next writes, otherwise no copy is written. */
+	byte_size = m_test_fd.size / 2;
+	zassert_false(emds_flash_prepare_keep(&ctx, byte_size, keep, ARRAY_SIZE(keep)),
+		      "Error when preparing");
+
+	for (size_t i = 0; i < ARRAY_SIZE(keep); i++) {
+		zassert_equal(keep[i].ate_addr, 0, "Copy should not be written");
+		zassert_true(emds_flash_read(&ctx, entries[i].id, data_out, sizeof(data_out)) < 0,
+			     "Should not be able to read");
+	}
+}
+
+ZTEST(emds_flash_tests, test_dirty_check_speed)
+{
+	uint8_t data_in_big[1024];
+	uint32_t ate_addr;
+	int64_t tic;
+	int64_t toc;
+	uint64_t cmp_time_us;
+	uint64_t store_time_us;
+
+	memset(data_in_big, 69, sizeof(data_in_big));
+
+	(void)flash_clear();
+	device_reset();
+
+	(void)emds_flash_init(&ctx);
+	(void)emds_flash_prepare(&ctx, sizeof(data_in_big) + ctx.ate_size);
+
+	ate_addr = ctx.ate_wra;
+	tic = k_uptime_ticks();
+	emds_flash_write(&ctx, 1, data_in_big, sizeof(data_in_big));
+	toc = k_uptime_ticks();
+	store_time_us = k_ticks_to_us_ceil64(toc - tic);
+
+	tic = k_uptime_ticks();
+	zassert_true(emds_flash_entry_cmp(&ctx, ate_addr, data_in_big, sizeof(data_in_big)),
+		     "Stored data should match");
+	toc = k_uptime_ticks();
+	cmp_time_us = k_ticks_to_us_ceil64(toc - tic);
+
+	printk("Comparing 1024 bytes took: %lldus, storing took: %lldus\n",
+	       cmp_time_us, store_time_us);
+	zassert_true(cmp_time_us * 10 < store_time_us,
+		     "Comparing stored data should be much faster than storing it");
+
+	data_in_big[sizeof(data_in_big) - 1]++;
+	zassert_false(emds_flash_entry_cmp(&ctx, ate_addr, data_in_big, sizeof(data_in_big)),
+		      "Changed data should not match");
+	zassert_false(emds_flash_entry_cmp(&ctx, ate_addr, data_in_big, sizeof(data_in_big) - 4),
+		      "Data of different length should not match");
+}
+
 ZTEST_SUITE(emds_flash_tests, NULL, fs_init, NULL, NULL, NULL);
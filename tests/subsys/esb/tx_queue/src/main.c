@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "esb_tx_queue.h"
+
+static struct esb_tx_queue q;
+
+/* Payload stored in each slot, used to check the ordering. */
+static uint32_t slot_data[CONFIG_ESB_TX_FIFO_SIZE];
+
+static void push(uint8_t pipe, uint32_t data)
+{
+	int slot = esb_tx_queue_alloc(&q);
+
+	zassert_true(slot >= 0, "Allocation failed");
+
+	slot_data[slot] = data;
+	esb_tx_queue_push(&q, pipe, slot);
+}
+
+/* Take the next packet the way the radio does: schedule, peek and pop. */
+static uint32_t transmit(uint8_t *pipe_out)
+{
+	int pipe = esb_tx_queue_schedule(&q);
+	int slot;
+	uint32_t data;
+
+	zassert_true(pipe >= 0, "Nothing scheduled");
+
+	slot = esb_tx_queue_peek(&q, pipe);
+	zassert_true(slot >= 0, "Scheduled pipe is empty");
+
+	data = slot_data[slot];
+	zassert_ok(esb_tx_queue_pop(&q, pipe), "Pop failed");
+
+	if (pipe_out) {
+		*pipe_out = pipe;
+	}
+
+	return data;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	esb_tx_queue_init(&q);
+}
+
+ZTEST(esb_tx_queue, test_fifo_order_per_pipe)
+{
+	for (uint32_t i = 0; i < 5; i++) {
+		push(2, i);
+	}
+
+	zassert_equal(esb_tx_queue_count(&q), 5, "Invalid count");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 2), 5, "Invalid pipe count");
+
+	for (uint32_t i = 0; i < 5; i++) {
+		zassert_equal(transmit(NULL), i, "Invalid order");
+	}
+
+	zassert_equal(esb_tx_queue_schedule(&q), -ENODATA, "Queue not empty");
+	zassert_equal(esb_tx_queue_pop(&q, 2), -ENODATA, "Pop from empty pipe");
+}
+
+ZTEST(esb_tx_queue, test_full)
+{
+	for (uint32_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
+		push(i % CONFIG_ESB_PIPE_COUNT, i);
+	}
+
+	zassert_true(esb_tx_queue_full(&q), "Queue not full");
+	zassert_equal(esb_tx_queue_alloc(&q), -ENOMEM, "Allocated from full queue");
+
+	transmit(NULL);
+	zassert_false(esb_tx_queue_full(&q), "Slot not freed");
+
+	esb_tx_queue_flush(&q);
+	zassert_equal(esb_tx_queue_count(&q), 0, "Flush failed");
+	zassert_equal(q.count_max, CONFIG_ESB_TX_FIFO_SIZE, "Invalid maximum occupancy");
+
+	/* All slots are available again after the flush. */
+	for (uint32_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
+		push(0, i);
+	}
+	zassert_true(esb_tx_queue_full(&q), "Slots lost on flush");
+}
+
+ZTEST(esb_tx_queue, test_alloc_free)
+{
+	int slot = esb_tx_queue_alloc(&q);
+
+	zassert_true(slot >= 0, "Allocation failed");
+	zassert_equal(esb_tx_queue_count(&q), 0, "Allocated slot counted as queued");
+
+	esb_tx_queue_free(&q, slot);
+
+	for (uint32_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
+		push(1, i);
+	}
+	zassert_true(esb_tx_queue_full(&q), "Freed slot lost");
+}
+
+ZTEST(esb_tx_queue, test_round_robin)
+{
+	uint8_t pipe;
+	uint32_t served = 0;
+
+	/* A burst on pipe 0 must not delay the single packets on other pipes. */
+	for (uint32_t i = 0; i < 4; i++) {
+		push(0, i);
+	}
+	push(1, 100);
+	push(3, 300);
+
+	for (size_t i = 0; i < 3; i++) {
+		transmit(&pipe);
+		served |= BIT(pipe);
+	}
+
+	zassert_equal(served, BIT(0) | BIT(1) | BIT(3), "Pipes not served in turn");
+
+	for (uint32_t i = 1; i < 4; i++) {
+		zassert_equal(transmit(&pipe), i, "Invalid order");
+		zassert_equal(pipe, 0, "Invalid pipe");
+	}
+}
+
+ZTEST(esb_tx_queue, test_weight)
+{
+	uint8_t pipes[6];
+
+	zassert_equal(esb_tx_queue_weight_set(&q, 0, 0), -EINVAL, "Zero weight accepted");
+	zassert_equal(esb_tx_queue_weight_set(&q, CONFIG_ESB_PIPE_COUNT, 1), -EINVAL,
+		      "Invalid pipe accepted");
+	zassert_ok(esb_tx_queue_weight_set(&q, 1, 2), "Weight not set");
+
+	for (uint32_t i = 0; i < 3; i++) {
+		push(1, i);
+		push(2, i);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(pipes); i++) {
+		transmit(&pipes[i]);
+	}
+
+	/* Pipe 1 sends two packets per round, pipe 2 one. */
+	zassert_equal(pipes[0], 1, "Invalid schedule");
+	zassert_equal(pipes[1], 1, "Invalid schedule");
+	zassert_equal(pipes[2], 2, "Invalid schedule");
+	zassert_equal(pipes[3], 1, "Invalid schedule");
+	zassert_equal(pipes[4], 2, "Invalid schedule");
+	zassert_equal(pipes[5], 2, "Invalid schedule");
+}
+
+ZTEST(esb_tx_queue, test_schedule_stable_until_pop)
+{
+	int pipe;
+
+	push(0, 0);
+	push(1, 1);
+
+	/* Retransmissions schedule again without popping. */
+	pipe = esb_tx_queue_schedule(&q);
+	zassert_equal(esb_tx_queue_schedule(&q), pipe, "Schedule changed without pop");
+	zassert_equal(esb_tx_queue_schedule(&q), pipe, "Schedule changed without pop");
+}
+
+ZTEST(esb_tx_queue, test_flush_keep)
+{
+	uint8_t pipe;
+
+	push(1, 10);
+	push(1, 11);
+	push(3, 30);
+	push(1, 12);
+
+	/* The packet in flight is the first one of the scheduled pipe. */
+	zassert_equal(esb_tx_queue_schedule(&q), 1, "Unexpected pipe");
+
+	esb_tx_queue_flush_keep(&q, BIT(1));
+
+	zassert_equal(esb_tx_queue_count(&q), 1, "Only the kept slot expected");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 1), 1, "Kept slot not on its pipe");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 3), 0, "Pipe not flushed");
+	zassert_equal(transmit(&pipe), 10, "Kept slot changed");
+	zassert_equal(pipe, 1, "Unexpected pipe");
+	zassert_equal(esb_tx_queue_schedule(&q), -ENODATA, "Queue not empty");
+
+	/* All slots are free again. */
+	for (uint32_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
+		push(0, i);
+	}
+
+	zassert_true(esb_tx_queue_full(&q), "Slots leaked");
+
+	/* Keeping an empty pipe flushes everything. */
+	esb_tx_queue_flush_keep(&q, BIT(2));
+	zassert_equal(esb_tx_queue_count(&q), 0, "Queue not empty");
+	zassert_false(esb_tx_queue_full(&q), "Slots not freed");
+}
+
+/* A PRX keeps the ACK payload in flight on every pipe. */
+ZTEST(esb_tx_queue, test_flush_keep_pipes)
+{
+	push(0, 1);
+	push(0, 2);
+	push(2, 20);
+	push(3, 30);
+	push(3, 31);
+
+	esb_tx_queue_flush_keep(&q, BIT(0) | BIT(1) | BIT(3));
+
+	zassert_equal(esb_tx_queue_count(&q), 2, "Only the kept slots expected");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 0), 1, "Kept slot not on its pipe");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 1), 0, "Empty pipe not empty");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 2), 0, "Pipe not flushed");
+	zassert_equal(esb_tx_queue_pipe_count(&q, 3), 1, "Kept slot not on its pipe");
+	zassert_equal(slot_data[esb_tx_queue_peek(&q, 0)], 1, "Kept slot changed");
+	zassert_equal(slot_data[esb_tx_queue_peek(&q, 3)], 30, "Kept slot changed");
+}
+
+ZTEST_SUITE(esb_tx_queue, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <unity.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#include <zephyr/fff.h>
+
+#include <net/wifi_credentials.h>
+
+#include "wifi_credentials_internal.h"
+
+DEFINE_FFF_GLOBALS;
+
+FAKE_VALUE_FUNC(int, wifi_credentials_store_entry, size_t, const void *, size_t)
+FAKE_VALUE_FUNC(int, wifi_credentials_load_entry, size_t, void *, size_t)
+FAKE_VALUE_FUNC(int, wifi_credentials_delete_entry, size_t)
+FAKE_VALUE_FUNC(int, wifi_credentials_backend_init)
+
+#define ENTRIES CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES
+/* Networks found in a scan, every other one is stored. */
+#define SCAN_COUNT (2 * ENTRIES)
+#define LOOKUP_ROUNDS 16
+
+uint8_t fake_settings_buf[ENTRIES][ENTRY_MAX_LEN];
+
+static char ssids[SCAN_COUNT][WIFI_SSID_MAX_LEN];
+static size_t ssid_lens[SCAN_COUNT];
+
+int custom_wifi_credentials_store_entry(size_t idx, const void *buf, size_t buf_len)
+{
+	TEST_ASSERT(idx < ENTRIES);
+	memcpy(fake_settings_buf[idx], buf, MIN(ENTRY_MAX_LEN, buf_len));
+	return 0;
+}
+
+int custom_wifi_credentials_load_entry(size_t idx, void *buf, size_t buf_len)
+{
+	TEST_ASSERT(idx < ENTRIES);
+	memcpy(buf, fake_settings_buf[idx], MIN(ENTRY_MAX_LEN, buf_len));
+	return 0;
+}
+
+static void password_of(size_t i, char *buf, size_t len)
+{
+	snprintf(buf, len, "password %u", (unsigned int)i);
+}
+
+/* Store the even numbered SSIDs. */
+static void store_all(void)
+{
+	char psk[WIFI_CREDENTIALS_MAX_PASSWORD_LEN];
+	int err;
+
+	for (size_t i = 0; i < SCAN_COUNT; i += 2) {
+		password_of(i, psk, sizeof(psk));
+		err = wifi_credentials_set_personal(ssids[i], ssid_lens[i],
+						    WIFI_SECURITY_TYPE_PSK, NULL, 0,
+						    psk, strlen(psk), 0);
+		TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	}
+}
+
+static void get_and_check(size_t i)
+{
+	struct wifi_credentials_personal creds;
+	char psk[WIFI_CREDENTIALS_MAX_PASSWORD_LEN];
+	int err;
+
+	err = wifi_credentials_get_by_ssid_personal_struct(ssids[i], ssid_lens[i], &creds);
+	TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	TEST_ASSERT_EQUAL(ssid_lens[i], creds.header.ssid_len);
+	TEST_ASSERT_EQUAL(0, memcmp(ssids[i], creds.header.ssid, ssid_lens[i]));
+
+	password_of(i, psk, sizeof(psk));
+	TEST_ASSERT_EQUAL(strlen(psk), creds.password_len);
+	TEST_ASSERT_EQUAL(0, memcmp(psk, creds.password, creds.password_len));
+}
+
+void setUp(void)
+{
+	RESET_FAKE(wifi_credentials_store_entry);
+	RESET_FAKE(wifi_credentials_load_entry);
+	RESET_FAKE(wifi_credentials_delete_entry);
+	wifi_credentials_store_entry_fake.custom_fake =
+		custom_wifi_credentials_store_entry;
+	wifi_credentials_load_entry_fake.custom_fake =
+		custom_wifi_credentials_load_entry;
+
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		/* Common prefixes and differing lengths, as found in real scans */
+		ssid_lens[i] = snprintf(ssids[i], sizeof(ssids[i]), "office-ap-%u",
+					(unsigned int)(i * 7));
+	}
+
+	store_all();
+	wifi_credentials_cache_invalidate();
+	RESET_FAKE(wifi_credentials_load_entry);
+	wifi_credentials_load_entry_fake.custom_fake =
+		custom_wifi_credentials_load_entry;
+}
+
+void tearDown(void)
+{
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		wifi_credentials_delete_by_ssid(ssids[i], ssid_lens[i]);
+	}
+}
+
+/* Verify that all stored networks are found, and report the lookup cost. */
+void test_lookup_all(void)
+{
+	struct wifi_credentials_personal creds;
+	uint32_t start, cycles;
+	int err;
+
+	for (size_t i = 0; i < SCAN_COUNT; i += 2) {
+		get_and_check(i);
+	}
+	TEST_ASSERT_EQUAL(ENTRIES, wifi_credentials_load_entry_fake.call_count);
+
+	for (size_t i = 1; i < SCAN_COUNT; i += 2) {
+		err = wifi_credentials_get_by_ssid_personal_struct(ssids[i], ssid_lens[i],
+								   &creds);
+		TEST_ASSERT_EQUAL(-ENOENT, err);
+	}
+	TEST_ASSERT_EQUAL(ENTRIES, wifi_credentials_load_entry_fake.call_count);
+
+	start = k_cycle_get_32();
+	for (int round = 0; round < LOOKUP_ROUNDS; ++round) {
+		for (size_t i = 1; i < SCAN_COUNT; i += 2) {
+			(void)wifi_credentials_get_by_ssid_personal_struct(ssids[i], ssid_lens[i],
+									   &creds);
+		}
+	}
+	cycles = k_cycle_get_32() - start;
+
+	printk("%d stored networks: %u cycles per failed lookup\n", ENTRIES,
+	       cycles / (LOOKUP_ROUNDS * ENTRIES));
+}
+
+/* Verify that a scan result list is matched in one call, without loading any entry. */
+void test_match_scan(void)
+{
+	static struct wifi_credentials_ssid scan[SCAN_COUNT];
+	static bool matched[SCAN_COUNT];
+	uint32_t start, cycles;
+	int found;
+
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		scan[i].ssid = ssids[i];
+		scan[i].ssid_len = ssid_lens[i];
+	}
+
+	start = k_cycle_get_32();
+	found = wifi_credentials_match_ssids(scan, SCAN_COUNT, matched);
+	cycles = k_cycle_get_32() - start;
+
+	TEST_ASSERT_EQUAL(ENTRIES, found);
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		TEST_ASSERT_EQUAL(i % 2 == 0, matched[i]);
+	}
+	TEST_ASSERT_EQUAL(0, wifi_credentials_load_entry_fake.call_count);
+
+	printk("%d stored networks: %u cycles to match %d scanned networks\n", ENTRIES,
+	       cycles, SCAN_COUNT);
+
+	/* Invalid SSIDs do not match. */
+	scan[0].ssid_len = 0;
+	scan[1].ssid = NULL;
+	found = wifi_credentials_match_ssids(scan, 2, matched);
+	TEST_ASSERT_EQUAL(0, found);
+	TEST_ASSERT_FALSE(matched[0]);
+	TEST_ASSERT_FALSE(matched[1]);
+
+	TEST_ASSERT_EQUAL(-EINVAL, wifi_credentials_match_ssids(NULL, 1, matched));
+	TEST_ASSERT_EQUAL(0, wifi_credentials_match_ssids(NULL, 0, NULL));
+}
+
+/* Verify that recently read credentials are served from the cache. */
+void test_cache_hit(void)
+{
+	get_and_check(0);
+	get_and_check(0);
+	TEST_ASSERT_EQUAL(1, wifi_credentials_load_entry_fake.call_count);
+
+	/* Fill the cache, the least recently used entry is evicted. */
+	for (size_t i = 2; i < 2 * (CONFIG_WIFI_CREDENTIALS_CACHE_SIZE + 1); i += 2) {
+		get_and_check(i);
+	}
+	TEST_ASSERT_EQUAL(CONFIG_WIFI_CREDENTIALS_CACHE_SIZE + 1,
+			  wifi_credentials_load_entry_fake.call_count);
+
+	get_and_check(2 * CONFIG_WIFI_CREDENTIALS_CACHE_SIZE);
+	TEST_ASSERT_EQUAL(CONFIG_WIFI_CREDENTIALS_CACHE_SIZE + 1,
+			  wifi_credentials_load_entry_fake.call_count);
+
+	get_and_check(0);
+	TEST_ASSERT_EQUAL(CONFIG_WIFI_CREDENTIALS_CACHE_SIZE + 2,
+			  wifi_credentials_load_entry_fake.call_count);
+}
+
+/* Verify that the cache follows updates and deletions, and can be invalidated. */
+void test_cache_invalidation(void)
+{
+	struct wifi_credentials_personal creds;
+	int err;
+
+	get_and_check(0);
+
+	err = wifi_credentials_set_personal(ssids[0], ssid_lens[0], WIFI_SECURITY_TYPE_SAE,
+					    NULL, 0, "changed", strlen("changed"), 0);
+	TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+
+	err = wifi_credentials_get_by_ssid_personal_struct(ssids[0], ssid_lens[0], &creds);
+	TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	TEST_ASSERT_EQUAL(WIFI_SECURITY_TYPE_SAE, creds.header.type);
+	TEST_ASSERT_EQUAL(0, memcmp("changed", creds.password, creds.password_len));
+	TEST_ASSERT_EQUAL(2, wifi_credentials_load_entry_fake.call_count);
+
+	err = wifi_credentials_delete_by_ssid(ssids[0], ssid_lens[0]);
+	TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	err = wifi_credentials_get_by_ssid_personal_struct(ssids[0], ssid_lens[0], &creds);
+	TEST_ASSERT_EQUAL(-ENOENT, err);
+
+	get_and_check(2);
+	wifi_credentials_cache_invalidate();
+	get_and_check(2);
+	TEST_ASSERT_EQUAL(4, wifi_credentials_load_entry_fake.call_count);
+}
+
+/* Verify that deleting entries keeps the others reachable in the SSID index. */
+void test_delete_and_reuse(void)
+{
+	char psk[WIFI_CREDENTIALS_MAX_PASSWORD_LEN];
+	int err;
+
+	for (size_t i = 0; i < SCAN_COUNT; i += 4) {
+		err = wifi_credentials_delete_by_ssid(ssids[i], ssid_lens[i]);
+		TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	}
+
+	for (size_t i = 2; i < SCAN_COUNT; i += 4) {
+		get_and_check(i);
+	}
+
+	/* Freed slots are reused by networks that were not stored. */
+	for (size_t i = 1; i < SCAN_COUNT; i += 4) {
+		password_of(i, psk, sizeof(psk));
+		err = wifi_credentials_set_personal(ssids[i], ssid_lens[i],
+						    WIFI_SECURITY_TYPE_PSK, NULL, 0,
+						    psk, strlen(psk), 0);
+		TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	}
+
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		if (i % 4 == 0 || i % 4 == 3) {
+			struct wifi_credentials_personal creds;
+
+			err = wifi_credentials_get_by_ssid_personal_struct(ssids[i],
+									   ssid_lens[i],
+									   &creds);
+			TEST_ASSERT_EQUAL(-ENOENT, err);
+		} else {
+			get_and_check(i);
+		}
+	}
+}
+
+/* It is required to be added to each test. That is because unity's
+ * main may return nonzero, while zephyr's main currently must
+ * return 0 in all cases (other values are reserved).
+ */
+extern int unity_main(void);
+
+int main(void)
+{
+	/* use the runner from test_runner_generate() */
+	(void)unity_main();
+
+	return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <unity.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+
+#include <net/wifi_credentials.h>
+
+#include "wifi_credentials_internal.h"
+
+#define ENTRIES CONFIG_WIFI_CREDENTIALS_MAX_ENTRIES
+/* Networks found in a scan, every other one is stored. */
+#define SCAN_COUNT (2 * ENTRIES)
+
+extern struct k_mutex wifi_credentials_mutex;
+
+static char ssids[SCAN_COUNT][WIFI_SSID_MAX_LEN];
+static size_t ssid_lens[SCAN_COUNT];
+
+static void password_of(size_t i, const char *prefix, char *buf, size_t len)
+{
+	snprintf(buf, len, "%s %u", prefix, (unsigned int)i);
+}
+
+static void store(size_t i, const char *prefix)
+{
+	char psk[WIFI_CREDENTIALS_MAX_PASSWORD_LEN];
+	int err;
+
+	password_of(i, prefix, psk, sizeof(psk));
+	err = wifi_credentials_set_personal(ssids[i], ssid_lens[i], WIFI_SECURITY_TYPE_PSK, NULL,
+					    0, psk, strlen(psk), 0);
+	TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+}
+
+static void get_and_check(size_t i, const char *prefix)
+{
+	struct wifi_credentials_personal creds;
+	char psk[WIFI_CREDENTIALS_MAX_PASSWORD_LEN];
+	int err;
+
+	err = wifi_credentials_get_by_ssid_personal_struct(ssids[i], ssid_lens[i], &creds);
+	TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	TEST_ASSERT_EQUAL(ssid_lens[i], creds.header.ssid_len);
+	TEST_ASSERT_EQUAL(0, memcmp(ssids[i], creds.header.ssid, ssid_lens[i]));
+
+	password_of(i, prefix, psk, sizeof(psk));
+	TEST_ASSERT_EQUAL(strlen(psk), creds.password_len);
+	TEST_ASSERT_EQUAL(0, memcmp(psk, creds.password, creds.password_len));
+}
+
+static void check_missing(size_t i)
+{
+	struct wifi_credentials_personal creds;
+	int err;
+
+	err = wifi_credentials_get_by_ssid_personal_struct(ssids[i], ssid_lens[i], &creds);
+	TEST_ASSERT_EQUAL(-ENOENT, err);
+}
+
+static int count_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+		    void *param)
+{
+	size_t *count = param;
+
+	/* Deleted entries may be reported with no value. */
+	if (len > 0) {
+		(*count)++;
+	}
+
+	return 0;
+}
+
+/* Count the entries stored in the settings. */
+static size_t stored_count(void)
+{
+	size_t count = 0;
+	int err;
+
+	err = settings_load_subtree_direct("wifi_cred", count_cb, &count);
+	TEST_ASSERT_EQUAL(0, err);
+
+	return count;
+}
+
+static int match_count(void)
+{
+	static struct wifi_credentials_ssid scan[SCAN_COUNT];
+	static bool matched[SCAN_COUNT];
+
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		scan[i].ssid = ssids[i];
+		scan[i].ssid_len = ssid_lens[i];
+	}
+
+	return wifi_credentials_match_ssids(scan, SCAN_COUNT, matched);
+}
+
+/* Drop the SSID index and the cached credentials, as a reboot does, and build the index
+ * again from the settings.
+ */
+static void index_reload(void)
+{
+	int err;
+
+	k_mutex_lock(&wifi_credentials_mutex, K_FOREVER);
+
+	for (size_t i = 0; i < ENTRIES; ++i) {
+		wifi_credentials_uncache_ssid(i);
+	}
+
+	k_mutex_unlock(&wifi_credentials_mutex);
+
+	TEST_ASSERT_EQUAL(0, match_count());
+
+	k_mutex_lock(&wifi_credentials_mutex, K_FOREVER);
+	err = wifi_credentials_backend_init();
+	k_mutex_unlock(&wifi_credentials_mutex);
+
+	TEST_ASSERT_EQUAL(0, err);
+}
+
+void setUp(void)
+{
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		/* Common prefixes and differing lengths, as found in real scans */
+		ssid_lens[i] = snprintf(ssids[i], sizeof(ssids[i]), "office-ap-%u",
+					(unsigned int)(i * 7));
+	}
+
+	/* The flash may hold the entries of an earlier run. */
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		wifi_credentials_delete_by_ssid(ssids[i], ssid_lens[i]);
+	}
+	TEST_ASSERT_EQUAL(0, stored_count());
+
+	/* Store the even numbered SSIDs. */
+	for (size_t i = 0; i < SCAN_COUNT; i += 2) {
+		store(i, "password");
+	}
+}
+
+void tearDown(void)
+{
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		wifi_credentials_delete_by_ssid(ssids[i], ssid_lens[i]);
+	}
+}
+
+/* Verify that the stored networks are found through the index rebuilt from the settings. */
+void test_reload(void)
+{
+	TEST_ASSERT_EQUAL(ENTRIES, stored_count());
+
+	index_reload();
+
+	TEST_ASSERT_EQUAL(ENTRIES, match_count());
+	for (size_t i = 0; i < SCAN_COUNT; i += 2) {
+		get_and_check(i, "password");
+	}
+	for (size_t i = 1; i < SCAN_COUNT; i += 2) {
+		check_missing(i);
+	}
+
+	/* The list is full. */
+	TEST_ASSERT_EQUAL(-ENOBUFS,
+			  wifi_credentials_set_personal(ssids[1], ssid_lens[1],
+							WIFI_SECURITY_TYPE_NONE, NULL, 0, NULL,
+							0, 0));
+}
+
+/* Verify that updates and deletions are persisted, and that slots freed before a reload
+ * are reused after it.
+ */
+void test_reload_after_changes(void)
+{
+	int err;
+
+	/* Read into the cache, then update. The reload must not serve the old values. */
+	get_and_check(2, "password");
+	store(2, "updated");
+
+	for (size_t i = 0; i < SCAN_COUNT; i += 4) {
+		err = wifi_credentials_delete_by_ssid(ssids[i], ssid_lens[i]);
+		TEST_ASSERT_EQUAL(EXIT_SUCCESS, err);
+	}
+	TEST_ASSERT_EQUAL(ENTRIES / 2, stored_count());
+
+	index_reload();
+
+	TEST_ASSERT_EQUAL(ENTRIES / 2, match_count());
+	get_and_check(2, "updated");
+	for (size_t i = 0; i < SCAN_COUNT; i += 4) {
+		check_missing(i);
+	}
+	for (size_t i = 6; i < SCAN_COUNT; i += 4) {
+		get_and_check(i, "password");
+	}
+
+	/* Freed slots are reused by networks that were not stored. */
+	for (size_t i = 1; i < SCAN_COUNT; i += 4) {
+		store(i, "password");
+	}
+	TEST_ASSERT_EQUAL(ENTRIES, stored_count());
+
+	index_reload();
+
+	TEST_ASSERT_EQUAL(ENTRIES, match_count());
+	for (size_t i = 0; i < SCAN_COUNT; ++i) {
+		if (i % 4 == 0 || i % 4 == 3) {
+			check_missing(i);
+		} else if (i == 2) {
+			get_and_check(i, "updated");
+		} else {
+			get_and_check(i, "password");
+		}
+	}
+}
+
+/* It is required to be added to each test. That is because unity's
+ * main may return nonzero, while zephyr's main currently must
+ * return 0 in all cases (other values are reserved).
+ */
+extern int unity_main(void);
+
+int main(void)
+{
+	/* use the runner from test_runner_generate() */
+	(void)unity_main();
+
+	return 0;
+}
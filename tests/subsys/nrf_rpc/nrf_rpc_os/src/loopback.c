@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stddef.h>
+#include <zephyr/kernel.h>
+
+#include <nrf_rpc.h>
+#include <nrf_rpc_errno.h>
+
+#include "loopback.h"
+
+#define RX_STACK_SIZE 2048
+#define RX_PRIORITY 0
+
+struct loopback_pkt {
+	void *fifo_reserved;
+	size_t len;
+	uint8_t data[];
+};
+
+static K_FIFO_DEFINE(rx_fifo);
+
+static nrf_rpc_tr_receive_handler_t receive_cb;
+static void *receive_ctx;
+
+static struct loopback_pkt *pkt_get(const void *data)
+{
+	return (struct loopback_pkt *)((uint8_t *)data - offsetof(struct loopback_pkt, data));
+}
+
+static void rx_entry(void *p1, void *p2, void *p3)
+{
+	struct loopback_pkt *pkt;
+
+	while (true) {
+		pkt = k_fifo_get(&rx_fifo, K_FOREVER);
+
+		receive_cb(&loopback_tr, pkt->data, pkt->len, receive_ctx);
+		k_free(pkt);
+	}
+}
+
+K_THREAD_DEFINE(loopback_rx, RX_STACK_SIZE, rx_entry, NULL, NULL, NULL, RX_PRIORITY, 0, 0);
+
+static int init(const struct nrf_rpc_tr *transport, nrf_rpc_tr_receive_handler_t cb,
+		void *context)
+{
+	if (cb == NULL) {
+		return -NRF_EINVAL;
+	}
+
+	receive_ctx = context;
+	receive_cb = cb;
+
+	return 0;
+}
+
+static int send(const struct nrf_rpc_tr *transport, const uint8_t *data, size_t length)
+{
+	struct loopback_pkt *pkt = pkt_get(data);
+
+	pkt->len = length;
+	k_fifo_put(&rx_fifo, pkt);
+
+	return 0;
+}
+
+static void *tx_buf_alloc(const struct nrf_rpc_tr *transport, size_t *size)
+{
+	struct loopback_pkt *pkt = k_malloc(sizeof(*pkt) + *size);
+
+	if (!pkt) {
+		/* It should fail to avoid writing to NULL buffer. */
+		k_oops();
+		*size = 0;
+		return NULL;
+	}
+
+	return pkt->data;
+}
+
+static void tx_buf_free(const struct nrf_rpc_tr *transport, void *buf)
+{
+	k_free(pkt_get(buf));
+}
+
+static const struct nrf_rpc_tr_api loopback_api = {
+	.init = init,
+	.send = send,
+	.tx_buf_alloc = tx_buf_alloc,
+	.tx_buf_free = tx_buf_free
+};
+
+const struct nrf_rpc_tr loopback_tr = {
+	.api = &loopback_api,
+};
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef LOOPBACK_H_
+#define LOOPBACK_H_
+
+#include <nrf_rpc_tr.h>
+
+/* nRF RPC transport delivering every sent packet back to the local core.
+ * Packets are received in a single thread, like from an IPC endpoint.
+ */
+extern const struct nrf_rpc_tr loopback_tr;
+
+#endif /* LOOPBACK_H_ */
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include <nrf_rpc.h>
+#include <nrf_rpc_cbor.h>
+#include <nrf_rpc_os.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+
+#include "loopback.h"
+
+#define SLOW_CMD 0x01
+#define FAST_EVT 0x01
+
+/* Slow commands keep every thread of the default pool busy. */
+#define SLOW_CLIENT_COUNT CONFIG_NRF_RPC_THREAD_POOL_SIZE
+#define SLOW_CMD_COUNT 10
+#define SLOW_HANDLER_US 5000
+
+#define FAST_EVT_COUNT 20
+#define FAST_EVT_INTERVAL_MS 3
+
+#define CLIENT_STACK_SIZE 2048
+#define CLIENT_PRIORITY 1
+
+NRF_RPC_GROUP_DEFINE(slow_grp, "slow", &loopback_tr, NULL, NULL, NULL);
+NRF_RPC_GROUP_DEFINE(fast_grp, "fast", &loopback_tr, NULL, NULL, NULL);
+
+static K_THREAD_STACK_ARRAY_DEFINE(client_stacks, SLOW_CLIENT_COUNT + 1, CLIENT_STACK_SIZE);
+static struct k_thread client_threads[SLOW_CLIENT_COUNT + 1];
+
+static K_SEM_DEFINE(fast_done, 0, 1);
+static atomic_t fast_handled;
+static uint32_t fast_latency_us_max;
+
+static void err_handler(const struct nrf_rpc_err_report *report)
+{
+	zassert_unreachable("nRF RPC error %d", report->code);
+}
+
+static void slow_cmd_handler(const struct nrf_rpc_group *group, struct nrf_rpc_cbor_ctx *ctx,
+			     void *handler_data)
+{
+	struct nrf_rpc_cbor_ctx rsp;
+
+	nrf_rpc_cbor_decoding_done(group, ctx);
+
+	k_busy_wait(SLOW_HANDLER_US);
+
+	NRF_RPC_CBOR_ALLOC(group, rsp, 0);
+	nrf_rpc_cbor_rsp_no_err(group, &rsp);
+}
+
+NRF_RPC_CBOR_CMD_DECODER(slow_grp, slow_cmd, SLOW_CMD, slow_cmd_handler, NULL);
+
+static void fast_evt_handler(const struct nrf_rpc_group *group, struct nrf_rpc_cbor_ctx *ctx,
+			     void *handler_data)
+{
+	uint32_t sent = 0;
+	uint32_t latency_us;
+
+	zassert_true(zcbor_uint32_decode(ctx->zs, &sent), "Invalid event");
+	nrf_rpc_cbor_decoding_done(group, ctx);
+
+	latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - sent);
+	fast_latency_us_max = MAX(fast_latency_us_max, latency_us);
+
+	if (atomic_inc(&fast_handled) + 1 == FAST_EVT_COUNT) {
+		k_sem_give(&fast_done);
+	}
+}
+
+NRF_RPC_CBOR_EVT_DECODER(fast_grp, fast_evt, FAST_EVT, fast_evt_handler, NULL);
+
+static void slow_rsp_handler(const struct nrf_rpc_group *group, struct nrf_rpc_cbor_ctx *ctx,
+			     void *handler_data)
+{
+}
+
+static void slow_client(void *p1, void *p2, void *p3)
+{
+	struct nrf_rpc_cbor_ctx ctx;
+
+	for (size_t i = 0; i < SLOW_CMD_COUNT; i++) {
+		NRF_RPC_CBOR_ALLOC(&slow_grp, ctx, 0);
+		nrf_rpc_cbor_cmd_no_err(&slow_grp, SLOW_CMD, &ctx, slow_rsp_handler, NULL);
+	}
+}
+
+static void fast_client(void *p1, void *p2, void *p3)
+{
+	struct nrf_rpc_cbor_ctx ctx;
+
+	for (size_t i = 0; i < FAST_EVT_COUNT; i++) {
+		k_msleep(FAST_EVT_INTERVAL_MS);
+
+		NRF_RPC_CBOR_ALLOC(&fast_grp, ctx, 1 + sizeof(uint32_t));
+		zcbor_uint32_put(ctx.zs, k_cycle_get_32());
+		nrf_rpc_cbor_evt_no_err(&fast_grp, FAST_EVT, &ctx);
+	}
+}
+
+static void pool_stats_print(enum nrf_rpc_os_pool pool)
+{
+	struct nrf_rpc_os_pool_stats stats;
+
+	zassert_ok(nrf_rpc_os_pool_stats_get(pool, &stats), "No stats");
+	zassert_true(stats.wakeups <= stats.handled, "More wakeups than packets");
+
+	printk("Pool %u: handled %u in %u wakeups, max depth %u, max wait %u us, "
+	       "avg wait %llu us\n",
+	       pool, stats.handled, stats.wakeups, stats.depth_max, stats.wait_us_max,
+	       stats.handled ? stats.wait_us_total / stats.handled : 0);
+}
+
+/* Runs slow commands on all threads of the default pool while events of
+ * another group arrive, and returns the worst latency of the events.
+ */
+static uint32_t mixed_run(void)
+{
+	int64_t start;
+	int64_t time_ms;
+	size_t rpc_count = SLOW_CLIENT_COUNT * SLOW_CMD_COUNT + FAST_EVT_COUNT;
+
+	start = k_uptime_get();
+
+	for (size_t i = 0; i < ARRAY_SIZE(client_threads); i++) {
+		k_thread_create(&client_threads[i], client_stacks[i],
+				K_THREAD_STACK_SIZEOF(client_stacks[i]),
+				(i < SLOW_CLIENT_COUNT) ? slow_client : fast_client,
+				NULL, NULL, NULL, CLIENT_PRIORITY, 0, K_NO_WAIT);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(client_threads); i++) {
+		zassert_ok(k_thread_join(&client_threads[i], K_SECONDS(10)), "Client stuck");
+	}
+
+	zassert_ok(k_sem_take(&fast_done, K_SECONDS(1)), "Events not handled");
+
+	time_ms = MAX(k_uptime_get() - start, 1);
+	printk("Handled %zu RPCs in %lld ms (%lld RPCs/s), max event latency %u us\n",
+	       rpc_count, time_ms, (int64_t)rpc_count * MSEC_PER_SEC / time_ms,
+	       fast_latency_us_max);
+
+	pool_stats_print(NRF_RPC_OS_POOL_DEFAULT);
+	pool_stats_print(NRF_RPC_OS_POOL_HIGH_PRIO);
+
+	return fast_latency_us_max;
+}
+
+static void *setup(void)
+{
+	zassert_ok(nrf_rpc_init(err_handler), "Init failed");
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(nrf_rpc_os_group_pool_set(slow_grp.data->src_group_id,
+					     NRF_RPC_OS_POOL_DEFAULT));
+	zassert_ok(nrf_rpc_os_group_pool_set(fast_grp.data->src_group_id,
+					     NRF_RPC_OS_POOL_DEFAULT));
+
+	atomic_clear(&fast_handled);
+	fast_latency_us_max = 0;
+	k_sem_reset(&fast_done);
+	nrf_rpc_os_pool_stats_reset();
+}
+
+ZTEST(nrf_rpc_os, test_mixed_workload_shared_pool)
+{
+	struct nrf_rpc_os_pool_stats stats;
+
+	mixed_run();
+
+	zassert_ok(nrf_rpc_os_pool_stats_get(NRF_RPC_OS_POOL_HIGH_PRIO, &stats));
+	zassert_equal(stats.handled, 0, "Events handled by the high-priority pool");
+}
+
+ZTEST(nrf_rpc_os, test_mixed_workload_high_prio_pool)
+{
+	struct nrf_rpc_os_pool_stats stats;
+	uint32_t latency_us;
+
+	zassert_ok(nrf_rpc_os_group_pool_set(fast_grp.data->src_group_id,
+					     NRF_RPC_OS_POOL_HIGH_PRIO));
+
+	latency_us = mixed_run();
+
+	zassert_ok(nrf_rpc_os_pool_stats_get(NRF_RPC_OS_POOL_HIGH_PRIO, &stats));
+	zassert_equal(stats.handled, FAST_EVT_COUNT, "Events not handled by their pool");
+	zassert_equal(stats.depth, 0, "Queue not empty");
+
+	/* Events never wait for a slow command to complete. */
+	zassert_true(latency_us < SLOW_HANDLER_US, "Events waited %u us", latency_us);
+}
+
+ZTEST(nrf_rpc_os, test_invalid_pool)
+{
+	struct nrf_rpc_os_pool_stats stats;
+
+	zassert_equal(nrf_rpc_os_group_pool_set(0, NRF_RPC_OS_POOL_HIGH_PRIO + 1), -EINVAL,
+		      "Pool should not exist");
+	zassert_equal(nrf_rpc_os_pool_stats_get(NRF_RPC_OS_POOL_HIGH_PRIO + 1, &stats),
+		      -EINVAL, "Pool should not exist");
+}
+
+ZTEST(nrf_rpc_os, test_stats_reset)
+{
+	struct nrf_rpc_os_pool_stats stats;
+
+	mixed_run();
+	nrf_rpc_os_pool_stats_reset();
+	zassert_ok(nrf_rpc_os_pool_stats_get(NRF_RPC_OS_POOL_DEFAULT, &stats));
+
+	zassert_equal(stats.handled, 0, "Handled count not reset");
+	zassert_equal(stats.wakeups, 0, "Wakeup count not reset");
+	zassert_equal(stats.depth_max, 0, "Max depth not reset");
+	zassert_equal(stats.wait_us_max, 0, "Max wait not reset");
+	zassert_equal(stats.wait_us_total, 0, "Total wait not reset");
+}
+
+ZTEST(nrf_rpc_os, test_ctx_pool)
+{
+	uint32_t ctx[CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE];
+	ATOMIC_DEFINE(used, CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE) = {0};
+
+	/* More contexts than fit in a single 32-bit mask. */
+	for (size_t i = 0; i < ARRAY_SIZE(ctx); i++) {
+		ctx[i] = nrf_rpc_os_ctx_pool_reserve();
+		zassert_true(ctx[i] < CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE,
+			     "Invalid context %u", ctx[i]);
+		zassert_false(atomic_test_and_set_bit(used, ctx[i]),
+			      "Context %u reserved twice", ctx[i]);
+	}
+
+	nrf_rpc_os_ctx_pool_release(ctx[35]);
+	zassert_equal(nrf_rpc_os_ctx_pool_reserve(), ctx[35], "Released context not reused");
+
+	for (size_t i = 0; i < ARRAY_SIZE(ctx); i++) {
+		nrf_rpc_os_ctx_pool_release(ctx[i]);
+	}
+
+	zassert_equal(nrf_rpc_os_ctx_pool_reserve(), 0, "Lowest context not preferred");
+	nrf_rpc_os_ctx_pool_release(0);
+}
+
+ZTEST_SUITE(nrf_rpc_os, NULL, setup, before, NULL, NULL);